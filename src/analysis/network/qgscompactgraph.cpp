@@ -0,0 +1,143 @@
+/***************************************************************************
+  qgscompactgraph.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#include "qgscompactgraph.h"
+#include "qgsgraph.h"
+
+QgsCompactGraph::QgsCompactGraph( const QgsGraph &graph )
+{
+  const int vertexCount = graph.vertexCount();
+  const int edgeCount = graph.edgeCount();
+
+  QVector<double> x( vertexCount );
+  QVector<double> y( vertexCount );
+  for ( int i = 0; i < vertexCount; ++i )
+  {
+    const QgsPointXY pt = graph.vertex( i ).point();
+    x[ i ] = pt.x();
+    y[ i ] = pt.y();
+  }
+
+  const int strategyCount = edgeCount > 0 ? graph.edge( 0 ).strategies().size() : 0;
+  QVector<int> from( edgeCount );
+  QVector<int> to( edgeCount );
+  QVector<double> costs( edgeCount * strategyCount, 0.0 );
+  for ( int i = 0; i < edgeCount; ++i )
+  {
+    const QgsGraphEdge &edge = graph.edge( i );
+    from[ i ] = edge.outVertex();
+    to[ i ] = edge.inVertex();
+    const QVector< QVariant > strategies = edge.strategies();
+    for ( int s = 0; s < strategyCount && s < strategies.size(); ++s )
+    {
+      costs[ i * strategyCount + s ] = strategies.at( s ).toDouble();
+    }
+  }
+
+  build( x, y, from, to, costs, strategyCount );
+}
+
+void QgsCompactGraph::build( const QVector<double> &x, const QVector<double> &y, const QVector<int> &from, const QVector<int> &to,
+                             const QVector<double> &costs, int strategyCount )
+{
+  const int vertexCount = x.size();
+  const int edgeCount = from.size();
+
+  mX = x;
+  mY = y;
+
+  // counting sort of the edges by outgoing vertex, stable so that parallel edges
+  // keep their source order
+  mOutOffsets.fill( 0, vertexCount + 1 );
+  mInOffsets.fill( 0, vertexCount + 1 );
+  for ( int i = 0; i < edgeCount; ++i )
+  {
+    ++mOutOffsets[ from.at( i ) + 1 ];
+    ++mInOffsets[ to.at( i ) + 1 ];
+  }
+  for ( int v = 0; v < vertexCount; ++v )
+  {
+    mOutOffsets[ v + 1 ] += mOutOffsets.at( v );
+    mInOffsets[ v + 1 ] += mInOffsets.at( v );
+  }
+
+  mEdgeFrom.resize( edgeCount );
+  mEdgeTo.resize( edgeCount );
+  mEdgeSource.resize( edgeCount );
+  mCosts.fill( QVector<double>( edgeCount ), strategyCount );
+
+  QVector<int> next = mOutOffsets;
+  for ( int i = 0; i < edgeCount; ++i )
+  {
+    const int edge = next[ from.at( i ) ]++;
+    mEdgeFrom[ edge ] = from.at( i );
+    mEdgeTo[ edge ] = to.at( i );
+    mEdgeSource[ edge ] = i;
+    for ( int s = 0; s < strategyCount; ++s )
+    {
+      mCosts[ s ][ edge ] = costs.at( i * strategyCount + s );
+    }
+  }
+
+  mInEdges.resize( edgeCount );
+  next = mInOffsets;
+  for ( int edge = 0; edge < edgeCount; ++edge )
+  {
+    mInEdges[ next[ mEdgeTo.at( edge ) ]++ ] = edge;
+  }
+}
+
+int QgsCompactGraph::findVertex( const QgsPointXY &pt ) const
+{
+  for ( int i = 0; i < mX.size(); ++i )
+  {
+    if ( qgsDoubleNear( mX.at( i ), pt.x() ) && qgsDoubleNear( mY.at( i ), pt.y() ) )
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+QVector<int> QgsCompactGraph::inEdges( int idx ) const
+{
+  return mInEdges.mid( mInOffsets.at( idx ), mInOffsets.at( idx + 1 ) - mInOffsets.at( idx ) );
+}
+
+QgsGraph *QgsCompactGraph::toGraph() const
+{
+  QgsGraph *graph = new QgsGraph();
+  for ( int i = 0; i < mX.size(); ++i )
+  {
+    graph->addVertex( QgsPointXY( mX.at( i ), mY.at( i ) ) );
+  }
+
+  QVector<int> bySource( mEdgeSource.size() );
+  for ( int edge = 0; edge < mEdgeSource.size(); ++edge )
+  {
+    bySource[ mEdgeSource.at( edge ) ] = edge;
+  }
+
+  QVector< QVariant > strategies( mCosts.size() );
+  Q_FOREACH ( int edge, bySource )
+  {
+    for ( int s = 0; s < mCosts.size(); ++s )
+    {
+      strategies[ s ] = mCosts.at( s ).at( edge );
+    }
+    graph->addEdge( mEdgeFrom.at( edge ), mEdgeTo.at( edge ), strategies );
+  }
+  return graph;
+}
@@ -0,0 +1,207 @@
+/***************************************************************************
+  qgscompactgraph.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSCOMPACTGRAPH_H
+#define QGSCOMPACTGRAPH_H
+
+#include <QVector>
+
+#include "qgspointxy.h"
+#include "qgis.h"
+#include "qgis_analysis.h"
+
+class QgsGraph;
+
+/**
+ * \ingroup analysis
+ * \class QgsCompactGraph
+ * \since QGIS 3.0
+ * \brief Frozen graph stored in compressed sparse row form.
+ *
+ * Edges are renumbered so that the outgoing edges of a vertex have consecutive indices,
+ * and all data is kept in flat arrays: one offset per vertex, one target vertex per edge
+ * and one column of double costs per strategy. A second offset array lists incoming edges
+ * per vertex. Compared with QgsGraph, which keeps two edge lists per vertex and a
+ * QVector of QVariant costs per edge, this needs an order of magnitude less memory and
+ * lets searches read adjacency sequentially.
+ *
+ * A compact graph cannot be modified. Create it from an existing QgsGraph or directly
+ * with QgsCompactGraphBuilder. Copies are cheap as all arrays are implicitly shared.
+ *
+ * \see QgsCompactGraphBuilder
+ */
+class ANALYSIS_EXPORT QgsCompactGraph
+{
+  public:
+
+    /**
+     * Constructor for an empty QgsCompactGraph
+     */
+    QgsCompactGraph() = default;
+
+    /**
+     * Creates a compact copy of \a graph. Strategy costs are converted to double.
+     */
+    explicit QgsCompactGraph( const QgsGraph &graph );
+
+    /**
+     * Returns number of graph vertices
+     */
+    int vertexCount() const { return mX.size(); }
+
+    /**
+     * Returns number of graph edges
+     */
+    int edgeCount() const { return mEdgeTo.size(); }
+
+    /**
+     * Returns number of cost strategies stored for each edge
+     */
+    int strategyCount() const { return mCosts.size(); }
+
+    /**
+     * Returns point associated with vertex at index \a idx
+     */
+    QgsPointXY vertexPoint( int idx ) const { return QgsPointXY( mX.at( idx ), mY.at( idx ) ); }
+
+    /**
+     * Find vertex by associated point
+     * \returns vertex index, or -1 if no vertex matches
+     */
+    int findVertex( const QgsPointXY &pt ) const;
+
+    /**
+     * Returns the index of the first outgoing edge of vertex \a idx. Outgoing
+     * edges of the vertex are the indices from outEdgesBegin() up to, but
+     * excluding, outEdgesEnd().
+     */
+    int outEdgesBegin( int idx ) const { return mOutOffsets.at( idx ); }
+
+    /**
+     * Returns the index following the last outgoing edge of vertex \a idx.
+     * \see outEdgesBegin()
+     */
+    int outEdgesEnd( int idx ) const { return mOutOffsets.at( idx + 1 ); }
+
+    /**
+     * Returns indices of the edges ending at vertex \a idx
+     */
+    QVector<int> inEdges( int idx ) const;
+
+    /**
+     * Returns index of the outgoing vertex of edge \a edgeIdx
+     */
+    int edgeOutVertex( int edgeIdx ) const { return mEdgeFrom.at( edgeIdx ); }
+
+    /**
+     * Returns index of the incoming vertex of edge \a edgeIdx
+     */
+    int edgeInVertex( int edgeIdx ) const { return mEdgeTo.at( edgeIdx ); }
+
+    /**
+     * Returns cost of edge \a edgeIdx calculated using strategy \a strategyIndex
+     */
+    double edgeCost( int edgeIdx, int strategyIndex ) const { return mCosts.at( strategyIndex ).at( edgeIdx ); }
+
+    /**
+     * Returns the index the edge \a edgeIdx had in the source it was created from,
+     * i.e. the edge index in the source QgsGraph, or the order in which the edge was
+     * added to QgsCompactGraphBuilder.
+     */
+    int sourceEdgeId( int edgeIdx ) const { return mEdgeSource.at( edgeIdx ); }
+
+    /**
+     * Returns a new QgsGraph with the same vertices and edges. Edges are added in
+     * their source order, so edge indices of the result match sourceEdgeId().
+     */
+    QgsGraph *toGraph() const SIP_FACTORY;
+
+#ifndef SIP_RUN
+
+    /**
+     * Returns the outgoing edge offsets, vertexCount() + 1 values.
+     * \note not available in Python bindings
+     */
+    const int *outOffsets() const { return mOutOffsets.constData(); }
+
+    /**
+     * Returns the outgoing vertex of each edge.
+     * \note not available in Python bindings
+     */
+    const int *edgeOutVertices() const { return mEdgeFrom.constData(); }
+
+    /**
+     * Returns the incoming vertex of each edge.
+     * \note not available in Python bindings
+     */
+    const int *edgeInVertices() const { return mEdgeTo.constData(); }
+
+    /**
+     * Returns the incoming edge offsets into inEdgeIds(), vertexCount() + 1 values.
+     * \note not available in Python bindings
+     */
+    const int *inOffsets() const { return mInOffsets.constData(); }
+
+    /**
+     * Returns the indices of incoming edges, grouped by incoming vertex.
+     * \note not available in Python bindings
+     */
+    const int *inEdgeIds() const { return mInEdges.constData(); }
+
+    /**
+     * Returns the cost column of strategy \a strategyIndex.
+     * \note not available in Python bindings
+     */
+    const double *costs( int strategyIndex ) const { return mCosts.at( strategyIndex ).constData(); }
+
+    /**
+     * Returns the x coordinates of all vertices.
+     * \note not available in Python bindings
+     */
+    const double *vertexX() const { return mX.constData(); }
+
+    /**
+     * Returns the y coordinates of all vertices.
+     * \note not available in Python bindings
+     */
+    const double *vertexY() const { return mY.constData(); }
+
+#endif
+
+  private:
+
+    /**
+     * Builds the compressed rows from flat per edge arrays. \a costs holds
+     * \a strategyCount values per edge, edge after edge.
+     */
+    void build( const QVector<double> &x, const QVector<double> &y, const QVector<int> &from, const QVector<int> &to,
+                const QVector<double> &costs, int strategyCount );
+
+    QVector<double> mX;
+    QVector<double> mY;
+
+    QVector<int> mOutOffsets;
+    QVector<int> mEdgeFrom;
+    QVector<int> mEdgeTo;
+    QVector<int> mEdgeSource;
+    QVector< QVector<double> > mCosts;
+
+    QVector<int> mInOffsets;
+    QVector<int> mInEdges;
+
+    friend class QgsCompactGraphBuilder;
+};
+
+#endif // QGSCOMPACTGRAPH_H
@@ -0,0 +1,59 @@
+/***************************************************************************
+  qgscompactgraphbuilder.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#include "qgscompactgraphbuilder.h"
+#include "qgscompactgraph.h"
+
+#include <algorithm>
+
+QgsCompactGraphBuilder::QgsCompactGraphBuilder( const QgsCoordinateReferenceSystem &crs, bool otfEnabled, double topologyTolerance, const QString &ellipsoidID )
+  : QgsGraphBuilderInterface( crs, otfEnabled, topologyTolerance, ellipsoidID )
+{
+}
+
+void QgsCompactGraphBuilder::addVertex( int, const QgsPointXY &pt )
+{
+  mX.append( pt.x() );
+  mY.append( pt.y() );
+}
+
+void QgsCompactGraphBuilder::addEdge( int pt1id, const QgsPointXY &, int pt2id, const QgsPointXY &, const QVector< QVariant > &prop )
+{
+  // all edges produced by a director carry the same strategies, the first edge defines
+  // the column count
+  if ( mStrategyCount < 0 )
+    mStrategyCount = prop.size();
+
+  mFrom.append( pt1id );
+  mTo.append( pt2id );
+  for ( int s = 0; s < mStrategyCount; ++s )
+  {
+    mCosts.append( s < prop.size() ? prop.at( s ).toDouble() : 0.0 );
+  }
+}
+
+QgsCompactGraph *QgsCompactGraphBuilder::compactGraph()
+{
+  QgsCompactGraph *graph = new QgsCompactGraph();
+  graph->build( mX, mY, mFrom, mTo, mCosts, std::max( mStrategyCount, 0 ) );
+
+  mX.clear();
+  mY.clear();
+  mFrom.clear();
+  mTo.clear();
+  mCosts.clear();
+  mStrategyCount = -1;
+  return graph;
+}
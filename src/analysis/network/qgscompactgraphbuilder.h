@@ -0,0 +1,63 @@
+/***************************************************************************
+  qgscompactgraphbuilder.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSCOMPACTGRAPHBUILDER_H
+#define QGSCOMPACTGRAPHBUILDER_H
+
+#include "qgsgraphbuilderinterface.h"
+#include "qgis.h"
+#include "qgis_analysis.h"
+
+class QgsCompactGraph;
+
+/**
+* \ingroup analysis
+* \class QgsCompactGraphBuilder
+* \since QGIS 3.0
+* \brief This class is used for making a QgsCompactGraph object.
+*
+* Vertices and edges are collected in flat arrays and only converted to compressed
+* rows once, when compactGraph() is called, so no intermediate QgsGraph is created.
+*/
+class ANALYSIS_EXPORT QgsCompactGraphBuilder : public QgsGraphBuilderInterface
+{
+  public:
+
+    /**
+     * Default constructor
+     */
+    QgsCompactGraphBuilder( const QgsCoordinateReferenceSystem &crs, bool otfEnabled = true, double topologyTolerance = 0.0, const QString &ellipsoidID = "WGS84" );
+
+    virtual void addVertex( int id, const QgsPointXY &pt ) override;
+
+    virtual void addEdge( int pt1id, const QgsPointXY &pt1, int pt2id, const QgsPointXY &pt2, const QVector< QVariant > &prop ) override;
+
+    /**
+     * Returns generated QgsCompactGraph. Collected vertices and edges are released,
+     * so the builder is empty afterwards.
+     */
+    QgsCompactGraph *compactGraph() SIP_FACTORY;
+
+  private:
+
+    QVector<double> mX;
+    QVector<double> mY;
+    QVector<int> mFrom;
+    QVector<int> mTo;
+    QVector<double> mCosts;
+    int mStrategyCount = -1;
+};
+
+#endif // QGSCOMPACTGRAPHBUILDER_H
@@ -0,0 +1,648 @@
+/***************************************************************************
+  qgscontractionhierarchy.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#include "qgscontractionhierarchy.h"
+#include "qgscompactgraph.h"
+#include "qgsfeedback.h"
+
+#include <QDataStream>
+#include <QFile>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+///@cond PRIVATE
+
+// "QGCH"
+static const quint32 CH_FILE_MAGIC = 0x51474348;
+static const quint32 CH_FILE_VERSION = 1;
+
+// witness searches give up after settling this many vertices and keep the shortcut,
+// which is always correct, just not minimal. Priority estimates use a tighter limit
+static const int CH_WITNESS_SETTLED_LIMIT = 500;
+static const int CH_PRIORITY_SETTLED_LIMIT = 50;
+
+/**
+ * Dynamic graph used while contracting the vertices
+ */
+class QgsContractionBuilder
+{
+  public:
+
+    struct Arc
+    {
+      int target;
+      double cost;
+      int edge;
+    };
+
+    QgsContractionBuilder( const QgsCompactGraph &graph, int criterionNum )
+      : mOut( graph.vertexCount() )
+      , mIn( graph.vertexCount() )
+      , mDeletedNeighbors( graph.vertexCount(), 0 )
+    {
+      mWitness.resize( graph.vertexCount() );
+      for ( int e = 0; e < graph.edgeCount(); ++e )
+      {
+        const int from = graph.edgeOutVertex( e );
+        const int to = graph.edgeInVertex( e );
+        if ( from == to )
+          continue;
+        addEdge( from, to, graph.edgeCost( e, criterionNum ), graph.sourceEdgeId( e ), -1, -1 );
+      }
+    }
+
+    //! Adds an edge, or lowers the cost of an existing parallel edge
+    void addEdge( int from, int to, double cost, int source, int first, int second )
+    {
+      QVector<Arc> &out = mOut[ from ];
+      for ( int i = 0; i < out.size(); ++i )
+      {
+        if ( out.at( i ).target != to )
+          continue;
+
+        if ( cost < out.at( i ).cost )
+        {
+          const int edge = newEdge( from, to, source, first, second );
+          out[ i ].cost = cost;
+          out[ i ].edge = edge;
+          QVector<Arc> &in = mIn[ to ];
+          for ( int j = 0; j < in.size(); ++j )
+          {
+            if ( in.at( j ).target == from )
+            {
+              in[ j ].cost = cost;
+              in[ j ].edge = edge;
+              break;
+            }
+          }
+        }
+        return;
+      }
+
+      const int edge = newEdge( from, to, source, first, second );
+      out.append( { to, cost, edge } );
+      mIn[ to ].append( { from, cost, edge } );
+    }
+
+    /**
+     * Contracts \a vertex, or only counts the shortcuts contraction would add if \a simulate is true.
+     * \returns number of shortcuts
+     */
+    int contract( int vertex, bool simulate )
+    {
+      int shortcuts = 0;
+      const QVector<Arc> in = mIn.at( vertex );
+      const QVector<Arc> out = mOut.at( vertex );
+      Q_FOREACH ( const Arc &inArc, in )
+      {
+        double maxCost = -1.0;
+        Q_FOREACH ( const Arc &outArc, out )
+        {
+          if ( outArc.target != inArc.target )
+            maxCost = std::max( maxCost, inArc.cost + outArc.cost );
+        }
+        if ( maxCost < 0.0 )
+          continue;
+
+        witnessSearch( inArc.target, vertex, maxCost, simulate ? CH_PRIORITY_SETTLED_LIMIT : CH_WITNESS_SETTLED_LIMIT );
+        Q_FOREACH ( const Arc &outArc, out )
+        {
+          if ( outArc.target == inArc.target )
+            continue;
+          const double cost = inArc.cost + outArc.cost;
+          if ( mWitness.dist.at( outArc.target ) <= cost )
+            continue;
+
+          ++shortcuts;
+          if ( !simulate )
+            addEdge( inArc.target, outArc.target, cost, -1, inArc.edge, outArc.edge );
+        }
+      }
+      return shortcuts;
+    }
+
+    //! Returns the contraction priority of \a vertex, lower values are contracted first
+    double priority( int vertex )
+    {
+      const int shortcuts = contract( vertex, true );
+      return shortcuts - ( mIn.at( vertex ).size() + mOut.at( vertex ).size() ) + mDeletedNeighbors.at( vertex );
+    }
+
+    //! Removes \a vertex from the remaining graph once its shortcuts have been added
+    void remove( int vertex )
+    {
+      Q_FOREACH ( const Arc &arc, mIn.at( vertex ) )
+      {
+        removeArcs( mOut[ arc.target ], vertex );
+        ++mDeletedNeighbors[ arc.target ];
+      }
+      Q_FOREACH ( const Arc &arc, mOut.at( vertex ) )
+      {
+        removeArcs( mIn[ arc.target ], vertex );
+        ++mDeletedNeighbors[ arc.target ];
+      }
+    }
+
+    //! Remaining arcs leaving a vertex
+    QVector< QVector<Arc> > mOut;
+    //! Remaining arcs entering a vertex, with target set to the arc start
+    QVector< QVector<Arc> > mIn;
+
+    QVector<int> mEdgeFrom;
+    QVector<int> mEdgeTo;
+    QVector<int> mEdgeSource;
+    QVector<int> mEdgeFirst;
+    QVector<int> mEdgeSecond;
+
+  private:
+
+    int newEdge( int from, int to, int source, int first, int second )
+    {
+      mEdgeFrom.append( from );
+      mEdgeTo.append( to );
+      mEdgeSource.append( source );
+      mEdgeFirst.append( first );
+      mEdgeSecond.append( second );
+      return mEdgeSource.size() - 1;
+    }
+
+    static void removeArcs( QVector<Arc> &arcs, int target )
+    {
+      for ( int i = arcs.size() - 1; i >= 0; --i )
+      {
+        if ( arcs.at( i ).target == target )
+          arcs.remove( i );
+      }
+    }
+
+    //! Local Dijkstra from \a start ignoring \a excluded, bounded by \a maxCost and \a settledLimit
+    void witnessSearch( int start, int excluded, double maxCost, int settledLimit )
+    {
+      mWitness.reset();
+      mWitness.update( start, 0.0, -1 );
+      mWitness.heap.push( start, 0.0 );
+
+      int settled = 0;
+      while ( !mWitness.heap.isEmpty() && settled < settledLimit )
+      {
+        if ( mWitness.heap.topKey() > maxCost )
+          break;
+        const int vertex = mWitness.heap.pop();
+        ++settled;
+        const double vertexCost = mWitness.dist.at( vertex );
+        Q_FOREACH ( const Arc &arc, mOut.at( vertex ) )
+        {
+          if ( arc.target == excluded )
+            continue;
+          const double cost = vertexCost + arc.cost;
+          if ( cost < mWitness.dist.at( arc.target ) )
+          {
+            mWitness.update( arc.target, cost, arc.edge );
+            mWitness.heap.push( arc.target, cost );
+          }
+        }
+      }
+    }
+
+    QVector<int> mDeletedNeighbors;
+    QgsGraphSearchState mWitness;
+};
+
+///@endcond
+
+QgsContractionHierarchy::QgsContractionHierarchy( const QgsCompactGraph &graph, int criterionNum, QgsFeedback *feedback )
+  : mCriterion( criterionNum )
+{
+  if ( criterionNum < 0 || ( graph.edgeCount() > 0 && criterionNum >= graph.strategyCount() ) )
+    return;
+
+  const int vertexCount = graph.vertexCount();
+  mX.resize( vertexCount );
+  mY.resize( vertexCount );
+  for ( int i = 0; i < vertexCount; ++i )
+  {
+    const QgsPointXY pt = graph.vertexPoint( i );
+    mX[ i ] = pt.x();
+    mY[ i ] = pt.y();
+  }
+
+  QgsContractionBuilder builder( graph, criterionNum );
+
+  // vertices sorted by priority, with priorities lazily refreshed when they reach the top
+  QgsGraphIndexedHeap queue;
+  queue.resize( vertexCount );
+  for ( int v = 0; v < vertexCount; ++v )
+  {
+    queue.push( v, builder.priority( v ) );
+  }
+
+  QVector< QVector<QgsContractionBuilder::Arc> > up( vertexCount );
+  QVector< QVector<QgsContractionBuilder::Arc> > down( vertexCount );
+
+  int contracted = 0;
+  while ( !queue.isEmpty() )
+  {
+    const int vertex = queue.pop();
+    const double priority = builder.priority( vertex );
+    if ( !queue.isEmpty() && priority > queue.topKey() )
+    {
+      queue.push( vertex, priority );
+      continue;
+    }
+
+    builder.contract( vertex, false );
+
+    // all remaining neighbors will be ranked higher than this vertex
+    up[ vertex ] = builder.mOut.at( vertex );
+    down[ vertex ] = builder.mIn.at( vertex );
+    builder.remove( vertex );
+
+
+    ++contracted;
+    if ( feedback && contracted % 1000 == 0 )
+    {
+      if ( feedback->isCanceled() )
+      {
+        mX.clear();
+        mY.clear();
+        return;
+      }
+      feedback->setProgress( 100.0 * contracted / vertexCount );
+    }
+  }
+
+  // flatten the upward and downward edges to compressed rows
+  mUpOffsets.fill( 0, vertexCount + 1 );
+  mDownOffsets.fill( 0, vertexCount + 1 );
+  for ( int v = 0; v < vertexCount; ++v )
+  {
+    mUpOffsets[ v + 1 ] = mUpOffsets.at( v ) + up.at( v ).size();
+    mDownOffsets[ v + 1 ] = mDownOffsets.at( v ) + down.at( v ).size();
+    Q_FOREACH ( const QgsContractionBuilder::Arc &arc, up.at( v ) )
+    {
+      mUpTargets.append( arc.target );
+      mUpCosts.append( arc.cost );
+      mUpEdges.append( arc.edge );
+    }
+    Q_FOREACH ( const QgsContractionBuilder::Arc &arc, down.at( v ) )
+    {
+      mDownTargets.append( arc.target );
+      mDownCosts.append( arc.cost );
+      mDownEdges.append( arc.edge );
+    }
+  }
+
+  mEdgeFrom = builder.mEdgeFrom;
+  mEdgeTo = builder.mEdgeTo;
+  mEdgeSource = builder.mEdgeSource;
+  mEdgeFirst = builder.mEdgeFirst;
+  mEdgeSecond = builder.mEdgeSecond;
+
+  resizeSearchStates();
+  mValid = true;
+
+  if ( feedback )
+    feedback->setProgress( 100.0 );
+}
+
+int QgsContractionHierarchy::shortcutCount() const
+{
+  return std::count( mEdgeSource.constBegin(), mEdgeSource.constEnd(), -1 );
+}
+
+int QgsContractionHierarchy::findVertex( const QgsPointXY &pt ) const
+{
+  for ( int i = 0; i < mX.size(); ++i )
+  {
+    if ( qgsDoubleNear( mX.at( i ), pt.x() ) && qgsDoubleNear( mY.at( i ), pt.y() ) )
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void QgsContractionHierarchy::resizeSearchStates()
+{
+  mForward.resize( mX.size() );
+  mBackward.resize( mX.size() );
+}
+
+double QgsContractionHierarchy::shortestPath( int startVertexIdx, int endVertexIdx, QVector<int> *path )
+{
+  if ( path )
+    path->clear();
+
+  if ( !mValid )
+    return std::numeric_limits<double>::infinity();
+
+  mForward.reset();
+  mBackward.reset();
+  mForward.update( startVertexIdx, 0.0, -1 );
+  mForward.heap.push( startVertexIdx, 0.0 );
+  mBackward.update( endVertexIdx, 0.0, -1 );
+  mBackward.heap.push( endVertexIdx, 0.0 );
+
+  double best = startVertexIdx == endVertexIdx ? 0.0 : std::numeric_limits<double>::infinity();
+  int meetVertex = startVertexIdx == endVertexIdx ? startVertexIdx : -1;
+
+  bool forward = true;
+  for ( ;; )
+  {
+    // a direction is finished once its queue cannot improve the best path any more
+    const bool forwardActive = !mForward.heap.isEmpty() && mForward.heap.topKey() < best;
+    const bool backwardActive = !mBackward.heap.isEmpty() && mBackward.heap.topKey() < best;
+    if ( !forwardActive && !backwardActive )
+      break;
+    if ( !forwardActive )
+      forward = false;
+    else if ( !backwardActive )
+      forward = true;
+
+    QgsGraphSearchState &state = forward ? mForward : mBackward;
+    const QgsGraphSearchState &other = forward ? mBackward : mForward;
+    const QVector<int> &offsets = forward ? mUpOffsets : mDownOffsets;
+    const QVector<int> &targets = forward ? mUpTargets : mDownTargets;
+    const QVector<double> &costs = forward ? mUpCosts : mDownCosts;
+    const QVector<int> &edges = forward ? mUpEdges : mDownEdges;
+
+    const int vertex = state.heap.pop();
+    const double vertexCost = state.dist.at( vertex );
+    if ( vertexCost + other.dist.at( vertex ) < best )
+    {
+      best = vertexCost + other.dist.at( vertex );
+      meetVertex = vertex;
+    }
+
+    for ( int i = offsets.at( vertex ); i < offsets.at( vertex + 1 ); ++i )
+    {
+      const double cost = vertexCost + costs.at( i );
+      if ( cost < state.dist.at( targets.at( i ) ) )
+      {
+        state.update( targets.at( i ), cost, edges.at( i ) );
+        state.heap.push( targets.at( i ), cost );
+      }
+    }
+    forward = !forward;
+  }
+
+  if ( path && meetVertex >= 0 )
+  {
+    // forward edges lead from the start vertex up to the meeting vertex, backward
+    // edges from the meeting vertex down to the end vertex
+    QVector<int> edges;
+    for ( int vertex = meetVertex; vertex != startVertexIdx; )
+    {
+      const int edge = mForward.pred.at( vertex );
+      edges.append( edge );
+      vertex = mEdgeFrom.at( edge );
+    }
+    std::reverse( edges.begin(), edges.end() );
+    for ( int vertex = meetVertex; vertex != endVertexIdx; )
+    {
+      const int edge = mBackward.pred.at( vertex );
+      edges.append( edge );
+      vertex = mEdgeTo.at( edge );
+    }
+
+    Q_FOREACH ( int edge, edges )
+      unpackEdge( edge, path );
+  }
+
+  return best;
+}
+
+void QgsContractionHierarchy::unpackEdge( int edge, QVector<int> *path ) const
+{
+  QVector<int> stack;
+  stack.append( edge );
+  while ( !stack.isEmpty() )
+  {
+    const int current = stack.last();
+    stack.removeLast();
+    if ( mEdgeSource.at( current ) >= 0 )
+    {
+      path->append( mEdgeSource.at( current ) );
+    }
+    else
+    {
+      stack.append( mEdgeSecond.at( current ) );
+      stack.append( mEdgeFirst.at( current ) );
+    }
+  }
+}
+
+void QgsContractionHierarchy::upwardSearch( QgsGraphSearchState &state, int startVertexIdx, bool forward )
+{
+  const QVector<int> &offsets = forward ? mUpOffsets : mDownOffsets;
+  const QVector<int> &targets = forward ? mUpTargets : mDownTargets;
+  const QVector<double> &costs = forward ? mUpCosts : mDownCosts;
+
+  state.reset();
+  state.update( startVertexIdx, 0.0, -1 );
+  state.heap.push( startVertexIdx, 0.0 );
+  while ( !state.heap.isEmpty() )
+  {
+    const int vertex = state.heap.pop();
+    const double vertexCost = state.dist.at( vertex );
+    for ( int i = offsets.at( vertex ); i < offsets.at( vertex + 1 ); ++i )
+    {
+      const double cost = vertexCost + costs.at( i );
+      if ( cost < state.dist.at( targets.at( i ) ) )
+      {
+        state.update( targets.at( i ), cost, -1 );
+        state.heap.push( targets.at( i ), cost );
+      }
+    }
+  }
+}
+
+QVector<double> QgsContractionHierarchy::costs( int startVertexIdx, const QVector<int> &endVertexIdxs )
+{
+  return costMatrix( QVector<int>() << startVertexIdx, endVertexIdxs ).value( 0 );
+}
+
+QVector< QVector< double > > QgsContractionHierarchy::costMatrix( const QVector<int> &startVertexIdxs, const QVector<int> &endVertexIdxs )
+{
+  QVector< QVector< double > > result( startVertexIdxs.size(), QVector<double>( endVertexIdxs.size(), std::numeric_limits<double>::infinity() ) );
+  if ( !mValid )
+    return result;
+
+  // one backward search per end vertex fills buckets on every vertex of its upward
+  // search space, then each forward search only needs to scan the buckets it meets
+  QVector<int> bucketHead( mX.size(), -1 );
+  QVector<int> bucketNext;
+  QVector<int> bucketColumn;
+  QVector<double> bucketCost;
+  QVector<int> bucketVertices;
+
+  for ( int column = 0; column < endVertexIdxs.size(); ++column )
+  {
+    upwardSearch( mBackward, endVertexIdxs.at( column ), false );
+    Q_FOREACH ( int vertex, mBackward.touched )
+    {
+      if ( bucketHead.at( vertex ) < 0 )
+        bucketVertices.append( vertex );
+      bucketNext.append( bucketHead.at( vertex ) );
+      bucketColumn.append( column );
+      bucketCost.append( mBackward.dist.at( vertex ) );
+      bucketHead[ vertex ] = bucketNext.size() - 1;
+    }
+  }
+
+  for ( int row = 0; row < startVertexIdxs.size(); ++row )
+  {
+    QVector<double> &rowCosts = result[ row ];
+    upwardSearch( mForward, startVertexIdxs.at( row ), true );
+    Q_FOREACH ( int vertex, mForward.touched )
+    {
+      const double forwardCost = mForward.dist.at( vertex );
+      for ( int entry = bucketHead.at( vertex ); entry >= 0; entry = bucketNext.at( entry ) )
+      {
+        const double cost = forwardCost + bucketCost.at( entry );
+        if ( cost < rowCosts.at( bucketColumn.at( entry ) ) )
+          rowCosts[ bucketColumn.at( entry ) ] = cost;
+      }
+    }
+  }
+
+  return result;
+}
+
+bool QgsContractionHierarchy::writeToFile( const QString &path ) const
+{
+  if ( !mValid )
+    return false;
+
+  QFile file( path );
+  if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    return false;
+
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_0 );
+  stream << CH_FILE_MAGIC << CH_FILE_VERSION << static_cast< qint32 >( mCriterion )
+         << mX << mY
+         << mUpOffsets << mUpTargets << mUpCosts << mUpEdges
+         << mDownOffsets << mDownTargets << mDownCosts << mDownEdges
+         << mEdgeFrom << mEdgeTo << mEdgeSource << mEdgeFirst << mEdgeSecond;
+  return stream.status() == QDataStream::Ok;
+}
+
+bool QgsContractionHierarchy::readFromFile( const QString &path )
+{
+  QFile file( path );
+  if ( !file.open( QIODevice::ReadOnly ) )
+    return false;
+
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_0 );
+
+  quint32 magic = 0;
+  quint32 version = 0;
+  stream >> magic >> version;
+  if ( magic != CH_FILE_MAGIC || version != CH_FILE_VERSION )
+    return false;
+
+  QgsContractionHierarchy hierarchy;
+  qint32 criterion = 0;
+  stream >> criterion
+         >> hierarchy.mX >> hierarchy.mY
+         >> hierarchy.mUpOffsets >> hierarchy.mUpTargets >> hierarchy.mUpCosts >> hierarchy.mUpEdges
+         >> hierarchy.mDownOffsets >> hierarchy.mDownTargets >> hierarchy.mDownCosts >> hierarchy.mDownEdges
+         >> hierarchy.mEdgeFrom >> hierarchy.mEdgeTo >> hierarchy.mEdgeSource >> hierarchy.mEdgeFirst >> hierarchy.mEdgeSecond;
+  if ( stream.status() != QDataStream::Ok )
+    return false;
+
+  const int vertexCount = hierarchy.mX.size();
+  const int edgeCount = hierarchy.mEdgeSource.size();
+  if ( hierarchy.mY.size() != vertexCount
+       || hierarchy.mUpOffsets.size() != vertexCount + 1 || hierarchy.mDownOffsets.size() != vertexCount + 1
+       || hierarchy.mUpTargets.size() != hierarchy.mUpOffsets.last() || hierarchy.mDownTargets.size() != hierarchy.mDownOffsets.last()
+       || hierarchy.mUpCosts.size() != hierarchy.mUpTargets.size() || hierarchy.mUpEdges.size() != hierarchy.mUpTargets.size()
+       || hierarchy.mDownCosts.size() != hierarchy.mDownTargets.size() || hierarchy.mDownEdges.size() != hierarchy.mDownTargets.size()
+       || hierarchy.mEdgeFrom.size() != edgeCount || hierarchy.mEdgeTo.size() != edgeCount
+       || hierarchy.mEdgeFirst.size() != edgeCount || hierarchy.mEdgeSecond.size() != edgeCount
+       || criterion < 0 || !hierarchy.hasValidIndexes() )
+    return false;
+
+  hierarchy.mCriterion = criterion;
+  hierarchy.resizeSearchStates();
+  hierarchy.mValid = true;
+  *this = hierarchy;
+  return true;
+}
+
+bool QgsContractionHierarchy::hasValidIndexes() const
+{
+  // searches and path unpacking index the arrays without further checks, so a
+  // corrupted file must not be accepted. Array sizes are checked by the caller.
+  const int vertexCount = mX.size();
+  const int edgeCount = mEdgeSource.size();
+
+  for ( int e = 0; e < edgeCount; ++e )
+  {
+    const int from = mEdgeFrom.at( e );
+    const int to = mEdgeTo.at( e );
+    if ( from < 0 || from >= vertexCount || to < 0 || to >= vertexCount )
+      return false;
+
+    const int source = mEdgeSource.at( e );
+    if ( source >= 0 )
+      continue;
+    if ( source != -1 )
+      return false;
+
+    // shortcut children are created before the shortcut, which bounds the unpacking
+    const int first = mEdgeFirst.at( e );
+    const int second = mEdgeSecond.at( e );
+    if ( first < 0 || first >= e || second < 0 || second >= e
+         || mEdgeFrom.at( first ) != from || mEdgeTo.at( first ) != mEdgeFrom.at( second ) || mEdgeTo.at( second ) != to )
+      return false;
+  }
+
+  for ( int pass = 0; pass < 2; ++pass )
+  {
+    const bool forward = pass == 0;
+    const QVector<int> &offsets = forward ? mUpOffsets : mDownOffsets;
+    const QVector<int> &targets = forward ? mUpTargets : mDownTargets;
+    const QVector<double> &costs = forward ? mUpCosts : mDownCosts;
+    const QVector<int> &edges = forward ? mUpEdges : mDownEdges;
+
+    if ( offsets.at( 0 ) != 0 )
+      return false;
+    for ( int v = 0; v < vertexCount; ++v )
+    {
+      if ( offsets.at( v + 1 ) < offsets.at( v ) )
+        return false;
+
+      for ( int i = offsets.at( v ); i < offsets.at( v + 1 ); ++i )
+      {
+        const int target = targets.at( i );
+        const int edge = edges.at( i );
+        if ( target < 0 || target >= vertexCount || edge < 0 || edge >= edgeCount || std::isnan( costs.at( i ) ) )
+          return false;
+
+        // upward edges start at their vertex, downward edges end at it
+        if ( forward ? ( mEdgeFrom.at( edge ) != v || mEdgeTo.at( edge ) != target )
+             : ( mEdgeTo.at( edge ) != v || mEdgeFrom.at( edge ) != target ) )
+          return false;
+      }
+    }
+  }
+
+  return true;
+}
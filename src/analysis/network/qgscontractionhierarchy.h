@@ -0,0 +1,172 @@
+/***************************************************************************
+  qgscontractionhierarchy.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSCONTRACTIONHIERARCHY_H
+#define QGSCONTRACTIONHIERARCHY_H
+
+#include <QVector>
+#include <QString>
+
+#include "qgspointxy.h"
+#include "qgis.h"
+#include "qgis_analysis.h"
+#include "qgsgraphsearchstate.h"
+
+class QgsCompactGraph;
+class QgsFeedback;
+
+/**
+ * \ingroup analysis
+ * \class QgsContractionHierarchy
+ * \since QGIS 3.0
+ * \brief Contraction hierarchy of a graph, for fast repeated shortest path queries.
+ *
+ * Preprocessing contracts the vertices one at a time, in order of importance, and adds
+ * shortcut edges that preserve shortest path costs between the remaining vertices.
+ * Queries then only need to search upwards in the hierarchy from both end points, which
+ * visits a few hundred vertices even on country sized networks.
+ *
+ * Preprocessing is expensive but only depends on the graph and the cost strategy, so the
+ * hierarchy can be saved with writeToFile() and restored later with readFromFile().
+ *
+ * Query methods are not thread safe. Copies share the hierarchy data (implicit sharing)
+ * and get their own search state, so a copy per thread should be used for concurrent queries.
+ */
+class ANALYSIS_EXPORT QgsContractionHierarchy
+{
+  public:
+
+    /**
+     * Constructor for an empty, invalid QgsContractionHierarchy. Use readFromFile() to load
+     * a saved hierarchy.
+     */
+    QgsContractionHierarchy() = default;
+
+    /**
+     * Builds a contraction hierarchy of \a graph for the strategy \a criterionNum.
+     * The optional \a feedback argument can be used to report progress and to cancel
+     * the preprocessing, in which case the hierarchy will be invalid.
+     */
+    QgsContractionHierarchy( const QgsCompactGraph &graph, int criterionNum, QgsFeedback *feedback = nullptr );
+
+    /**
+     * Returns true if the hierarchy was successfully built or loaded
+     */
+    bool isValid() const { return mValid; }
+
+    /**
+     * Returns the index of the optimization strategy the hierarchy was built for
+     */
+    int criterion() const { return mCriterion; }
+
+    /**
+     * Returns number of graph vertices
+     */
+    int vertexCount() const { return mX.size(); }
+
+    /**
+     * Returns number of shortcut edges added by the preprocessing
+     */
+    int shortcutCount() const;
+
+    /**
+     * Returns point associated with vertex at index \a idx
+     */
+    QgsPointXY vertexPoint( int idx ) const { return QgsPointXY( mX.at( idx ), mY.at( idx ) ); }
+
+    /**
+     * Find vertex by associated point
+     * \returns vertex index, or -1 if no vertex matches
+     */
+    int findVertex( const QgsPointXY &pt ) const;
+
+    /**
+     * Calculates the shortest path between two vertices.
+     * \param startVertexIdx index of the start vertex
+     * \param endVertexIdx index of the end vertex
+     * \param path if specified, will be set to the path edges ordered from the start vertex to the end vertex,
+     * given as source edge indices (see QgsCompactGraph::sourceEdgeId())
+     * \returns path cost, or infinity if the end vertex is not reachable
+     */
+    double shortestPath( int startVertexIdx, int endVertexIdx, QVector<int> *path SIP_OUT = nullptr );
+
+    /**
+     * Calculates the shortest path costs from \a startVertexIdx to each vertex of \a endVertexIdxs.
+     * Unreachable vertices have an infinite cost.
+     */
+    QVector<double> costs( int startVertexIdx, const QVector<int> &endVertexIdxs );
+
+    /**
+     * Calculates the shortest path costs from each vertex of \a startVertexIdxs to each vertex of
+     * \a endVertexIdxs. Result rows correspond to start vertices, columns to end vertices.
+     * Unreachable vertices have an infinite cost.
+     */
+    QVector< QVector< double > > costMatrix( const QVector<int> &startVertexIdxs, const QVector<int> &endVertexIdxs );
+
+    /**
+     * Saves the hierarchy to the file at \a path.
+     * \returns true if the file was successfully written
+     * \see readFromFile()
+     */
+    bool writeToFile( const QString &path ) const;
+
+    /**
+     * Loads a hierarchy previously saved with writeToFile() from the file at \a path.
+     * \returns true if the file was successfully read
+     * \see writeToFile()
+     */
+    bool readFromFile( const QString &path );
+
+  private:
+
+#ifndef SIP_RUN
+    void upwardSearch( QgsGraphSearchState &state, int startVertexIdx, bool forward );
+    void unpackEdge( int edge, QVector<int> *path ) const;
+    void resizeSearchStates();
+    bool hasValidIndexes() const;
+
+    bool mValid = false;
+    int mCriterion = 0;
+
+    QVector<double> mX;
+    QVector<double> mY;
+
+    // edges leading to higher ranked vertices, grouped by their start vertex
+    QVector<int> mUpOffsets;
+    QVector<int> mUpTargets;
+    QVector<double> mUpCosts;
+    QVector<int> mUpEdges;
+
+    // edges coming from higher ranked vertices, grouped by their end vertex
+    QVector<int> mDownOffsets;
+    QVector<int> mDownTargets;
+    QVector<double> mDownCosts;
+    QVector<int> mDownEdges;
+
+    // end points of all edges, original and shortcuts
+    QVector<int> mEdgeFrom;
+    QVector<int> mEdgeTo;
+
+    // source edge index for original edges, -1 for shortcuts, which are made of two child edges
+    QVector<int> mEdgeSource;
+    QVector<int> mEdgeFirst;
+    QVector<int> mEdgeSecond;
+
+    QgsGraphSearchState mForward;
+    QgsGraphSearchState mBackward;
+#endif
+};
+
+#endif // QGSCONTRACTIONHIERARCHY_H
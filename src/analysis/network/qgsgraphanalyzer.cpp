@@ -21,6 +21,7 @@
 
 #include "qgsgraph.h"
 #include "qgsgraphanalyzer.h"
+#include "qgsgraphsearch.h"
 
 void QgsGraphAnalyzer::dijkstra( const QgsGraph *source, int startPointIdx, int criterionNum, QVector<int> *resultTree, QVector<double> *resultCost )
 {
@@ -118,3 +119,15 @@ QgsGraph *QgsGraphAnalyzer::shortestTree( const QgsGraph *source, int startVerte
 
   return treeResult;
 }
+
+double QgsGraphAnalyzer::shortestPath( const QgsGraph *source, int startVertexIdx, int endVertexIdx, int criterionNum, QgsGraphSearch::Algorithm algorithm, QVector<int> *path )
+{
+  QgsGraphSearch search( source, criterionNum );
+  return search.shortestPath( startVertexIdx, endVertexIdx, algorithm, path );
+}
+
+double QgsGraphAnalyzer::shortestPath( const QgsCompactGraph *source, int startVertexIdx, int endVertexIdx, int criterionNum, QgsGraphSearch::Algorithm algorithm, QVector<int> *path )
+{
+  QgsGraphSearch search( *source, criterionNum );
+  return search.shortestPath( startVertexIdx, endVertexIdx, algorithm, path );
+}
@@ -20,6 +20,7 @@
 
 #include <qgis.h>
 #include "qgis_analysis.h"
+#include "qgsgraphsearch.h"
 
 class QgsGraph;
 
@@ -80,6 +81,37 @@ class ANALYSIS_EXPORT QgsGraphAnalyzer
      * \param criterionNum index of the optimization strategy
      */
     static QgsGraph *shortestTree( const QgsGraph *source, int startVertexIdx, int criterionNum );
+
+    /**
+     * Solves the point to point shortest path problem using an indexed heap search engine.
+     *
+     * Edge costs of the selected strategy are converted once per call, use a QgsGraphSearch
+     * object directly to run several queries against the same graph.
+     * \param source source graph
+     * \param startVertexIdx index of the start vertex
+     * \param endVertexIdx index of the end vertex
+     * \param criterionNum index of the optimization strategy
+     * \param algorithm search algorithm
+     * \param path if specified, will be set to the indices of the path edges ordered from the start vertex to the end vertex
+     * \returns path cost, or infinity if the end vertex is not reachable
+     * \since QGIS 3.0
+     */
+    static double shortestPath( const QgsGraph *source, int startVertexIdx, int endVertexIdx, int criterionNum,
+                                QgsGraphSearch::Algorithm algorithm = QgsGraphSearch::Dijkstra, QVector<int> *path SIP_OUT = nullptr );
+
+    /**
+     * Solves the point to point shortest path problem on a compact graph.
+     * \param source source graph
+     * \param startVertexIdx index of the start vertex
+     * \param endVertexIdx index of the end vertex
+     * \param criterionNum index of the optimization strategy
+     * \param algorithm search algorithm
+     * \param path if specified, will be set to the QgsCompactGraph indices of the path edges ordered from the start vertex to the end vertex
+     * \returns path cost, or infinity if the end vertex is not reachable
+     * \since QGIS 3.0
+     */
+    static double shortestPath( const QgsCompactGraph *source, int startVertexIdx, int endVertexIdx, int criterionNum,
+                                QgsGraphSearch::Algorithm algorithm = QgsGraphSearch::Dijkstra, QVector<int> *path SIP_OUT = nullptr );
 };
 
 #endif // QGSGRAPHANALYZER_H
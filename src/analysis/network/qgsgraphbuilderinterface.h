@@ -27,6 +27,7 @@
 #ifdef SIP_RUN
 % ModuleHeaderCode
 #include <qgsgraphbuilder.h>
+#include <qgscompactgraphbuilder.h>
 % End
 #endif
 
@@ -34,7 +35,8 @@
 * \ingroup analysis
 * \class QgsGraphBuilderInterface
 * \brief Determine interface for creating a graph. Contains the settings of the graph.
-* QgsGraphBuilder and QgsGraphDirector both use a "builder" design pattern
+* QgsGraphBuilder and QgsGraphDirector both use a "builder" design pattern.
+* QgsCompactGraphBuilder creates a QgsCompactGraph instead of a QgsGraph
 */
 class ANALYSIS_EXPORT QgsGraphBuilderInterface
 {
@@ -43,6 +45,8 @@ class ANALYSIS_EXPORT QgsGraphBuilderInterface
     SIP_CONVERT_TO_SUBCLASS_CODE
     if ( dynamic_cast< QgsGraphBuilder * >( sipCpp ) != NULL )
       sipType = sipType_QgsGraphBuilder;
+    else if ( dynamic_cast< QgsCompactGraphBuilder * >( sipCpp ) != NULL )
+      sipType = sipType_QgsCompactGraphBuilder;
     else
       sipType = NULL;
     SIP_END
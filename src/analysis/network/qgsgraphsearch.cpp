@@ -0,0 +1,365 @@
+/***************************************************************************
+  qgsgraphsearch.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "qgsgraph.h"
+#include "qgsgraphsearch.h"
+#include "qgslogger.h"
+
+//
+// QgsGraphSearch
+//
+
+QgsGraphSearch::QgsGraphSearch( const QgsGraph *graph, int criterionNum )
+  : mGraph( *graph )
+  , mCriterion( criterionNum )
+  , mMapEdges( true )
+{
+  if ( !isValid() )
+    QgsDebugMsg( QString( "Invalid optimization strategy index %1" ).arg( criterionNum ) );
+  prepare();
+}
+
+QgsGraphSearch::QgsGraphSearch( const QgsCompactGraph &graph, int criterionNum )
+  : mGraph( graph )
+  , mCriterion( criterionNum )
+{
+  if ( !isValid() )
+    QgsDebugMsg( QString( "Invalid optimization strategy index %1" ).arg( criterionNum ) );
+  prepare();
+}
+
+void QgsGraphSearch::prepare()
+{
+  const int vertexCount = mGraph.vertexCount();
+  const int edgeCount = mGraph.edgeCount();
+
+  // the smallest cost per unit of length keeps the heuristic both admissible and
+  // consistent: cost( u, v ) >= scale * |uv| and the triangle inequality gives
+  // h( u ) <= cost( u, v ) + h( v )
+  double scale = std::numeric_limits<double>::infinity();
+  const double *costs = criterionCosts();
+  if ( costs )
+  {
+    const double *x = mGraph.vertexX();
+    const double *y = mGraph.vertexY();
+    const int *from = mGraph.edgeOutVertices();
+    const int *to = mGraph.edgeInVertices();
+    for ( int i = 0; i < edgeCount && scale > 0.0; ++i )
+    {
+      const double length = std::hypot( x[ to[ i ] ] - x[ from[ i ] ], y[ to[ i ] ] - y[ from[ i ] ] );
+      if ( length > 0.0 )
+        scale = std::min( scale, std::max( costs[ i ], 0.0 ) / length );
+    }
+  }
+  mHeuristicScale = std::isinf( scale ) ? 0.0 : scale;
+
+  mForward.resize( vertexCount );
+  mBackward.resize( vertexCount );
+  mPendingTargets.fill( false, vertexCount );
+}
+
+void QgsGraphSearch::shortestPathTree( int startVertexIdx, QVector<int> *resultTree, QVector<double> *resultCost )
+{
+  const int vertexCount = mGraph.vertexCount();
+  if ( !isValid() || startVertexIdx < 0 || startVertexIdx >= vertexCount )
+  {
+    // nothing is reachable
+    if ( resultTree )
+      resultTree->fill( -1, vertexCount );
+    if ( resultCost )
+      resultCost->fill( std::numeric_limits<double>::infinity(), vertexCount );
+    return;
+  }
+
+  mForward.reset();
+  mForward.update( startVertexIdx, 0.0, -1 );
+  mForward.heap.push( startVertexIdx, 0.0 );
+
+  const int *offsets = mGraph.outOffsets();
+  const int *targets = mGraph.edgeInVertices();
+  const double *costs = criterionCosts();
+
+  while ( !mForward.heap.isEmpty() )
+  {
+    const int vertex = mForward.heap.pop();
+    const double vertexCost = mForward.dist.at( vertex );
+    for ( int i = offsets[ vertex ]; i < offsets[ vertex + 1 ]; ++i )
+    {
+      const double cost = vertexCost + costs[ i ];
+      if ( cost < mForward.dist.at( targets[ i ] ) )
+      {
+        mForward.update( targets[ i ], cost, i );
+        mForward.heap.push( targets[ i ], cost );
+      }
+    }
+  }
+
+  if ( resultTree )
+  {
+    *resultTree = mForward.pred;
+    if ( mMapEdges )
+    {
+      Q_FOREACH ( int vertex, mForward.touched )
+      {
+        int &edge = ( *resultTree )[ vertex ];
+        if ( edge >= 0 )
+          edge = mapEdge( edge );
+      }
+    }
+  }
+  if ( resultCost )
+  {
+    *resultCost = mForward.dist;
+  }
+}
+
+QVector<double> QgsGraphSearch::costs( int startVertexIdx, const QVector<int> &endVertexIdxs )
+{
+  const int vertexCount = mGraph.vertexCount();
+  QVector<double> result( endVertexIdxs.size(), std::numeric_limits<double>::infinity() );
+  if ( !isValid() || startVertexIdx < 0 || startVertexIdx >= vertexCount )
+    return result;
+
+  int pending = 0;
+  Q_FOREACH ( int vertex, endVertexIdxs )
+  {
+    if ( vertex >= 0 && vertex < vertexCount && !mPendingTargets.at( vertex ) )
+    {
+      mPendingTargets[ vertex ] = true;
+      ++pending;
+    }
+  }
+
+  mForward.reset();
+  mForward.update( startVertexIdx, 0.0, -1 );
+  mForward.heap.push( startVertexIdx, 0.0 );
+
+  const int *offsets = mGraph.outOffsets();
+  const int *targets = mGraph.edgeInVertices();
+  const double *costs = criterionCosts();
+
+  while ( pending > 0 && !mForward.heap.isEmpty() )
+  {
+    const int vertex = mForward.heap.pop();
+    const double vertexCost = mForward.dist.at( vertex );
+    if ( mPendingTargets.at( vertex ) )
+    {
+      mPendingTargets[ vertex ] = false;
+      --pending;
+    }
+
+    for ( int i = offsets[ vertex ]; i < offsets[ vertex + 1 ]; ++i )
+    {
+      const double cost = vertexCost + costs[ i ];
+      if ( cost < mForward.dist.at( targets[ i ] ) )
+      {
+        mForward.update( targets[ i ], cost, i );
+        mForward.heap.push( targets[ i ], cost );
+      }
+    }
+  }
+
+  // either all end vertices are settled or the heap is exhausted, in which case
+  // the remaining ones are unreachable and still have an infinite cost
+  for ( int i = 0; i < endVertexIdxs.size(); ++i )
+  {
+    const int vertex = endVertexIdxs.at( i );
+    if ( vertex < 0 || vertex >= vertexCount )
+      continue;
+
+    mPendingTargets[ vertex ] = false;
+    result[ i ] = mForward.dist.at( vertex );
+  }
+  return result;
+}
+
+double QgsGraphSearch::shortestPath( int startVertexIdx, int endVertexIdx, QgsGraphSearch::Algorithm algorithm, QVector<int> *path )
+{
+  if ( path )
+    path->clear();
+
+  const int vertexCount = mGraph.vertexCount();
+  if ( !isValid() || startVertexIdx < 0 || startVertexIdx >= vertexCount || endVertexIdx < 0 || endVertexIdx >= vertexCount )
+    return std::numeric_limits<double>::infinity();
+
+  if ( startVertexIdx == endVertexIdx )
+    return 0.0;
+
+  double cost = std::numeric_limits<double>::infinity();
+  int meetVertex = endVertexIdx;
+  switch ( algorithm )
+  {
+    case Dijkstra:
+      cost = searchDijkstra( startVertexIdx, endVertexIdx );
+      break;
+    case AStar:
+      cost = searchAStar( startVertexIdx, endVertexIdx );
+      break;
+    case Bidirectional:
+      cost = searchBidirectional( startVertexIdx, endVertexIdx, meetVertex );
+      break;
+  }
+
+  if ( path && !std::isinf( cost ) )
+    tracePath( startVertexIdx, endVertexIdx, algorithm == Bidirectional ? meetVertex : -1, path );
+
+  return cost;
+}
+
+double QgsGraphSearch::searchDijkstra( int startVertexIdx, int endVertexIdx )
+{
+  mForward.reset();
+  mForward.update( startVertexIdx, 0.0, -1 );
+  mForward.heap.push( startVertexIdx, 0.0 );
+
+  const int *offsets = mGraph.outOffsets();
+  const int *targets = mGraph.edgeInVertices();
+  const double *costs = criterionCosts();
+
+  while ( !mForward.heap.isEmpty() )
+  {
+    const int vertex = mForward.heap.pop();
+    const double vertexCost = mForward.dist.at( vertex );
+    if ( vertex == endVertexIdx )
+      return vertexCost;
+
+    for ( int i = offsets[ vertex ]; i < offsets[ vertex + 1 ]; ++i )
+    {
+      const double cost = vertexCost + costs[ i ];
+      if ( cost < mForward.dist.at( targets[ i ] ) )
+      {
+        mForward.update( targets[ i ], cost, i );
+        mForward.heap.push( targets[ i ], cost );
+      }
+    }
+  }
+  return std::numeric_limits<double>::infinity();
+}
+
+double QgsGraphSearch::searchAStar( int startVertexIdx, int endVertexIdx )
+{
+  mForward.reset();
+  mForward.update( startVertexIdx, 0.0, -1 );
+  mForward.heap.push( startVertexIdx, 0.0 );
+
+  const int *offsets = mGraph.outOffsets();
+  const int *targets = mGraph.edgeInVertices();
+  const double *costs = criterionCosts();
+  const double *x = mGraph.vertexX();
+  const double *y = mGraph.vertexY();
+  const double endX = x[ endVertexIdx ];
+  const double endY = y[ endVertexIdx ];
+
+  while ( !mForward.heap.isEmpty() )
+  {
+    const int vertex = mForward.heap.pop();
+    const double vertexCost = mForward.dist.at( vertex );
+    if ( vertex == endVertexIdx )
+      return vertexCost;
+
+    for ( int i = offsets[ vertex ]; i < offsets[ vertex + 1 ]; ++i )
+    {
+      const int target = targets[ i ];
+      const double cost = vertexCost + costs[ i ];
+      if ( cost < mForward.dist.at( target ) )
+      {
+        mForward.update( target, cost, i );
+        mForward.heap.push( target, cost + mHeuristicScale * std::hypot( x[ target ] - endX, y[ target ] - endY ) );
+      }
+    }
+  }
+  return std::numeric_limits<double>::infinity();
+}
+
+double QgsGraphSearch::searchBidirectional( int startVertexIdx, int endVertexIdx, int &meetVertex )
+{
+  mForward.reset();
+  mBackward.reset();
+  mForward.update( startVertexIdx, 0.0, -1 );
+  mForward.heap.push( startVertexIdx, 0.0 );
+  mBackward.update( endVertexIdx, 0.0, -1 );
+  mBackward.heap.push( endVertexIdx, 0.0 );
+
+  const int *outOffsets = mGraph.outOffsets();
+  const int *inOffsets = mGraph.inOffsets();
+  const int *inEdges = mGraph.inEdgeIds();
+  const int *from = mGraph.edgeOutVertices();
+  const int *to = mGraph.edgeInVertices();
+  const double *costs = criterionCosts();
+
+  double best = std::numeric_limits<double>::infinity();
+  meetVertex = -1;
+
+  while ( !mForward.heap.isEmpty() && !mBackward.heap.isEmpty() )
+  {
+    // no path through unsettled vertices can be shorter than the sum of both frontiers
+    if ( mForward.heap.topKey() + mBackward.heap.topKey() >= best )
+      break;
+
+    // expand the smaller frontier
+    const bool forward = mForward.heap.topKey() <= mBackward.heap.topKey();
+    QgsGraphSearchState &state = forward ? mForward : mBackward;
+    const QgsGraphSearchState &other = forward ? mBackward : mForward;
+
+    const int vertex = state.heap.pop();
+    const double vertexCost = state.dist.at( vertex );
+    const int begin = forward ? outOffsets[ vertex ] : inOffsets[ vertex ];
+    const int end = forward ? outOffsets[ vertex + 1 ] : inOffsets[ vertex + 1 ];
+    for ( int i = begin; i < end; ++i )
+    {
+      const int edge = forward ? i : inEdges[ i ];
+      const int target = forward ? to[ edge ] : from[ edge ];
+      const double cost = vertexCost + costs[ edge ];
+      if ( cost < state.dist.at( target ) )
+      {
+        state.update( target, cost, edge );
+        state.heap.push( target, cost );
+      }
+      const double total = state.dist.at( target ) + other.dist.at( target );
+      if ( total < best )
+      {
+        best = total;
+        meetVertex = target;
+      }
+    }
+  }
+  return best;
+}
+
+void QgsGraphSearch::tracePath( int startVertexIdx, int endVertexIdx, int meetVertex, QVector<int> *path ) const
+{
+  const int forwardEnd = meetVertex < 0 ? endVertexIdx : meetVertex;
+  for ( int vertex = forwardEnd; vertex != startVertexIdx; )
+  {
+    const int edge = mForward.pred.at( vertex );
+    path->append( mapEdge( edge ) );
+    vertex = mGraph.edgeOutVertex( edge );
+  }
+  std::reverse( path->begin(), path->end() );
+
+  if ( meetVertex < 0 )
+    return;
+
+  for ( int vertex = meetVertex; vertex != endVertexIdx; )
+  {
+    const int edge = mBackward.pred.at( vertex );
+    path->append( mapEdge( edge ) );
+    vertex = mGraph.edgeInVertex( edge );
+  }
+}
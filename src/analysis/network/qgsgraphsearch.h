@@ -0,0 +1,146 @@
+/***************************************************************************
+  qgsgraphsearch.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSGRAPHSEARCH_H
+#define QGSGRAPHSEARCH_H
+
+#include <QVector>
+
+#include "qgis.h"
+#include "qgis_analysis.h"
+#include "qgscompactgraph.h"
+#include "qgsgraphsearchstate.h"
+
+class QgsGraph;
+
+/**
+ * \ingroup analysis
+ * \class QgsGraphSearch
+ * \since QGIS 3.0
+ * \brief Reusable shortest path search engine over a QgsGraph or QgsCompactGraph.
+ *
+ * Searches traverse the compressed rows of a QgsCompactGraph, so they neither copy edge
+ * lists nor convert QVariant costs. When created from a QgsGraph a compact copy is made
+ * once on construction. Searches use an indexed binary heap with decrease-key and only reset
+ * the vertices touched by the previous search, so a single instance can answer many
+ * queries cheaply.
+ *
+ * A QgsGraphSearch instance is not thread safe. Copies share the immutable graph
+ * arrays (implicit sharing) and get their own search state, so a copy per thread
+ * should be used for concurrent queries.
+ */
+class ANALYSIS_EXPORT QgsGraphSearch
+{
+  public:
+
+    //! Point to point search algorithm
+    enum Algorithm
+    {
+      Dijkstra, //!< Unidirectional Dijkstra, stopping once the end vertex is settled
+      AStar, //!< A* search guided by the Euclidean distance to the end vertex
+      Bidirectional, //!< Dijkstra running simultaneously from both end points
+    };
+
+    /**
+     * Constructor for QgsGraphSearch.
+     * \param graph source graph. A compact copy is made, edge indices returned by the search are indices of \a graph.
+     * \param criterionNum index of the optimization strategy. If out of range the search is invalid, see isValid()
+     */
+    QgsGraphSearch( const QgsGraph *graph, int criterionNum );
+
+    /**
+     * Constructor for QgsGraphSearch traversing a compact \a graph directly. Edge indices
+     * returned by the search are QgsCompactGraph edge indices.
+     * \param graph source graph. Its data is implicitly shared, so no copy is made.
+     * \param criterionNum index of the optimization strategy. If out of range the search is invalid, see isValid()
+     */
+    QgsGraphSearch( const QgsCompactGraph &graph, int criterionNum );
+
+    /**
+     * Returns the compact graph traversed by the search
+     */
+    QgsCompactGraph compactGraph() const { return mGraph; }
+
+    /**
+     * Returns the index of the optimization strategy used by the search
+     */
+    int criterion() const { return mCriterion; }
+
+    /**
+     * Returns true if the criterion passed to the constructor is the index of one of the
+     * graph optimization strategies. An invalid instance reaches no vertex: path costs
+     * are infinite and every shortest path tree entry is -1.
+     */
+    bool isValid() const { return mCriterion >= 0 && mCriterion < mGraph.strategyCount(); }
+
+    /**
+     * Calculates the shortest path tree rooted at \a startVertexIdx. Results use the same
+     * conventions as QgsGraphAnalyzer::dijkstra().
+     * \param startVertexIdx index of the start vertex
+     * \param resultTree array that represents shortest path tree. resultTree[ vertexIndex ] == inboundingArcIndex if vertex reachable, otherwise resultTree[ vertexIndex ] == -1
+     * \param resultCost array of the paths costs
+     */
+    void shortestPathTree( int startVertexIdx, QVector<int> *resultTree SIP_OUT, QVector<double> *resultCost SIP_OUT );
+
+    /**
+     * Calculates the shortest path between two vertices.
+     * \param startVertexIdx index of the start vertex
+     * \param endVertexIdx index of the end vertex
+     * \param algorithm search algorithm
+     * \param path if specified, will be set to the indices of the path edges ordered from the start vertex to the end vertex
+     * \returns path cost, or infinity if the end vertex is not reachable or either vertex index is out of range
+     */
+    double shortestPath( int startVertexIdx, int endVertexIdx, QgsGraphSearch::Algorithm algorithm = Dijkstra, QVector<int> *path SIP_OUT = nullptr );
+
+    /**
+     * Calculates the shortest path costs from \a startVertexIdx to each vertex of \a endVertexIdxs.
+     * The search stops as soon as all end vertices are reached. Unreachable vertices have an infinite cost.
+     */
+    QVector<double> costs( int startVertexIdx, const QVector<int> &endVertexIdxs );
+
+    /**
+     * Returns the factor converting Euclidean distances between vertex coordinates to a lower bound
+     * of the path cost. This is the smallest ratio between edge cost and edge length found in the
+     * graph and is used as heuristic by the AStar algorithm.
+     */
+    double heuristicScale() const { return mHeuristicScale; }
+
+  private:
+
+#ifndef SIP_RUN
+
+    void prepare();
+    const double *criterionCosts() const { return isValid() ? mGraph.costs( mCriterion ) : nullptr; }
+    int mapEdge( int edge ) const { return mMapEdges ? mGraph.sourceEdgeId( edge ) : edge; }
+    double searchDijkstra( int startVertexIdx, int endVertexIdx );
+    double searchAStar( int startVertexIdx, int endVertexIdx );
+    double searchBidirectional( int startVertexIdx, int endVertexIdx, int &meetVertex );
+    void tracePath( int startVertexIdx, int endVertexIdx, int meetVertex, QVector<int> *path ) const;
+
+    QgsCompactGraph mGraph;
+    int mCriterion = 0;
+    bool mMapEdges = false;
+    double mHeuristicScale = 0.0;
+
+    QgsGraphSearchState mForward;
+    QgsGraphSearchState mBackward;
+
+    // end vertices not yet reached by costs()
+    QVector<bool> mPendingTargets;
+
+#endif
+};
+
+#endif // QGSGRAPHSEARCH_H
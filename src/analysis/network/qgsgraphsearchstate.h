@@ -0,0 +1,228 @@
+/***************************************************************************
+  qgsgraphsearchstate.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSGRAPHSEARCHSTATE_H
+#define QGSGRAPHSEARCHSTATE_H
+
+#define SIP_NO_FILE
+
+#include <QVector>
+#include <limits>
+#include <cmath>
+
+#include "qgis_analysis.h"
+
+/**
+ * \ingroup analysis
+ * \class QgsGraphIndexedHeap
+ * \since QGIS 3.0
+ * \brief Binary min-heap of vertex indices keyed by cost, supporting decrease-key.
+ *
+ * The position of every vertex in the heap is tracked, so a vertex is stored at most
+ * once. Popped vertices and cleared heaps leave the position index reset, so clearing
+ * a heap costs as much as the number of vertices still queued, not the graph size.
+ * \note not available in Python bindings
+ */
+class ANALYSIS_EXPORT QgsGraphIndexedHeap
+{
+  public:
+
+    /**
+     * Empties the heap and sizes the position index for \a vertexCount vertices
+     */
+    void resize( int vertexCount )
+    {
+      mItems.clear();
+      mKeys.clear();
+      mPos.fill( -1, vertexCount );
+    }
+
+    /**
+     * Returns true if no vertex is queued
+     */
+    bool isEmpty() const { return mItems.isEmpty(); }
+
+    /**
+     * Returns the smallest key. The heap must not be empty.
+     */
+    double topKey() const { return mKeys.at( 0 ); }
+
+    /**
+     * Queues \a vertex with \a key, or lowers the key of an already queued vertex.
+     * Larger keys for queued vertices are ignored.
+     */
+    void push( int vertex, double key )
+    {
+      int pos = mPos.at( vertex );
+      if ( pos < 0 )
+      {
+        pos = mItems.size();
+        mItems.append( vertex );
+        mKeys.append( key );
+        mPos[ vertex ] = pos;
+        siftUp( pos );
+      }
+      else if ( key < mKeys.at( pos ) )
+      {
+        mKeys[ pos ] = key;
+        siftUp( pos );
+      }
+    }
+
+    /**
+     * Removes and returns the vertex with the smallest key. The heap must not be empty.
+     */
+    int pop()
+    {
+      const int top = mItems.at( 0 );
+      mPos[ top ] = -1;
+
+      const int last = mItems.size() - 1;
+      const int lastVertex = mItems.at( last );
+      const double lastKey = mKeys.at( last );
+      mItems.removeLast();
+      mKeys.removeLast();
+      if ( last > 0 )
+      {
+        place( 0, lastVertex, lastKey );
+        siftDown( 0 );
+      }
+      return top;
+    }
+
+    /**
+     * Removes all queued vertices
+     */
+    void clear()
+    {
+      for ( int i = 0; i < mItems.size(); ++i )
+        mPos[ mItems.at( i ) ] = -1;
+      mItems.erase( mItems.begin(), mItems.end() );
+      mKeys.erase( mKeys.begin(), mKeys.end() );
+    }
+
+  private:
+
+    void place( int pos, int vertex, double key )
+    {
+      mItems[ pos ] = vertex;
+      mKeys[ pos ] = key;
+      mPos[ vertex ] = pos;
+    }
+
+    void siftUp( int pos )
+    {
+      const int vertex = mItems.at( pos );
+      const double key = mKeys.at( pos );
+      while ( pos > 0 )
+      {
+        const int parent = ( pos - 1 ) / 2;
+        if ( mKeys.at( parent ) <= key )
+          break;
+        place( pos, mItems.at( parent ), mKeys.at( parent ) );
+        pos = parent;
+      }
+      place( pos, vertex, key );
+    }
+
+    void siftDown( int pos )
+    {
+      const int count = mItems.size();
+      const int vertex = mItems.at( pos );
+      const double key = mKeys.at( pos );
+      for ( ;; )
+      {
+        int child = 2 * pos + 1;
+        if ( child >= count )
+          break;
+        if ( child + 1 < count && mKeys.at( child + 1 ) < mKeys.at( child ) )
+          ++child;
+        if ( key <= mKeys.at( child ) )
+          break;
+        place( pos, mItems.at( child ), mKeys.at( child ) );
+        pos = child;
+      }
+      place( pos, vertex, key );
+    }
+
+    QVector<int> mItems;
+    QVector<double> mKeys;
+    QVector<int> mPos;
+};
+
+/**
+ * \ingroup analysis
+ * \class QgsGraphSearchState
+ * \since QGIS 3.0
+ * \brief Cost, predecessor and queue of one Dijkstra style search direction.
+ *
+ * Vertices reached by a search are remembered, so reset() only restores those and
+ * repeated local searches do not depend on the graph size.
+ * \note not available in Python bindings
+ */
+class ANALYSIS_EXPORT QgsGraphSearchState
+{
+  public:
+
+    /**
+     * Sizes the state for \a vertexCount vertices, all unreached
+     */
+    void resize( int vertexCount )
+    {
+      dist.fill( std::numeric_limits<double>::infinity(), vertexCount );
+      pred.fill( -1, vertexCount );
+      touched.clear();
+      heap.resize( vertexCount );
+    }
+
+    /**
+     * Restores all vertices reached by the previous search to unreached
+     */
+    void reset()
+    {
+      for ( int i = 0; i < touched.size(); ++i )
+      {
+        dist[ touched.at( i ) ] = std::numeric_limits<double>::infinity();
+        pred[ touched.at( i ) ] = -1;
+      }
+      touched.erase( touched.begin(), touched.end() );
+      heap.clear();
+    }
+
+    /**
+     * Sets the cost of \a vertex and the edge it was reached by
+     */
+    void update( int vertex, double cost, int edge )
+    {
+      if ( std::isinf( dist.at( vertex ) ) )
+        touched.append( vertex );
+      dist[ vertex ] = cost;
+      pred[ vertex ] = edge;
+    }
+
+    //! Cost of the best known path to each vertex, infinity if unreached
+    QVector<double> dist;
+
+    //! Edge each vertex was reached by, -1 if none
+    QVector<int> pred;
+
+    //! Vertices reached since the last reset
+    QVector<int> touched;
+
+    //! Queue of vertices to expand
+    QgsGraphIndexedHeap heap;
+};
+
+#endif // QGSGRAPHSEARCHSTATE_H
@@ -0,0 +1,310 @@
+/***************************************************************************
+  qgsnetworkanalysisalgorithms.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#include "qgsnetworkanalysisalgorithms.h"
+#include "qgsapplication.h"
+#include "qgscompactgraph.h"
+#include "qgscompactgraphbuilder.h"
+#include "qgsfeatureiterator.h"
+#include "qgsgraphsearch.h"
+#include "qgsnetworkdistancestrategy.h"
+#include "qgsnetworkspeedstrategy.h"
+#include "qgsprocessingcontext.h"
+#include "qgsprocessingfeedback.h"
+#include "qgsprocessingutils.h"
+#include "qgsvectorlayer.h"
+#include "qgsvectorlayerdirector.h"
+
+#include <QHash>
+#include <QPair>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+QgsNetworkAnalysisAlgorithms::QgsNetworkAnalysisAlgorithms( QObject *parent )
+  : QgsProcessingProvider( parent )
+{}
+
+QIcon QgsNetworkAnalysisAlgorithms::icon() const
+{
+  return QgsApplication::getThemeIcon( QStringLiteral( "/providerQgis.svg" ) );
+}
+
+QString QgsNetworkAnalysisAlgorithms::svgIconPath() const
+{
+  return QgsApplication::iconPath( QStringLiteral( "providerQgis.svg" ) );
+}
+
+QString QgsNetworkAnalysisAlgorithms::id() const
+{
+  return QStringLiteral( "network" );
+}
+
+QString QgsNetworkAnalysisAlgorithms::name() const
+{
+  return tr( "QGIS network analysis (native c++)" );
+}
+
+bool QgsNetworkAnalysisAlgorithms::supportsNonFileBasedOutput() const
+{
+  return true;
+}
+
+void QgsNetworkAnalysisAlgorithms::loadAlgorithms()
+{
+  addAlgorithm( new QgsNetworkCostMatrixAlgorithm() );
+}
+
+///@cond PRIVATE
+
+/**
+ * Calculates the cost matrix rows of a batch of origins. Each worker owns a search,
+ * reused for all the rows it calculates.
+ */
+struct CostMatrixRowsWrapper
+{
+  CostMatrixRowsWrapper( std::vector< QgsGraphSearch > *searches, const int *origins, int originCount,
+                         const QVector<int> *destinations, QVector<double> *rows )
+    : searches( searches )
+    , origins( origins )
+    , originCount( originCount )
+    , destinations( destinations )
+    , rows( rows )
+  {}
+
+  void operator()( int worker )
+  {
+    QgsGraphSearch &search = ( *searches )[ worker ];
+    const int workerCount = static_cast< int >( searches->size() );
+    for ( int row = worker; row < originCount; row += workerCount )
+    {
+      rows[ row ] = search.costs( origins[ row ], *destinations );
+    }
+  }
+
+  std::vector< QgsGraphSearch > *searches = nullptr;
+  const int *origins = nullptr;
+  int originCount = 0;
+  const QVector<int> *destinations = nullptr;
+  QVector<double> *rows = nullptr;
+};
+
+/**
+ * Reads the points of \a source in \a crs. \a pointIndex is set to the index of the
+ * feature point in \a points, or -1 for features without geometry.
+ */
+static void readPoints( QgsFeatureSource *source, const QgsCoordinateReferenceSystem &crs, QgsProcessingFeedback *feedback,
+                        QVector< QgsPointXY > &points, QVector< QgsFeatureId > &ids, QVector< int > &pointIndex )
+{
+  QgsFeatureRequest request;
+  request.setSubsetOfAttributes( QgsAttributeList() );
+  request.setDestinationCrs( crs );
+
+  QgsFeatureIterator it = source->getFeatures( request );
+  QgsFeature f;
+  while ( it.nextFeature( f ) )
+  {
+    if ( feedback->isCanceled() )
+      break;
+
+    ids.append( f.id() );
+    if ( !f.hasGeometry() )
+    {
+      pointIndex.append( -1 );
+      continue;
+    }
+
+    QgsGeometry geometry = f.geometry();
+    if ( QgsWkbTypes::flatType( geometry.wkbType() ) != QgsWkbTypes::Point )
+      geometry = geometry.centroid();
+    pointIndex.append( points.size() );
+    points.append( geometry.asPoint() );
+  }
+}
+
+QgsNetworkCostMatrixAlgorithm::QgsNetworkCostMatrixAlgorithm()
+{
+  addParameter( new QgsProcessingParameterVectorLayer( QStringLiteral( "INPUT" ), QObject::tr( "Vector layer representing network" ) ) );
+  addParameter( new QgsProcessingParameterFeatureSource( QStringLiteral( "ORIGINS" ), QObject::tr( "Origin points" ),
+                QList< int >() << QgsProcessingParameterDefinition::TypeVectorPoint ) );
+  addParameter( new QgsProcessingParameterFeatureSource( QStringLiteral( "DESTINATIONS" ), QObject::tr( "Destination points" ),
+                QList< int >() << QgsProcessingParameterDefinition::TypeVectorPoint ) );
+  addParameter( new QgsProcessingParameterEnum( QStringLiteral( "STRATEGY" ), QObject::tr( "Path type to calculate" ),
+                QStringList() << QObject::tr( "Shortest" ) << QObject::tr( "Fastest" ), false, 0 ) );
+
+  QList< QgsProcessingParameterDefinition * > advanced;
+  advanced << new QgsProcessingParameterField( QStringLiteral( "DIRECTION_FIELD" ), QObject::tr( "Direction field" ), QVariant(),
+           QStringLiteral( "INPUT" ), QgsProcessingParameterField::Any, false, true );
+  advanced << new QgsProcessingParameterString( QStringLiteral( "VALUE_FORWARD" ), QObject::tr( "Value for forward direction" ), QVariant(), false, true );
+  advanced << new QgsProcessingParameterString( QStringLiteral( "VALUE_BACKWARD" ), QObject::tr( "Value for backward direction" ), QVariant(), false, true );
+  advanced << new QgsProcessingParameterString( QStringLiteral( "VALUE_BOTH" ), QObject::tr( "Value for both directions" ), QVariant(), false, true );
+  advanced << new QgsProcessingParameterEnum( QStringLiteral( "DEFAULT_DIRECTION" ), QObject::tr( "Default direction" ),
+           QStringList() << QObject::tr( "Forward direction" ) << QObject::tr( "Backward direction" ) << QObject::tr( "Both directions" ), false, 2 );
+  advanced << new QgsProcessingParameterField( QStringLiteral( "SPEED_FIELD" ), QObject::tr( "Speed field" ), QVariant(),
+           QStringLiteral( "INPUT" ), QgsProcessingParameterField::Numeric, false, true );
+  advanced << new QgsProcessingParameterNumber( QStringLiteral( "DEFAULT_SPEED" ), QObject::tr( "Default speed (km/h)" ), QgsProcessingParameterNumber::Double, 5.0, false, 0.0 );
+  advanced << new QgsProcessingParameterNumber( QStringLiteral( "TOLERANCE" ), QObject::tr( "Topology tolerance" ), QgsProcessingParameterNumber::Double, 0.0, false, 0.0 );
+  Q_FOREACH ( QgsProcessingParameterDefinition *def, advanced )
+  {
+    def->setFlags( def->flags() | QgsProcessingParameterDefinition::FlagAdvanced );
+    addParameter( def );
+  }
+
+  addParameter( new QgsProcessingParameterFeatureSink( QStringLiteral( "OUTPUT_LAYER" ), QObject::tr( "Cost matrix" ), QgsProcessingParameterDefinition::TypeTable ) );
+  addOutput( new QgsProcessingOutputVectorLayer( QStringLiteral( "OUTPUT_LAYER" ), QObject::tr( "Cost matrix" ), QgsProcessingParameterDefinition::TypeTable ) );
+}
+
+QString QgsNetworkCostMatrixAlgorithm::shortHelpString() const
+{
+  return QObject::tr( "This algorithm computes the network cost from every origin point to every destination point.\n\n"
+                      "The graph is built once from the network layer, with origins and destinations tied to their nearest segment. "
+                      "The output table has one row per origin and destination pair, with the feature ids of both points "
+                      "and the cost of the shortest or fastest path between them, in meters or seconds. "
+                      "The cost is empty when the destination cannot be reached." );
+}
+
+QVariantMap QgsNetworkCostMatrixAlgorithm::processAlgorithm( const QVariantMap &parameters, QgsProcessingContext &context, QgsProcessingFeedback *feedback ) const
+{
+  QgsVectorLayer *network = parameterAsVectorLayer( parameters, QStringLiteral( "INPUT" ), context );
+  if ( !network )
+    return QVariantMap();
+
+  std::unique_ptr< QgsFeatureSource > originSource( parameterAsSource( parameters, QStringLiteral( "ORIGINS" ), context ) );
+  std::unique_ptr< QgsFeatureSource > destinationSource( parameterAsSource( parameters, QStringLiteral( "DESTINATIONS" ), context ) );
+  if ( !originSource || !destinationSource )
+    return QVariantMap();
+
+  QgsFields fields;
+  fields.append( QgsField( QStringLiteral( "origin_id" ), QVariant::LongLong ) );
+  fields.append( QgsField( QStringLiteral( "destination_id" ), QVariant::LongLong ) );
+  fields.append( QgsField( QStringLiteral( "cost" ), QVariant::Double, QString(), 20, 7 ) );
+
+  QString dest;
+  std::unique_ptr< QgsFeatureSink > sink( parameterAsSink( parameters, QStringLiteral( "OUTPUT_LAYER" ), context, dest, fields, QgsWkbTypes::NoGeometry, network->crs() ) );
+  if ( !sink )
+    return QVariantMap();
+
+  const int strategy = parameterAsEnum( parameters, QStringLiteral( "STRATEGY" ), context );
+  const QString directionFieldName = parameterAsString( parameters, QStringLiteral( "DIRECTION_FIELD" ), context );
+  const QString forwardValue = parameterAsString( parameters, QStringLiteral( "VALUE_FORWARD" ), context );
+  const QString backwardValue = parameterAsString( parameters, QStringLiteral( "VALUE_BACKWARD" ), context );
+  const QString bothValue = parameterAsString( parameters, QStringLiteral( "VALUE_BOTH" ), context );
+  const QgsVectorLayerDirector::Direction defaultDirection = static_cast< QgsVectorLayerDirector::Direction >( parameterAsEnum( parameters, QStringLiteral( "DEFAULT_DIRECTION" ), context ) );
+  const QString speedFieldName = parameterAsString( parameters, QStringLiteral( "SPEED_FIELD" ), context );
+  const double defaultSpeed = parameterAsDouble( parameters, QStringLiteral( "DEFAULT_SPEED" ), context );
+  const double tolerance = parameterAsDouble( parameters, QStringLiteral( "TOLERANCE" ), context );
+
+  const int directionField = directionFieldName.isEmpty() ? -1 : network->fields().lookupField( directionFieldName );
+  QgsVectorLayerDirector director( network, directionField, forwardValue, backwardValue, bothValue, defaultDirection );
+  if ( strategy == 0 )
+  {
+    director.addStrategy( new QgsNetworkDistanceStrategy() );
+  }
+  else
+  {
+    // edges are measured in meters on the ellipsoid, speeds are given in km/h
+    const int speedField = speedFieldName.isEmpty() ? -1 : network->fields().lookupField( speedFieldName );
+    director.addStrategy( new QgsNetworkSpeedStrategy( speedField, defaultSpeed, 1000.0 / 3600.0 ) );
+  }
+
+  feedback->pushInfo( QObject::tr( "Loading points..." ) );
+  QVector< QgsPointXY > points;
+  QVector< QgsFeatureId > originIds;
+  QVector< QgsFeatureId > destinationIds;
+  QVector< int > originPoints;
+  QVector< int > destinationPoints;
+  readPoints( originSource.get(), network->crs(), feedback, points, originIds, originPoints );
+  readPoints( destinationSource.get(), network->crs(), feedback, points, destinationIds, destinationPoints );
+  if ( feedback->isCanceled() )
+    return QVariantMap();
+
+  feedback->pushInfo( QObject::tr( "Building graph..." ) );
+  QgsCompactGraphBuilder builder( network->crs(), false, tolerance );
+  QVector< QgsPointXY > snappedPoints;
+  director.makeGraph( &builder, points, snappedPoints );
+  std::unique_ptr< QgsCompactGraph > graph( builder.compactGraph() );
+  if ( feedback->isCanceled() )
+    return QVariantMap();
+
+  // snapped points are graph vertices, look them up once
+  QHash< QPair< double, double >, int > vertexIds;
+  vertexIds.reserve( graph->vertexCount() );
+  for ( int i = 0; i < graph->vertexCount(); ++i )
+  {
+    const QgsPointXY pt = graph->vertexPoint( i );
+    vertexIds.insert( qMakePair( pt.x(), pt.y() ), i );
+  }
+  auto vertexForPoint = [&snappedPoints, &vertexIds]( int point )
+  {
+    if ( point < 0 )
+      return -1;
+    const QgsPointXY &pt = snappedPoints.at( point );
+    return vertexIds.value( qMakePair( pt.x(), pt.y() ), -1 );
+  };
+  QVector< int > originVertices( originPoints.size() );
+  for ( int i = 0; i < originPoints.size(); ++i )
+    originVertices[ i ] = vertexForPoint( originPoints.at( i ) );
+  QVector< int > destinationVertices( destinationPoints.size() );
+  for ( int i = 0; i < destinationPoints.size(); ++i )
+    destinationVertices[ i ] = vertexForPoint( destinationPoints.at( i ) );
+
+  feedback->pushInfo( QObject::tr( "Calculating cost matrix..." ) );
+
+  // one search per worker thread. Copies share the graph and each allocates its own search
+  // state on first use, which is then reused for all its rows
+  const int workerCount = std::max( 1, QThread::idealThreadCount() );
+  std::vector< QgsGraphSearch > searches( workerCount, QgsGraphSearch( *graph, 0 ) );
+  QVector< int > workers( workerCount );
+  for ( int i = 0; i < workerCount; ++i )
+    workers[ i ] = i;
+
+  // rows are calculated in batches, so results can be written while memory use stays bounded
+  const int originCount = originVertices.size();
+  const int batchSize = workerCount * 16;
+  QVector< QVector< double > > rows( batchSize );
+  QgsFeature outFeature( fields );
+  for ( int batchStart = 0; batchStart < originCount; batchStart += batchSize )
+  {
+    if ( feedback->isCanceled() )
+      break;
+
+    const int batchCount = std::min( batchSize, originCount - batchStart );
+    QtConcurrent::blockingMap( workers, CostMatrixRowsWrapper( &searches, originVertices.constData() + batchStart, batchCount,
+                               &destinationVertices, rows.data() ) );
+
+    for ( int row = 0; row < batchCount; ++row )
+    {
+      const QVector< double > &costs = rows.at( row );
+      for ( int column = 0; column < costs.size(); ++column )
+      {
+        const double cost = costs.at( column );
+        outFeature.setAttributes( QgsAttributes() << originIds.at( batchStart + row ) << destinationIds.at( column )
+                                  << ( cost < std::numeric_limits<double>::infinity() ? QVariant( cost ) : QVariant( QVariant::Double ) ) );
+        sink->addFeature( outFeature, QgsFeatureSink::FastInsert );
+      }
+    }
+    feedback->setProgress( 100.0 * ( batchStart + batchCount ) / originCount );
+  }
+
+  QVariantMap outputs;
+  outputs.insert( QStringLiteral( "OUTPUT_LAYER" ), dest );
+  return outputs;
+}
+
+///@endcond
@@ -0,0 +1,85 @@
+/***************************************************************************
+  qgsnetworkanalysisalgorithms.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+****************************************************************************
+*                                                                          *
+*   This program is free software; you can redistribute it and/or modify   *
+*   it under the terms of the GNU General Public License as published by   *
+*   the Free Software Foundation; either version 2 of the License, or      *
+*   (at your option) any later version.                                    *
+*                                                                          *
+***************************************************************************/
+
+#ifndef QGSNETWORKANALYSISALGORITHMS_H
+#define QGSNETWORKANALYSISALGORITHMS_H
+
+#include "qgis.h"
+#include "qgis_analysis.h"
+#include "qgsprocessingalgorithm.h"
+#include "qgsprocessingprovider.h"
+
+/**
+ * \ingroup analysis
+ * \class QgsNetworkAnalysisAlgorithms
+ * \since QGIS 3.0
+ * \brief Processing provider for the native network analysis algorithms.
+ *
+ * The algorithms depend on the analysis library and cannot be part of the core
+ * native provider, so they are registered separately, under the "network" provider id.
+ * The QGIS application adds the provider to QgsApplication::processingRegistry() on startup,
+ * standalone applications and scripts need to add it themselves.
+ */
+class ANALYSIS_EXPORT QgsNetworkAnalysisAlgorithms: public QgsProcessingProvider
+{
+  public:
+
+    /**
+     * Constructor for QgsNetworkAnalysisAlgorithms.
+     */
+    QgsNetworkAnalysisAlgorithms( QObject *parent = nullptr );
+
+    QIcon icon() const override;
+    QString svgIconPath() const override;
+    QString id() const override;
+    QString name() const override;
+    bool supportsNonFileBasedOutput() const override;
+
+  protected:
+
+    void loadAlgorithms() override;
+
+};
+
+///@cond PRIVATE
+#ifndef SIP_RUN
+
+/**
+ * Native origin-destination cost matrix algorithm.
+ */
+class QgsNetworkCostMatrixAlgorithm : public QgsProcessingAlgorithm
+{
+
+  public:
+
+    QgsNetworkCostMatrixAlgorithm();
+
+    QString name() const override { return QStringLiteral( "costmatrix" ); }
+    QString displayName() const override { return QObject::tr( "Cost matrix (layer to layer)" ); }
+    virtual QStringList tags() const override { return QObject::tr( "network,od,origin,destination,distance,matrix,cost,shortest,fastest" ).split( ',' ); }
+    QString group() const override { return QObject::tr( "Network analysis" ); }
+    QString shortHelpString() const override;
+
+  protected:
+
+    virtual QVariantMap processAlgorithm( const QVariantMap &parameters,
+                                          QgsProcessingContext &context, QgsProcessingFeedback *feedback ) const override;
+
+};
+
+#endif
+///@endcond PRIVATE
+
+#endif // QGSNETWORKANALYSISALGORITHMS_H
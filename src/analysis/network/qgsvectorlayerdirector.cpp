@@ -31,6 +31,10 @@
 
 #include <QString>
 #include <QtAlgorithms>
+#include <QtConcurrentMap>
+
+#include <cmath>
+#include <queue>
 
 /** \ingroup analysis
  * \class QgsPointCompare
@@ -102,6 +106,223 @@ bool TiePointInfoCompare( const TiePointInfo &a, const TiePointInfo &b )
   return a.mFirstPoint.x() == b.mFirstPoint.x() ? a.mFirstPoint.y() < b.mFirstPoint.y() : a.mFirstPoint.x() < b.mFirstPoint.x();
 }
 
+///@cond PRIVATE
+
+/**
+ * \ingroup analysis
+ * \class QgsNetworkSegmentIndex
+ * Static R-tree over the network segments, bulk loaded with sort-tile-recursive packing.
+ * The tree is only read once built, so nearest segment queries can run concurrently.
+ */
+class QgsNetworkSegmentIndex
+{
+  public:
+
+    //! Adds the segment from \a pt1 to \a pt2. Segments are identified by their insertion order.
+    void addSegment( const QgsPointXY &pt1, const QgsPointXY &pt2 )
+    {
+      mFirstPoints.push_back( pt1 );
+      mLastPoints.push_back( pt2 );
+    }
+
+    //! Packs the added segments into the tree. Must be called once all segments are added.
+    void build();
+
+    /**
+     * Returns the segment closest to \a pt. If several segments are at the same distance,
+     * the first added one is returned. The length is infinite if the index is empty.
+     */
+    TiePointInfo nearestSegment( const QgsPointXY &pt ) const;
+
+  private:
+
+    struct Box
+    {
+      double xMin;
+      double yMin;
+      double xMax;
+      double yMax;
+
+      double sqrDist( const QgsPointXY &pt ) const
+      {
+        double dx = pt.x() < xMin ? xMin - pt.x() : ( pt.x() > xMax ? pt.x() - xMax : 0.0 );
+        double dy = pt.y() < yMin ? yMin - pt.y() : ( pt.y() > yMax ? pt.y() - yMax : 0.0 );
+        return dx * dx + dy * dy;
+      }
+    };
+
+    static const int NODE_SIZE = 16;
+
+    QVector< QgsPointXY > mFirstPoints;
+    QVector< QgsPointXY > mLastPoints;
+
+    // segment boxes followed by the node boxes, level after level. For segments mChildren holds
+    // the segment index, for nodes the position of their first child
+    QVector< Box > mBoxes;
+    QVector< int > mChildren;
+    // end position of each level, the first level being the segments
+    QVector< int > mLevelEnds;
+};
+
+void QgsNetworkSegmentIndex::build()
+{
+  const int segmentCount = mFirstPoints.size();
+  mBoxes.clear();
+  mChildren.clear();
+  mLevelEnds.clear();
+  if ( segmentCount == 0 )
+    return;
+
+  QVector< Box > boxes( segmentCount );
+  QVector< int > order( segmentCount );
+  for ( int i = 0; i < segmentCount; ++i )
+  {
+    const QgsPointXY &pt1 = mFirstPoints.at( i );
+    const QgsPointXY &pt2 = mLastPoints.at( i );
+    boxes[ i ].xMin = std::min( pt1.x(), pt2.x() );
+    boxes[ i ].yMin = std::min( pt1.y(), pt2.y() );
+    boxes[ i ].xMax = std::max( pt1.x(), pt2.x() );
+    boxes[ i ].yMax = std::max( pt1.y(), pt2.y() );
+    order[ i ] = i;
+  }
+
+  // sort-tile-recursive: sort by x, cut into vertical slices and sort each slice by y
+  // so that consecutive runs of NODE_SIZE segments are spatially close
+  auto centerX = [&boxes]( int i ) { return boxes.at( i ).xMin + boxes.at( i ).xMax; };
+  auto centerY = [&boxes]( int i ) { return boxes.at( i ).yMin + boxes.at( i ).yMax; };
+  std::sort( order.begin(), order.end(), [&centerX]( int a, int b ) { return centerX( a ) < centerX( b ); } );
+  const int leafCount = ( segmentCount + NODE_SIZE - 1 ) / NODE_SIZE;
+  const int sliceCount = std::max( 1, static_cast< int >( std::ceil( std::sqrt( static_cast< double >( leafCount ) ) ) ) );
+  const int sliceSize = ( ( leafCount + sliceCount - 1 ) / sliceCount ) * NODE_SIZE;
+  for ( int start = 0; start < segmentCount; start += sliceSize )
+  {
+    std::sort( order.begin() + start, order.begin() + std::min( start + sliceSize, segmentCount ),
+               [&centerY]( int a, int b ) { return centerY( a ) < centerY( b ); } );
+  }
+
+  mBoxes.reserve( segmentCount + segmentCount / ( NODE_SIZE - 1 ) + 1 );
+  mChildren.reserve( mBoxes.capacity() );
+  Q_FOREACH ( int i, order )
+  {
+    mBoxes.append( boxes.at( i ) );
+    mChildren.append( i );
+  }
+  mLevelEnds.append( segmentCount );
+
+  // group runs of NODE_SIZE entries of the previous level until a single root remains
+  int levelStart = 0;
+  do
+  {
+    const int levelEnd = mBoxes.size();
+    for ( int child = levelStart; child < levelEnd; child += NODE_SIZE )
+    {
+      Box box = mBoxes.at( child );
+      const int childEnd = std::min( child + NODE_SIZE, levelEnd );
+      for ( int j = child + 1; j < childEnd; ++j )
+      {
+        const Box &childBox = mBoxes.at( j );
+        box.xMin = std::min( box.xMin, childBox.xMin );
+        box.yMin = std::min( box.yMin, childBox.yMin );
+        box.xMax = std::max( box.xMax, childBox.xMax );
+        box.yMax = std::max( box.yMax, childBox.yMax );
+      }
+      mBoxes.append( box );
+      mChildren.append( child );
+    }
+    mLevelEnds.append( mBoxes.size() );
+    levelStart = levelEnd;
+  }
+  while ( mBoxes.size() - levelStart > 1 );
+}
+
+TiePointInfo QgsNetworkSegmentIndex::nearestSegment( const QgsPointXY &pt ) const
+{
+  TiePointInfo result;
+  result.mLength = std::numeric_limits<double>::infinity();
+  if ( mBoxes.isEmpty() )
+    return result;
+
+  int resultSegment = -1;
+
+  // best first traversal, nodes are visited by increasing distance of their box
+  typedef std::pair< double, int > QueueItem;
+  std::priority_queue< QueueItem, std::vector< QueueItem >, std::greater< QueueItem > > queue;
+  const int root = mBoxes.size() - 1;
+  queue.push( QueueItem( mBoxes.at( root ).sqrDist( pt ), root ) );
+
+  while ( !queue.empty() )
+  {
+    const QueueItem item = queue.top();
+    queue.pop();
+    if ( item.first > result.mLength )
+      break;
+
+    const int node = item.second;
+    int level = 1;
+    while ( node >= mLevelEnds.at( level ) )
+      ++level;
+    const int childStart = mChildren.at( node );
+    const int childEnd = std::min( childStart + NODE_SIZE, mLevelEnds.at( level - 1 ) );
+
+    for ( int child = childStart; child < childEnd; ++child )
+    {
+      const double boxDist = mBoxes.at( child ).sqrDist( pt );
+      if ( boxDist > result.mLength )
+        continue;
+
+      if ( level > 1 )
+      {
+        queue.push( QueueItem( boxDist, child ) );
+        continue;
+      }
+
+      const int segment = mChildren.at( child );
+      const QgsPointXY &pt1 = mFirstPoints.at( segment );
+      const QgsPointXY &pt2 = mLastPoints.at( segment );
+      QgsPointXY tiedPoint;
+      double length;
+      if ( pt1 == pt2 )
+      {
+        length = pt.sqrDist( pt1 );
+        tiedPoint = pt1;
+      }
+      else
+      {
+        length = pt.sqrDistToSegment( pt1.x(), pt1.y(), pt2.x(), pt2.y(), tiedPoint );
+      }
+
+      if ( length < result.mLength || ( length == result.mLength && segment < resultSegment ) )
+      {
+        result.mLength = length;
+        result.mTiedPoint = tiedPoint;
+        result.mFirstPoint = pt1;
+        result.mLastPoint = pt2;
+        resultSegment = segment;
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * \ingroup analysis
+ * Finds the tie point of an additional point, used to snap points concurrently.
+ */
+struct SnapPointWrapper
+{
+  typedef TiePointInfo result_type;
+
+  explicit SnapPointWrapper( const QgsNetworkSegmentIndex *index )
+    : index( index )
+  {}
+
+  TiePointInfo operator()( const QgsPointXY &point ) const { return index->nearestSegment( point ); }
+
+  const QgsNetworkSegmentIndex *index = nullptr;
+};
+
+///@endcond
+
 QgsVectorLayerDirector::QgsVectorLayerDirector( QgsVectorLayer *myLayer,
     int directionFieldId,
     const QString &directDirectionValue,
@@ -147,11 +368,9 @@ void QgsVectorLayerDirector::makeGraph( QgsGraphBuilderInterface *builder, const
 
   snappedPoints = QVector< QgsPointXY >( additionalPoints.size(), QgsPointXY( 0.0, 0.0 ) );
 
-  TiePointInfo tmpInfo;
-  tmpInfo.mLength = std::numeric_limits<double>::infinity();
-
-  QVector< TiePointInfo > pointLengthMap( additionalPoints.size(), tmpInfo );
-  QVector< TiePointInfo >::iterator pointLengthIt;
+  QVector< TiePointInfo > pointLengthMap;
+  QgsNetworkSegmentIndex segmentIndex;
+  const bool snapPoints = !additionalPoints.isEmpty();
 
   //Graph's points;
   QVector< QgsPointXY > points;
@@ -180,33 +399,9 @@ void QgsVectorLayerDirector::makeGraph( QgsGraphBuilderInterface *builder, const
         pt2 = ct.transform( *pointIt );
         points.push_back( pt2 );
 
-        if ( !isFirstPoint )
+        if ( !isFirstPoint && snapPoints )
         {
-          int i = 0;
-          for ( i = 0; i != additionalPoints.size(); ++i )
-          {
-            TiePointInfo info;
-            if ( pt1 == pt2 )
-            {
-              info.mLength = additionalPoints[ i ].sqrDist( pt1 );
-              info.mTiedPoint = pt1;
-            }
-            else
-            {
-              info.mLength = additionalPoints[ i ].sqrDistToSegment( pt1.x(), pt1.y(),
-                             pt2.x(), pt2.y(), info.mTiedPoint );
-            }
-
-            if ( pointLengthMap[ i ].mLength > info.mLength )
-            {
-              Q_UNUSED( info.mTiedPoint );
-              info.mFirstPoint = pt1;
-              info.mLastPoint = pt2;
-
-              pointLengthMap[ i ] = info;
-              snappedPoints[ i ] = info.mTiedPoint;
-            }
-          }
+          segmentIndex.addSegment( pt1, pt2 );
         }
         pt1 = pt2;
         isFirstPoint = false;
@@ -214,6 +409,18 @@ void QgsVectorLayerDirector::makeGraph( QgsGraphBuilderInterface *builder, const
     }
     emit buildProgress( ++step, featureCount );
   }
+
+  // each point is tied to its nearest segment, the first one in layer order on equal distances
+  if ( snapPoints )
+  {
+    segmentIndex.build();
+    pointLengthMap = QtConcurrent::blockingMapped< QVector< TiePointInfo > >( additionalPoints, SnapPointWrapper( &segmentIndex ) );
+    for ( int i = 0; i < pointLengthMap.size(); ++i )
+    {
+      if ( pointLengthMap.at( i ).mLength < std::numeric_limits<double>::infinity() )
+        snappedPoints[ i ] = pointLengthMap.at( i ).mTiedPoint;
+    }
+  }
   // end: tie points to graph
 
   // add tied point to graph
@@ -324,25 +531,11 @@ void QgsVectorLayerDirector::makeGraph( QgsGraphBuilderInterface *builder, const
           t.mFirstPoint = pt1;
           t.mLastPoint  = pt2;
           t.mLength = 0.0;
-          pointLengthIt = my_binary_search( pointLengthMap.begin(), pointLengthMap.end(), t, TiePointInfoCompare );
-
-          if ( pointLengthIt != pointLengthMap.end() )
+          std::pair< QVector< TiePointInfo >::const_iterator, QVector< TiePointInfo >::const_iterator > tiedRange =
+            std::equal_range( pointLengthMap.constBegin(), pointLengthMap.constEnd(), t, TiePointInfoCompare );
+          for ( QVector< TiePointInfo >::const_iterator it = tiedRange.first; it != tiedRange.second; ++it )
           {
-            QVector< TiePointInfo >::iterator it;
-            for ( it = pointLengthIt; it - pointLengthMap.begin() >= 0; --it )
-            {
-              if ( it->mFirstPoint == pt1 && it->mLastPoint == pt2 )
-              {
-                pointsOnArc[ pt1.sqrDist( it->mTiedPoint )] = it->mTiedPoint;
-              }
-            }
-            for ( it = pointLengthIt + 1; it != pointLengthMap.end(); ++it )
-            {
-              if ( it->mFirstPoint == pt1 && it->mLastPoint == pt2 )
-              {
-                pointsOnArc[ pt1.sqrDist( it->mTiedPoint )] = it->mTiedPoint;
-              }
-            }
+            pointsOnArc[ pt1.sqrDist( it->mTiedPoint )] = it->mTiedPoint;
           }
 
           QMap< double, QgsPointXY >::iterator pointsIt;
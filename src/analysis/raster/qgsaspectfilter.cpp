@@ -16,6 +16,39 @@
  ***************************************************************************/
 
 #include "qgsaspectfilter.h"
+#include "qgsninecellfilterbatch_p.h"
+
+///@cond PRIVATE
+
+//! Batch kernel of QgsAspectFilter
+struct AspectKernel
+{
+  AspectKernel( const QgsDerivativeBatchParameters &parameters, const float *rowAbove, const float *rowCurrent, const float *rowBelow )
+    : parameters( parameters )
+    , rowAbove( rowAbove )
+    , rowCurrent( rowCurrent )
+    , rowBelow( rowBelow )
+  {}
+
+  template <class F> void operator()( int offset, F &result ) const
+  {
+    F derX, derY;
+    typename F::Mask valid;
+    batchFirstDerivatives( parameters, rowAbove + offset, rowCurrent + offset, rowBelow + offset, derX, derY, valid );
+    //aspect is undefined on flat areas
+    const F zero( 0.0f );
+    valid = valid & !( ( derX == zero ) & ( derY == zero ) );
+    const F aspect = F( 180.0f ) + batchAtan2( derX, derY ) * F( static_cast< float >( 180.0 / M_PI ) );
+    result = select( valid, aspect, F( parameters.outputNodata ) );
+  }
+
+  QgsDerivativeBatchParameters parameters;
+  const float *rowAbove = nullptr;
+  const float *rowCurrent = nullptr;
+  const float *rowBelow = nullptr;
+};
+
+///@endcond
 
 QgsAspectFilter::QgsAspectFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsDerivativeFilter( inputFile, outputFile, outputFormat )
@@ -43,3 +76,8 @@ float QgsAspectFilter::processNineCellWindow(
   }
 }
 
+void QgsAspectFilter::processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count )
+{
+  const QgsDerivativeBatchParameters parameters( mInputNodataValue, mOutputNodataValue, mCellSizeX, mCellSizeY, mZFactor );
+  processNineCellBatches( AspectKernel( parameters, rowAbove, rowCurrent, rowBelow ), resultRow, count );
+}
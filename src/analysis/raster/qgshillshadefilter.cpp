@@ -16,6 +16,54 @@
  ***************************************************************************/
 
 #include "qgshillshadefilter.h"
+#include "qgsninecellfilterbatch_p.h"
+
+///@cond PRIVATE
+
+/**
+ * Batch kernel of QgsHillshadeFilter. With the slope angle atan( r ) and the aspect angle pi + atan2( derX, derY ),
+ * where r = sqrt( derX^2 + derY^2 ), the illumination formula of processNineCellWindow() reduces to
+ * ( cos( zenith ) - sin( zenith ) * ( cos( azimuth ) * derY + sin( azimuth ) * derX ) ) / sqrt( 1 + r^2 ),
+ * which needs no trigonometric function per cell.
+ */
+struct HillshadeKernel
+{
+  HillshadeKernel( const QgsDerivativeBatchParameters &parameters, const float *rowAbove, const float *rowCurrent, const float *rowBelow,
+                   float lightAzimuth, float lightAngle )
+    : parameters( parameters )
+    , rowAbove( rowAbove )
+    , rowCurrent( rowCurrent )
+    , rowBelow( rowBelow )
+  {
+    const float zenithRad = lightAngle * M_PI / 180.0;
+    const float azimuthRad = lightAzimuth * M_PI / 180.0;
+    cosZenith = 255.0 * cos( zenithRad );
+    sinZenith = 255.0 * sin( zenithRad );
+    cosAzimuth = cos( azimuthRad );
+    sinAzimuth = sin( azimuthRad );
+  }
+
+  template <class F> void operator()( int offset, F &result ) const
+  {
+    F derX, derY;
+    typename F::Mask valid;
+    batchFirstDerivatives( parameters, rowAbove + offset, rowCurrent + offset, rowBelow + offset, derX, derY, valid );
+    const F norm = sqrt( F( 1.0f ) + derX * derX + derY * derY );
+    const F shade = ( F( cosZenith ) - F( sinZenith ) * ( F( cosAzimuth ) * derY + F( sinAzimuth ) * derX ) ) / norm;
+    result = select( valid, max( F( 0.0f ), shade ), F( parameters.outputNodata ) );
+  }
+
+  QgsDerivativeBatchParameters parameters;
+  const float *rowAbove = nullptr;
+  const float *rowCurrent = nullptr;
+  const float *rowBelow = nullptr;
+  float cosZenith = 0;
+  float sinZenith = 0;
+  float cosAzimuth = 0;
+  float sinAzimuth = 0;
+};
+
+///@endcond
 
 QgsHillshadeFilter::QgsHillshadeFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat, double lightAzimuth,
                                         double lightAngle )
@@ -51,3 +99,9 @@ float QgsHillshadeFilter::processNineCellWindow( float *x11, float *x21, float *
   }
   return qMax( 0.0, 255.0 * ( ( cos( zenith_rad ) * cos( slope_rad ) ) + ( sin( zenith_rad ) * sin( slope_rad ) * cos( azimuth_rad - aspect_rad ) ) ) );
 }
+
+void QgsHillshadeFilter::processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count )
+{
+  const QgsDerivativeBatchParameters parameters( mInputNodataValue, mOutputNodataValue, mCellSizeX, mCellSizeY, mZFactor );
+  processNineCellBatches( HillshadeKernel( parameters, rowAbove, rowCurrent, rowBelow, mLightAzimuth, mLightAngle ), resultRow, count );
+}
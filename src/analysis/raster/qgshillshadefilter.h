@@ -36,6 +36,9 @@ class ANALYSIS_EXPORT QgsHillshadeFilter: public QgsDerivativeFilter
                                  float *x12, float *x22, float *x32,
                                  float *x13, float *x23, float *x33 ) override;
 
+    //! Calculates a row span at once, with SIMD instructions where available
+    void processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count ) override;
+
     float lightAzimuth() const { return mLightAzimuth; }
     void setLightAzimuth( float azimuth ) { mLightAzimuth = azimuth; }
     float lightAngle() const { return mLightAngle; }
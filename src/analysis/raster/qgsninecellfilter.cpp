@@ -21,6 +21,56 @@
 #include "qgsfeedback.h"
 #include <QProgressDialog>
 #include <QFile>
+#include <QFuture>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+///@cond PRIVATE
+
+//! Maximum number of rows of a tile
+static const int MAX_TILE_ROWS = 128;
+//! Maximum number of input cells of a tile, limits the tile height of wide rasters
+static const int MAX_TILE_CELLS = 1 << 22;
+
+/**
+ * Calculates a chunk of contiguous rows of a tile. \a input holds the padded tile rows,
+ * including the halo rows above and below.
+ */
+struct ProcessRowsWrapper
+{
+  ProcessRowsWrapper( QgsNineCellFilter *filter, float *input, float *result, int xSize, int rows, int chunkCount )
+    : filter( filter )
+    , input( input )
+    , result( result )
+    , xSize( xSize )
+    , rows( rows )
+    , chunkCount( chunkCount )
+  {}
+
+  void operator()( int chunk )
+  {
+    const int paddedWidth = xSize + 2;
+    const int endRow = static_cast< int >( static_cast< qint64 >( rows ) * ( chunk + 1 ) / chunkCount );
+    for ( int row = static_cast< int >( static_cast< qint64 >( rows ) * chunk / chunkCount ); row < endRow; ++row )
+    {
+      filter->processNineCellRow( input + row * paddedWidth, input + ( row + 1 ) * paddedWidth, input + ( row + 2 ) * paddedWidth,
+                                  result + row * xSize, xSize );
+    }
+  }
+
+  QgsNineCellFilter *filter = nullptr;
+  float *input = nullptr;
+  float *result = nullptr;
+  int xSize = 0;
+  int rows = 0;
+  int chunkCount = 1;
+};
+
+///@endcond
 
 QgsNineCellFilter::QgsNineCellFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : mInputFile( inputFile )
@@ -97,15 +147,28 @@ int QgsNineCellFilter::processRaster( QgsFeedback *feedback )
     return 6;
   }
 
-  //keep only three scanlines in memory at a time
-  float *scanLine1 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
-  float *scanLine2 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
-  float *scanLine3 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
+  const int threadCount = mThreadCount > 0 ? mThreadCount : std::max( 1, QThread::idealThreadCount() );
 
-  float *resultLine = ( float * ) CPLMalloc( sizeof( float ) * xSize );
+  //the raster is processed in tiles of full rows. Each tile is read with a halo row above and below, and every row
+  //is padded with a cell on both sides, so that values outside the layer extent are (input) nodata values
+  const int paddedWidth = xSize + 2;
+  const int tileRows = std::max( 1, std::min( std::min( MAX_TILE_ROWS, ySize ), MAX_TILE_CELLS / paddedWidth ) );
+  QVector< float > input( paddedWidth * ( tileRows + 2 ) );
+  for ( int row = 0; row < tileRows + 2; ++row )
+  {
+    input[ row * paddedWidth ] = mInputNodataValue;
+    input[ row * paddedWidth + xSize + 1 ] = mInputNodataValue;
+  }
+
+  //results are written in the background while the next tile is calculated
+  QVector< float > results[2];
+  results[0].resize( xSize * tileRows );
+  results[1].resize( xSize * tileRows );
+  QFuture< CPLErr > pendingWrite;
+  bool hasPendingWrite = false;
 
-  //values outside the layer extent (if the 3x3 window is on the border) are sent to the processing method as (input) nodata values
-  for ( int i = 0; i < ySize; ++i )
+  int tile = 0;
+  for ( int tileStart = 0; tileStart < ySize; tileStart += tileRows, ++tile )
   {
     if ( feedback && feedback->isCanceled() )
     {
@@ -114,74 +177,58 @@ int QgsNineCellFilter::processRaster( QgsFeedback *feedback )
 
     if ( feedback )
     {
-      feedback->setProgress( 100.0 * static_cast< double >( i ) / ySize );
+      feedback->setProgress( 100.0 * static_cast< double >( tileStart ) / ySize );
     }
 
-    if ( i == 0 )
+    const int rows = std::min( tileRows, ySize - tileStart );
+    const int firstRow = std::max( 0, tileStart - 1 );
+    const int lastRow = std::min( ySize - 1, tileStart + rows );
+    float *inputData = input.data();
+    if ( tileStart == 0 )
     {
-      //fill scanline 1 with (input) nodata for the values above the first row and feed scanline2 with the first row
-      for ( int a = 0; a < xSize; ++a )
-      {
-        scanLine1[a] = mInputNodataValue;
-      }
-      if ( GDALRasterIO( rasterBand, GF_Read, 0, 0, xSize, 1, scanLine2, xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
-      {
-        QgsDebugMsg( "Raster IO Error" );
-      }
+      std::fill( inputData + 1, inputData + 1 + xSize, mInputNodataValue );
     }
-    else
+    if ( lastRow < tileStart + rows )
     {
-      //normally fetch only scanLine3 and release scanline 1 if we move forward one row
-      CPLFree( scanLine1 );
-      scanLine1 = scanLine2;
-      scanLine2 = scanLine3;
-      scanLine3 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
+      std::fill( inputData + ( rows + 1 ) * paddedWidth + 1, inputData + ( rows + 1 ) * paddedWidth + 1 + xSize, mInputNodataValue );
     }
-
-    if ( i == ySize - 1 ) //fill the row below the bottom with nodata values
+    if ( GDALRasterIO( rasterBand, GF_Read, 0, firstRow, xSize, lastRow - firstRow + 1,
+                       inputData + ( firstRow - tileStart + 1 ) * paddedWidth + 1, xSize, lastRow - firstRow + 1, GDT_Float32,
+                       0, sizeof( float ) * paddedWidth ) != CE_None )
     {
-      for ( int a = 0; a < xSize; ++a )
-      {
-        scanLine3[a] = mInputNodataValue;
-      }
+      QgsDebugMsg( "Raster IO Error" );
     }
-    else
+
+    float *resultData = results[ tile % 2 ].data();
+    const int chunkCount = std::min( threadCount, rows );
+    if ( chunkCount > 1 )
     {
-      if ( GDALRasterIO( rasterBand, GF_Read, 0, i + 1, xSize, 1, scanLine3, xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
-      {
-        QgsDebugMsg( "Raster IO Error" );
-      }
+      QVector< int > chunks( chunkCount );
+      for ( int i = 0; i < chunkCount; ++i )
+        chunks[ i ] = i;
+      QtConcurrent::blockingMap( chunks, ProcessRowsWrapper( this, inputData, resultData, xSize, rows, chunkCount ) );
     }
-
-    for ( int j = 0; j < xSize; ++j )
+    else
     {
-      if ( j == 0 )
-      {
-        resultLine[j] = processNineCellWindow( &mInputNodataValue, &scanLine1[j], &scanLine1[j + 1], &mInputNodataValue, &scanLine2[j],
-                                               &scanLine2[j + 1], &mInputNodataValue, &scanLine3[j], &scanLine3[j + 1] );
-      }
-      else if ( j == xSize - 1 )
-      {
-        resultLine[j] = processNineCellWindow( &scanLine1[j - 1], &scanLine1[j], &mInputNodataValue, &scanLine2[j - 1], &scanLine2[j],
-                                               &mInputNodataValue, &scanLine3[j - 1], &scanLine3[j], &mInputNodataValue );
-      }
-      else
-      {
-        resultLine[j] = processNineCellWindow( &scanLine1[j - 1], &scanLine1[j], &scanLine1[j + 1], &scanLine2[j - 1], &scanLine2[j],
-                                               &scanLine2[j + 1], &scanLine3[j - 1], &scanLine3[j], &scanLine3[j + 1] );
-      }
+      ProcessRowsWrapper( this, inputData, resultData, xSize, rows, 1 )( 0 );
     }
 
-    if ( GDALRasterIO( outputRasterBand, GF_Write, 0, i, xSize, 1, resultLine, xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
+    //the other result buffer is reused for the next tile, so its write needs to be finished
+    if ( hasPendingWrite && pendingWrite.result() != CE_None )
     {
       QgsDebugMsg( "Raster IO Error" );
     }
+    pendingWrite = QtConcurrent::run( [ = ]
+    {
+      return GDALRasterIO( outputRasterBand, GF_Write, 0, tileStart, xSize, rows, resultData, xSize, rows, GDT_Float32, 0, 0 );
+    } );
+    hasPendingWrite = true;
   }
 
-  CPLFree( resultLine );
-  CPLFree( scanLine1 );
-  CPLFree( scanLine2 );
-  CPLFree( scanLine3 );
+  if ( hasPendingWrite && pendingWrite.result() != CE_None )
+  {
+    QgsDebugMsg( "Raster IO Error" );
+  }
 
   GDALClose( inputDataset );
 
@@ -196,6 +243,16 @@ int QgsNineCellFilter::processRaster( QgsFeedback *feedback )
   return 0;
 }
 
+void QgsNineCellFilter::processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count )
+{
+  for ( int i = 0; i < count; ++i )
+  {
+    resultRow[i] = processNineCellWindow( &rowAbove[i], &rowAbove[i + 1], &rowAbove[i + 2],
+                                          &rowCurrent[i], &rowCurrent[i + 1], &rowCurrent[i + 2],
+                                          &rowBelow[i], &rowBelow[i + 1], &rowBelow[i + 2] );
+  }
+}
+
 GDALDatasetH QgsNineCellFilter::openInputFile( int &nCellsX, int &nCellsY )
 {
   GDALDatasetH inputDataset = GDALOpen( mInputFile.toUtf8().constData(), GA_ReadOnly );
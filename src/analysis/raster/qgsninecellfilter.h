@@ -36,11 +36,29 @@ class ANALYSIS_EXPORT QgsNineCellFilter
     QgsNineCellFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat );
     virtual ~QgsNineCellFilter() = default;
 
-    /** Starts the calculation, reads from mInputFile and stores the result in mOutputFile
+    /** Starts the calculation, reads from mInputFile and stores the result in mOutputFile.
+      The raster is processed in tiles of full rows, and the rows of a tile are calculated in parallel
+      unless threadCount() is 1, so processNineCellRow() must be safe to call from several threads at once.
       \param feedback feedback object that receives update and that is checked for cancelation.
       \returns 0 in case of success*/
     int processRaster( QgsFeedback *feedback = nullptr );
 
+    /**
+     * Returns the maximum number of threads used by processRaster(). A value of 0 means
+     * that the number of threads matches the number of processor cores.
+     * \see setThreadCount()
+     * \since QGIS 3.0
+     */
+    int threadCount() const { return mThreadCount; }
+
+    /**
+     * Sets the maximum number of threads used by processRaster(). A \a count of 0 means
+     * that the number of threads matches the number of processor cores, 1 disables threading.
+     * \see threadCount()
+     * \since QGIS 3.0
+     */
+    void setThreadCount( int count ) { mThreadCount = count; }
+
     double cellSizeX() const { return mCellSizeX; }
     void setCellSizeX( double size ) { mCellSizeX = size; }
     double cellSizeY() const { return mCellSizeY; }
@@ -60,6 +78,18 @@ class ANALYSIS_EXPORT QgsNineCellFilter
                                          float *x12, float *x22, float *x32,
                                          float *x13, float *x23, float *x33 ) = 0;
 
+    /**
+     * Calculates output values for \a count consecutive cells of a row. \a rowAbove, \a rowCurrent and \a rowBelow
+     * point to the input values of the rows above, at and below the output row, starting one cell to the left of the
+     * first output cell, so the window of output cell i covers the input cells i to i + 2. Cells outside of the
+     * raster are set to the input nodata value. Results are written to \a resultRow.
+     *
+     * The default implementation calls processNineCellWindow() for each cell. Subclasses can override it to
+     * process the whole span at once.
+     * \since QGIS 3.0
+     */
+    virtual void processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count );
+
   private:
     //default constructor forbidden. We need input file, output file and format obligatory
     QgsNineCellFilter();
@@ -89,6 +119,8 @@ class ANALYSIS_EXPORT QgsNineCellFilter
     float mOutputNodataValue;
     //! Scale factor for z-value if x-/y- units are different to z-units (111120 for degree->meters and 370400 for degree->feet)
     double mZFactor;
+    //! Maximum number of threads, 0 for the number of processor cores
+    int mThreadCount = 0;
 };
 
 #endif // QGSNINECELLFILTER_H
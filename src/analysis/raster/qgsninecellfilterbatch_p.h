@@ -0,0 +1,331 @@
+/***************************************************************************
+  qgsninecellfilterbatch_p.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSNINECELLFILTERBATCH_PRIVATE_H
+#define QGSNINECELLFILTERBATCH_PRIVATE_H
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#define SIP_NO_FILE
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define QGS_FLOAT_BATCH_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define QGS_FLOAT_BATCH_SSE2
+#endif
+
+/*
+ * Small abstraction over SIMD registers of floats, used to write the nine cell filter row kernels once
+ * for all instruction sets. QgsFloatBatch is the widest batch available for the target the code is
+ * compiled for (AVX or SSE2), QgsScalarFloatBatch is the portable fallback which is also used for the
+ * cells left over at the end of a row. Both offer the same operations, so kernels are templates
+ * over the batch type.
+ */
+
+//! Single float, portable fallback of QgsFloatBatch
+struct QgsScalarFloatBatch
+{
+  typedef bool Mask;
+  static const int SIZE = 1;
+
+  QgsScalarFloatBatch() = default;
+  QgsScalarFloatBatch( float value ) : v( value ) {}
+
+  static QgsScalarFloatBatch load( const float *p ) { return QgsScalarFloatBatch( *p ); }
+  void store( float *p ) const { *p = v; }
+
+  float v = 0;
+};
+
+inline QgsScalarFloatBatch operator+( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v + b.v; }
+inline QgsScalarFloatBatch operator-( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v - b.v; }
+inline QgsScalarFloatBatch operator*( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v * b.v; }
+inline QgsScalarFloatBatch operator/( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v / b.v; }
+inline bool operator==( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v == b.v; }
+inline bool operator!=( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v != b.v; }
+inline bool operator<( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v < b.v; }
+inline bool operator>( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v > b.v; }
+inline QgsScalarFloatBatch select( bool mask, QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return mask ? a : b; }
+inline QgsScalarFloatBatch sqrt( QgsScalarFloatBatch a ) { return std::sqrt( a.v ); }
+inline QgsScalarFloatBatch max( QgsScalarFloatBatch a, QgsScalarFloatBatch b ) { return a.v > b.v ? a.v : b.v; }
+inline QgsScalarFloatBatch abs( QgsScalarFloatBatch a ) { return std::fabs( a.v ); }
+inline QgsScalarFloatBatch copySign( QgsScalarFloatBatch magnitude, QgsScalarFloatBatch sign ) { return std::copysign( magnitude.v, sign.v ); }
+
+#if defined(QGS_FLOAT_BATCH_AVX)
+
+//! Comparison result of QgsFloatBatch, all bits of a lane are set where the comparison is true
+struct QgsFloatBatchMask
+{
+  QgsFloatBatchMask() = default;
+  QgsFloatBatchMask( __m256 mask ) : m( mask ) {}
+  __m256 m;
+};
+
+inline QgsFloatBatchMask operator&( QgsFloatBatchMask a, QgsFloatBatchMask b ) { return _mm256_and_ps( a.m, b.m ); }
+inline QgsFloatBatchMask operator|( QgsFloatBatchMask a, QgsFloatBatchMask b ) { return _mm256_or_ps( a.m, b.m ); }
+inline QgsFloatBatchMask operator!( QgsFloatBatchMask a ) { return _mm256_xor_ps( a.m, _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) ) ); }
+
+//! Eight floats in an AVX register
+struct QgsFloatBatch
+{
+  typedef QgsFloatBatchMask Mask;
+  static const int SIZE = 8;
+
+  QgsFloatBatch() = default;
+  QgsFloatBatch( __m256 value ) : v( value ) {}
+  QgsFloatBatch( float value ) : v( _mm256_set1_ps( value ) ) {}
+
+  static QgsFloatBatch load( const float *p ) { return _mm256_loadu_ps( p ); }
+  void store( float *p ) const { _mm256_storeu_ps( p, v ); }
+
+  __m256 v;
+};
+
+inline QgsFloatBatch operator+( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_add_ps( a.v, b.v ); }
+inline QgsFloatBatch operator-( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_sub_ps( a.v, b.v ); }
+inline QgsFloatBatch operator*( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_mul_ps( a.v, b.v ); }
+inline QgsFloatBatch operator/( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_div_ps( a.v, b.v ); }
+inline QgsFloatBatchMask operator==( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_EQ_OQ ); }
+inline QgsFloatBatchMask operator!=( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_NEQ_UQ ); }
+inline QgsFloatBatchMask operator<( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_LT_OQ ); }
+inline QgsFloatBatchMask operator>( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_GT_OQ ); }
+inline QgsFloatBatch select( QgsFloatBatchMask mask, QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_blendv_ps( b.v, a.v, mask.m ); }
+inline QgsFloatBatch sqrt( QgsFloatBatch a ) { return _mm256_sqrt_ps( a.v ); }
+inline QgsFloatBatch max( QgsFloatBatch a, QgsFloatBatch b ) { return _mm256_max_ps( a.v, b.v ); }
+inline QgsFloatBatch abs( QgsFloatBatch a ) { return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a.v ); }
+inline QgsFloatBatch copySign( QgsFloatBatch magnitude, QgsFloatBatch sign )
+{
+  const __m256 signMask = _mm256_set1_ps( -0.0f );
+  return _mm256_or_ps( _mm256_andnot_ps( signMask, magnitude.v ), _mm256_and_ps( signMask, sign.v ) );
+}
+
+#elif defined(QGS_FLOAT_BATCH_SSE2)
+
+//! Comparison result of QgsFloatBatch, all bits of a lane are set where the comparison is true
+struct QgsFloatBatchMask
+{
+  QgsFloatBatchMask() = default;
+  QgsFloatBatchMask( __m128 mask ) : m( mask ) {}
+  __m128 m;
+};
+
+inline QgsFloatBatchMask operator&( QgsFloatBatchMask a, QgsFloatBatchMask b ) { return _mm_and_ps( a.m, b.m ); }
+inline QgsFloatBatchMask operator|( QgsFloatBatchMask a, QgsFloatBatchMask b ) { return _mm_or_ps( a.m, b.m ); }
+inline QgsFloatBatchMask operator!( QgsFloatBatchMask a ) { return _mm_xor_ps( a.m, _mm_castsi128_ps( _mm_set1_epi32( -1 ) ) ); }
+
+//! Four floats in an SSE register
+struct QgsFloatBatch
+{
+  typedef QgsFloatBatchMask Mask;
+  static const int SIZE = 4;
+
+  QgsFloatBatch() = default;
+  QgsFloatBatch( __m128 value ) : v( value ) {}
+  QgsFloatBatch( float value ) : v( _mm_set1_ps( value ) ) {}
+
+  static QgsFloatBatch load( const float *p ) { return _mm_loadu_ps( p ); }
+  void store( float *p ) const { _mm_storeu_ps( p, v ); }
+
+  __m128 v;
+};
+
+inline QgsFloatBatch operator+( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_add_ps( a.v, b.v ); }
+inline QgsFloatBatch operator-( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_sub_ps( a.v, b.v ); }
+inline QgsFloatBatch operator*( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_mul_ps( a.v, b.v ); }
+inline QgsFloatBatch operator/( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_div_ps( a.v, b.v ); }
+inline QgsFloatBatchMask operator==( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_cmpeq_ps( a.v, b.v ); }
+inline QgsFloatBatchMask operator!=( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_cmpneq_ps( a.v, b.v ); }
+inline QgsFloatBatchMask operator<( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_cmplt_ps( a.v, b.v ); }
+inline QgsFloatBatchMask operator>( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_cmpgt_ps( a.v, b.v ); }
+inline QgsFloatBatch select( QgsFloatBatchMask mask, QgsFloatBatch a, QgsFloatBatch b ) { return _mm_or_ps( _mm_and_ps( mask.m, a.v ), _mm_andnot_ps( mask.m, b.v ) ); }
+inline QgsFloatBatch sqrt( QgsFloatBatch a ) { return _mm_sqrt_ps( a.v ); }
+inline QgsFloatBatch max( QgsFloatBatch a, QgsFloatBatch b ) { return _mm_max_ps( a.v, b.v ); }
+inline QgsFloatBatch abs( QgsFloatBatch a ) { return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a.v ); }
+inline QgsFloatBatch copySign( QgsFloatBatch magnitude, QgsFloatBatch sign )
+{
+  const __m128 signMask = _mm_set1_ps( -0.0f );
+  return _mm_or_ps( _mm_andnot_ps( signMask, magnitude.v ), _mm_and_ps( signMask, sign.v ) );
+}
+
+#else
+
+//! No SIMD instruction set available, rows are processed one cell at a time
+typedef QgsScalarFloatBatch QgsFloatBatch;
+
+#endif
+
+/**
+ * Arc tangent of a batch, in radians. Single precision polynomial approximation after Cephes atanf,
+ * with a maximum error of about two ulp.
+ */
+template <class F> inline F batchAtan( F x )
+{
+  const F ax = abs( x );
+  const typename F::Mask large = ax > F( 2.414213562373095f ); // tan(3 pi / 8)
+  const typename F::Mask medium = ax > F( 0.4142135623730950f ); // tan(pi / 8)
+  const F offset = select( large, F( 1.57079632679489662f ), select( medium, F( 0.785398163397448310f ), F( 0.0f ) ) );
+  const F reduced = select( large, F( -1.0f ) / ax, select( medium, ( ax - F( 1.0f ) ) / ( ax + F( 1.0f ) ), ax ) );
+  const F z = reduced * reduced;
+  const F poly = ( ( ( F( 8.05374449538e-2f ) * z - F( 1.38776856032e-1f ) ) * z + F( 1.99777106478e-1f ) ) * z - F( 3.33329491539e-1f ) ) * z * reduced + reduced;
+  return copySign( offset + poly, x );
+}
+
+/**
+ * Arc tangent of y / x of a batch, in radians, using the signs of both arguments to find the quadrant
+ * like std::atan2. The result is undefined if both arguments are zero.
+ */
+template <class F> inline F batchAtan2( F y, F x )
+{
+  const F zero( 0.0f );
+  F result = batchAtan( y / x );
+  result = result + select( x < zero, copySign( F( 3.14159265358979324f ), y ), zero );
+  return select( x == zero, copySign( F( 1.57079632679489662f ), y ), result );
+}
+
+/**
+ * Parameters of the first order derivative calculation of QgsDerivativeFilter, for the batch kernels.
+ */
+struct QgsDerivativeBatchParameters
+{
+
+  /**
+   * Constructor for QgsDerivativeBatchParameters.
+   */
+  QgsDerivativeBatchParameters( float inputNodataValue, float outputNodataValue, double cellSizeX, double cellSizeY, double zFactor )
+    : inputNodata( inputNodataValue )
+    , outputNodata( outputNodataValue )
+    , scaleX( static_cast< float >( cellSizeX * zFactor ) )
+    , scaleY( static_cast< float >( cellSizeY * zFactor ) )
+  {}
+
+  float inputNodata;
+  float outputNodata;
+  float scaleX;
+  float scaleY;
+};
+
+/**
+ * Calculates the first order derivatives in x- and y-direction for a batch of consecutive cells, with the same
+ * nodata handling as QgsDerivativeFilter::calcFirstDerX() and QgsDerivativeFilter::calcFirstDerY(). The rows
+ * start one cell left of the first cell. \a valid is set to false for lanes where the per cell implementation
+ * would return the output nodata value for any of the derivatives.
+ */
+template <class F> inline void batchFirstDerivatives( const QgsDerivativeBatchParameters &parameters, const float *rowAbove, const float *rowCurrent, const float *rowBelow,
+    F &derX, F &derY, typename F::Mask &valid )
+{
+  typedef typename F::Mask Mask;
+  const F nodata( parameters.inputNodata );
+  const F zero( 0.0f );
+  const F one( 1.0f );
+  const F two( 2.0f );
+
+  const F x11 = F::load( rowAbove ), x21 = F::load( rowAbove + 1 ), x31 = F::load( rowAbove + 2 );
+  const F x12 = F::load( rowCurrent ), x22 = F::load( rowCurrent + 1 ), x32 = F::load( rowCurrent + 2 );
+  const F x13 = F::load( rowBelow ), x23 = F::load( rowBelow + 1 ), x33 = F::load( rowBelow + 2 );
+
+  const Mask v11 = x11 != nodata, v21 = x21 != nodata, v31 = x31 != nodata;
+  const Mask v12 = x12 != nodata, v22 = x22 != nodata, v32 = x32 != nodata;
+  const Mask v13 = x13 != nodata, v23 = x23 != nodata, v33 = x33 != nodata;
+
+  //x-direction, one term per row. The cases are mutually exclusive
+  F sum = zero;
+  F weight = zero;
+  Mask normal = v31 & v11;
+  Mask right = v11 & v21 & !v31;
+  Mask left = v31 & v21 & !v11;
+  sum = sum + select( normal, x31 - x11, select( right, x21 - x11, select( left, x31 - x21, zero ) ) );
+  weight = weight + select( normal, two, select( right | left, one, zero ) );
+
+  normal = v32 & v12;
+  right = v12 & v22 & !v32;
+  left = v32 & v22 & !v12;
+  sum = sum + two * select( normal, x32 - x12, select( right, x22 - x12, select( left, x32 - x22, zero ) ) );
+  weight = weight + two * select( normal, two, select( right | left, one, zero ) );
+
+  normal = v33 & v13;
+  right = v13 & v23 & !v33;
+  left = v33 & v23 & !v13;
+  sum = sum + select( normal, x33 - x13, select( right, x23 - x13, select( left, x33 - x23, zero ) ) );
+  weight = weight + select( normal, two, select( right | left, one, zero ) );
+
+  const Mask validX = weight != zero;
+  derX = sum / ( weight * F( parameters.scaleX ) );
+
+  //y-direction, one term per column. The third case of the first column tests x31 like calcFirstDerY() does
+  sum = zero;
+  weight = zero;
+  normal = v11 & v13;
+  Mask down = v13 & v12 & !v11;
+  Mask up = v11 & v12 & !normal & !down & !v31;
+  sum = sum + select( normal, x11 - x13, select( down, x12 - x13, select( up, x11 - x12, zero ) ) );
+  weight = weight + select( normal, two, select( down | up, one, zero ) );
+
+  normal = v21 & v23;
+  down = v23 & v22 & !v21;
+  up = v21 & v22 & !v23;
+  sum = sum + two * select( normal, x21 - x23, select( down, x22 - x23, select( up, x21 - x22, zero ) ) );
+  weight = weight + two * select( normal, two, select( down | up, one, zero ) );
+
+  normal = v31 & v33;
+  down = v33 & v32 & !v31;
+  up = v31 & v32 & !v33;
+  sum = sum + select( normal, x31 - x33, select( down, x32 - x33, select( up, x31 - x32, zero ) ) );
+  weight = weight + select( normal, two, select( down | up, one, zero ) );
+
+  const Mask validY = weight != zero;
+  derY = sum / ( weight * F( parameters.scaleY ) );
+
+  const F outputNodata( parameters.outputNodata );
+  valid = validX & validY & ( derX != outputNodata ) & ( derY != outputNodata );
+}
+
+/**
+ * Runs \a kernel over a row span of \a count cells, using the widest batch available and the scalar
+ * fallback for the remaining cells. The kernel has a templated operator()( int offset, Batch &result )
+ * computing the batch of cells starting at \a offset.
+ */
+template <class Kernel> inline void processNineCellBatches( const Kernel &kernel, float *resultRow, int count )
+{
+  int i = 0;
+  for ( ; i + QgsFloatBatch::SIZE <= count; i += QgsFloatBatch::SIZE )
+  {
+    QgsFloatBatch result( 0.0f );
+    kernel( i, result );
+    result.store( resultRow + i );
+  }
+  for ( ; i < count; ++i )
+  {
+    QgsScalarFloatBatch result;
+    kernel( i, result );
+    result.store( resultRow + i );
+  }
+}
+
+/// @endcond
+
+#endif // QGSNINECELLFILTERBATCH_PRIVATE_H
@@ -115,6 +115,7 @@ class ANALYSIS_EXPORT QgsRasterCalcNode
     QgsRasterMatrix *mMatrix = nullptr;
     Operator mOperator;
 
+    friend class QgsRasterCalcProgram;
 };
 
 
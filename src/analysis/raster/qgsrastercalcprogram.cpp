@@ -0,0 +1,377 @@
+/***************************************************************************
+  qgsrastercalcprogram.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrastercalcprogram.h"
+#include "qgsrasterblock.h"
+#include "qgsrastermatrix.h"
+
+#include <qmath.h>
+
+#include <algorithm>
+#include <cmath>
+
+///@cond PRIVATE
+
+//the operators follow QgsRasterMatrix::oneArgumentOperation() and QgsRasterMatrix::calculateTwoArgumentOp()
+
+static bool isUnaryOperator( QgsRasterCalcNode::Operator op )
+{
+  switch ( op )
+  {
+    case QgsRasterCalcNode::opSQRT:
+    case QgsRasterCalcNode::opSIN:
+    case QgsRasterCalcNode::opCOS:
+    case QgsRasterCalcNode::opTAN:
+    case QgsRasterCalcNode::opASIN:
+    case QgsRasterCalcNode::opACOS:
+    case QgsRasterCalcNode::opATAN:
+    case QgsRasterCalcNode::opSIGN:
+    case QgsRasterCalcNode::opLOG:
+    case QgsRasterCalcNode::opLOG10:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool isBinaryOperator( QgsRasterCalcNode::Operator op )
+{
+  switch ( op )
+  {
+    case QgsRasterCalcNode::opPLUS:
+    case QgsRasterCalcNode::opMINUS:
+    case QgsRasterCalcNode::opMUL:
+    case QgsRasterCalcNode::opDIV:
+    case QgsRasterCalcNode::opPOW:
+    case QgsRasterCalcNode::opEQ:
+    case QgsRasterCalcNode::opNE:
+    case QgsRasterCalcNode::opGT:
+    case QgsRasterCalcNode::opLT:
+    case QgsRasterCalcNode::opGE:
+    case QgsRasterCalcNode::opLE:
+    case QgsRasterCalcNode::opAND:
+    case QgsRasterCalcNode::opOR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool isValidPower( double base, double power )
+{
+  return !( ( base == 0 && power < 0 ) || ( base < 0 && ( power - floor( power ) ) > 0 ) );
+}
+
+//! Applies \a f to the values of \a data which are not nodata
+template <class F> static void unaryLoop( double *data, int count, double nodata, F f )
+{
+  for ( int i = 0; i < count; ++i )
+  {
+    if ( data[i] != nodata )
+      data[i] = f( data[i] );
+  }
+}
+
+//! Stores \a f( left, right ) to \a target, or nodata if any argument is nodata. A stride of 0 repeats a constant
+template <class F> static void binaryLoop( double *target, const double *left, int leftStride, const double *right, int rightStride,
+    int count, double nodata, F f )
+{
+  for ( int i = 0; i < count; ++i )
+  {
+    const double a = left[ i * leftStride ];
+    const double b = right[ i * rightStride ];
+    target[i] = ( a == nodata || b == nodata ) ? nodata : f( a, b );
+  }
+}
+
+static void applyUnary( QgsRasterCalcNode::Operator op, double *data, int count, double nodata )
+{
+  switch ( op )
+  {
+    case QgsRasterCalcNode::opSQRT:
+      unaryLoop( data, count, nodata, [nodata]( double v ) { return v < 0 ? nodata : std::sqrt( v ); } );
+      break;
+    case QgsRasterCalcNode::opSIN:
+      unaryLoop( data, count, nodata, []( double v ) { return std::sin( v ); } );
+      break;
+    case QgsRasterCalcNode::opCOS:
+      unaryLoop( data, count, nodata, []( double v ) { return std::cos( v ); } );
+      break;
+    case QgsRasterCalcNode::opTAN:
+      unaryLoop( data, count, nodata, []( double v ) { return std::tan( v ); } );
+      break;
+    case QgsRasterCalcNode::opASIN:
+      unaryLoop( data, count, nodata, []( double v ) { return std::asin( v ); } );
+      break;
+    case QgsRasterCalcNode::opACOS:
+      unaryLoop( data, count, nodata, []( double v ) { return std::acos( v ); } );
+      break;
+    case QgsRasterCalcNode::opATAN:
+      unaryLoop( data, count, nodata, []( double v ) { return std::atan( v ); } );
+      break;
+    case QgsRasterCalcNode::opSIGN:
+      unaryLoop( data, count, nodata, []( double v ) { return -v; } );
+      break;
+    case QgsRasterCalcNode::opLOG:
+      unaryLoop( data, count, nodata, [nodata]( double v ) { return v <= 0 ? nodata : std::log( v ); } );
+      break;
+    case QgsRasterCalcNode::opLOG10:
+      unaryLoop( data, count, nodata, [nodata]( double v ) { return v <= 0 ? nodata : std::log10( v ); } );
+      break;
+    default:
+      break;
+  }
+}
+
+static void applyBinary( QgsRasterCalcNode::Operator op, double *target, const double *left, int leftStride, const double *right, int rightStride,
+                         int count, double nodata )
+{
+  switch ( op )
+  {
+    case QgsRasterCalcNode::opPLUS:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a + b; } );
+      break;
+    case QgsRasterCalcNode::opMINUS:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a - b; } );
+      break;
+    case QgsRasterCalcNode::opMUL:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a * b; } );
+      break;
+    case QgsRasterCalcNode::opDIV:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, [nodata]( double a, double b ) { return b == 0 ? nodata : a / b; } );
+      break;
+    case QgsRasterCalcNode::opPOW:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, [nodata]( double a, double b ) { return isValidPower( a, b ) ? qPow( a, b ) : nodata; } );
+      break;
+    case QgsRasterCalcNode::opEQ:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a == b ? 1.0 : 0.0; } );
+      break;
+    case QgsRasterCalcNode::opNE:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a == b ? 0.0 : 1.0; } );
+      break;
+    case QgsRasterCalcNode::opGT:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a > b ? 1.0 : 0.0; } );
+      break;
+    case QgsRasterCalcNode::opLT:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a < b ? 1.0 : 0.0; } );
+      break;
+    case QgsRasterCalcNode::opGE:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a >= b ? 1.0 : 0.0; } );
+      break;
+    case QgsRasterCalcNode::opLE:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a <= b ? 1.0 : 0.0; } );
+      break;
+    case QgsRasterCalcNode::opAND:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a && b ? 1.0 : 0.0; } );
+      break;
+    case QgsRasterCalcNode::opOR:
+      binaryLoop( target, left, leftStride, right, rightStride, count, nodata, []( double a, double b ) { return a || b ? 1.0 : 0.0; } );
+      break;
+    default:
+      break;
+  }
+}
+
+///@endcond
+
+QgsRasterCalcProgram::QgsRasterCalcProgram( const QgsRasterCalcNode *node, double nodataValue )
+  : mNodataValue( nodataValue )
+{
+  mValid = node && compileNode( node, 0, mIsConstant, mConstant );
+  if ( !mValid )
+  {
+    mInstructions.clear();
+    mRasterNames.clear();
+    mScratchBufferCount = 0;
+  }
+}
+
+bool QgsRasterCalcProgram::compileNode( const QgsRasterCalcNode *node, int depth, bool &isConstant, double &constant )
+{
+  switch ( node->mType )
+  {
+    case QgsRasterCalcNode::tNumber:
+      isConstant = true;
+      constant = node->mNumber;
+      return true;
+
+    case QgsRasterCalcNode::tMatrix:
+    {
+      //matrices are not split in rows by QgsRasterCalcNode::calculate(), only single numbers can be handled
+      if ( !node->mMatrix || !node->mMatrix->isNumber() )
+        return false;
+
+      isConstant = true;
+      const double value = node->mMatrix->number();
+      constant = value == node->mMatrix->nodataValue() ? mNodataValue : value;
+      return true;
+    }
+
+    case QgsRasterCalcNode::tRasterRef:
+    {
+      int index = mRasterNames.indexOf( node->mRasterName );
+      if ( index < 0 )
+      {
+        index = mRasterNames.size();
+        mRasterNames << node->mRasterName;
+      }
+      Instruction instruction;
+      instruction.code = LoadRaster;
+      instruction.op = QgsRasterCalcNode::opNONE;
+      instruction.target = depth;
+      instruction.source = index;
+      instruction.constant = 0;
+      mInstructions << instruction;
+      mScratchBufferCount = std::max( mScratchBufferCount, depth + 1 );
+      isConstant = false;
+      return true;
+    }
+
+    case QgsRasterCalcNode::tOperator:
+    {
+      if ( !node->mLeft )
+        return false;
+
+      if ( isUnaryOperator( node->mOperator ) )
+      {
+        if ( !compileNode( node->mLeft, depth, isConstant, constant ) )
+          return false;
+
+        if ( isConstant )
+        {
+          applyUnary( node->mOperator, &constant, 1, mNodataValue );
+        }
+        else
+        {
+          Instruction instruction;
+          instruction.code = Unary;
+          instruction.op = node->mOperator;
+          instruction.target = depth;
+          instruction.source = -1;
+          instruction.constant = 0;
+          mInstructions << instruction;
+        }
+        return true;
+      }
+
+      if ( !isBinaryOperator( node->mOperator ) || !node->mRight )
+        return false;
+
+      bool leftIsConstant = false;
+      double leftConstant = 0;
+      if ( !compileNode( node->mLeft, depth, leftIsConstant, leftConstant ) )
+        return false;
+
+      //a constant left side does not occupy its buffer
+      const int rightDepth = leftIsConstant ? depth : depth + 1;
+      bool rightIsConstant = false;
+      double rightConstant = 0;
+      if ( !compileNode( node->mRight, rightDepth, rightIsConstant, rightConstant ) )
+        return false;
+
+      Instruction instruction;
+      instruction.op = node->mOperator;
+      instruction.target = depth;
+      instruction.source = -1;
+      instruction.constant = 0;
+      if ( leftIsConstant && rightIsConstant )
+      {
+        isConstant = true;
+        applyBinary( node->mOperator, &constant, &leftConstant, 0, &rightConstant, 0, 1, mNodataValue );
+        return true;
+      }
+      else if ( leftIsConstant )
+      {
+        instruction.code = BinaryConstantLeft;
+        instruction.constant = leftConstant;
+      }
+      else if ( rightIsConstant )
+      {
+        instruction.code = BinaryConstantRight;
+        instruction.constant = rightConstant;
+      }
+      else
+      {
+        instruction.code = BinaryBuffers;
+        instruction.source = rightDepth;
+      }
+      mInstructions << instruction;
+      isConstant = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+void QgsRasterCalcProgram::evaluate( const QVector< QgsRasterBlock * > &inputs, int startRow, int rows, int columns,
+                                     QVector< QVector< double > > &scratch, float *result ) const
+{
+  const int count = rows * columns;
+  if ( mIsConstant )
+  {
+    std::fill( result, result + count, static_cast< float >( mConstant ) );
+    return;
+  }
+
+  if ( scratch.size() < mScratchBufferCount )
+    scratch.resize( mScratchBufferCount );
+  for ( int i = 0; i < mScratchBufferCount; ++i )
+  {
+    if ( scratch[i].size() < count )
+      scratch[i].resize( count );
+  }
+
+  const qgssize firstCell = static_cast< qgssize >( startRow ) * columns;
+  for ( const Instruction &instruction : mInstructions )
+  {
+    double *target = scratch[ instruction.target ].data();
+    switch ( instruction.code )
+    {
+      case LoadRaster:
+      {
+        //convert input raster values to double, also convert input no data to result no data
+        QgsRasterBlock *block = inputs.at( instruction.source );
+        for ( int i = 0; i < count; ++i )
+        {
+          const qgssize index = firstCell + i;
+          target[i] = block->isNoData( index ) ? mNodataValue : block->value( index );
+        }
+        break;
+      }
+
+      case Unary:
+        applyUnary( instruction.op, target, count, mNodataValue );
+        break;
+
+      case BinaryBuffers:
+        applyBinary( instruction.op, target, target, 1, scratch.at( instruction.source ).constData(), 1, count, mNodataValue );
+        break;
+
+      case BinaryConstantRight:
+        applyBinary( instruction.op, target, target, 1, &instruction.constant, 0, count, mNodataValue );
+        break;
+
+      case BinaryConstantLeft:
+        applyBinary( instruction.op, target, &instruction.constant, 0, target, 1, count, mNodataValue );
+        break;
+    }
+  }
+
+  const double *values = scratch.at( 0 ).constData();
+  for ( int i = 0; i < count; ++i )
+  {
+    result[i] = static_cast< float >( values[i] );
+  }
+}
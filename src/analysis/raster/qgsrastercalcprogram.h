@@ -0,0 +1,113 @@
+/***************************************************************************
+  qgsrastercalcprogram.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERCALCPROGRAM_H
+#define QGSRASTERCALCPROGRAM_H
+
+#define SIP_NO_FILE
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "qgis_analysis.h"
+#include "qgsrastercalcnode.h"
+
+class QgsRasterBlock;
+
+/**
+ * \ingroup analysis
+ * \class QgsRasterCalcProgram
+ * \brief A QgsRasterCalcNode tree compiled to a linear list of instructions.
+ *
+ * The instructions evaluate a whole tile of cells at once, each one looping over
+ * the cells of a scratch buffer. Subexpressions without raster references are folded
+ * to constants when compiling. Results are identical to QgsRasterCalcNode::calculate().
+ *
+ * A compiled program is immutable, so evaluate() can be called concurrently from several
+ * threads as long as every thread uses its own scratch buffers.
+ *
+ * \note not available in Python bindings
+ * \since QGIS 3.0
+ */
+class ANALYSIS_EXPORT QgsRasterCalcProgram
+{
+  public:
+
+    /**
+     * Compiles the tree starting at \a node. The \a nodataValue is the value used for
+     * nodata cells of the inputs and the result.
+     * Check isValid() to find out if the tree could be compiled.
+     */
+    QgsRasterCalcProgram( const QgsRasterCalcNode *node, double nodataValue );
+
+    /**
+     * Returns true if the tree was successfully compiled.
+     */
+    bool isValid() const { return mValid; }
+
+    /**
+     * Returns the names of the rasters referenced by the program. The inputs passed
+     * to evaluate() must be in the same order.
+     */
+    QStringList rasterNames() const { return mRasterNames; }
+
+    /**
+     * Returns the number of scratch buffers needed by evaluate().
+     */
+    int scratchBufferCount() const { return mScratchBufferCount; }
+
+    /**
+     * Evaluates the program for the rows \a startRow to \a startRow + \a rows - 1 of the
+     * \a inputs, which all need to be \a columns cells wide. Values are written to
+     * \a result, which needs space for \a rows * \a columns values.
+     * \a scratch buffers are resized as needed and can be reused for the next call.
+     */
+    void evaluate( const QVector< QgsRasterBlock * > &inputs, int startRow, int rows, int columns,
+                   QVector< QVector< double > > &scratch, float *result ) const;
+
+  private:
+
+    enum OpCode
+    {
+      LoadRaster, //!< Loads a raster into the target buffer
+      Unary, //!< Applies an operator to the target buffer
+      BinaryBuffers, //!< Applies an operator to the target and the source buffer
+      BinaryConstantRight, //!< Applies an operator to the target buffer and a constant
+      BinaryConstantLeft, //!< Applies an operator to a constant and the target buffer
+    };
+
+    struct Instruction
+    {
+      OpCode code;
+      QgsRasterCalcNode::Operator op;
+      int target;
+      int source;
+      double constant;
+    };
+
+    //! Compiles \a node into a buffer at \a depth, or to \a constant if it contains no raster reference
+    bool compileNode( const QgsRasterCalcNode *node, int depth, bool &isConstant, double &constant );
+
+    bool mValid = false;
+    double mNodataValue = 0;
+    QVector< Instruction > mInstructions;
+    QStringList mRasterNames;
+    int mScratchBufferCount = 0;
+    bool mIsConstant = false;
+    double mConstant = 0;
+};
+
+#endif // QGSRASTERCALCPROGRAM_H
@@ -17,6 +17,7 @@
 
 #include "qgsrastercalculator.h"
 #include "qgsrastercalcnode.h"
+#include "qgsrastercalcprogram.h"
 #include "qgsrasterdataprovider.h"
 #include "qgsrasterinterface.h"
 #include "qgsrasterlayer.h"
@@ -25,10 +26,122 @@
 
 #include <QProgressDialog>
 #include <QFile>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+
+#include <algorithm>
 
 #include <cpl_string.h>
 #include <gdalwarper.h>
 
+///@cond PRIVATE
+
+//! Number of cells of a tile evaluated by a single thread
+static const int TILE_CELLS = 1 << 16;
+
+//! Evaluates one tile of a batch, using the scratch buffers of the tile index
+struct EvaluateTileWrapper
+{
+  EvaluateTileWrapper( const QgsRasterCalcProgram *program, const QVector< QgsRasterBlock * > &inputs, QVector< QVector< QVector< double > > > *scratch,
+                       int batchStart, int batchRows, int tileRows, int columns, float *result )
+    : program( program )
+    , inputs( inputs )
+    , scratch( scratch )
+    , batchStart( batchStart )
+    , batchRows( batchRows )
+    , tileRows( tileRows )
+    , columns( columns )
+    , result( result )
+  {}
+
+  void operator()( int tile )
+  {
+    const int startRow = tile * tileRows;
+    const int rows = std::min( tileRows, batchRows - startRow );
+    program->evaluate( inputs, batchStart + startRow, rows, columns, ( *scratch )[ tile ], result + startRow * columns );
+  }
+
+  const QgsRasterCalcProgram *program = nullptr;
+  QVector< QgsRasterBlock * > inputs;
+  QVector< QVector< QVector< double > > > *scratch = nullptr;
+  int batchStart = 0;
+  int batchRows = 0;
+  int tileRows = 0;
+  int columns = 0;
+  float *result = nullptr;
+};
+
+/**
+ * Evaluates a compiled \a program in batches of tiles, one tile per thread, and writes the results of a batch
+ * to \a outputRasterBand while the next batch is evaluated.
+ */
+static void processTiles( const QgsRasterCalcProgram &program, const QVector< QgsRasterBlock * > &inputs, int columns, int rows,
+                          GDALRasterBandH outputRasterBand, QProgressDialog *p )
+{
+  const int threadCount = std::max( 1, QThread::idealThreadCount() );
+  const int tileRows = std::max( 1, TILE_CELLS / std::max( 1, columns ) );
+  const int batchRows = tileRows * threadCount;
+
+  //scratch buffers are reused by the tile with the same index in every batch
+  QVector< QVector< QVector< double > > > scratch( threadCount );
+  QVector< float > results[2];
+  QFuture< CPLErr > pendingWrite;
+  bool hasPendingWrite = false;
+
+  int batch = 0;
+  for ( int batchStart = 0; batchStart < rows; batchStart += batchRows, ++batch )
+  {
+    if ( p )
+    {
+      p->setValue( batchStart );
+    }
+
+    if ( p && p->wasCanceled() )
+    {
+      break;
+    }
+
+    const int currentRows = std::min( batchRows, rows - batchStart );
+    const int tileCount = ( currentRows + tileRows - 1 ) / tileRows;
+    QVector< float > &result = results[ batch % 2 ];
+    result.resize( currentRows * columns );
+    float *resultData = result.data();
+
+    EvaluateTileWrapper evaluateTile( &program, inputs, &scratch, batchStart, currentRows, tileRows, columns, resultData );
+    if ( tileCount > 1 )
+    {
+      QVector< int > tiles( tileCount );
+      for ( int i = 0; i < tileCount; ++i )
+        tiles[i] = i;
+      QtConcurrent::blockingMap( tiles, evaluateTile );
+    }
+    else
+    {
+      evaluateTile( 0 );
+    }
+
+    //the other result buffer is reused for the next batch, so its write needs to be finished
+    if ( hasPendingWrite && pendingWrite.result() != CE_None )
+    {
+      QgsDebugMsg( "RasterIO error!" );
+    }
+    pendingWrite = QtConcurrent::run( [ = ]
+    {
+      return GDALRasterIO( outputRasterBand, GF_Write, 0, batchStart, columns, currentRows, resultData, columns, currentRows, GDT_Float32, 0, 0 );
+    } );
+    hasPendingWrite = true;
+  }
+
+  if ( hasPendingWrite && pendingWrite.result() != CE_None )
+  {
+    QgsDebugMsg( "RasterIO error!" );
+  }
+}
+
+///@endcond
+
 QgsRasterCalculator::QgsRasterCalculator( const QString &formulaString, const QString &outputFile, const QString &outputFormat,
     const QgsRectangle &outputExtent, int nOutputColumns, int nOutputRows, const QVector<QgsRasterCalculatorEntry> &rasterEntries )
   : mFormulaString( formulaString )
@@ -122,41 +235,63 @@ int QgsRasterCalculator::processCalculation( QProgressDialog *p )
     p->setMaximum( mNumOutputRows );
   }
 
-  QgsRasterMatrix resultMatrix;
-  resultMatrix.setNodataValue( outputNodataValue );
-
-  //read / write line by line
-  for ( int i = 0; i < mNumOutputRows; ++i )
+  //compiled programs are evaluated in parallel tiles, the node tree is the fallback for trees which cannot be compiled
+  QgsRasterCalcProgram program( calcNode, outputNodataValue );
+  QVector< QgsRasterBlock * > programInputs;
+  bool useProgram = program.isValid();
+  Q_FOREACH ( const QString &rasterName, program.rasterNames() )
   {
-    if ( p )
-    {
-      p->setValue( i );
-    }
-
-    if ( p && p->wasCanceled() )
+    QgsRasterBlock *block = inputBlocks.value( rasterName );
+    if ( !block )
     {
+      useProgram = false;
       break;
     }
+    programInputs << block;
+  }
+
+  if ( useProgram )
+  {
+    processTiles( program, programInputs, mNumOutputColumns, mNumOutputRows, outputRasterBand, p );
+  }
+  else
+  {
+    QgsRasterMatrix resultMatrix;
+    resultMatrix.setNodataValue( outputNodataValue );
 
-    if ( calcNode->calculate( inputBlocks, resultMatrix, i ) )
+    //read / write line by line
+    for ( int i = 0; i < mNumOutputRows; ++i )
     {
-      bool resultIsNumber = resultMatrix.isNumber();
-      float *calcData = new float[mNumOutputColumns];
+      if ( p )
+      {
+        p->setValue( i );
+      }
 
-      for ( int j = 0; j < mNumOutputColumns; ++j )
+      if ( p && p->wasCanceled() )
       {
-        calcData[j] = ( float )( resultIsNumber ? resultMatrix.number() : resultMatrix.data()[j] );
+        break;
       }
 
-      //write scanline to the dataset
-      if ( GDALRasterIO( outputRasterBand, GF_Write, 0, i, mNumOutputColumns, 1, calcData, mNumOutputColumns, 1, GDT_Float32, 0, 0 ) != CE_None )
+      if ( calcNode->calculate( inputBlocks, resultMatrix, i ) )
       {
-        QgsDebugMsg( "RasterIO error!" );
+        bool resultIsNumber = resultMatrix.isNumber();
+        float *calcData = new float[mNumOutputColumns];
+
+        for ( int j = 0; j < mNumOutputColumns; ++j )
+        {
+          calcData[j] = ( float )( resultIsNumber ? resultMatrix.number() : resultMatrix.data()[j] );
+        }
+
+        //write scanline to the dataset
+        if ( GDALRasterIO( outputRasterBand, GF_Write, 0, i, mNumOutputColumns, 1, calcData, mNumOutputColumns, 1, GDT_Float32, 0, 0 ) != CE_None )
+        {
+          QgsDebugMsg( "RasterIO error!" );
+        }
+
+        delete[] calcData;
       }
 
-      delete[] calcData;
     }
-
   }
 
   if ( p )
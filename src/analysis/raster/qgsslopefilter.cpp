@@ -16,6 +16,36 @@
  ***************************************************************************/
 
 #include "qgsslopefilter.h"
+#include "qgsninecellfilterbatch_p.h"
+
+///@cond PRIVATE
+
+//! Batch kernel of QgsSlopeFilter
+struct SlopeKernel
+{
+  SlopeKernel( const QgsDerivativeBatchParameters &parameters, const float *rowAbove, const float *rowCurrent, const float *rowBelow )
+    : parameters( parameters )
+    , rowAbove( rowAbove )
+    , rowCurrent( rowCurrent )
+    , rowBelow( rowBelow )
+  {}
+
+  template <class F> void operator()( int offset, F &result ) const
+  {
+    F derX, derY;
+    typename F::Mask valid;
+    batchFirstDerivatives( parameters, rowAbove + offset, rowCurrent + offset, rowBelow + offset, derX, derY, valid );
+    const F slope = batchAtan( sqrt( derX * derX + derY * derY ) ) * F( static_cast< float >( 180.0 / M_PI ) );
+    result = select( valid, slope, F( parameters.outputNodata ) );
+  }
+
+  QgsDerivativeBatchParameters parameters;
+  const float *rowAbove = nullptr;
+  const float *rowCurrent = nullptr;
+  const float *rowBelow = nullptr;
+};
+
+///@endcond
 
 QgsSlopeFilter::QgsSlopeFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsDerivativeFilter( inputFile, outputFile, outputFormat )
@@ -37,3 +67,8 @@ float QgsSlopeFilter::processNineCellWindow( float *x11, float *x21, float *x31,
   return atan( sqrt( derX * derX + derY * derY ) ) * 180.0 / M_PI;
 }
 
+void QgsSlopeFilter::processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count )
+{
+  const QgsDerivativeBatchParameters parameters( mInputNodataValue, mOutputNodataValue, mCellSizeX, mCellSizeY, mZFactor );
+  processNineCellBatches( SlopeKernel( parameters, rowAbove, rowCurrent, rowBelow ), resultRow, count );
+}
@@ -34,6 +34,9 @@ class ANALYSIS_EXPORT QgsSlopeFilter: public QgsDerivativeFilter
     float processNineCellWindow( float *x11, float *x21, float *x31,
                                  float *x12, float *x22, float *x32,
                                  float *x13, float *x23, float *x33 ) override;
+
+    //! Calculates a row span at once, with SIMD instructions where available
+    void processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count ) override;
 };
 
 #endif // QGSSLOPEFILTER_H
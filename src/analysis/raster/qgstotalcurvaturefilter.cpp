@@ -16,6 +16,53 @@
  ***************************************************************************/
 
 #include "qgstotalcurvaturefilter.h"
+#include "qgsninecellfilterbatch_p.h"
+
+///@cond PRIVATE
+
+//! Batch kernel of QgsTotalCurvatureFilter
+struct TotalCurvatureKernel
+{
+  TotalCurvatureKernel( const float *rowAbove, const float *rowCurrent, const float *rowBelow, float inputNodataValue, float outputNodataValue,
+                        double cellSizeX, double cellSizeY )
+    : rowAbove( rowAbove )
+    , rowCurrent( rowCurrent )
+    , rowBelow( rowBelow )
+    , inputNodata( inputNodataValue )
+    , outputNodata( outputNodataValue )
+    , factorXX( 1.0 / ( cellSizeX * cellSizeX ) )
+    , factorYY( 1.0 / ( cellSizeY * cellSizeY ) )
+    , factorXY( 1.0 / ( ( cellSizeX + cellSizeY ) * ( cellSizeX + cellSizeY ) ) )
+  {}
+
+  template <class F> void operator()( int offset, F &result ) const
+  {
+    const F x11 = F::load( rowAbove + offset ), x21 = F::load( rowAbove + offset + 1 ), x31 = F::load( rowAbove + offset + 2 );
+    const F x12 = F::load( rowCurrent + offset ), x22 = F::load( rowCurrent + offset + 1 ), x32 = F::load( rowCurrent + offset + 2 );
+    const F x13 = F::load( rowBelow + offset ), x23 = F::load( rowBelow + offset + 1 ), x33 = F::load( rowBelow + offset + 2 );
+
+    const F nodata( inputNodata );
+    const typename F::Mask missing = ( x11 == nodata ) | ( x21 == nodata ) | ( x31 == nodata ) | ( x12 == nodata ) | ( x22 == nodata )
+                                     | ( x32 == nodata ) | ( x13 == nodata ) | ( x23 == nodata ) | ( x33 == nodata );
+
+    const F two( 2.0f );
+    const F dxx = ( x32 - two * x22 + x12 ) * F( factorXX );
+    const F dxy = ( x31 - x11 + x13 - x33 ) * F( factorXY );
+    const F dyy = ( x21 - two * x22 + x23 ) * F( factorYY );
+    result = select( missing, F( outputNodata ), dxx * dxx + two * dxy * dxy + dyy * dyy );
+  }
+
+  const float *rowAbove = nullptr;
+  const float *rowCurrent = nullptr;
+  const float *rowBelow = nullptr;
+  float inputNodata;
+  float outputNodata;
+  float factorXX;
+  float factorYY;
+  float factorXY;
+};
+
+///@endcond
 
 QgsTotalCurvatureFilter::QgsTotalCurvatureFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsNineCellFilter( inputFile, outputFile, outputFormat )
@@ -41,3 +88,9 @@ float QgsTotalCurvatureFilter::processNineCellWindow( float *x11, float *x21, fl
 
   return dxx * dxx + 2 * dxy * dxy + dyy * dyy;
 }
+
+void QgsTotalCurvatureFilter::processNineCellRow( float *rowAbove, float *rowCurrent, float *rowBelow, float *resultRow, int count )
+{
+  processNineCellBatches( TotalCurvatureKernel( rowAbove, rowCurrent, rowBelow, mInputNodataValue, mOutputNodataValue, mCellSizeX, mCellSizeY ),
+                          resultRow, count );
+}
@@ -28,7 +28,159 @@
 
 #include "qmath.h"
 
+#include <QCache>
 #include <QFile>
+#include <QHash>
+#include <QSharedPointer>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+
+///@cond PRIVATE
+
+//! Width and height of the raster blocks read by the Scanline method, in cells
+static const int BLOCK_SIZE = 256;
+//! Maximum number of cells of the raster blocks kept for neighbouring polygons
+static const int MAX_CACHED_CELLS = 1 << 22;
+//! Maximum number of features calculated in one parallel batch
+static const int MAX_BATCH_FEATURES = 1024;
+//! Maximum number of bounding box cells of the features of one batch
+static const qint64 MAX_BATCH_CELLS = 1 << 22;
+
+/**
+ * Returns the extent of a window of raster cells. Reading a block for the exact cells avoids
+ * resampling of the raster, which happens for blocks with the polygon bounding box as extent.
+ */
+static QgsRectangle cellWindowExtent( const QgsRectangle &rasterBBox, int offsetX, int offsetY, int nCellsX, int nCellsY,
+                                      double cellSizeX, double cellSizeY )
+{
+  return QgsRectangle( rasterBBox.xMinimum() + offsetX * cellSizeX, rasterBBox.yMaximum() - ( offsetY + nCellsY ) * cellSizeY,
+                       rasterBBox.xMinimum() + ( offsetX + nCellsX ) * cellSizeX, rasterBBox.yMaximum() - offsetY * cellSizeY );
+}
+
+/**
+ * Raster blocks of BLOCK_SIZE x BLOCK_SIZE cells. The blocks needed by a batch of features are
+ * pinned before the batch is calculated, pinned blocks can be read from several threads at once.
+ * Blocks of previous batches are kept in a cache, as neighbouring polygons share raster blocks.
+ */
+class QgsZonalStatistics::RasterBlockCache
+{
+  public:
+    RasterBlockCache( QgsRasterDataProvider *provider, int band, const QgsRectangle &rasterBBox, double cellSizeX, double cellSizeY,
+                      int xSize, int ySize )
+      : mProvider( provider )
+      , mBand( band )
+      , mRasterBBox( rasterBBox )
+      , mCellSizeX( cellSizeX )
+      , mCellSizeY( cellSizeY )
+      , mXSize( xSize )
+      , mYSize( ySize )
+      , mColumns( ( xSize + BLOCK_SIZE - 1 ) / BLOCK_SIZE )
+      , mCache( MAX_CACHED_CELLS )
+    {}
+
+    //! Pins the blocks covering a window of cells, reading them from the provider if they are not cached
+    void pin( int offsetX, int offsetY, int nCellsX, int nCellsY )
+    {
+      if ( nCellsX <= 0 || nCellsY <= 0 )
+        return;
+
+      for ( int row = offsetY / BLOCK_SIZE; row <= ( offsetY + nCellsY - 1 ) / BLOCK_SIZE; ++row )
+      {
+        for ( int column = offsetX / BLOCK_SIZE; column <= ( offsetX + nCellsX - 1 ) / BLOCK_SIZE; ++column )
+        {
+          const qint64 key = static_cast< qint64 >( row ) * mColumns + column;
+          if ( mPinned.contains( key ) )
+            continue;
+
+          QSharedPointer< QgsRasterBlock > *cached = mCache.object( key );
+          if ( cached )
+          {
+            mPinned.insert( key, *cached );
+            continue;
+          }
+
+          const int width = std::min( BLOCK_SIZE, mXSize - column * BLOCK_SIZE );
+          const int height = std::min( BLOCK_SIZE, mYSize - row * BLOCK_SIZE );
+          QSharedPointer< QgsRasterBlock > block( mProvider->block( mBand, cellWindowExtent( mRasterBBox, column * BLOCK_SIZE, row * BLOCK_SIZE, width, height, mCellSizeX, mCellSizeY ), width, height ) );
+          mPinned.insert( key, block );
+          mCache.insert( key, new QSharedPointer< QgsRasterBlock >( block ), width * height );
+        }
+      }
+    }
+
+    //! Releases all pinned blocks, they stay available from the cache
+    void unpinAll() { mPinned.clear(); }
+
+    //! Returns the pinned block containing the cell at \a row and \a column
+    const QgsRasterBlock *block( int row, int column ) const
+    {
+      return mPinned.value( static_cast< qint64 >( row / BLOCK_SIZE ) * mColumns + column / BLOCK_SIZE ).data();
+    }
+
+  private:
+    QgsRasterDataProvider *mProvider = nullptr;
+    int mBand = 1;
+    QgsRectangle mRasterBBox;
+    double mCellSizeX = 0;
+    double mCellSizeY = 0;
+    int mXSize = 0;
+    int mYSize = 0;
+    int mColumns = 0;
+    QCache< qint64, QSharedPointer< QgsRasterBlock > > mCache;
+    QHash< qint64, QSharedPointer< QgsRasterBlock > > mPinned;
+};
+
+//! A feature calculated by the Scanline method
+struct QgsZonalStatistics::ScanlineFeature
+{
+  QgsFeatureId id = 0;
+  QgsGeometry geometry;
+  QgsMultiPolygon polygons;
+  int offsetX = 0;
+  int offsetY = 0;
+  int nCellsX = 0;
+  int nCellsY = 0;
+  FeatureStats stats;
+};
+
+//! Calculates a chunk of contiguous features of a batch
+struct QgsZonalStatistics::ScanlineWrapper
+{
+  ScanlineWrapper( const QgsZonalStatistics *zonalStatistics, ScanlineFeature *features, int featureCount, int chunkCount,
+                   const RasterBlockCache *blocks, double cellSizeX, double cellSizeY, const QgsRectangle &rasterBBox )
+    : zonalStatistics( zonalStatistics )
+    , features( features )
+    , featureCount( featureCount )
+    , chunkCount( chunkCount )
+    , blocks( blocks )
+    , cellSizeX( cellSizeX )
+    , cellSizeY( cellSizeY )
+    , rasterBBox( rasterBBox )
+  {}
+
+  void operator()( int chunk )
+  {
+    const int end = static_cast< int >( static_cast< qint64 >( featureCount ) * ( chunk + 1 ) / chunkCount );
+    for ( int i = static_cast< int >( static_cast< qint64 >( featureCount ) * chunk / chunkCount ); i < end; ++i )
+    {
+      zonalStatistics->statisticsFromScanline( features[i], *blocks, cellSizeX, cellSizeY, rasterBBox );
+    }
+  }
+
+  const QgsZonalStatistics *zonalStatistics = nullptr;
+  ScanlineFeature *features = nullptr;
+  int featureCount = 0;
+  int chunkCount = 1;
+  const RasterBlockCache *blocks = nullptr;
+  double cellSizeX = 0;
+  double cellSizeY = 0;
+  QgsRectangle rasterBBox;
+};
+
+///@endcond
 
 QgsZonalStatistics::QgsZonalStatistics( QgsVectorLayer *polygonLayer, QgsRasterLayer *rasterLayer, const QString &attributePrefix, int rasterBand, QgsZonalStatistics::Statistics stats )
   : mRasterLayer( rasterLayer )
@@ -218,59 +370,8 @@ int QgsZonalStatistics::calculateStatistics( QgsFeedback *feedback )
   int featureCounter = 0;
 
   QgsChangedAttributesMap changeMap;
-  while ( fi.nextFeature( f ) )
+  auto addStatisticsAttributes = [&]( QgsFeatureId id, FeatureStats &featureStats )
   {
-    if ( feedback && feedback->isCanceled() )
-    {
-      break;
-    }
-
-    if ( feedback )
-    {
-      feedback->setProgress( 100.0 * static_cast< double >( featureCounter ) / featureCount );
-    }
-
-    if ( !f.hasGeometry() )
-    {
-      ++featureCounter;
-      continue;
-    }
-    QgsGeometry featureGeometry = f.geometry();
-
-    QgsRectangle featureRect = featureGeometry.boundingBox().intersect( &rasterBBox );
-    if ( featureRect.isEmpty() )
-    {
-      ++featureCounter;
-      continue;
-    }
-
-    int offsetX, offsetY, nCellsX, nCellsY;
-    if ( cellInfoForBBox( rasterBBox, featureRect, cellsizeX, cellsizeY, offsetX, offsetY, nCellsX, nCellsY ) != 0 )
-    {
-      ++featureCounter;
-      continue;
-    }
-
-    //avoid access to cells outside of the raster (may occur because of rounding)
-    if ( ( offsetX + nCellsX ) > nCellsXProvider )
-    {
-      nCellsX = nCellsXProvider - offsetX;
-    }
-    if ( ( offsetY + nCellsY ) > nCellsYProvider )
-    {
-      nCellsY = nCellsYProvider - offsetY;
-    }
-
-    statisticsFromMiddlePointTest( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
-                                   rasterBBox, featureStats );
-
-    if ( featureStats.count <= 1 )
-    {
-      //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
-      statisticsFromPreciseIntersection( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
-                                         rasterBBox, featureStats );
-    }
-
     //write the statistics value to the vector data provider
     QgsAttributeMap changeAttributeMap;
     if ( mStatistics & QgsZonalStatistics::Count )
@@ -340,10 +441,110 @@ int QgsZonalStatistics::calculateStatistics( QgsFeedback *feedback )
         changeAttributeMap.insert( varietyIndex, QVariant( featureStats.valueCount.count() ) );
     }
 
-    changeMap.insert( f.id(), changeAttributeMap );
+    changeMap.insert( id, changeAttributeMap );
+  };
+
+  RasterBlockCache blockCache( mRasterProvider, mRasterBand, rasterBBox, cellsizeX, cellsizeY, nCellsXProvider, nCellsYProvider );
+  QVector< ScanlineFeature > batch;
+  qint64 batchCells = 0;
+  auto processBatch = [&]()
+  {
+    processScanlineBatch( batch, blockCache, cellsizeX, cellsizeY, rasterBBox );
+    for ( ScanlineFeature &feature : batch )
+    {
+      addStatisticsAttributes( feature.id, feature.stats );
+    }
+    batch.clear();
+    batchCells = 0;
+  };
+
+  while ( fi.nextFeature( f ) )
+  {
+    if ( feedback && feedback->isCanceled() )
+    {
+      break;
+    }
+
+    if ( feedback )
+    {
+      feedback->setProgress( 100.0 * static_cast< double >( featureCounter ) / featureCount );
+    }
+
+    if ( !f.hasGeometry() )
+    {
+      ++featureCounter;
+      continue;
+    }
+    QgsGeometry featureGeometry = f.geometry();
+
+    QgsRectangle featureRect = featureGeometry.boundingBox().intersect( &rasterBBox );
+    if ( featureRect.isEmpty() )
+    {
+      ++featureCounter;
+      continue;
+    }
+
+    int offsetX, offsetY, nCellsX, nCellsY;
+    if ( cellInfoForBBox( rasterBBox, featureRect, cellsizeX, cellsizeY, offsetX, offsetY, nCellsX, nCellsY ) != 0 )
+    {
+      ++featureCounter;
+      continue;
+    }
+
+    //avoid access to cells outside of the raster (may occur because of rounding)
+    if ( ( offsetX + nCellsX ) > nCellsXProvider )
+    {
+      nCellsX = nCellsXProvider - offsetX;
+    }
+    if ( ( offsetY + nCellsY ) > nCellsYProvider )
+    {
+      nCellsY = nCellsYProvider - offsetY;
+    }
+
+    if ( mMethod == Scanline )
+    {
+      ScanlineFeature feature;
+      feature.id = f.id();
+      feature.geometry = featureGeometry;
+      if ( featureGeometry.isMultipart() )
+        feature.polygons = featureGeometry.asMultiPolygon();
+      else
+        feature.polygons << featureGeometry.asPolygon();
+      feature.offsetX = offsetX;
+      feature.offsetY = offsetY;
+      feature.nCellsX = nCellsX;
+      feature.nCellsY = nCellsY;
+      feature.stats = FeatureStats( statsStoreValues, statsStoreValueCount );
+      batch << feature;
+
+      batchCells += static_cast< qint64 >( nCellsX ) * nCellsY;
+      if ( batch.size() >= MAX_BATCH_FEATURES || batchCells >= MAX_BATCH_CELLS )
+      {
+        processBatch();
+      }
+      ++featureCounter;
+      continue;
+    }
+
+    statisticsFromMiddlePointTest( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
+                                   rasterBBox, featureStats );
+
+    if ( featureStats.count <= 1 )
+    {
+      //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
+      statisticsFromPreciseIntersection( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
+                                         rasterBBox, featureStats );
+    }
+
+    addStatisticsAttributes( f.id(), featureStats );
     ++featureCounter;
   }
 
+  if ( !batch.isEmpty() && !( feedback && feedback->isCanceled() ) )
+  {
+    processBatch();
+  }
+
   vectorProvider->changeAttributeValues( changeMap );
 
   if ( feedback )
@@ -413,10 +614,8 @@ void QgsZonalStatistics::statisticsFromMiddlePointTest( const QgsGeometry &poly,
   GEOSCoordSequence *cellCenterCoords = nullptr;
   GEOSGeometry *currentCellCenter = nullptr;
 
-  QgsRectangle featureBBox = poly.boundingBox().intersect( &rasterBBox );
-  QgsRectangle intersectBBox = rasterBBox.intersect( &featureBBox );
-
-  QgsRasterBlock *block = mRasterProvider->block( mRasterBand, intersectBBox, nCellsX, nCellsY );
+  QgsRasterBlock *block = mRasterProvider->block( mRasterBand, cellWindowExtent( rasterBBox, pixelOffsetX, pixelOffsetY, nCellsX, nCellsY, cellSizeX, cellSizeY ),
+                          nCellsX, nCellsY );
   for ( int i = 0; i < nCellsY; ++i )
   {
     cellCenterX = rasterBBox.xMinimum() + pixelOffsetX * cellSizeX + cellSizeX / 2;
@@ -458,10 +657,8 @@ void QgsZonalStatistics::statisticsFromPreciseIntersection( const QgsGeometry &p
   double pixelArea = cellSizeX * cellSizeY;
   double weight = 0;
 
-  QgsRectangle featureBBox = poly.boundingBox().intersect( &rasterBBox );
-  QgsRectangle intersectBBox = rasterBBox.intersect( &featureBBox );
-
-  QgsRasterBlock *block = mRasterProvider->block( mRasterBand, intersectBBox, nCellsX, nCellsY );
+  QgsRasterBlock *block = mRasterProvider->block( mRasterBand, cellWindowExtent( rasterBBox, pixelOffsetX, pixelOffsetY, nCellsX, nCellsY, cellSizeX, cellSizeY ),
+                          nCellsX, nCellsY );
   for ( int i = 0; i < nCellsY; ++i )
   {
     double currentX = rasterBBox.xMinimum() + cellSizeX / 2.0 + pixelOffsetX * cellSizeX;
@@ -495,6 +692,136 @@ void QgsZonalStatistics::statisticsFromPreciseIntersection( const QgsGeometry &p
   delete block;
 }
 
+void QgsZonalStatistics::statisticsFromScanline( ScanlineFeature &feature, const RasterBlockCache &blocks, double cellSizeX, double cellSizeY,
+    const QgsRectangle &rasterBBox ) const
+{
+  feature.stats.reset();
+
+  //spans of cells with the center within a polygon, as ( row, first column, last column ). A polygon has an
+  //even number of ring crossings on every row center line, the cells between a pair of crossings are inside
+  QVector< QPair< int, QPair< int, int > > > spans;
+  QVector< QPair< int, double > > crossings;
+  const int firstRow = feature.offsetY;
+  const int lastRow = feature.offsetY + feature.nCellsY - 1;
+  const int firstColumn = feature.offsetX;
+  const int lastColumn = feature.offsetX + feature.nCellsX - 1;
+  const QgsMultiPolygon &polygons = feature.polygons;
+  for ( const QgsPolygon &polygon : polygons )
+  {
+    crossings.clear();
+    for ( const QgsPolyline &ring : polygon )
+    {
+      const int nVertices = ring.size();
+      for ( int i = 0; i < nVertices; ++i )
+      {
+        const QgsPointXY &p1 = ring.at( i );
+        const QgsPointXY &p2 = ring.at( ( i + 1 ) % nVertices );
+        if ( p1.y() == p2.y() )
+          continue;
+
+        //rows with a center line between the edge end points, one more on each side to be safe from rounding
+        const double yMin = std::min( p1.y(), p2.y() );
+        const double yMax = std::max( p1.y(), p2.y() );
+        const int edgeFirstRow = static_cast< int >( std::max< double >( firstRow, std::floor( ( rasterBBox.yMaximum() - yMax ) / cellSizeY - 0.5 ) ) );
+        const int edgeLastRow = static_cast< int >( std::min< double >( lastRow, std::floor( ( rasterBBox.yMaximum() - yMin ) / cellSizeY - 0.5 ) + 1 ) );
+        for ( int row = edgeFirstRow; row <= edgeLastRow; ++row )
+        {
+          const double y = rasterBBox.yMaximum() - ( row + 0.5 ) * cellSizeY;
+          if ( ( p1.y() <= y ) == ( p2.y() <= y ) )
+            continue;
+          crossings << qMakePair( row, p1.x() + ( y - p1.y() ) * ( p2.x() - p1.x() ) / ( p2.y() - p1.y() ) );
+        }
+      }
+    }
+
+    std::sort( crossings.begin(), crossings.end() );
+    for ( int i = 0; i + 1 < crossings.size(); i += 2 )
+    {
+      //cells with the center strictly between the crossings
+      const int row = crossings.at( i ).first;
+      const int spanFirstColumn = static_cast< int >( std::max< double >( firstColumn, std::floor( ( crossings.at( i ).second - rasterBBox.xMinimum() ) / cellSizeX - 0.5 ) + 1 ) );
+      const int spanLastColumn = static_cast< int >( std::min< double >( lastColumn, std::ceil( ( crossings.at( i + 1 ).second - rasterBBox.xMinimum() ) / cellSizeX - 0.5 ) - 1 ) );
+      if ( spanFirstColumn <= spanLastColumn )
+        spans << qMakePair( row, qMakePair( spanFirstColumn, spanLastColumn ) );
+    }
+  }
+
+  //the parts of a multipolygon are not supposed to overlap, but cells must not be counted twice if they do
+  if ( polygons.size() > 1 )
+    std::sort( spans.begin(), spans.end() );
+
+  int lastCountedRow = -1;
+  int lastCountedColumn = -1;
+  for ( const auto &span : spans )
+  {
+    const int row = span.first;
+    int column = span.second.first;
+    if ( row == lastCountedRow )
+      column = std::max( column, lastCountedColumn + 1 );
+
+    while ( column <= span.second.second )
+    {
+      const QgsRasterBlock *block = blocks.block( row, column );
+      const int blockColumn = column % BLOCK_SIZE;
+      const int blockEnd = std::min( span.second.second, column - blockColumn + BLOCK_SIZE - 1 );
+      if ( block )
+      {
+        const int blockRow = row % BLOCK_SIZE;
+        for ( int i = blockColumn; i <= blockColumn + blockEnd - column; ++i )
+        {
+          const float value = block->value( blockRow, i );
+          if ( validPixel( value ) )
+          {
+            feature.stats.addValue( value );
+          }
+        }
+      }
+      column = blockEnd + 1;
+    }
+
+    if ( row != lastCountedRow || span.second.second > lastCountedColumn )
+      lastCountedColumn = span.second.second;
+    lastCountedRow = row;
+  }
+}
+
+void QgsZonalStatistics::processScanlineBatch( QVector< ScanlineFeature > &batch, RasterBlockCache &blocks, double cellSizeX, double cellSizeY,
+    const QgsRectangle &rasterBBox )
+{
+  //the data provider is not thread safe, so all raster blocks are read before calculating in parallel
+  for ( const ScanlineFeature &feature : batch )
+  {
+    blocks.pin( feature.offsetX, feature.offsetY, feature.nCellsX, feature.nCellsY );
+  }
+
+  const int threadCount = mThreadCount > 0 ? mThreadCount : std::max( 1, QThread::idealThreadCount() );
+  const int chunkCount = std::min( threadCount, batch.size() );
+  ScanlineWrapper wrapper( this, batch.data(), batch.size(), chunkCount, &blocks, cellSizeX, cellSizeY, rasterBBox );
+  if ( chunkCount > 1 )
+  {
+    QVector< int > chunks( chunkCount );
+    for ( int i = 0; i < chunkCount; ++i )
+      chunks[ i ] = i;
+    QtConcurrent::blockingMap( chunks, wrapper );
+  }
+  else
+  {
+    wrapper( 0 );
+  }
+  blocks.unpinAll();
+
+  //GEOS is not used from the worker threads, so the fallback for small polygons runs here
+  for ( ScanlineFeature &feature : batch )
+  {
+    if ( feature.stats.count <= 1 )
+    {
+      //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
+      statisticsFromPreciseIntersection( feature.geometry, feature.offsetX, feature.offsetY, feature.nCellsX, feature.nCellsY,
+                                         cellSizeX, cellSizeY, rasterBBox, feature.stats );
+    }
+  }
+}
+
 bool QgsZonalStatistics::validPixel( float value ) const
 {
   if ( value == mInputNodataValue || qIsNaN( value ) )
@@ -20,6 +20,7 @@
 
 #include <QString>
 #include <QMap>
+#include <QVector>
 
 #include <limits>
 #include <cfloat>
@@ -60,6 +61,17 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     };
     Q_DECLARE_FLAGS( Statistics, Statistic )
 
+    /**
+     * Methods for finding the raster cells of a polygon. Both methods consider the cells
+     * whose center is within the polygon.
+     * \since QGIS 3.0
+     */
+    enum Method
+    {
+      MiddlePointTest, //!< Tests every cell center of the polygon bounding box with GEOS, one feature after the other
+      Scanline //!< Rasterizes the polygon rings row by row and calculates batches of features in parallel (default)
+    };
+
     /**
      * Constructor for QgsZonalStatistics.
      */
@@ -73,6 +85,36 @@ class ANALYSIS_EXPORT QgsZonalStatistics
       \returns 0 in case of success*/
     int calculateStatistics( QgsFeedback *feedback );
 
+    /**
+     * Returns the method used for finding the raster cells of a polygon.
+     * \see setMethod()
+     * \since QGIS 3.0
+     */
+    Method method() const { return mMethod; }
+
+    /**
+     * Sets the \a method used for finding the raster cells of a polygon.
+     * \see method()
+     * \since QGIS 3.0
+     */
+    void setMethod( Method method ) { mMethod = method; }
+
+    /**
+     * Returns the maximum number of threads used by the Scanline method. A value of 0 means
+     * that the number of threads matches the number of processor cores.
+     * \see setThreadCount()
+     * \since QGIS 3.0
+     */
+    int threadCount() const { return mThreadCount; }
+
+    /**
+     * Sets the maximum number of threads used by the Scanline method. A \a count of 0 means
+     * that the number of threads matches the number of processor cores, 1 disables threading.
+     * \see threadCount()
+     * \since QGIS 3.0
+     */
+    void setThreadCount( int count ) { mThreadCount = count; }
+
   private:
     QgsZonalStatistics() = default;
 
@@ -130,6 +172,20 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     void statisticsFromPreciseIntersection( const QgsGeometry &poly, int pixelOffsetX, int pixelOffsetY, int nCellsX, int nCellsY,
                                             double cellSizeX, double cellSizeY, const QgsRectangle &rasterBBox, FeatureStats &stats );
 
+#ifndef SIP_RUN
+    class RasterBlockCache;
+    struct ScanlineFeature;
+    struct ScanlineWrapper;
+#endif
+
+    //! Returns statistics of the cells whose center is within the polygon, found by rasterizing the polygon rings (fast, thread safe)
+    void statisticsFromScanline( ScanlineFeature &feature, const RasterBlockCache &blocks, double cellSizeX, double cellSizeY,
+                                 const QgsRectangle &rasterBBox ) const;
+
+    //! Calculates the statistics of a \a batch of features, in parallel where possible
+    void processScanlineBatch( QVector< ScanlineFeature > &batch, RasterBlockCache &blocks, double cellSizeX, double cellSizeY,
+                               const QgsRectangle &rasterBBox );
+
     //! Tests whether a pixel's value should be included in the result
     bool validPixel( float value ) const;
 
@@ -144,6 +200,9 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     //! The nodata value of the input layer
     float mInputNodataValue = -1;
     Statistics mStatistics = QgsZonalStatistics::All;
+    Method mMethod = Scanline;
+    //! Maximum number of threads, 0 for the number of processor cores
+    int mThreadCount = 0;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS( QgsZonalStatistics::Statistics )
@@ -99,6 +99,7 @@ bool QgsExpression::checkExpression( const QString &text, const QgsExpressionCon
 void QgsExpression::setExpression( const QString &expression )
 {
   detach();
+  d->mProgram.reset();
   d->mRootNode = ::parseExpression( expression, d->mParserErrorString );
   d->mEvalErrorString = QString();
   d->mExp = expression;
@@ -319,6 +320,7 @@ void QgsExpression::setGeomCalculator( const QgsDistanceArea *calc )
 bool QgsExpression::prepare( const QgsExpressionContext *context )
 {
   detach();
+  d->mProgram.reset();
   d->mEvalErrorString = QString();
   if ( !d->mRootNode )
   {
@@ -337,6 +339,22 @@ bool QgsExpression::prepare( const QgsExpressionContext *context )
   return d->mRootNode->prepare( this, context );
 }
 
+bool QgsExpression::compile( const QgsExpressionContext *context )
+{
+  detach();
+  d->mProgram.reset();
+  if ( !d->mRootNode )
+    return false;
+
+  d->mProgram.reset( new QgsExpressionProgram( d->mRootNode, context ) );
+  return true;
+}
+
+bool QgsExpression::isCompiled() const
+{
+  return static_cast< bool >( d->mProgram );
+}
+
 QVariant QgsExpression::evaluate()
 {
   d->mEvalErrorString = QString();
@@ -346,6 +364,9 @@ QVariant QgsExpression::evaluate()
     return QVariant();
   }
 
+  if ( d->mProgram )
+    return d->mProgram->evaluate( this, nullptr );
+
   return d->mRootNode->eval( this, static_cast<const QgsExpressionContext *>( nullptr ) );
 }
 
@@ -358,9 +379,46 @@ QVariant QgsExpression::evaluate( const QgsExpressionContext *context )
     return QVariant();
   }
 
+  if ( d->mProgram )
+    return d->mProgram->evaluate( this, context );
+
   return d->mRootNode->eval( this, context );
 }
 
+QVariantList QgsExpression::evaluateFeatures( const QList<QgsFeature> &features, QgsExpressionContext *context )
+{
+  QVariantList results;
+  d->mEvalErrorString = QString();
+  if ( !d->mRootNode )
+  {
+    d->mEvalErrorString = tr( "No root node! Parsing failed?" );
+    for ( int i = 0; i < features.size(); ++i )
+      results << QVariant();
+    return results;
+  }
+
+  if ( d->mProgram && context )
+  {
+    QVector< QVariant > values( features.size() );
+    const QVector< QgsFeature > block = features.toVector();
+    d->mProgram->evaluateBlock( this, context, block.constData(), block.size(), values.data() );
+    return values.toList();
+  }
+
+  QString firstError;
+  results.reserve( features.size() );
+  Q_FOREACH ( const QgsFeature &feature, features )
+  {
+    if ( context )
+      context->setFeature( feature );
+    results << evaluate( context );
+    if ( hasEvalError() && firstError.isNull() )
+      firstError = d->mEvalErrorString;
+  }
+  d->mEvalErrorString = firstError;
+  return results;
+}
+
 bool QgsExpression::hasEvalError() const
 {
   return !d->mEvalErrorString.isNull();
@@ -175,6 +175,27 @@ class CORE_EXPORT QgsExpression
      */
     bool prepare( const QgsExpressionContext *context );
 
+    /**
+     * Compiles the prepared expression to a program of typed instructions, used by evaluate()
+     * instead of walking the node tree. Static parts of the expression are folded to constants,
+     * column references are resolved to attribute indexes and numeric and boolean intermediate
+     * results are not converted to QVariant values. The results are identical to the evaluation
+     * of the node tree.
+     *
+     * Should be called after prepare(), with the same \a context. The program is discarded
+     * by the next call to prepare().
+     * \returns true if the expression was compiled
+     * \see isCompiled()
+     * \since QGIS 3.0
+     */
+    bool compile( const QgsExpressionContext *context );
+
+    /**
+     * Returns true if the expression was compiled by compile() and evaluates its program.
+     * \since QGIS 3.0
+     */
+    bool isCompiled() const;
+
     /**
      * Get list of columns referenced by the expression.
      *
@@ -220,6 +241,23 @@ class CORE_EXPORT QgsExpression
      */
     QVariant evaluate( const QgsExpressionContext *context );
 
+    /**
+     * Evaluates the expression for a list of \a features and returns their values, in the
+     * order of the features. The feature of the \a context is changed by the evaluation.
+     *
+     * A compiled expression evaluates the features in blocks, each instruction of the program
+     * being run over the whole block and column references being resolved once per block,
+     * which is faster than calling evaluate() for each feature. Other expressions are
+     * evaluated feature by feature.
+     *
+     * Features which fail to evaluate get a null value, hasEvalError() and evalErrorString()
+     * report the first error.
+     * \note prepare() should be called before calling this method.
+     * \see compile()
+     * \since QGIS 3.0
+     */
+    QVariantList evaluateFeatures( const QList<QgsFeature> &features, QgsExpressionContext *context );
+
     //! Returns true if an error occurred when evaluating last input
     bool hasEvalError() const;
     //! Returns evaluation error
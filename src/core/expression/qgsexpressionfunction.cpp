@@ -42,6 +42,12 @@
 #include "qgsrasterbandstats.h"
 #include "qgscolorramp.h"
 
+#include <QAtomicInt>
+#include <QMutex>
+#include <QPointer>
+#include <QThread>
+#include <QSharedPointer>
+
 const QString QgsExpressionFunction::helpText() const
 {
   return mHelpText.isEmpty() ? QgsExpression::helpText( mName ) : mHelpText;
@@ -2358,47 +2364,232 @@ static QVariant fcnBbox( const QVariantList &values, const QgsExpressionContext
   QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
   return fGeom.intersects( sGeom.boundingBox() ) ? TVL_True : TVL_False;
 }
-static QVariant fcnDisjoint( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+///@cond PRIVATE
+
+//! Spatial predicates of the expression functions
+enum QgsSpatialPredicate
+{
+  SpatialDisjoint,
+  SpatialIntersects,
+  SpatialTouches,
+  SpatialCrosses,
+  SpatialContains,
+  SpatialOverlaps,
+  SpatialWithin,
+};
+
+/**
+ * Prepared GEOS geometries of the constant operands of spatial predicates.
+ *
+ * Constant operands, like a geometry from a variable or from geom_from_wkt() with a literal,
+ * are cached by prepare() so the same geometry is passed to every call. The cache recognizes
+ * a geometry passed again and prepares it once, the geometries of the features pass once
+ * and are dropped as new geometries come in.
+ *
+ * Copies of an expression context share the cache and may evaluate in several threads.
+ * GEOS prepared geometries cannot be used by several threads at once, so each thread gets
+ * its own prepared engine. The cache is locked only to look up and store engines, the
+ * predicates are evaluated without the lock.
+ */
+class QgsPreparedGeometryCache
+{
+  public:
+
+    //! Cached value key of the cache in an expression context
+    static QString cacheKey() { return QStringLiteral( "preparedgeometries" ); }
+
+    /**
+     * Returns the prepared engine of \a geometry for the current thread if the same geometry
+     * was passed before, or nullptr if it is new.
+     */
+    std::shared_ptr< QgsGeometryEngine > engine( const QgsGeometry &geometry )
+    {
+      QThread *thread = QThread::currentThread();
+      {
+        QMutexLocker locker( &mMutex );
+        const int index = indexOf( geometry );
+        if ( index < 0 )
+        {
+          // the entry keeps the geometry alive, so its address cannot be reused by another one
+          Entry entry;
+          entry.geometry = geometry;
+          mEntries.prepend( entry );
+          if ( mEntries.size() > MAX_ENTRIES )
+            mEntries.removeLast();
+          return nullptr;
+        }
+
+        if ( index > 0 )
+          mEntries.move( index, 0 );
+        std::shared_ptr< QgsGeometryEngine > engine = mEntries.at( 0 ).engines.value( thread );
+        if ( engine )
+          return engine;
+      }
+
+      // prepare without the lock, as other threads keep using their engines
+      std::shared_ptr< QgsGeometryEngine > engine( QgsGeometry::createGeometryEngine( geometry.geometry() ) );
+      engine->prepareGeometry();
+
+      // the entry may have been dropped meanwhile, the engine is then only used for this call
+      QMutexLocker locker( &mMutex );
+      const int index = indexOf( geometry );
+      if ( index >= 0 )
+        mEntries[index].engines.insert( thread, engine );
+      return engine;
+    }
+
+  private:
+
+    static const int MAX_ENTRIES = 8;
+
+    struct Entry
+    {
+      QgsGeometry geometry;
+      //! Prepared engines by thread, a thread which ended may leave its engine to a new one
+      QHash< QThread *, std::shared_ptr< QgsGeometryEngine > > engines;
+    };
+
+    int indexOf( const QgsGeometry &geometry ) const
+    {
+      for ( int i = 0; i < mEntries.size(); ++i )
+      {
+        if ( mEntries.at( i ).geometry.geometry() == geometry.geometry() )
+          return i;
+      }
+      return -1;
+    }
+
+    QMutex mMutex;
+    QList< Entry > mEntries;
+};
+
+typedef QSharedPointer< QgsPreparedGeometryCache > QgsPreparedGeometryCachePtr;
+
+///@endcond
+
+Q_DECLARE_METATYPE( QgsPreparedGeometryCachePtr )
+
+static bool relateEngine( QgsGeometryEngine *engine, QgsSpatialPredicate predicate, const QgsAbstractGeometry &geometry )
 {
-  QgsGeometry fGeom = QgsExpressionUtils::getGeometry( values.at( 0 ), parent );
-  QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
-  return fGeom.disjoint( sGeom ) ? TVL_True : TVL_False;
+  switch ( predicate )
+  {
+    case SpatialDisjoint:
+      return engine->disjoint( geometry );
+    case SpatialIntersects:
+      return engine->intersects( geometry );
+    case SpatialTouches:
+      return engine->touches( geometry );
+    case SpatialCrosses:
+      return engine->crosses( geometry );
+    case SpatialContains:
+      return engine->contains( geometry );
+    case SpatialOverlaps:
+      return engine->overlaps( geometry );
+    case SpatialWithin:
+      return engine->within( geometry );
+  }
+  return false;
 }
-static QVariant fcnIntersects( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+
+static QVariant fcnSpatialPredicate( QgsSpatialPredicate predicate, const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
 {
   QgsGeometry fGeom = QgsExpressionUtils::getGeometry( values.at( 0 ), parent );
   QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
-  return fGeom.intersects( sGeom ) ? TVL_True : TVL_False;
+  if ( fGeom.isNull() || sGeom.isNull() )
+    return TVL_False;
+
+  // envelope prefilter, geometries with disjoint bounding boxes are disjoint
+  const QgsRectangle fBox = fGeom.boundingBox();
+  const QgsRectangle sBox = sGeom.boundingBox();
+  if ( !fBox.intersects( sBox ) )
+    return predicate == SpatialDisjoint ? TVL_True : TVL_False;
+  if ( predicate == SpatialContains && !fBox.contains( sBox ) )
+    return TVL_False;
+  if ( predicate == SpatialWithin && !sBox.contains( fBox ) )
+    return TVL_False;
+
+  if ( context && context->hasCachedValue( QgsPreparedGeometryCache::cacheKey() ) )
+  {
+    QgsPreparedGeometryCachePtr cache = context->cachedValue( QgsPreparedGeometryCache::cacheKey() ).value< QgsPreparedGeometryCachePtr >();
+    if ( std::shared_ptr< QgsGeometryEngine > engine = cache->engine( fGeom ) )
+      return relateEngine( engine.get(), predicate, *sGeom.geometry() ) ? TVL_True : TVL_False;
+
+    if ( std::shared_ptr< QgsGeometryEngine > engine = cache->engine( sGeom ) )
+    {
+      // the prepared geometry is the first operand of the engine
+      QgsSpatialPredicate converse = predicate;
+      if ( predicate == SpatialContains )
+        converse = SpatialWithin;
+      else if ( predicate == SpatialWithin )
+        converse = SpatialContains;
+      return relateEngine( engine.get(), converse, *fGeom.geometry() ) ? TVL_True : TVL_False;
+    }
+  }
+
+  switch ( predicate )
+  {
+    case SpatialDisjoint:
+      return fGeom.disjoint( sGeom ) ? TVL_True : TVL_False;
+    case SpatialIntersects:
+      return fGeom.intersects( sGeom ) ? TVL_True : TVL_False;
+    case SpatialTouches:
+      return fGeom.touches( sGeom ) ? TVL_True : TVL_False;
+    case SpatialCrosses:
+      return fGeom.crosses( sGeom ) ? TVL_True : TVL_False;
+    case SpatialContains:
+      return fGeom.contains( sGeom ) ? TVL_True : TVL_False;
+    case SpatialOverlaps:
+      return fGeom.overlaps( sGeom ) ? TVL_True : TVL_False;
+    case SpatialWithin:
+      return fGeom.within( sGeom ) ? TVL_True : TVL_False;
+  }
+  return TVL_False;
 }
-static QVariant fcnTouches( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+
+static bool prepareSpatialPredicate( const QgsExpressionNodeFunction *node, QgsExpression *parent, const QgsExpressionContext *context )
 {
-  QgsGeometry fGeom = QgsExpressionUtils::getGeometry( values.at( 0 ), parent );
-  QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
-  return fGeom.touches( sGeom ) ? TVL_True : TVL_False;
+  // predicates with a constant operand share a cache of prepared geometries in the context
+  if ( !context || context->hasCachedValue( QgsPreparedGeometryCache::cacheKey() ) || !node->args() )
+    return true;
+
+  Q_FOREACH ( QgsExpressionNode *argNode, node->args()->list() )
+  {
+    if ( argNode->isStatic( parent, context ) )
+    {
+      context->setCachedValue( QgsPreparedGeometryCache::cacheKey(), QVariant::fromValue( QgsPreparedGeometryCachePtr( new QgsPreparedGeometryCache() ) ) );
+      break;
+    }
+  }
+  return true;
 }
-static QVariant fcnCrosses( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+
+static QVariant fcnDisjoint( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
 {
-  QgsGeometry fGeom = QgsExpressionUtils::getGeometry( values.at( 0 ), parent );
-  QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
-  return fGeom.crosses( sGeom ) ? TVL_True : TVL_False;
+  return fcnSpatialPredicate( SpatialDisjoint, values, context, parent );
 }
-static QVariant fcnContains( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+static QVariant fcnIntersects( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
 {
-  QgsGeometry fGeom = QgsExpressionUtils::getGeometry( values.at( 0 ), parent );
-  QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
-  return fGeom.contains( sGeom ) ? TVL_True : TVL_False;
+  return fcnSpatialPredicate( SpatialIntersects, values, context, parent );
 }
-static QVariant fcnOverlaps( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+static QVariant fcnTouches( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
 {
-  QgsGeometry fGeom = QgsExpressionUtils::getGeometry( values.at( 0 ), parent );
-  QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
-  return fGeom.overlaps( sGeom ) ? TVL_True : TVL_False;
+  return fcnSpatialPredicate( SpatialTouches, values, context, parent );
 }
-static QVariant fcnWithin( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+static QVariant fcnCrosses( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
 {
-  QgsGeometry fGeom = QgsExpressionUtils::getGeometry( values.at( 0 ), parent );
-  QgsGeometry sGeom = QgsExpressionUtils::getGeometry( values.at( 1 ), parent );
-  return fGeom.within( sGeom ) ? TVL_True : TVL_False;
+  return fcnSpatialPredicate( SpatialCrosses, values, context, parent );
+}
+static QVariant fcnContains( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
+{
+  return fcnSpatialPredicate( SpatialContains, values, context, parent );
+}
+static QVariant fcnOverlaps( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
+{
+  return fcnSpatialPredicate( SpatialOverlaps, values, context, parent );
+}
+static QVariant fcnWithin( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
+{
+  return fcnSpatialPredicate( SpatialWithin, values, context, parent );
 }
 static QVariant fcnBuffer( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
 {
@@ -3287,7 +3478,159 @@ static QVariant fcnTransformGeometry( const QVariantList &values, const QgsExpre
 }
 
 
-static QVariant fcnGetFeature( const QVariantList &values, const QgsExpressionContext *, QgsExpression *parent )
+///@cond PRIVATE
+
+/**
+ * Returns the key of \a value for get_feature() lookups. Values of numeric fields
+ * compare as numbers, values of other fields as strings, so that '01' or '1.0' do
+ * not match '1' in a string field.
+ */
+static QString featureLookupKey( const QVariant &value, bool numericField )
+{
+  if ( numericField && QgsExpressionUtils::isDoubleSafe( value ) )
+    return QString::number( value.toDouble(), 'g', 17 );
+  return value.toString();
+}
+
+//! Returns the first feature of \a layer whose \a attribute has the key of \a value, with a request
+static bool requestFeatureLookup( QgsVectorLayer *layer, int attribute, const QVariant &value, bool fetchGeometry, QgsFeature &feature )
+{
+  const QgsField field = layer->fields().at( attribute );
+  QgsFeatureRequest req;
+  req.setFilterExpression( QStringLiteral( "%1=%2" ).arg( QgsExpression::quotedColumnRef( field.name() ),
+                           QgsExpression::quotedString( value.toString() ) ) );
+  // the filter compares strings looking like numbers as numbers, which only
+  // numeric fields do, so candidates of other fields are checked
+  if ( field.isNumeric() )
+    req.setLimit( 1 );
+  if ( !fetchGeometry )
+    req.setFlags( QgsFeatureRequest::NoGeometry );
+
+  const QString key = featureLookupKey( value, field.isNumeric() );
+  QgsFeatureIterator fIt = layer->getFeatures( req );
+  while ( fIt.nextFeature( feature ) )
+  {
+    if ( featureLookupKey( feature.attribute( attribute ), field.isNumeric() ) == key )
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Index of the features of a vector layer by the value of one attribute, used by get_feature().
+ *
+ * The first lookup uses a request, so that single evaluations do not read the whole layer.
+ * The index is built by the next lookup and built again by the next lookup after the
+ * layer or its fields were modified. Layers with more than MAX_FEATURES features are not
+ * indexed, their lookups always use requests. The index is shared through the cached values
+ * of an expression context, so it lives as long as the context, for instance a render job.
+ */
+class QgsFeatureLookupIndex
+{
+  public:
+
+    //! Maximum number of features of an indexed layer
+    static const long MAX_FEATURES = 100000;
+
+    QgsFeatureLookupIndex( QgsVectorLayer *layer, int attribute, bool fetchGeometry )
+      : mLayer( layer )
+      , mAttribute( attribute )
+      , mFetchGeometry( fetchGeometry )
+      , mValid( 0 )
+    {
+      // edits are signaled from the main thread, the flag is read by the evaluating thread
+      QAtomicInt *valid = &mValid;
+      auto invalidate = [valid] { valid->store( 0 ); };
+      mConnections << QObject::connect( layer, &QgsVectorLayer::layerModified, invalidate )
+                   << QObject::connect( layer, &QgsVectorLayer::afterRollBack, invalidate )
+                   << QObject::connect( layer, &QgsVectorLayer::afterCommitChanges, invalidate )
+                   << QObject::connect( layer, &QgsVectorLayer::updatedFields, invalidate )
+                   << QObject::connect( layer, &QgsMapLayer::dataChanged, invalidate );
+    }
+
+    ~QgsFeatureLookupIndex()
+    {
+      Q_FOREACH ( const QMetaObject::Connection &connection, mConnections )
+        QObject::disconnect( connection );
+    }
+
+    //! Returns the first feature whose attribute has the key of \a value
+    bool lookup( const QVariant &value, QgsFeature &feature )
+    {
+      QMutexLocker locker( &mMutex );
+      if ( !mLayer )
+        return false;
+
+      if ( ++mLookupCount > 1 && !mValid.load() )
+        build();
+      if ( !mIndexed )
+        return requestFeatureLookup( mLayer, mAttribute, value, mFetchGeometry, feature );
+
+      QHash< QString, QgsFeature >::const_iterator it = mFeatures.constFind( featureLookupKey( value, mNumeric ) );
+      if ( it == mFeatures.constEnd() )
+        return false;
+
+      feature = it.value();
+      return true;
+    }
+
+  private:
+
+    void build()
+    {
+      mFeatures.clear();
+      mIndexed = false;
+      mValid.store( 1 );
+      if ( mLayer->featureCount() > MAX_FEATURES )
+        return;
+
+      mNumeric = mLayer->fields().at( mAttribute ).isNumeric();
+      QgsFeatureRequest req;
+      if ( !mFetchGeometry )
+        req.setFlags( QgsFeatureRequest::NoGeometry );
+      QgsFeatureIterator fIt = mLayer->getFeatures( req );
+      QgsFeature fet;
+      long count = 0;
+      while ( fIt.nextFeature( fet ) )
+      {
+        // the feature count of some providers is an estimate
+        if ( ++count > MAX_FEATURES )
+        {
+          mFeatures.clear();
+          return;
+        }
+
+        const QVariant value = fet.attribute( mAttribute );
+        if ( value.isNull() )
+          continue;
+
+        // the first matching feature is returned, as with a request
+        const QString valueKey = featureLookupKey( value, mNumeric );
+        if ( !mFeatures.contains( valueKey ) )
+          mFeatures.insert( valueKey, fet );
+      }
+      mIndexed = true;
+    }
+
+    QPointer< QgsVectorLayer > mLayer;
+    int mAttribute;
+    bool mFetchGeometry;
+    QAtomicInt mValid;
+    QMutex mMutex;
+    int mLookupCount = 0;
+    bool mIndexed = false;
+    bool mNumeric = false;
+    QHash< QString, QgsFeature > mFeatures;
+    QList< QMetaObject::Connection > mConnections;
+};
+
+typedef QSharedPointer< QgsFeatureLookupIndex > QgsFeatureLookupIndexPtr;
+
+///@endcond
+
+Q_DECLARE_METATYPE( QgsFeatureLookupIndexPtr )
+
+static QVariant fcnGetFeature( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent )
 {
   //arguments: 1. layer id / name, 2. key attribute, 3. eq value
   QgsVectorLayer *vl = QgsExpressionUtils::getVectorLayer( values.at( 0 ), parent );
@@ -3306,18 +3649,30 @@ static QVariant fcnGetFeature( const QVariantList &values, const QgsExpressionCo
   }
 
   const QVariant &attVal = values.at( 2 );
-  QgsFeatureRequest req;
-  req.setFilterExpression( QStringLiteral( "%1=%2" ).arg( QgsExpression::quotedColumnRef( attribute ),
-                           QgsExpression::quotedString( attVal.toString() ) ) );
-  req.setLimit( 1 );
-  if ( !parent->needsGeometry() )
+  const bool fetchGeometry = parent->needsGeometry();
+  QgsFeature fet;
+
+  if ( context )
   {
-    req.setFlags( QgsFeatureRequest::NoGeometry );
+    // repeated lookups in the same layer are answered by an index kept with the context
+    const QString cacheKey = QStringLiteral( "getfeature:%1:%2:%3" ).arg( vl->id() ).arg( attributeId ).arg( static_cast< int >( fetchGeometry ) );
+    QgsFeatureLookupIndexPtr index;
+    if ( context->hasCachedValue( cacheKey ) )
+    {
+      index = context->cachedValue( cacheKey ).value< QgsFeatureLookupIndexPtr >();
+    }
+    else
+    {
+      index = QgsFeatureLookupIndexPtr( new QgsFeatureLookupIndex( vl, attributeId, fetchGeometry ) );
+      context->setCachedValue( cacheKey, QVariant::fromValue( index ) );
+    }
+
+    if ( index->lookup( attVal, fet ) )
+      return QVariant::fromValue( fet );
+    return QVariant();
   }
-  QgsFeatureIterator fIt = vl->getFeatures( req );
 
-  QgsFeature fet;
-  if ( fIt.nextFeature( fet ) )
+  if ( requestFeatureLookup( vl, attributeId, attVal, fetchGeometry, fet ) )
     return QVariant::fromValue( fet );
 
   return QVariant();
@@ -3971,14 +4326,23 @@ const QList<QgsExpressionFunction *> &QgsExpression::Functions()
         << new QgsStaticExpressionFunction( QStringLiteral( "geom_from_wkt" ), 1, fcnGeomFromWKT, QStringLiteral( "GeometryGroup" ), QString(), false, QSet<QString>(), false, QStringList() << QStringLiteral( "geomFromWKT" ) )
         << new QgsStaticExpressionFunction( QStringLiteral( "geom_from_gml" ), 1, fcnGeomFromGML, QStringLiteral( "GeometryGroup" ), QString(), false, QSet<QString>(), false, QStringList() << QStringLiteral( "geomFromGML" ) )
         << new QgsStaticExpressionFunction( QStringLiteral( "relate" ), -1, fcnRelate, QStringLiteral( "GeometryGroup" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "intersects_bbox" ), 2, fcnBbox, QStringLiteral( "GeometryGroup" ), QString(), false, QSet<QString>(), false, QStringList() << QStringLiteral( "bbox" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "disjoint" ), 2, fcnDisjoint, QStringLiteral( "GeometryGroup" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "intersects" ), 2, fcnIntersects, QStringLiteral( "GeometryGroup" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "touches" ), 2, fcnTouches, QStringLiteral( "GeometryGroup" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "crosses" ), 2, fcnCrosses, QStringLiteral( "GeometryGroup" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "contains" ), 2, fcnContains, QStringLiteral( "GeometryGroup" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "overlaps" ), 2, fcnOverlaps, QStringLiteral( "GeometryGroup" ) )
-        << new QgsStaticExpressionFunction( QStringLiteral( "within" ), 2, fcnWithin, QStringLiteral( "GeometryGroup" ) )
+        << new QgsStaticExpressionFunction( QStringLiteral( "intersects_bbox" ), 2, fcnBbox, QStringLiteral( "GeometryGroup" ), QString(), false, QSet<QString>(), false, QStringList() << QStringLiteral( "bbox" ) );
+
+    QList< QgsStaticExpressionFunction * > spatialPredicates;
+    spatialPredicates << new QgsStaticExpressionFunction( QStringLiteral( "disjoint" ), 2, fcnDisjoint, QStringLiteral( "GeometryGroup" ) )
+                      << new QgsStaticExpressionFunction( QStringLiteral( "intersects" ), 2, fcnIntersects, QStringLiteral( "GeometryGroup" ) )
+                      << new QgsStaticExpressionFunction( QStringLiteral( "touches" ), 2, fcnTouches, QStringLiteral( "GeometryGroup" ) )
+                      << new QgsStaticExpressionFunction( QStringLiteral( "crosses" ), 2, fcnCrosses, QStringLiteral( "GeometryGroup" ) )
+                      << new QgsStaticExpressionFunction( QStringLiteral( "contains" ), 2, fcnContains, QStringLiteral( "GeometryGroup" ) )
+                      << new QgsStaticExpressionFunction( QStringLiteral( "overlaps" ), 2, fcnOverlaps, QStringLiteral( "GeometryGroup" ) )
+                      << new QgsStaticExpressionFunction( QStringLiteral( "within" ), 2, fcnWithin, QStringLiteral( "GeometryGroup" ) );
+    Q_FOREACH ( QgsStaticExpressionFunction *predicate, spatialPredicates )
+    {
+      predicate->setPrepareFunction( prepareSpatialPredicate );
+      sFunctions << predicate;
+    }
+
+    sFunctions
         << new QgsStaticExpressionFunction( QStringLiteral( "translate" ), 3, fcnTranslate, QStringLiteral( "GeometryGroup" ) )
         << new QgsStaticExpressionFunction( QStringLiteral( "buffer" ), -1, fcnBuffer, QStringLiteral( "GeometryGroup" ) )
         << new QgsStaticExpressionFunction( QStringLiteral( "offset_curve" ), QgsExpressionFunction::ParameterList() << QgsExpressionFunction::Parameter( QStringLiteral( "geometry" ) )
@@ -236,6 +236,22 @@ class CORE_EXPORT QgsExpressionNode SIP_ABSTRACT
      */
     bool prepare( QgsExpression *parent, const QgsExpressionContext *context );
 
+    /**
+     * Returns true if the node was found static by prepare() and its value is cached.
+     *
+     * \see cachedStaticValue()
+     * \since QGIS 3.0
+     */
+    bool hasCachedStaticValue() const { return mHasCachedValue; }
+
+    /**
+     * Returns the value cached by prepare() for a static node. Only valid if
+     * hasCachedStaticValue() returns true.
+     *
+     * \see hasCachedStaticValue()
+     * \since QGIS 3.0
+     */
+    QVariant cachedStaticValue() const { return mCachedStaticValue; }
 
   protected:
 
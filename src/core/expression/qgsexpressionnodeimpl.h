@@ -68,10 +68,16 @@ class CORE_EXPORT QgsExpressionNodeUnaryOperator : public QgsExpressionNode
     QString text() const;
 
   private:
+
+    //! Applies the operator to the value of the operand
+    QVariant evalValue( QgsExpression *parent, const QVariant &val );
+
     UnaryOperator mOp;
     QgsExpressionNode *mOperand = nullptr;
 
     static const char *UNARY_OPERATOR_TEXT[];
+
+    friend class QgsExpressionProgram;
 };
 
 /** \ingroup core
@@ -153,6 +159,10 @@ class CORE_EXPORT QgsExpressionNodeBinaryOperator : public QgsExpressionNode
     QString text() const;
 
   private:
+
+    //! Applies the operator to the values of the operands
+    QVariant evalValues( QgsExpression *parent, const QgsExpressionContext *context, const QVariant &vL, const QVariant &vR );
+
     bool compare( double diff );
     qlonglong computeInt( qlonglong x, qlonglong y );
     double computeDouble( double x, double y );
@@ -168,6 +178,8 @@ class CORE_EXPORT QgsExpressionNodeBinaryOperator : public QgsExpressionNode
     QgsExpressionNode *mOpRight = nullptr;
 
     static const char *BINARY_OPERATOR_TEXT[];
+
+    friend class QgsExpressionProgram;
 };
 
 /** \ingroup core
@@ -326,6 +338,18 @@ class CORE_EXPORT QgsExpressionNodeCondition : public QgsExpressionNode
          */
         QgsExpressionNodeCondition::WhenThen *clone() const SIP_FACTORY;
 
+        /**
+         * The expression that makes the WHEN part of the condition.
+         * \since QGIS 3.0
+         */
+        QgsExpressionNode *whenExp() const { return mWhenExp; }
+
+        /**
+         * The expression node that makes the THEN result part of the condition.
+         * \since QGIS 3.0
+         */
+        QgsExpressionNode *thenExp() const { return mThenExp; }
+
       private:
 #ifdef SIP_RUN
         WhenThen( const QgsExpressionNodeCondition::WhenThen &rh );
@@ -352,6 +376,18 @@ class CORE_EXPORT QgsExpressionNodeCondition : public QgsExpressionNode
 
     ~QgsExpressionNodeCondition();
 
+    /**
+     * The list of WHEN THEN expression parts of the expression.
+     * \since QGIS 3.0
+     */
+    QgsExpressionNodeCondition::WhenThenList conditions() const { return mConditions; }
+
+    /**
+     * The ELSE expression used for the condition.
+     * \since QGIS 3.0
+     */
+    QgsExpressionNode *elseExp() const { return mElseExp; }
+
     virtual QgsExpressionNode::NodeType nodeType() const override;
     virtual QVariant evalNode( QgsExpression *parent, const QgsExpressionContext *context ) override;
     virtual bool prepareNode( QgsExpression *parent, const QgsExpressionContext *context ) override;
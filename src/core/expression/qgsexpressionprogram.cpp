@@ -0,0 +1,718 @@
+/***************************************************************************
+  qgsexpressionprogram.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsexpressionprogram.h"
+#include "qgsexpression.h"
+#include "qgsexpressioncontext.h"
+#include "qgsexpressionfunction.h"
+#include "qgsexpressionnodeimpl.h"
+#include "qgsexpressionutils.h"
+#include "qgsfeature.h"
+
+#include <QtMath>
+
+///@cond PRIVATE
+
+QgsExpressionProgram::QgsExpressionProgram( QgsExpressionNode *rootNode, const QgsExpressionContext *context )
+  : mContext( context )
+{
+  compileNode( rootNode, 0 );
+  mContext = nullptr;
+}
+
+int QgsExpressionProgram::append( OpCode code, int target, int a, int b, QgsExpressionNode *node )
+{
+  Instruction instruction;
+  instruction.code = code;
+  instruction.target = target;
+  instruction.a = a;
+  instruction.b = b;
+  instruction.jump = -1;
+  instruction.node = node;
+  mInstructions << instruction;
+  useRegister( target );
+  return mInstructions.size() - 1;
+}
+
+void QgsExpressionProgram::useRegister( int index )
+{
+  if ( mRegisterCount <= index )
+    mRegisterCount = index + 1;
+}
+
+int QgsExpressionProgram::addConstant( const QVariant &constant )
+{
+  Value value;
+  setValue( value, constant );
+  mConstants << value;
+  return mConstants.size() - 1;
+}
+
+void QgsExpressionProgram::compileNode( QgsExpressionNode *node, int target )
+{
+  useRegister( target );
+
+  if ( node->hasCachedStaticValue() )
+  {
+    append( LoadConstant, target, addConstant( node->cachedStaticValue() ) );
+    return;
+  }
+
+  switch ( node->nodeType() )
+  {
+    case QgsExpressionNode::ntLiteral:
+      append( LoadConstant, target, addConstant( static_cast< QgsExpressionNodeLiteral * >( node )->value() ) );
+      return;
+
+    case QgsExpressionNode::ntColumnRef:
+    {
+      // resolved as in QgsExpressionNodeColumnRef::prepareNode(), unknown columns are looked up by the node
+      int index = -1;
+      if ( mContext && mContext->hasVariable( QgsExpressionContext::EXPR_FIELDS ) )
+      {
+        QgsFields fields = qvariant_cast<QgsFields>( mContext->variable( QgsExpressionContext::EXPR_FIELDS ) );
+        index = fields.lookupField( static_cast< QgsExpressionNodeColumnRef * >( node )->name() );
+      }
+      if ( index < 0 )
+        break;
+
+      append( LoadAttribute, target, index, 0, node );
+      mUsesFeature = true;
+      return;
+    }
+
+    case QgsExpressionNode::ntUnaryOperator:
+    {
+      QgsExpressionNodeUnaryOperator *unary = static_cast< QgsExpressionNodeUnaryOperator * >( node );
+      compileNode( unary->operand(), target );
+      append( Unary, target, target, 0, node );
+      return;
+    }
+
+    case QgsExpressionNode::ntBinaryOperator:
+    {
+      QgsExpressionNodeBinaryOperator *binary = static_cast< QgsExpressionNodeBinaryOperator * >( node );
+      compileNode( binary->opLeft(), target );
+      compileNode( binary->opRight(), target + 1 );
+      append( Binary, target, target, target + 1, node );
+      return;
+    }
+
+    case QgsExpressionNode::ntInOperator:
+    {
+      QgsExpressionNodeInOperator *in = static_cast< QgsExpressionNodeInOperator * >( node );
+      InList list;
+      list.notIn = in->isNotIn();
+      list.hasNull = false;
+      bool constantList = true;
+      Q_FOREACH ( QgsExpressionNode *item, in->list()->list() )
+      {
+        QVariant value;
+        if ( item->hasCachedStaticValue() )
+          value = item->cachedStaticValue();
+        else if ( item->nodeType() == QgsExpressionNode::ntLiteral )
+          value = static_cast< QgsExpressionNodeLiteral * >( item )->value();
+        else
+        {
+          constantList = false;
+          break;
+        }
+
+        InItem inItem;
+        inItem.isNull = QgsExpressionUtils::isNull( value );
+        inItem.isDoubleSafe = !inItem.isNull && QgsExpressionUtils::isDoubleSafe( value );
+        inItem.doubleValue = 0;
+        if ( inItem.isDoubleSafe )
+        {
+          bool ok;
+          inItem.doubleValue = value.toDouble( &ok );
+          // conversion errors are left to the node
+          if ( !ok || !qIsFinite( inItem.doubleValue ) )
+          {
+            constantList = false;
+            break;
+          }
+        }
+        if ( !inItem.isNull )
+          inItem.stringValue = value.toString();
+        list.hasNull |= inItem.isNull;
+        list.items << inItem;
+      }
+      if ( !constantList )
+        break;
+
+      if ( list.items.isEmpty() )
+      {
+        // the node returns without evaluating its operand
+        append( LoadConstant, target, addConstant( list.notIn ? TVL_True : TVL_False ) );
+        return;
+      }
+
+      const int listIndex = mInLists.size();
+      mInLists << list;
+      compileNode( in->node(), target );
+      append( In, target, target, listIndex, node );
+      return;
+    }
+
+    case QgsExpressionNode::ntCondition:
+    {
+      QgsExpressionNodeCondition *condition = static_cast< QgsExpressionNodeCondition * >( node );
+      QList< int > jumpsToEnd;
+      Q_FOREACH ( QgsExpressionNodeCondition::WhenThen *whenThen, condition->conditions() )
+      {
+        compileNode( whenThen->whenExp(), target );
+        const int jumpToNext = append( JumpIfNotTrue, target, target );
+        compileNode( whenThen->thenExp(), target );
+        jumpsToEnd << append( Jump, target );
+        mInstructions[jumpToNext].jump = mInstructions.size();
+      }
+
+      if ( condition->elseExp() )
+        compileNode( condition->elseExp(), target );
+      else
+        append( LoadConstant, target, addConstant( QVariant() ) );
+
+      Q_FOREACH ( int jump, jumpsToEnd )
+        mInstructions[jump].jump = mInstructions.size();
+      return;
+    }
+
+    case QgsExpressionNode::ntFunction:
+    {
+      QgsExpressionNodeFunction *function = static_cast< QgsExpressionNodeFunction * >( node );
+      QgsExpressionFunction *fd = QgsExpression::Functions()[function->fnIndex()];
+      if ( fd->lazyEval() )
+        break;
+
+      FunctionCall call;
+      call.function = fd;
+      call.name = fd->name();
+      const int callIndex = mCalls.size();
+      mCalls << call;
+      QList< int > jumpsToEnd;
+      jumpsToEnd << append( CallBegin, target, 0, callIndex, node );
+
+      // as in QgsExpressionNodeFunction::evalNode(), arguments after a null one are not evaluated
+      const QList< QgsExpressionNode * > args = function->args() ? function->args()->list() : QList< QgsExpressionNode * >();
+      for ( int i = 0; i < args.size(); ++i )
+      {
+        const int argRegister = target + 1 + i;
+        compileNode( args.at( i ), argRegister );
+        mCalls[callIndex].args << argRegister;
+        if ( !fd->handlesNull() )
+          jumpsToEnd << append( ArgNullCheck, target, argRegister );
+      }
+      append( Call, target, 0, callIndex, node );
+
+      Q_FOREACH ( int jump, jumpsToEnd )
+        mInstructions[jump].jump = mInstructions.size();
+      return;
+    }
+  }
+
+  append( EvalNode, target, 0, 0, node );
+}
+
+void QgsExpressionProgram::setValue( Value &value, const QVariant &variant )
+{
+  if ( !variant.isNull() )
+  {
+    switch ( variant.type() )
+    {
+      case QVariant::Int:
+        value.type = Value::Int;
+        value.i = variant.toInt();
+        return;
+      case QVariant::LongLong:
+        value.type = Value::LongLong;
+        value.i = variant.toLongLong();
+        return;
+      case QVariant::Double:
+        value.type = Value::Double;
+        value.d = variant.toDouble();
+        return;
+      default:
+        break;
+    }
+  }
+  value.type = Value::Variant;
+  value.v = variant;
+}
+
+QVariant QgsExpressionProgram::toVariant( const Value &value )
+{
+  switch ( value.type )
+  {
+    case Value::Int:
+      return QVariant( static_cast< int >( value.i ) );
+    case Value::LongLong:
+      return QVariant( value.i );
+    case Value::Double:
+      return QVariant( value.d );
+    case Value::Variant:
+      break;
+  }
+  return value.v;
+}
+
+int QgsExpressionProgram::tvlValue( const Value &value, QgsExpression *parent )
+{
+  // same conversions as QgsExpressionUtils::getTVLValue()
+  switch ( value.type )
+  {
+    case Value::Int:
+      return value.i != 0 ? QgsExpressionUtils::True : QgsExpressionUtils::False;
+    case Value::LongLong:
+      return !qgsDoubleNear( static_cast< double >( value.i ), 0.0 ) ? QgsExpressionUtils::True : QgsExpressionUtils::False;
+    case Value::Double:
+      return !qgsDoubleNear( value.d, 0.0 ) ? QgsExpressionUtils::True : QgsExpressionUtils::False;
+    case Value::Variant:
+      break;
+  }
+  return QgsExpressionUtils::getTVLValue( value.v, parent );
+}
+
+void QgsExpressionProgram::setTvl( Value &value, int tvl )
+{
+  if ( tvl == QgsExpressionUtils::Unknown )
+  {
+    value.type = Value::Variant;
+    value.v = QVariant();
+  }
+  else
+  {
+    value.type = Value::Int;
+    value.i = tvl == QgsExpressionUtils::True ? 1 : 0;
+  }
+}
+
+bool QgsExpressionProgram::numericBinary( int op, const Value &left, const Value &right, Value &result )
+{
+  // follows QgsExpressionNodeBinaryOperator::evalValues(), non finite doubles are reported
+  // as conversion errors by the node
+  const bool integers = left.type != Value::Double && right.type != Value::Double;
+  const double fL = left.type == Value::Double ? left.d : static_cast< double >( left.i );
+  const double fR = right.type == Value::Double ? right.d : static_cast< double >( right.i );
+
+  switch ( op )
+  {
+    case QgsExpressionNodeBinaryOperator::boPlus:
+    case QgsExpressionNodeBinaryOperator::boMinus:
+    case QgsExpressionNodeBinaryOperator::boMul:
+    case QgsExpressionNodeBinaryOperator::boMod:
+      if ( integers )
+      {
+        const qlonglong iL = left.i;
+        const qlonglong iR = right.i;
+        if ( op == QgsExpressionNodeBinaryOperator::boMod && iR == 0 )
+        {
+          setTvl( result, QgsExpressionUtils::Unknown );
+          return true;
+        }
+
+        qlonglong value = 0;
+        switch ( op )
+        {
+          case QgsExpressionNodeBinaryOperator::boPlus:
+            value = iL + iR;
+            break;
+          case QgsExpressionNodeBinaryOperator::boMinus:
+            value = iL - iR;
+            break;
+          case QgsExpressionNodeBinaryOperator::boMul:
+            value = iL * iR;
+            break;
+          default:
+            value = iL % iR;
+            break;
+        }
+        result.type = Value::LongLong;
+        result.i = value;
+        return true;
+      }
+      FALLTHROUGH;
+    case QgsExpressionNodeBinaryOperator::boDiv:
+    {
+      if ( !qIsFinite( fL ) || !qIsFinite( fR ) )
+        return false;
+      if ( ( op == QgsExpressionNodeBinaryOperator::boDiv || op == QgsExpressionNodeBinaryOperator::boMod ) && fR == 0. )
+      {
+        setTvl( result, QgsExpressionUtils::Unknown );
+        return true;
+      }
+
+      double value = 0;
+      switch ( op )
+      {
+        case QgsExpressionNodeBinaryOperator::boPlus:
+          value = fL + fR;
+          break;
+        case QgsExpressionNodeBinaryOperator::boMinus:
+          value = fL - fR;
+          break;
+        case QgsExpressionNodeBinaryOperator::boMul:
+          value = fL * fR;
+          break;
+        case QgsExpressionNodeBinaryOperator::boDiv:
+          value = fL / fR;
+          break;
+        default:
+          value = fmod( fL, fR );
+          break;
+      }
+      result.type = Value::Double;
+      result.d = value;
+      return true;
+    }
+
+    case QgsExpressionNodeBinaryOperator::boIntDiv:
+      if ( !qIsFinite( fL ) || !qIsFinite( fR ) )
+        return false;
+      if ( fR == 0. )
+      {
+        setTvl( result, QgsExpressionUtils::Unknown );
+        return true;
+      }
+      result.type = Value::Int;
+      result.i = qFloor( fL / fR );
+      return true;
+
+    case QgsExpressionNodeBinaryOperator::boPow:
+      if ( !qIsFinite( fL ) || !qIsFinite( fR ) )
+        return false;
+      result.type = Value::Double;
+      result.d = pow( fL, fR );
+      return true;
+
+    case QgsExpressionNodeBinaryOperator::boEQ:
+    case QgsExpressionNodeBinaryOperator::boNE:
+    case QgsExpressionNodeBinaryOperator::boLT:
+    case QgsExpressionNodeBinaryOperator::boGT:
+    case QgsExpressionNodeBinaryOperator::boLE:
+    case QgsExpressionNodeBinaryOperator::boGE:
+    {
+      if ( !qIsFinite( fL ) || !qIsFinite( fR ) )
+        return false;
+      const double diff = fL - fR;
+      bool value = false;
+      switch ( op )
+      {
+        case QgsExpressionNodeBinaryOperator::boEQ:
+          value = qgsDoubleNear( diff, 0.0 );
+          break;
+        case QgsExpressionNodeBinaryOperator::boNE:
+          value = !qgsDoubleNear( diff, 0.0 );
+          break;
+        case QgsExpressionNodeBinaryOperator::boLT:
+          value = diff < 0;
+          break;
+        case QgsExpressionNodeBinaryOperator::boGT:
+          value = diff > 0;
+          break;
+        case QgsExpressionNodeBinaryOperator::boLE:
+          value = diff <= 0;
+          break;
+        default:
+          value = diff >= 0;
+          break;
+      }
+      setTvl( result, value ? QgsExpressionUtils::True : QgsExpressionUtils::False );
+      return true;
+    }
+
+    case QgsExpressionNodeBinaryOperator::boIs:
+    case QgsExpressionNodeBinaryOperator::boIsNot:
+    {
+      if ( !qIsFinite( fL ) || !qIsFinite( fR ) )
+        return false;
+      const bool equal = qgsDoubleNear( fL, fR );
+      const bool value = op == QgsExpressionNodeBinaryOperator::boIs ? equal : !equal;
+      setTvl( result, value ? QgsExpressionUtils::True : QgsExpressionUtils::False );
+      return true;
+    }
+
+    default:
+      break;
+  }
+  return false;
+}
+
+void QgsExpressionProgram::evalIn( const Instruction &instruction, const Value &value, QgsExpression *parent, Value &result )
+{
+  // follows QgsExpressionNodeInOperator::evalNode(), the operand is in the result register
+  const InList &list = mInLists.at( instruction.b );
+  if ( isNull( value ) )
+  {
+    setTvl( result, QgsExpressionUtils::Unknown );
+    return;
+  }
+
+  const bool valueIsDoubleSafe = value.type != Value::Variant || QgsExpressionUtils::isDoubleSafe( value.v );
+  bool hasDouble = false;
+  double valueDouble = 0;
+  bool hasString = false;
+  QString valueString;
+  Q_FOREACH ( const InItem &item, list.items )
+  {
+    if ( item.isNull )
+      continue;
+
+    bool equal = false;
+    if ( valueIsDoubleSafe && item.isDoubleSafe )
+    {
+      if ( !hasDouble )
+      {
+        if ( value.type == Value::Int || value.type == Value::LongLong )
+          valueDouble = value.i;
+        else if ( value.type == Value::Double && qIsFinite( value.d ) )
+          valueDouble = value.d;
+        else
+          valueDouble = QgsExpressionUtils::getDoubleValue( toVariant( value ), parent );
+        if ( parent->hasEvalError() )
+          return;
+        hasDouble = true;
+      }
+      equal = qgsDoubleNear( valueDouble, item.doubleValue );
+    }
+    else
+    {
+      if ( !hasString )
+      {
+        valueString = toVariant( value ).toString();
+        hasString = true;
+      }
+      equal = QString::compare( valueString, item.stringValue ) == 0;
+    }
+
+    if ( equal )
+    {
+      setTvl( result, list.notIn ? QgsExpressionUtils::False : QgsExpressionUtils::True );
+      return;
+    }
+  }
+
+  if ( list.hasNull )
+    setTvl( result, QgsExpressionUtils::Unknown );
+  else
+    setTvl( result, list.notIn ? QgsExpressionUtils::True : QgsExpressionUtils::False );
+}
+
+QVariant QgsExpressionProgram::evaluate( QgsExpression *parent, const QgsExpressionContext *context )
+{
+  // the feature is fetched once instead of once per column reference
+  QgsFeature feature;
+  bool hasFeature = false;
+  if ( mUsesFeature && context && context->hasFeature() )
+  {
+    feature = context->feature();
+    hasFeature = true;
+  }
+
+  // registers belong to the evaluation, copies of an expression share the program
+  Value stackRegisters[STACK_REGISTER_COUNT];
+  QVector< Value > heapRegisters;
+  Value *registers = stackRegisters;
+  if ( mRegisterCount > STACK_REGISTER_COUNT )
+  {
+    heapRegisters.resize( mRegisterCount );
+    registers = heapRegisters.data();
+  }
+
+  const int count = mInstructions.size();
+  int pc = 0;
+  while ( pc < count )
+  {
+    pc = execute( pc, registers, 1, hasFeature ? &feature : nullptr, parent, context );
+    if ( pc < 0 )
+      return QVariant();
+  }
+
+  return toVariant( registers[0] );
+}
+
+void QgsExpressionProgram::evaluateBlock( QgsExpression *parent, QgsExpressionContext *context, const QgsFeature *features, int count, QVariant *results )
+{
+  const int instructionCount = mInstructions.size();
+  QString firstError;
+
+  // registers belong to the evaluation, copies of an expression share the program
+  QVector< Value > blockRegisters;
+  QVector< int > blockPcs;
+
+  for ( int offset = 0; offset < count; offset += BLOCK_SIZE )
+  {
+    // registers are stored by column, register r of row i is at r * rows + i
+    const int rows = count - offset < BLOCK_SIZE ? count - offset : BLOCK_SIZE;
+    blockRegisters.resize( mRegisterCount * rows );
+    blockPcs.fill( 0, rows );
+    Value *registers = blockRegisters.data();
+    int *pcs = blockPcs.data();
+
+    // jumps only go forward, so a single pass over the instructions runs every row to its end
+    for ( int pc = 0; pc < instructionCount; ++pc )
+    {
+      const OpCode code = mInstructions.at( pc ).code;
+      const bool needsContextFeature = code == EvalNode || code == CallBegin || code == Call;
+      for ( int row = 0; row < rows; ++row )
+      {
+        if ( pcs[row] != pc )
+          continue;
+
+        const QgsFeature &feature = features[offset + row];
+        if ( needsContextFeature )
+          context->setFeature( feature );
+
+        const int next = execute( pc, registers + row, rows, &feature, parent, context );
+        if ( next < 0 )
+        {
+          // the row fails alone, the first error is reported once the block is evaluated
+          if ( firstError.isNull() )
+            firstError = parent->evalErrorString();
+          parent->setEvalErrorString( QString() );
+        }
+        pcs[row] = next;
+      }
+    }
+
+    for ( int row = 0; row < rows; ++row )
+      results[offset + row] = pcs[row] < 0 ? QVariant() : toVariant( registers[row] );
+  }
+
+  if ( !firstError.isNull() )
+    parent->setEvalErrorString( firstError );
+}
+
+int QgsExpressionProgram::execute( int pc, Value *registers, int stride, const QgsFeature *feature, QgsExpression *parent, const QgsExpressionContext *context )
+{
+  const Instruction &instruction = mInstructions.at( pc++ );
+  Value &target = registers[instruction.target * stride];
+  switch ( instruction.code )
+  {
+    case LoadConstant:
+      target = mConstants.at( instruction.a );
+      return pc;
+
+    case LoadAttribute:
+      if ( feature )
+        setValue( target, feature->attribute( instruction.a ) );
+      else
+        setValue( target, QVariant( '[' + static_cast< QgsExpressionNodeColumnRef * >( instruction.node )->name() + ']' ) );
+      return pc;
+
+    case EvalNode:
+      setValue( target, instruction.node->eval( parent, context ) );
+      break;
+
+    case Unary:
+    {
+      QgsExpressionNodeUnaryOperator *unary = static_cast< QgsExpressionNodeUnaryOperator * >( instruction.node );
+      const Value &operand = registers[instruction.a * stride];
+      if ( unary->op() == QgsExpressionNodeUnaryOperator::uoNot )
+      {
+        const int tvl = tvlValue( operand, parent );
+        setTvl( target, QgsExpressionUtils::NOT[tvl] );
+      }
+      else if ( operand.type == Value::Int || operand.type == Value::LongLong )
+      {
+        target.i = -operand.i;
+        target.type = Value::LongLong;
+      }
+      else if ( operand.type == Value::Double && qIsFinite( operand.d ) )
+      {
+        target.d = -operand.d;
+        target.type = Value::Double;
+      }
+      else
+      {
+        setValue( target, unary->evalValue( parent, toVariant( operand ) ) );
+      }
+      break;
+    }
+
+    case Binary:
+    {
+      QgsExpressionNodeBinaryOperator *binary = static_cast< QgsExpressionNodeBinaryOperator * >( instruction.node );
+      const Value &left = registers[instruction.a * stride];
+      const Value &right = registers[instruction.b * stride];
+      const int op = binary->op();
+      if ( op == QgsExpressionNodeBinaryOperator::boAnd || op == QgsExpressionNodeBinaryOperator::boOr )
+      {
+        const int tvlL = tvlValue( left, parent );
+        const int tvlR = tvlValue( right, parent );
+        setTvl( target, op == QgsExpressionNodeBinaryOperator::boAnd ? QgsExpressionUtils::AND[tvlL][tvlR] : QgsExpressionUtils::OR[tvlL][tvlR] );
+        break;
+      }
+
+      if ( left.type != Value::Variant && right.type != Value::Variant && numericBinary( op, left, right, target ) )
+        return pc;
+
+      setValue( target, binary->evalValues( parent, context, toVariant( left ), toVariant( right ) ) );
+      break;
+    }
+
+    case In:
+      evalIn( instruction, registers[instruction.a * stride], parent, target );
+      break;
+
+    case JumpIfNotTrue:
+    {
+      const int tvl = tvlValue( registers[instruction.a * stride], parent );
+      if ( parent->hasEvalError() )
+        return -1;
+      return tvl != QgsExpressionUtils::True ? instruction.jump : pc;
+    }
+
+    case Jump:
+      return instruction.jump;
+
+    case CallBegin:
+    {
+      // a function of the context takes precedence, as in QgsExpressionNodeFunction::evalNode()
+      const FunctionCall &call = mCalls.at( instruction.b );
+      if ( context && context->hasFunction( call.name ) && context->function( call.name ) != call.function )
+      {
+        setValue( target, instruction.node->eval( parent, context ) );
+        if ( parent->hasEvalError() )
+          return -1;
+        return instruction.jump;
+      }
+      return pc;
+    }
+
+    case ArgNullCheck:
+      if ( isNull( registers[instruction.a * stride] ) )
+      {
+        setTvl( target, QgsExpressionUtils::Unknown );
+        return instruction.jump;
+      }
+      return pc;
+
+    case Call:
+    {
+      const FunctionCall &call = mCalls.at( instruction.b );
+      QVariantList args;
+      args.reserve( call.args.size() );
+      for ( int i = 0; i < call.args.size(); ++i )
+        args << toVariant( registers[call.args.at( i ) * stride] );
+      setValue( target, call.function->func( args, context, parent ) );
+      break;
+    }
+  }
+
+  return parent->hasEvalError() ? -1 : pc;
+}
+
+///@endcond
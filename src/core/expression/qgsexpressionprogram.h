@@ -0,0 +1,199 @@
+/***************************************************************************
+  qgsexpressionprogram.h
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSEXPRESSIONPROGRAM_H
+#define QGSEXPRESSIONPROGRAM_H
+
+#define SIP_NO_FILE
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+class QgsExpression;
+class QgsExpressionContext;
+class QgsExpressionFunction;
+class QgsFeature;
+class QgsExpressionNode;
+
+///@cond PRIVATE
+
+/**
+ * \ingroup core
+ * \class QgsExpressionProgram
+ * \brief A prepared QgsExpressionNode tree compiled to a linear list of instructions
+ * working on a register file.
+ *
+ * Nodes with a value cached by prepare() are folded to constants and column references
+ * are resolved to attribute indexes. Integer, double and boolean intermediate results
+ * are kept in typed registers, other values and null values are kept as QVariant. Operators
+ * fall back to the implementation of the nodes for values which are not numeric, so the
+ * results and errors are identical to QgsExpressionNode::eval().
+ *
+ * Nodes which cannot be compiled, like functions with lazy evaluated arguments or column
+ * references which are not found in the fields of the context, are evaluated by the node
+ * tree from within the program.
+ *
+ * Blocks of features can be evaluated at once with evaluateBlock(), which runs each
+ * instruction over all the features of the block before the next one.
+ *
+ * The registers are allocated by each evaluation, so the program shared by copies of
+ * an expression can be evaluated concurrently.
+ *
+ * \note not available in Python bindings
+ * \since QGIS 3.0
+ */
+class QgsExpressionProgram
+{
+  public:
+
+    /**
+     * Compiles the tree starting at \a rootNode, which must outlive the program.
+     * Column references are resolved with the fields of the \a context.
+     */
+    QgsExpressionProgram( QgsExpressionNode *rootNode, const QgsExpressionContext *context );
+
+    /**
+     * Evaluates the program. Evaluation errors are reported to \a parent.
+     */
+    QVariant evaluate( QgsExpression *parent, const QgsExpressionContext *context );
+
+    /**
+     * Evaluates the program for \a count \a features and stores the values in \a results.
+     * Attributes are read from the features directly, the feature of the \a context is only
+     * set for the parts of the expression evaluated by functions or by the node tree.
+     * Features which fail to evaluate get a null result and the first error is reported
+     * to \a parent.
+     */
+    void evaluateBlock( QgsExpression *parent, QgsExpressionContext *context, const QgsFeature *features, int count, QVariant *results );
+
+    /**
+     * Returns the number of instructions of the program.
+     */
+    int instructionCount() const { return mInstructions.size(); }
+
+    //! Number of features evaluated together by evaluateBlock()
+    static const int BLOCK_SIZE = 1024;
+
+    //! Number of registers evaluate() allocates on the stack
+    static const int STACK_REGISTER_COUNT = 16;
+
+  private:
+
+    enum OpCode
+    {
+      LoadConstant, //!< Loads constant a into the target register
+      LoadAttribute, //!< Loads the attribute a of the feature of the context into the target register
+      EvalNode, //!< Evaluates the node into the target register
+      Unary, //!< Applies the unary operator node to register a
+      Binary, //!< Applies the binary operator node to registers a and b
+      In, //!< Tests whether register a is in the constant list b
+      JumpIfNotTrue, //!< Jumps if register a is not true
+      Jump, //!< Jumps unconditionally
+      CallBegin, //!< Evaluates call b by the node tree and jumps if the context overrides the function
+      ArgNullCheck, //!< Sets the target register to null and jumps if register a is null
+      Call, //!< Calls the function of call b with its argument registers
+    };
+
+    struct Instruction
+    {
+      OpCode code;
+      int target;
+      int a;
+      int b;
+      int jump;
+      QgsExpressionNode *node;
+    };
+
+    //! A register, numeric values are not boxed into the variant
+    struct Value
+    {
+      enum Type
+      {
+        Variant, //!< Null and non-numeric values
+        Int, //!< QVariant::Int, the type of boolean results
+        LongLong,
+        Double,
+      };
+
+      Type type = Variant;
+      qlonglong i = 0;
+      double d = 0;
+      QVariant v;
+    };
+
+    //! A constant IN list
+    struct InItem
+    {
+      bool isNull;
+      bool isDoubleSafe;
+      double doubleValue;
+      QString stringValue;
+    };
+
+    struct InList
+    {
+      bool notIn;
+      bool hasNull;
+      QVector< InItem > items;
+    };
+
+    struct FunctionCall
+    {
+      QgsExpressionFunction *function;
+      QString name;
+      QVector< int > args;
+    };
+
+    //! Compiles \a node into the \a target register, registers from \a target + 1 can be used as temporaries
+    void compileNode( QgsExpressionNode *node, int target );
+
+    int append( OpCode code, int target, int a = 0, int b = 0, QgsExpressionNode *node = nullptr );
+    int addConstant( const QVariant &constant );
+    void useRegister( int index );
+
+    static void setValue( Value &value, const QVariant &variant );
+    static QVariant toVariant( const Value &value );
+    static bool isNull( const Value &value ) { return value.type == Value::Variant && value.v.isNull(); }
+
+    //! Returns the three value logic value of \a value, as QgsExpressionUtils::TVL
+    static int tvlValue( const Value &value, QgsExpression *parent );
+    static void setTvl( Value &value, int tvl );
+
+    //! Applies a binary operator to numeric registers, returns false if the node has to handle the values
+    static bool numericBinary( int op, const Value &left, const Value &right, Value &result );
+
+    void evalIn( const Instruction &instruction, const Value &value, QgsExpression *parent, Value &result );
+
+    /**
+     * Executes the instruction at \a pc, register r is at registers[r * stride].
+     * \returns the next instruction or -1 if an evaluation error occurred
+     */
+    int execute( int pc, Value *registers, int stride, const QgsFeature *feature, QgsExpression *parent, const QgsExpressionContext *context );
+
+    //! The context of the compilation
+    const QgsExpressionContext *mContext = nullptr;
+
+    QVector< Instruction > mInstructions;
+    QVector< Value > mConstants;
+    QVector< InList > mInLists;
+    QVector< FunctionCall > mCalls;
+    int mRegisterCount = 0;
+    bool mUsesFeature = false;
+};
+
+///@endcond
+
+#endif // QGSEXPRESSIONPROGRAM_H
@@ -24,9 +24,61 @@
 #include "qgsgeometry.h"
 #include "qgsgeometryengine.h"
 #include "qgswkbtypes.h"
+#include "qgsexpressionprogram.h"
 
 ///@cond PRIVATE
 
+/**
+ * Evaluates \a expression for blocks of the features of \a iterator and adds
+ * them to \a matchingSink or to \a nonMatchingSink depending on the result.
+ * The expression must be prepared.
+ */
+static void splitFeaturesByExpression( QgsFeatureIterator &iterator, QgsExpression &expression, QgsExpressionContext &context,
+                                       QgsFeatureSink *matchingSink, QgsFeatureSink *nonMatchingSink, double step, QgsProcessingFeedback *feedback )
+{
+  expression.compile( &context );
+
+  int current = 0;
+  QgsFeature f;
+  QgsFeatureList block;
+  block.reserve( QgsExpressionProgram::BLOCK_SIZE );
+  bool hasMoreFeatures = true;
+  while ( hasMoreFeatures && !feedback->isCanceled() )
+  {
+    block.clear();
+    while ( block.size() < QgsExpressionProgram::BLOCK_SIZE )
+    {
+      if ( !iterator.nextFeature( f ) )
+      {
+        hasMoreFeatures = false;
+        break;
+      }
+      block << f;
+    }
+
+    const QVariantList results = expression.evaluateFeatures( block, &context );
+    for ( int i = 0; i < block.size(); ++i )
+    {
+      if ( feedback->isCanceled() )
+      {
+        break;
+      }
+
+      if ( results.at( i ).toBool() )
+      {
+        matchingSink->addFeature( block[i], QgsFeatureSink::FastInsert );
+      }
+      else
+      {
+        nonMatchingSink->addFeature( block[i], QgsFeatureSink::FastInsert );
+      }
+
+      feedback->setProgress( current * step );
+      current++;
+    }
+  }
+}
+
 QgsNativeAlgorithms::QgsNativeAlgorithms( QObject *parent )
   : QgsProcessingProvider( parent )
 {}
@@ -805,6 +857,8 @@ QVariantMap QgsExtractByExpressionAlgorithm::processAlgorithm( const QVariantMap
     QgsFeatureRequest req;
     req.setFilterExpression( expressionString );
     req.setExpressionContext( expressionContext );
+    // every feature is read, so the filter can be evaluated for blocks of features
+    req.setFlags( QgsFeatureRequest::EvaluateFilterInBlocks );
 
     QgsFeatureIterator it = source->getFeatures( req );
     QgsFeature f;
@@ -828,27 +882,7 @@ QVariantMap QgsExtractByExpressionAlgorithm::processAlgorithm( const QVariantMap
     expression.prepare( &expressionContext );
 
     QgsFeatureIterator it = source->getFeatures();
-    QgsFeature f;
-    while ( it.nextFeature( f ) )
-    {
-      if ( feedback->isCanceled() )
-      {
-        break;
-      }
-
-      expressionContext.setFeature( f );
-      if ( expression.evaluate( &expressionContext ).toBool() )
-      {
-        matchingSink->addFeature( f, QgsFeatureSink::FastInsert );
-      }
-      else
-      {
-        nonMatchingSink->addFeature( f, QgsFeatureSink::FastInsert );
-      }
-
-      feedback->setProgress( current * step );
-      current++;
-    }
+    splitFeaturesByExpression( it, expression, expressionContext, matchingSink.get(), nonMatchingSink.get(), step, feedback );
   }
 
 
@@ -999,6 +1033,8 @@ QVariantMap QgsExtractByAttributeAlgorithm::processAlgorithm( const QVariantMap
     QgsFeatureRequest req;
     req.setFilterExpression( expr );
     req.setExpressionContext( expressionContext );
+    // every feature is read, so the filter can be evaluated for blocks of features
+    req.setFlags( QgsFeatureRequest::EvaluateFilterInBlocks );
 
     QgsFeatureIterator it = source->getFeatures( req );
     QgsFeature f;
@@ -1022,27 +1058,7 @@ QVariantMap QgsExtractByAttributeAlgorithm::processAlgorithm( const QVariantMap
     expression.prepare( &expressionContext );
 
     QgsFeatureIterator it = source->getFeatures();
-    QgsFeature f;
-    while ( it.nextFeature( f ) )
-    {
-      if ( feedback->isCanceled() )
-      {
-        break;
-      }
-
-      expressionContext.setFeature( f );
-      if ( expression.evaluate( &expressionContext ).toBool() )
-      {
-        matchingSink->addFeature( f, QgsFeatureSink::FastInsert );
-      }
-      else
-      {
-        nonMatchingSink->addFeature( f, QgsFeatureSink::FastInsert );
-      }
-
-      feedback->setProgress( current * step );
-      current++;
-    }
+    splitFeaturesByExpression( it, expression, expressionContext, matchingSink.get(), nonMatchingSink.get(), step, feedback );
   }
 
 
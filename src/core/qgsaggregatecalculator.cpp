@@ -21,7 +21,7 @@
 #include "qgsfeatureiterator.h"
 #include "qgsgeometry.h"
 #include "qgsvectorlayer.h"
-
+#include "qgsexpressionprogram.h"
 
 
 QgsAggregateCalculator::QgsAggregateCalculator( const QgsVectorLayer *layer )
@@ -69,6 +69,7 @@ QVariant QgsAggregateCalculator::calculate( QgsAggregateCalculator::Aggregate ag
     {
       return QVariant();
     }
+    expression->compile( context );
   }
 
   QSet<QString> lst;
@@ -77,10 +78,11 @@ QVariant QgsAggregateCalculator::calculate( QgsAggregateCalculator::Aggregate ag
   else
     lst = expression->referencedColumns();
 
+  // every feature is read, so the filter can be evaluated for blocks of features
   QgsFeatureRequest request = QgsFeatureRequest()
-                              .setFlags( ( expression && expression->needsGeometry() ) ?
-                                         QgsFeatureRequest::NoFlags :
-                                         QgsFeatureRequest::NoGeometry )
+                              .setFlags( ( ( expression && expression->needsGeometry() ) ?
+                                           QgsFeatureRequest::NoFlags :
+                                           QgsFeatureRequest::NoGeometry ) | QgsFeatureRequest::EvaluateFilterInBlocks )
                               .setSubsetOfAttributes( lst, mLayer->fields() );
   if ( !mFilterExpression.isEmpty() )
     request.setFilterExpression( mFilterExpression );
@@ -404,21 +406,12 @@ QVariant QgsAggregateCalculator::calculateNumericAggregate( QgsFeatureIterator &
   Q_ASSERT( expression || attr >= 0 );
 
   QgsStatisticalSummary s( stat );
-  QgsFeature f;
+  QVariantList values;
 
-  while ( fit.nextFeature( f ) )
+  while ( nextValues( fit, attr, expression, context, values ) )
   {
-    if ( expression )
-    {
-      Q_ASSERT( context );
-      context->setFeature( f );
-      QVariant v = expression->evaluate( context );
+    Q_FOREACH ( const QVariant &v, values )
       s.addVariant( v );
-    }
-    else
-    {
-      s.addVariant( f.attribute( attr ) );
-    }
   }
   s.finalize();
   double val = s.statistic( stat );
@@ -431,21 +424,12 @@ QVariant QgsAggregateCalculator::calculateStringAggregate( QgsFeatureIterator &f
   Q_ASSERT( expression || attr >= 0 );
 
   QgsStringStatisticalSummary s( stat );
-  QgsFeature f;
+  QVariantList values;
 
-  while ( fit.nextFeature( f ) )
+  while ( nextValues( fit, attr, expression, context, values ) )
   {
-    if ( expression )
-    {
-      Q_ASSERT( context );
-      context->setFeature( f );
-      QVariant v = expression->evaluate( context );
+    Q_FOREACH ( const QVariant &v, values )
       s.addValue( v );
-    }
-    else
-    {
-      s.addValue( f.attribute( attr ) );
-    }
   }
   s.finalize();
   return s.statistic( stat );
@@ -455,16 +439,16 @@ QVariant QgsAggregateCalculator::calculateGeometryAggregate( QgsFeatureIterator
 {
   Q_ASSERT( expression );
 
-  QgsFeature f;
+  QVariantList values;
   QList< QgsGeometry > geometries;
-  while ( fit.nextFeature( f ) )
+  while ( nextValues( fit, -1, expression, context, values ) )
   {
-    Q_ASSERT( context );
-    context->setFeature( f );
-    QVariant v = expression->evaluate( context );
-    if ( v.canConvert<QgsGeometry>() )
+    Q_FOREACH ( const QVariant &v, values )
     {
-      geometries << v.value<QgsGeometry>();
+      if ( v.canConvert<QgsGeometry>() )
+      {
+        geometries << v.value<QgsGeometry>();
+      }
     }
   }
 
@@ -476,24 +460,17 @@ QVariant QgsAggregateCalculator::concatenateStrings( QgsFeatureIterator &fit, in
 {
   Q_ASSERT( expression || attr >= 0 );
 
-  QgsFeature f;
+  QVariantList values;
   QString result;
-  while ( fit.nextFeature( f ) )
+  while ( nextValues( fit, attr, expression, context, values ) )
   {
-    if ( !result.isEmpty() )
-      result += delimiter;
-
-    if ( expression )
+    Q_FOREACH ( const QVariant &v, values )
     {
-      Q_ASSERT( context );
-      context->setFeature( f );
-      QVariant v = expression->evaluate( context );
+      if ( !result.isEmpty() )
+        result += delimiter;
+
       result += v.toString();
     }
-    else
-    {
-      result += f.attribute( attr ).toString();
-    }
   }
   return result;
 }
@@ -540,22 +517,40 @@ QVariant QgsAggregateCalculator::calculateDateTimeAggregate( QgsFeatureIterator
   Q_ASSERT( expression || attr >= 0 );
 
   QgsDateTimeStatisticalSummary s( stat );
-  QgsFeature f;
+  QVariantList values;
 
-  while ( fit.nextFeature( f ) )
+  while ( nextValues( fit, attr, expression, context, values ) )
   {
-    if ( expression )
-    {
-      Q_ASSERT( context );
-      context->setFeature( f );
-      QVariant v = expression->evaluate( context );
+    Q_FOREACH ( const QVariant &v, values )
       s.addValue( v );
-    }
-    else
-    {
-      s.addValue( f.attribute( attr ) );
-    }
   }
   s.finalize();
   return s.statistic( stat );
 }
+
+bool QgsAggregateCalculator::nextValues( QgsFeatureIterator &fit, int attr, QgsExpression *expression,
+    QgsExpressionContext *context, QVariantList &values )
+{
+  Q_ASSERT( expression || attr >= 0 );
+
+  values.clear();
+  QgsFeature f;
+  if ( !expression )
+  {
+    while ( values.size() < QgsExpressionProgram::BLOCK_SIZE && fit.nextFeature( f ) )
+      values << f.attribute( attr );
+    return !values.isEmpty();
+  }
+
+  // the expression is evaluated for a block of features at once
+  Q_ASSERT( context );
+  QgsFeatureList features;
+  features.reserve( QgsExpressionProgram::BLOCK_SIZE );
+  while ( features.size() < QgsExpressionProgram::BLOCK_SIZE && fit.nextFeature( f ) )
+    features << f;
+  if ( features.isEmpty() )
+    return false;
+
+  values = expression->evaluateFeatures( features, context );
+  return true;
+}
@@ -172,6 +172,14 @@ class CORE_EXPORT QgsAggregateCalculator
     static QVariant concatenateStrings( QgsFeatureIterator &fit, int attr, QgsExpression *expression,
                                         QgsExpressionContext *context, const QString &delimiter );
 
+    /**
+     * Fetches the next block of features from \a fit and stores the values of the
+     * attribute \a attr, or of the \a expression if set, in \a values.
+     * \returns false once all features have been fetched
+     */
+    static bool nextValues( QgsFeatureIterator &fit, int attr, QgsExpression *expression,
+                            QgsExpressionContext *context, QVariantList &values );
+
     QVariant defaultValue( Aggregate aggregate ) const;
 };
 
@@ -24,6 +24,7 @@
 #include "qgsdistancearea.h"
 #include "qgsunittypes.h"
 #include "qgsexpressionnode.h"
+#include "qgsexpressionprogram.h"
 
 ///@cond
 
@@ -43,6 +44,7 @@ class QgsExpressionPrivate
       , mAreaUnit( QgsUnitTypes::AreaUnknownUnit )
     {}
 
+    //! The program is not copied, it refers to the nodes of the tree
     QgsExpressionPrivate( const QgsExpressionPrivate &other )
       : ref( 1 )
       , mRootNode( other.mRootNode ? other.mRootNode->clone() : nullptr )
@@ -56,6 +58,7 @@ class QgsExpressionPrivate
 
     ~QgsExpressionPrivate()
     {
+      mProgram.reset();
       delete mRootNode;
     }
 
@@ -63,6 +66,9 @@ class QgsExpressionPrivate
 
     QgsExpressionNode *mRootNode = nullptr;
 
+    //! Program compiled from the root node, if any
+    std::unique_ptr<QgsExpressionProgram> mProgram;
+
     QString mParserErrorString;
     QString mEvalErrorString;
 
@@ -18,6 +18,7 @@
 #include "qgssimplifymethod.h"
 #include "qgsexception.h"
 #include "qgsexpressionsorter.h"
+#include "qgsexpressionprogram.h"
 
 QgsAbstractFeatureIterator::QgsAbstractFeatureIterator( const QgsFeatureRequest &request )
   : mRequest( request )
@@ -27,6 +28,8 @@ QgsAbstractFeatureIterator::QgsAbstractFeatureIterator( const QgsFeatureRequest
   , mFetchedCount( 0 )
   , mCompileStatus( NoCompilation )
   , mUseCachedFeatures( false )
+  , mFilterBlockIndex( 0 )
+  , mFilterCompiled( false )
 {
 }
 
@@ -79,13 +82,65 @@ bool QgsAbstractFeatureIterator::nextFeature( QgsFeature &f )
 
 bool QgsAbstractFeatureIterator::nextFeatureFilterExpression( QgsFeature &f )
 {
-  while ( fetchFeature( f ) )
+  // fetching ahead is only worth it for requests reading all their features
+  if ( !( mRequest.flags() & QgsFeatureRequest::EvaluateFilterInBlocks ) )
   {
-    mRequest.expressionContext()->setFeature( f );
-    if ( mRequest.filterExpression()->evaluate( mRequest.expressionContext() ).toBool() )
-      return true;
+    while ( fetchFeature( f ) )
+    {
+      mRequest.expressionContext()->setFeature( f );
+      if ( mRequest.filterExpression()->evaluate( mRequest.expressionContext() ).toBool() )
+        return true;
+    }
+    return false;
   }
-  return false;
+
+  Q_FOREVER
+  {
+    while ( mFilterBlockIndex < mFilterBlock.size() )
+    {
+      const int index = mFilterBlockIndex++;
+      if ( mFilterResults.at( index ).toBool() )
+      {
+        f = mFilterBlock.at( index );
+        return true;
+      }
+    }
+
+    if ( !fetchFilterBlock() )
+      return false;
+  }
+}
+
+bool QgsAbstractFeatureIterator::fetchFilterBlock()
+{
+  clearFilterBlock();
+
+  // do not fetch more features than the limit of the request could return
+  long blockSize = QgsExpressionProgram::BLOCK_SIZE;
+  if ( mRequest.limit() >= 0 )
+    blockSize = qBound( 1L, mRequest.limit() - mFetchedCount, blockSize );
+
+  QgsFeature f;
+  while ( mFilterBlock.size() < blockSize && fetchFeature( f ) )
+    mFilterBlock << f;
+  if ( mFilterBlock.isEmpty() )
+    return false;
+
+  QgsExpression *expression = mRequest.filterExpression();
+  if ( !mFilterCompiled )
+  {
+    expression->compile( mRequest.expressionContext() );
+    mFilterCompiled = true;
+  }
+  mFilterResults = expression->evaluateFeatures( mFilterBlock, mRequest.expressionContext() );
+  return true;
+}
+
+void QgsAbstractFeatureIterator::clearFilterBlock()
+{
+  mFilterBlock.clear();
+  mFilterResults.clear();
+  mFilterBlockIndex = 0;
 }
 
 bool QgsAbstractFeatureIterator::nextFeatureFilterFids( QgsFeature &f )
@@ -91,7 +91,9 @@ class CORE_EXPORT QgsAbstractFeatureIterator
 
     /**
      * By default, the iterator will fetch all features and check if the feature
-     * matches the expression.
+     * matches the expression. With the EvaluateFilterInBlocks flag of the request,
+     * features are fetched in blocks and the compiled expression is evaluated for a
+     * whole block at once.
      * If you have a more sophisticated metodology (SQL request for the features...)
      * and you check for the expression in your fetchFeature method, you can just
      * redirect this call to fetchFeature so the default check will be omitted.
@@ -174,6 +176,20 @@ class CORE_EXPORT QgsAbstractFeatureIterator
     QList<QgsIndexedFeature> mCachedFeatures;
     QList<QgsIndexedFeature>::ConstIterator mFeatureIterator;
 
+    //! Features fetched by nextFeatureFilterExpression() and not returned yet
+    QgsFeatureList mFilterBlock;
+    //! Values of the filter expression for the features of mFilterBlock
+    QVariantList mFilterResults;
+    //! Index of the next feature to test in mFilterBlock
+    int mFilterBlockIndex;
+    //! Whether the filter expression has been compiled
+    bool mFilterCompiled;
+
+    //! Fetches and evaluates the next block of features for nextFeatureFilterExpression()
+    bool fetchFilterBlock();
+    //! Drops the features fetched by nextFeatureFilterExpression() and not returned yet
+    void clearFilterBlock();
+
     //! returns whether the iterator supports simplify geometries on provider side
     virtual bool providerCanSimplify( QgsSimplifyMethod::MethodType methodType ) const;
 
@@ -333,7 +349,10 @@ inline bool QgsFeatureIterator::nextFeature( QgsFeature &f )
 inline bool QgsFeatureIterator::rewind()
 {
   if ( mIter )
+  {
     mIter->mFetchedCount = 0;
+    mIter->clearFilterBlock();
+  }
 
   return mIter ? mIter->rewind() : false;
 }
@@ -341,7 +360,10 @@ inline bool QgsFeatureIterator::rewind()
 inline bool QgsFeatureIterator::close()
 {
   if ( mIter )
+  {
     mIter->mFetchedCount = 0;
+    mIter->clearFilterBlock();
+  }
 
   return mIter ? mIter->close() : false;
 }
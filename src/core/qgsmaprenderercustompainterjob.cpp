@@ -199,6 +199,7 @@ void QgsMapRendererCustomPainterJob::futureFinished()
   mRenderingTime = mRenderingStart.elapsed();
   QgsDebugMsg( "QPAINTER futureFinished" );
 
+  storeRenderingTimes( mLayerJobs, mLabelJob );
   logRenderingTime( mLayerJobs, mLabelJob );
 
   // final cleanup
@@ -495,6 +495,17 @@ QImage QgsMapRendererJob::composeImage( const QgsMapSettings &settings, const La
   return image;
 }
 
+void QgsMapRendererJob::storeRenderingTimes( const LayerRenderJobs &jobs, const LabelRenderJob &labelJob )
+{
+  mPerLayerRenderingTime.clear();
+  Q_FOREACH ( const LayerRenderJob &job, jobs )
+  {
+    if ( job.layer && job.renderingTime >= 0 )
+      mPerLayerRenderingTime.insert( job.layer, job.renderingTime );
+  }
+  mLabelingTime = labelJob.renderingTime;
+}
+
 void QgsMapRendererJob::logRenderingTime( const LayerRenderJobs &jobs, const LabelRenderJob &labelJob )
 {
   QgsSettings settings;
@@ -20,6 +20,7 @@
 #include "qgis_sip.h"
 #include "qgis.h"
 #include <QFutureWatcher>
+#include <QHash>
 #include <QImage>
 #include <QPainter>
 #include <QObject>
@@ -189,6 +190,20 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
     //! Find out how long it took to finish the job (in milliseconds)
     int renderingTime() const { return mRenderingTime; }
 
+    /**
+     * Returns how long it took to render each layer (in milliseconds), once the job is finished.
+     * \note not available in Python bindings
+     * \since QGIS 3.0
+     */
+    QHash< QgsMapLayer *, int > perLayerRenderingTime() const SIP_SKIP { return mPerLayerRenderingTime; }
+
+    /**
+     * Returns how long it took to draw the labels (in milliseconds), once the job is finished.
+     * Returns -1 if labels were not drawn.
+     * \since QGIS 3.0
+     */
+    int labelingTime() const { return mLabelingTime; }
+
     /**
      * Return map settings with which this job was started.
      * \returns A QgsMapSettings instance with render settings
@@ -226,6 +241,12 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
 
     int mRenderingTime = 0;
 
+    //! Rendering time of each layer, stored when the job is finished
+    QHash< QgsMapLayer *, int > mPerLayerRenderingTime;
+
+    //! Labeling time, stored when the job is finished
+    int mLabelingTime = -1;
+
     /**
      * Prepares the cache for storing the result of labeling. Returns false if
      * the render cannot use cached labels and should not cache the result.
@@ -246,6 +267,13 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
     //! \note not available in Python bindings
     static QImage composeImage( const QgsMapSettings &settings, const LayerRenderJobs &jobs, const LabelRenderJob &labelJob ) SIP_SKIP;
 
+    /**
+     * Stores the rendering times of the layers and of the labels.
+     * \note not available in Python bindings
+     * \since QGIS 3.0
+     */
+    void storeRenderingTimes( const LayerRenderJobs &jobs, const LabelRenderJob &labelJob ) SIP_SKIP;
+
     //! \note not available in Python bindings
     void logRenderingTime( const LayerRenderJobs &jobs, const LabelRenderJob &labelJob ) SIP_SKIP;
 
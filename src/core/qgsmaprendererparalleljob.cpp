@@ -25,6 +25,7 @@
 
 #include <QtConcurrentMap>
 #include <QtConcurrentRun>
+#include <QThreadPool>
 
 QgsMapRendererParallelJob::QgsMapRendererParallelJob( const QgsMapSettings &settings )
   : QgsMapRendererQImageJob( settings )
@@ -67,10 +68,30 @@ void QgsMapRendererParallelJob::start()
 
   connect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderLayersFinished );
 
-  mFuture = QtConcurrent::map( mLayerJobs, renderLayerStatic );
+  if ( mThreadPool )
+    mFuture = QtConcurrent::run( renderLayersOnPoolStatic, this );
+  else
+    mFuture = QtConcurrent::map( mLayerJobs, renderLayerStatic );
   mFutureWatcher.setFuture( mFuture );
 }
 
+void QgsMapRendererParallelJob::setMaxThreads( int maxThreads )
+{
+  Q_ASSERT( !isActive() );
+
+  mMaxThreads = qMax( maxThreads, 0 );
+  if ( mMaxThreads > 0 )
+  {
+    if ( !mThreadPool )
+      mThreadPool.reset( new QThreadPool() );
+    mThreadPool->setMaxThreadCount( mMaxThreads );
+  }
+  else
+  {
+    mThreadPool.reset();
+  }
+}
+
 void QgsMapRendererParallelJob::cancel()
 {
   if ( !isActive() )
@@ -207,7 +228,10 @@ void QgsMapRendererParallelJob::renderLayersFinished()
     connect( &mLabelingFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderingFinished );
 
     // now start rendering of labeling!
-    mLabelingFuture = QtConcurrent::run( renderLabelsStatic, this );
+    if ( mThreadPool )
+      mLabelingFuture = QtConcurrent::run( mThreadPool.get(), renderLabelsStatic, this );
+    else
+      mLabelingFuture = QtConcurrent::run( renderLabelsStatic, this );
     mLabelingFutureWatcher.setFuture( mLabelingFuture );
     emit renderingLayersFinished();
   }
@@ -221,6 +245,7 @@ void QgsMapRendererParallelJob::renderingFinished()
 {
   QgsDebugMsg( "PARALLEL finished" );
 
+  storeRenderingTimes( mLayerJobs, mLabelJob );
   logRenderingTime( mLayerJobs, mLabelJob );
 
   cleanupJobs( mLayerJobs );
@@ -275,6 +300,18 @@ void QgsMapRendererParallelJob::renderLayerStatic( LayerRenderJob &job )
   QgsDebugMsgLevel( QString( "job %1 end [%2 ms] (layer %3)" ).arg( reinterpret_cast< quint64 >( &job ), 0, 16 ).arg( job.renderingTime ).arg( job.layer ? job.layer->id() : QString() ), 2 );
 }
 
+void QgsMapRendererParallelJob::renderLayersOnPoolStatic( QgsMapRendererParallelJob *self )
+{
+  // QtConcurrent::map() has no thread pool argument: the layers are dispatched
+  // one by one to the pool of the job and this thread waits for all of them.
+  // This thread belongs to the global pool and stays busy until the layers are rendered
+  for ( LayerRenderJobs::iterator it = self->mLayerJobs.begin(); it != self->mLayerJobs.end(); ++it )
+  {
+    LayerRenderJob *job = &( *it );
+    QtConcurrent::run( self->mThreadPool.get(), [job]() { renderLayerStatic( *job ); } );
+  }
+  self->mThreadPool->waitForDone();
+}
 
 void QgsMapRendererParallelJob::renderLabelsStatic( QgsMapRendererParallelJob *self )
 {
@@ -20,6 +20,10 @@
 #include "qgis_sip.h"
 #include "qgsmaprendererjob.h"
 
+#include <memory>
+
+class QThreadPool;
+
 /** \ingroup core
  * Job implementation that renders all layers in parallel.
  *
@@ -47,6 +51,24 @@ class CORE_EXPORT QgsMapRendererParallelJob : public QgsMapRendererQImageJob
     // from QgsMapRendererJobWithPreview
     virtual QImage renderedImage() override;
 
+    /** Sets the maximum number of threads rendering the layers and the labels of this job.
+     * The job then uses its own thread pool instead of the global one, so that
+     * concurrent jobs do not compete for the threads of each other.
+     * A thread of the global pool still dispatches the layers to the pool of the
+     * job and waits for them, so each running job holds one global pool thread.
+     * A value of 0 or less uses the global thread pool (the default).
+     * Must be called before start().
+     * \see maxThreads()
+     * \since QGIS 3.0
+     */
+    void setMaxThreads( int maxThreads );
+
+    /** Returns the maximum number of threads of this job, or 0 if it uses the global thread pool.
+     * \see setMaxThreads()
+     * \since QGIS 3.0
+     */
+    int maxThreads() const { return mMaxThreads; }
+
   private slots:
     //! layers are rendered, labeling is still pending
     void renderLayersFinished();
@@ -59,6 +81,8 @@ class CORE_EXPORT QgsMapRendererParallelJob : public QgsMapRendererQImageJob
     static void renderLayerStatic( LayerRenderJob &job ) SIP_SKIP;
     //! \note not available in Python bindings
     static void renderLabelsStatic( QgsMapRendererParallelJob *self ) SIP_SKIP;
+    //! Renders the layers on the thread pool of the job and waits for them, in a thread of the global pool
+    static void renderLayersOnPoolStatic( QgsMapRendererParallelJob *self ) SIP_SKIP;
 
     QImage mFinalImage;
 
@@ -76,6 +100,9 @@ class CORE_EXPORT QgsMapRendererParallelJob : public QgsMapRendererQImageJob
     QFuture<void> mLabelingFuture;
     QFutureWatcher<void> mLabelingFutureWatcher;
 
+    int mMaxThreads = 0;
+    std::unique_ptr< QThreadPool > mThreadPool;
+
 };
 
 
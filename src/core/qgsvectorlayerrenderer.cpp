@@ -164,6 +164,12 @@ bool QgsVectorLayerRenderer::render()
   {
     featureRequest.combineFilterExpression( rendererFilter );
   }
+  // all the features of the extent are drawn, so the filter can be evaluated
+  // in blocks. A canceled render reads at most one block ahead.
+  if ( featureRequest.filterType() == QgsFeatureRequest::FilterExpression )
+  {
+    featureRequest.setFlags( featureRequest.flags() | QgsFeatureRequest::EvaluateFilterInBlocks );
+  }
 
   // enable the simplification of the geometries (Using the current map2pixel context) before send it to renderer engine.
   if ( mSimplifyGeometry )
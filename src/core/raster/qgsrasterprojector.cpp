@@ -23,6 +23,9 @@
 #include "qgscoordinatetransform.h"
 #include "qgsexception.h"
 
+#include <QThread>
+#include <QtConcurrentMap>
+
 
 QgsRasterProjector::QgsRasterProjector()
   : QgsRasterInterface( nullptr )
@@ -43,6 +46,7 @@ QgsRasterProjector *QgsRasterProjector::clone() const
   projector->mSrcDatumTransform = mSrcDatumTransform;
   projector->mDestDatumTransform = mDestDatumTransform;
   projector->mPrecision = mPrecision;
+  projector->mThreadCount = mThreadCount;
   return projector;
 }
 
@@ -63,6 +67,72 @@ Qgis::DataType QgsRasterProjector::dataType( int bandNo ) const
 
 /// @cond PRIVATE
 
+//! Minimum number of destination pixels per stripe filled by a thread
+static const int MIN_STRIPE_PIXELS = 1 << 15;
+
+/**
+ * Fills a stripe of contiguous rows of a reprojected block.
+ */
+struct ProjectStripeWrapper
+{
+  ProjectStripeWrapper( const ProjectorData *pd, QgsRasterBlock *input, QgsRasterBlock *output, const char *srcData, char *destData,
+                        qgssize pixelSize, bool doNoData, int width, int height, int stripeCount, QgsRasterBlockFeedback *feedback )
+    : pd( pd )
+    , input( input )
+    , output( output )
+    , srcData( srcData )
+    , destData( destData )
+    , pixelSize( pixelSize )
+    , doNoData( doNoData )
+    , width( width )
+    , height( height )
+    , stripeCount( stripeCount )
+    , feedback( feedback )
+  {}
+
+  void operator()( int stripe )
+  {
+    ProjectorData::RowHelper helper;
+    QVector< qint64 > srcIndexes( width );
+    const int endRow = static_cast< int >( static_cast< qint64 >( height ) * ( stripe + 1 ) / stripeCount );
+    for ( int i = static_cast< int >( static_cast< qint64 >( height ) * stripe / stripeCount ); i < endRow; ++i )
+    {
+      if ( feedback && feedback->isCanceled() )
+        break;
+
+      pd->srcIndexes( i, helper, srcIndexes.data() );
+      for ( int j = 0; j < width; ++j )
+      {
+        const qint64 srcIndex = srcIndexes.at( j );
+        if ( srcIndex < 0 ) continue; // we have everything set to no data
+
+        // isNoData() may be slow so we check doNoData first
+        if ( doNoData && input->isNoData( static_cast< qgssize >( srcIndex ) ) )
+        {
+          output->setIsNoData( i, j );
+          continue;
+        }
+
+        qgssize destIndex = static_cast< qgssize >( i ) * width + j;
+        memcpy( destData + destIndex * pixelSize, srcData + static_cast< qgssize >( srcIndex ) * pixelSize, pixelSize );
+        output->setIsData( i, j );
+      }
+    }
+  }
+
+  const ProjectorData *pd = nullptr;
+  QgsRasterBlock *input = nullptr;
+  QgsRasterBlock *output = nullptr;
+  const char *srcData = nullptr;
+  char *destData = nullptr;
+  qgssize pixelSize = 0;
+  bool doNoData = false;
+  int width = 0;
+  int height = 0;
+  int stripeCount = 1;
+  QgsRasterBlockFeedback *feedback = nullptr;
+};
+
 
 void QgsRasterProjector::setCrs( const QgsCoordinateReferenceSystem &srcCRS, const QgsCoordinateReferenceSystem &destCRS, int srcDatumTransform, int destDatumTransform )
 {
@@ -87,9 +157,6 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   , mSrcYRes( 0.0 )
   , mDestRowsPerMatrixRow( 0.0 )
   , mDestColsPerMatrixCol( 0.0 )
-  , pHelperTop( nullptr )
-  , pHelperBottom( nullptr )
-  , mHelperTopRow( 0 )
   , mCPCols( 0 )
   , mCPRows( 0 )
   , mSqrTolerance( 0.0 )
@@ -139,20 +206,9 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   // Always try to calculate mCPMatrix, it is used in calcSrcExtent() for both Approximate and Exact
   // Initialize the matrix by corners and middle points
   mCPCols = mCPRows = 3;
-  for ( int i = 0; i < mCPRows; i++ )
-  {
-    QList<QgsPointXY> myRow;
-    myRow.append( QgsPointXY() );
-    myRow.append( QgsPointXY() );
-    myRow.append( QgsPointXY() );
-    mCPMatrix.insert( i, myRow );
-    // And the legal points
-    QList<bool> myLegalRow;
-    myLegalRow.append( bool( false ) );
-    myLegalRow.append( bool( false ) );
-    myLegalRow.append( bool( false ) );
-    mCPLegalMatrix.insert( i, myLegalRow );
-  }
+  mCPMatrix.resize( mCPRows * mCPCols );
+  // And the legal points
+  mCPLegalMatrix.fill( false, mCPRows * mCPCols );
   for ( int i = 0; i < mCPRows; i++ )
   {
     calcRow( i, inverseCt );
@@ -192,13 +248,6 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   QgsDebugMsgLevel( "CPMatrix:", 5 );
   QgsDebugMsgLevel( cpToString(), 5 );
 
-  // init helper points
-  pHelperTop = new QgsPointXY[mDestCols];
-  pHelperBottom = new QgsPointXY[mDestCols];
-  calcHelper( 0, pHelperTop );
-  calcHelper( 1, pHelperBottom );
-  mHelperTopRow = 0;
-
   // Calculate source dimensions
   calcSrcExtent();
   calcSrcRowsCols();
@@ -206,13 +255,6 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   mSrcXRes = mSrcExtent.width() / mSrcCols;
 }
 
-ProjectorData::~ProjectorData()
-{
-  delete[] pHelperTop;
-  delete[] pHelperBottom;
-}
-
-
 void ProjectorData::calcSrcExtent()
 {
   /* Run around the mCPMatrix and find source extent */
@@ -223,17 +265,14 @@ void ProjectorData::calcSrcExtent()
   // For now, we run through all matrix
   // mCPMatrix is used for both Approximate and Exact because QgsCoordinateTransform::transformBoundingBox()
   // is not precise enough, see #13665
-  QgsPointXY myPoint = mCPMatrix[0][0];
+  QgsPointXY myPoint = mCPMatrix[0];
   mSrcExtent = QgsRectangle( myPoint.x(), myPoint.y(), myPoint.x(), myPoint.y() );
-  for ( int i = 0; i < mCPRows; i++ )
+  for ( int i = 0; i < mCPRows * mCPCols; i++ )
   {
-    for ( int j = 0; j < mCPCols ; j++ )
+    myPoint = mCPMatrix[i];
+    if ( mCPLegalMatrix[i] )
     {
-      myPoint = mCPMatrix[i][j];
-      if ( mCPLegalMatrix[i][j] )
-      {
-        mSrcExtent.combineExtentWith( myPoint.x(), myPoint.y() );
-      }
+      mSrcExtent.combineExtentWith( myPoint.x(), myPoint.y() );
     }
   }
   // Expand a bit to avoid possible approx coords falling out because of representation error?
@@ -288,8 +327,8 @@ QString ProjectorData::cpToString()
     {
       if ( j > 0 )
         myString += QLatin1String( "  " );
-      QgsPointXY myPoint = mCPMatrix[i][j];
-      if ( mCPLegalMatrix[i][j] )
+      QgsPointXY myPoint = mCPMatrix[i * mCPCols + j];
+      if ( mCPLegalMatrix[i * mCPCols + j] )
       {
         myString += myPoint.toString();
       }
@@ -322,10 +361,13 @@ void ProjectorData::calcSrcRowsCols()
     {
       for ( int j = 0; j < mCPCols - 1; j++ )
       {
-        QgsPointXY myPointA = mCPMatrix[i][j];
-        QgsPointXY myPointB = mCPMatrix[i][j + 1];
-        QgsPointXY myPointC = mCPMatrix[i + 1][j];
-        if ( mCPLegalMatrix[i][j] && mCPLegalMatrix[i][j + 1] && mCPLegalMatrix[i + 1][j] )
+        const int myIndexA = i * mCPCols + j;
+        const int myIndexB = myIndexA + 1;
+        const int myIndexC = myIndexA + mCPCols;
+        QgsPointXY myPointA = mCPMatrix[myIndexA];
+        QgsPointXY myPointB = mCPMatrix[myIndexB];
+        QgsPointXY myPointC = mCPMatrix[myIndexC];
+        if ( mCPLegalMatrix[myIndexA] && mCPLegalMatrix[myIndexB] && mCPLegalMatrix[myIndexC] )
         {
           double mySize = sqrt( myPointA.sqrDist( myPointB ) ) / myDestColsPerMatrixCell;
           if ( mySize < myMinSize )
@@ -376,22 +418,22 @@ void ProjectorData::calcSrcRowsCols()
 }
 
 
-inline void ProjectorData::destPointOnCPMatrix( int row, int col, double *theX, double *theY )
+inline void ProjectorData::destPointOnCPMatrix( int row, int col, double *theX, double *theY ) const
 {
   *theX = mDestExtent.xMinimum() + col * mDestExtent.width() / ( mCPCols - 1 );
   *theY = mDestExtent.yMaximum() - row * mDestExtent.height() / ( mCPRows - 1 );
 }
 
-inline int ProjectorData::matrixRow( int destRow )
+inline int ProjectorData::matrixRow( int destRow ) const
 {
   return static_cast< int >( floor( ( destRow + 0.5 ) / mDestRowsPerMatrixRow ) );
 }
-inline int ProjectorData::matrixCol( int destCol )
+inline int ProjectorData::matrixCol( int destCol ) const
 {
   return static_cast< int >( floor( ( destCol + 0.5 ) / mDestColsPerMatrixCol ) );
 }
 
-void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points )
+void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points ) const
 {
   // TODO?: should we also precalc dest cell center coordinates for x and y?
   for ( int myDestCol = 0; myDestCol < mDestCols; myDestCol++ )
@@ -407,8 +449,8 @@ void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points )
 
     double xfrac = ( myDestX - myDestXMin ) / ( myDestXMax - myDestXMin );
 
-    QgsPointXY &mySrcPoint0 = mCPMatrix[matrixRow][myMatrixCol];
-    QgsPointXY &mySrcPoint1 = mCPMatrix[matrixRow][myMatrixCol + 1];
+    const QgsPointXY &mySrcPoint0 = mCPMatrix[matrixRow * mCPCols + myMatrixCol];
+    const QgsPointXY &mySrcPoint1 = mCPMatrix[matrixRow * mCPCols + myMatrixCol + 1];
     double s = mySrcPoint0.x() + ( mySrcPoint1.x() - mySrcPoint0.x() ) * xfrac;
     double t = mySrcPoint0.y() + ( mySrcPoint1.y() - mySrcPoint0.y() ) * xfrac;
 
@@ -417,153 +459,152 @@ void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points )
   }
 }
 
-void ProjectorData::nextHelper()
-{
-  // We just switch pHelperTop and pHelperBottom, memory is not lost
-  QgsPointXY *tmp = nullptr;
-  tmp = pHelperTop;
-  pHelperTop = pHelperBottom;
-  pHelperBottom = tmp;
-  calcHelper( mHelperTopRow + 2, pHelperBottom );
-  mHelperTopRow++;
-}
-
-bool ProjectorData::srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+void ProjectorData::srcIndexes( int destRow, RowHelper &helper, qint64 *srcIndexes ) const
 {
   if ( mApproximate )
   {
-    return approximateSrcRowCol( destRow, destCol, srcRow, srcCol );
+    approximateSrcIndexes( destRow, helper, srcIndexes );
   }
   else
   {
-    return preciseSrcRowCol( destRow, destCol, srcRow, srcCol );
+    preciseSrcIndexes( destRow, helper, srcIndexes );
   }
 }
 
-bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+inline qint64 ProjectorData::srcIndex( double x, double y ) const
 {
-#ifdef QGISDEBUG
-  QgsDebugMsgLevel( QString( "theDestRow = %1" ).arg( destRow ), 5 );
-  QgsDebugMsgLevel( QString( "theDestRow = %1 mDestExtent.yMaximum() = %2 mDestYRes = %3" ).arg( destRow ).arg( mDestExtent.yMaximum() ).arg( mDestYRes ), 5 );
-#endif
+  if ( !( mExtent.xMinimum() <= x && x <= mExtent.xMaximum() && mExtent.yMinimum() <= y && y <= mExtent.yMaximum() ) )
+  {
+    return -1;
+  }
 
-  // Get coordinate of center of destination cell
-  double x = mDestExtent.xMinimum() + ( destCol + 0.5 ) * mDestXRes;
-  double y = mDestExtent.yMaximum() - ( destRow + 0.5 ) * mDestYRes;
-  double z = 0;
+  // TODO: check again cell selection (coor is in the middle)
 
-#ifdef QGISDEBUG
-  QgsDebugMsgLevel( QString( "x = %1 y = %2" ).arg( x ).arg( y ), 5 );
-#endif
+  int srcRow = static_cast< int >( floor( ( mSrcExtent.yMaximum() - y ) / mSrcYRes ) );
+  int srcCol = static_cast< int >( floor( ( x - mSrcExtent.xMinimum() ) / mSrcXRes ) );
 
-  if ( mInverseCt.isValid() )
+  // With epsg 32661 (Polar Stereographic) it was happening that srcCol == mSrcCols
+  // For now silently correct limits to avoid crashes
+  // TODO: review
+  // should not happen
+  if ( srcRow >= mSrcRows || srcRow < 0 || srcCol >= mSrcCols || srcCol < 0 )
   {
-    mInverseCt.transformInPlace( x, y, z );
+    return -1;
   }
 
-#ifdef QGISDEBUG
-  QgsDebugMsgLevel( QString( "x = %1 y = %2" ).arg( x ).arg( y ), 5 );
-#endif
+  return static_cast< qint64 >( srcRow ) * mSrcCols + srcCol;
+}
 
-  if ( !mExtent.contains( QgsPointXY( x, y ) ) )
+void ProjectorData::preciseSrcIndexes( int destRow, RowHelper &helper, qint64 *srcIndexes ) const
+{
+  // Get coordinates of centers of destination cells
+  helper.x.resize( mDestCols );
+  helper.y.fill( mDestExtent.yMaximum() - ( destRow + 0.5 ) * mDestYRes, mDestCols );
+  helper.z.fill( 0, mDestCols );
+  for ( int destCol = 0; destCol < mDestCols; ++destCol )
   {
-    return false;
+    helper.x[destCol] = mDestExtent.xMinimum() + ( destCol + 0.5 ) * mDestXRes;
   }
-  // Get source row col
-  *srcRow = static_cast< int >( floor( ( mSrcExtent.yMaximum() - y ) / mSrcYRes ) );
-  *srcCol = static_cast< int >( floor( ( x - mSrcExtent.xMinimum() ) / mSrcXRes ) );
-#ifdef QGISDEBUG
-  QgsDebugMsgLevel( QString( "mSrcExtent.yMinimum() = %1 mSrcExtent.yMaximum() = %2 mSrcYRes = %3" ).arg( mSrcExtent.yMinimum() ).arg( mSrcExtent.yMaximum() ).arg( mSrcYRes ), 5 );
-  QgsDebugMsgLevel( QString( "theSrcRow = %1 srcCol = %2" ).arg( *srcRow ).arg( *srcCol ), 5 );
-#endif
 
-  // With epsg 32661 (Polar Stereographic) it was happening that *srcCol == mSrcCols
-  // For now silently correct limits to avoid crashes
-  // TODO: review
-  // should not happen
-  if ( *srcRow >= mSrcRows ) return false;
-  if ( *srcRow < 0 ) return false;
-  if ( *srcCol >= mSrcCols ) return false;
-  if ( *srcCol < 0 ) return false;
+  if ( mInverseCt.isValid() )
+  {
+    try
+    {
+      // the whole row in a single call, points which cannot be transformed are set to HUGE_VAL by proj
+      mInverseCt.transformInPlace( helper.x, helper.y, helper.z );
+    }
+    catch ( QgsCsException & )
+    {
+      // the row contains a point which failed in a way that aborted the transformation, transform point by point
+      for ( int destCol = 0; destCol < mDestCols; ++destCol )
+      {
+        double x = mDestExtent.xMinimum() + ( destCol + 0.5 ) * mDestXRes;
+        double y = mDestExtent.yMaximum() - ( destRow + 0.5 ) * mDestYRes;
+        double z = 0;
+        try
+        {
+          mInverseCt.transformInPlace( x, y, z );
+        }
+        catch ( QgsCsException & )
+        {
+          x = y = std::numeric_limits<double>::quiet_NaN();
+        }
+        helper.x[destCol] = x;
+        helper.y[destCol] = y;
+      }
+    }
+  }
 
-  return true;
+  const double *x = helper.x.constData();
+  const double *y = helper.y.constData();
+  for ( int destCol = 0; destCol < mDestCols; ++destCol )
+  {
+    srcIndexes[destCol] = srcIndex( x[destCol], y[destCol] );
+  }
 }
 
-bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+void ProjectorData::approximateSrcIndexes( int destRow, RowHelper &helper, qint64 *srcIndexes ) const
 {
   int myMatrixRow = matrixRow( destRow );
-  int myMatrixCol = matrixCol( destCol );
 
-  if ( myMatrixRow > mHelperTopRow )
+  if ( myMatrixRow != helper.matrixRow )
   {
-    // TODO: make it more robust (for random, not sequential reading)
-    nextHelper();
+    helper.top.resize( mDestCols );
+    helper.bottom.resize( mDestCols );
+    if ( helper.matrixRow >= 0 && myMatrixRow == helper.matrixRow + 1 )
+    {
+      // We just switch top and bottom, memory is not lost
+      helper.top.swap( helper.bottom );
+    }
+    else
+    {
+      calcHelper( myMatrixRow, helper.top.data() );
+    }
+    calcHelper( myMatrixRow + 1, helper.bottom.data() );
+    helper.matrixRow = myMatrixRow;
   }
 
   double myDestY = mDestExtent.yMaximum() - ( destRow + 0.5 ) * mDestYRes;
 
   // See the schema in javax.media.jai.WarpGrid doc (but up side down)
-  // TODO: use some kind of cache of values which can be reused
   double myDestXMin, myDestYMin, myDestXMax, myDestYMax;
 
-  destPointOnCPMatrix( myMatrixRow + 1, myMatrixCol, &myDestXMin, &myDestYMin );
-  destPointOnCPMatrix( myMatrixRow, myMatrixCol + 1, &myDestXMax, &myDestYMax );
+  destPointOnCPMatrix( myMatrixRow + 1, 0, &myDestXMin, &myDestYMin );
+  destPointOnCPMatrix( myMatrixRow, 1, &myDestXMax, &myDestYMax );
 
+  // the fraction is the same for the whole row
   double yfrac = ( myDestY - myDestYMin ) / ( myDestYMax - myDestYMin );
 
-  QgsPointXY &myTop = pHelperTop[destCol];
-  QgsPointXY &myBot = pHelperBottom[destCol];
-
-  // Warning: this is very SLOW compared to the following code!:
-  //double mySrcX = myBot.x() + (myTop.x() - myBot.x()) * yfrac;
-  //double mySrcY = myBot.y() + (myTop.y() - myBot.y()) * yfrac;
-
-  double tx = myTop.x();
-  double ty = myTop.y();
-  double bx = myBot.x();
-  double by = myBot.y();
-  double mySrcX = bx + ( tx - bx ) * yfrac;
-  double mySrcY = by + ( ty - by ) * yfrac;
-
-  if ( !mExtent.contains( QgsPointXY( mySrcX, mySrcY ) ) )
+  const QgsPointXY *myTop = helper.top.constData();
+  const QgsPointXY *myBot = helper.bottom.constData();
+  for ( int destCol = 0; destCol < mDestCols; ++destCol )
   {
-    return false;
-  }
-
-  // TODO: check again cell selection (coor is in the middle)
-
-  *srcRow = static_cast< int >( floor( ( mSrcExtent.yMaximum() - mySrcY ) / mSrcYRes ) );
-  *srcCol = static_cast< int >( floor( ( mySrcX - mSrcExtent.xMinimum() ) / mSrcXRes ) );
-
-  // For now silently correct limits to avoid crashes
-  // TODO: review
-  // should not happen
-  if ( *srcRow >= mSrcRows ) return false;
-  if ( *srcRow < 0 ) return false;
-  if ( *srcCol >= mSrcCols ) return false;
-  if ( *srcCol < 0 ) return false;
+    double tx = myTop[destCol].x();
+    double ty = myTop[destCol].y();
+    double bx = myBot[destCol].x();
+    double by = myBot[destCol].y();
+    double mySrcX = bx + ( tx - bx ) * yfrac;
+    double mySrcY = by + ( ty - by ) * yfrac;
 
-  return true;
+    srcIndexes[destCol] = srcIndex( mySrcX, mySrcY );
+  }
 }
 
 void ProjectorData::insertRows( const QgsCoordinateTransform &ct )
 {
-  for ( int r = 0; r < mCPRows - 1; r++ )
+  // new rows are inserted between all existing rows, existing row r becomes row 2 * r
+  int myNewRows = mCPRows + mCPRows - 1;
+  QVector<QgsPointXY> myMatrix( myNewRows * mCPCols );
+  QVector<bool> myLegalMatrix( myNewRows * mCPCols, false );
+  for ( int r = 0; r < mCPRows; r++ )
   {
-    QList<QgsPointXY> myRow;
-    QList<bool> myLegalRow;
-    myRow.reserve( mCPCols );
-    myLegalRow.reserve( mCPCols );
-    for ( int c = 0; c < mCPCols; ++c )
-    {
-      myRow.append( QgsPointXY() );
-      myLegalRow.append( false );
-    }
-    QgsDebugMsgLevel( QString( "insert new row at %1" ).arg( 1 + r * 2 ), 3 );
-    mCPMatrix.insert( 1 + r * 2, myRow );
-    mCPLegalMatrix.insert( 1 + r * 2, myLegalRow );
+    std::copy( mCPMatrix.constBegin() + r * mCPCols, mCPMatrix.constBegin() + ( r + 1 ) * mCPCols, myMatrix.begin() + 2 * r * mCPCols );
+    std::copy( mCPLegalMatrix.constBegin() + r * mCPCols, mCPLegalMatrix.constBegin() + ( r + 1 ) * mCPCols, myLegalMatrix.begin() + 2 * r * mCPCols );
   }
-  mCPRows += mCPRows - 1;
+  QgsDebugMsgLevel( QString( "insert %1 new rows" ).arg( mCPRows - 1 ), 3 );
+  mCPMatrix.swap( myMatrix );
+  mCPLegalMatrix.swap( myLegalMatrix );
+  mCPRows = myNewRows;
   for ( int r = 1; r < mCPRows - 1; r += 2 )
   {
     calcRow( r, ct );
@@ -572,15 +613,21 @@ void ProjectorData::insertRows( const QgsCoordinateTransform &ct )
 
 void ProjectorData::insertCols( const QgsCoordinateTransform &ct )
 {
+  // new columns are inserted between all existing columns, existing column c becomes column 2 * c
+  int myNewCols = mCPCols + mCPCols - 1;
+  QVector<QgsPointXY> myMatrix( mCPRows * myNewCols );
+  QVector<bool> myLegalMatrix( mCPRows * myNewCols, false );
   for ( int r = 0; r < mCPRows; r++ )
   {
-    for ( int c = 0; c < mCPCols - 1; c++ )
+    for ( int c = 0; c < mCPCols; c++ )
     {
-      mCPMatrix[r].insert( 1 + c * 2, QgsPointXY() );
-      mCPLegalMatrix[r].insert( 1 + c * 2, false );
+      myMatrix[r * myNewCols + 2 * c] = mCPMatrix[r * mCPCols + c];
+      myLegalMatrix[r * myNewCols + 2 * c] = mCPLegalMatrix[r * mCPCols + c];
     }
   }
-  mCPCols += mCPCols - 1;
+  mCPMatrix.swap( myMatrix );
+  mCPLegalMatrix.swap( myLegalMatrix );
+  mCPCols = myNewCols;
   for ( int c = 1; c < mCPCols - 1; c += 2 )
   {
     calcCol( c, ct );
@@ -597,19 +644,19 @@ void ProjectorData::calcCP( int row, int col, const QgsCoordinateTransform &ct )
   {
     if ( ct.isValid() )
     {
-      mCPMatrix[row][col] = ct.transform( myDestPoint );
-      mCPLegalMatrix[row][col] = true;
+      mCPMatrix[row * mCPCols + col] = ct.transform( myDestPoint );
+      mCPLegalMatrix[row * mCPCols + col] = true;
     }
     else
     {
-      mCPLegalMatrix[row][col] = false;
+      mCPLegalMatrix[row * mCPCols + col] = false;
     }
   }
   catch ( QgsCsException &e )
   {
     Q_UNUSED( e );
     // Caught an error in transform
-    mCPLegalMatrix[row][col] = false;
+    mCPLegalMatrix[row * mCPCols + col] = false;
   }
 }
 
@@ -650,12 +697,12 @@ bool ProjectorData::checkCols( const QgsCoordinateTransform &ct )
       destPointOnCPMatrix( r, c, &myDestX, &myDestY );
       QgsPointXY myDestPoint( myDestX, myDestY );
 
-      QgsPointXY mySrcPoint1 = mCPMatrix[r - 1][c];
-      QgsPointXY mySrcPoint2 = mCPMatrix[r][c];
-      QgsPointXY mySrcPoint3 = mCPMatrix[r + 1][c];
+      const int myIndex = r * mCPCols + c;
+      QgsPointXY mySrcPoint1 = mCPMatrix[myIndex - mCPCols];
+      QgsPointXY mySrcPoint3 = mCPMatrix[myIndex + mCPCols];
 
       QgsPointXY mySrcApprox( ( mySrcPoint1.x() + mySrcPoint3.x() ) / 2, ( mySrcPoint1.y() + mySrcPoint3.y() ) / 2 );
-      if ( !mCPLegalMatrix[r - 1][c] || !mCPLegalMatrix[r][c] || !mCPLegalMatrix[r + 1][c] )
+      if ( !mCPLegalMatrix[myIndex - mCPCols] || !mCPLegalMatrix[myIndex] || !mCPLegalMatrix[myIndex + mCPCols] )
       {
         // There was an error earlier in transform, just abort
         return false;
@@ -695,12 +742,12 @@ bool ProjectorData::checkRows( const QgsCoordinateTransform &ct )
       destPointOnCPMatrix( r, c, &myDestX, &myDestY );
 
       QgsPointXY myDestPoint( myDestX, myDestY );
-      QgsPointXY mySrcPoint1 = mCPMatrix[r][c - 1];
-      QgsPointXY mySrcPoint2 = mCPMatrix[r][c];
-      QgsPointXY mySrcPoint3 = mCPMatrix[r][c + 1];
+      const int myIndex = r * mCPCols + c;
+      QgsPointXY mySrcPoint1 = mCPMatrix[myIndex - 1];
+      QgsPointXY mySrcPoint3 = mCPMatrix[myIndex + 1];
 
       QgsPointXY mySrcApprox( ( mySrcPoint1.x() + mySrcPoint3.x() ) / 2, ( mySrcPoint1.y() + mySrcPoint3.y() ) / 2 );
-      if ( !mCPLegalMatrix[r][c - 1] || !mCPLegalMatrix[r][c] || !mCPLegalMatrix[r][c + 1] )
+      if ( !mCPLegalMatrix[myIndex - 1] || !mCPLegalMatrix[myIndex] || !mCPLegalMatrix[myIndex + 1] )
       {
         // There was an error earlier in transform, just abort
         return false;
@@ -810,41 +857,29 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
 
   outputBlock->setIsNoData();
 
-  int srcRow, srcCol;
-  for ( int i = 0; i < height; ++i )
+  const char *srcData = inputBlock->bits();
+  char *destData = outputBlock->bits();
+  if ( !srcData || !destData )
   {
-    if ( feedback && feedback->isCanceled() )
-      break;
-    for ( int j = 0; j < width; ++j )
-    {
-      bool inside = pd.srcRowCol( i, j, &srcRow, &srcCol );
-      if ( !inside ) continue; // we have everything set to no data
-
-      qgssize srcIndex = static_cast< qgssize >( srcRow ) * pd.srcCols() + srcCol;
-
-      // isNoData() may be slow so we check doNoData first
-      if ( doNoData && inputBlock->isNoData( srcRow, srcCol ) )
-      {
-        outputBlock->setIsNoData( i, j );
-        continue;
-      }
+    QgsDebugMsg( "Cannot get block data" );
+    return outputBlock.release();
+  }
 
-      qgssize destIndex = static_cast< qgssize >( i ) * width + j;
-      char *srcBits = inputBlock->bits( srcIndex );
-      char *destBits = outputBlock->bits( destIndex );
-      if ( !srcBits )
-      {
-        // QgsDebugMsg( QString( "Cannot get input block data: row = %1 col = %2" ).arg( i ).arg( j ) );
-        continue;
-      }
-      if ( !destBits )
-      {
-        // QgsDebugMsg( QString( "Cannot set output block data: srcRow = %1 srcCol = %2" ).arg( srcRow ).arg( srcCol ) );
-        continue;
-      }
-      memcpy( destBits, srcBits, pixelSize );
-      outputBlock->setIsData( i, j );
-    }
+  // Stripes of rows are filled in parallel. Setting no data in the bitmap of an image block may
+  // allocate the bitmap, so such blocks are filled by a single thread.
+  const int threadCount = mThreadCount > 0 ? mThreadCount : std::max( 1, QThread::idealThreadCount() );
+  const int stripeCount = doNoData ? 1 : std::min( std::min( threadCount, height ), std::max( 1, static_cast< int >( static_cast< qint64 >( width ) * height / MIN_STRIPE_PIXELS ) ) );
+  ProjectStripeWrapper wrapper( &pd, inputBlock.get(), outputBlock.get(), srcData, destData, pixelSize, doNoData, width, height, stripeCount, feedback );
+  if ( stripeCount > 1 )
+  {
+    QVector< int > stripes( stripeCount );
+    for ( int i = 0; i < stripeCount; ++i )
+      stripes[ i ] = i;
+    QtConcurrent::blockingMap( stripes, wrapper );
+  }
+  else
+  {
+    wrapper( 0 );
   }
 
   return outputBlock.release();
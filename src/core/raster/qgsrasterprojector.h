@@ -79,6 +79,23 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
     // Translated precision mode, for use in ComboBox etc.
     static QString precisionLabel( Precision precision );
 
+    /**
+     * Returns the maximum number of threads used for filling a reprojected block. A value of 0 means
+     * that the number of threads matches the number of processor cores.
+     * \see setThreadCount()
+     * \since QGIS 3.0
+     */
+    int threadCount() const { return mThreadCount; }
+
+    /**
+     * Sets the maximum number of threads used for filling a reprojected block. A \a count of 0 means
+     * that the number of threads matches the number of processor cores, 1 disables threading.
+     * Small blocks are always filled by the calling thread.
+     * \see threadCount()
+     * \since QGIS 3.0
+     */
+    void setThreadCount( int count ) { mThreadCount = count; }
+
     QgsRasterBlock *block( int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback = nullptr ) override SIP_FACTORY;
 
     //! Calculate destination extent and size from source extent and size
@@ -107,6 +124,9 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
     //! Requested precision
     Precision mPrecision;
 
+    //! Maximum number of threads, 0 for the number of processor cores
+    int mThreadCount = 0;
+
 };
 
 
@@ -115,24 +135,41 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
 
 /**
  * Internal class for reprojection of rasters - either exact or approximate.
- * QgsRasterProjector creates it and then keeps calling srcRowCol() to get source pixel position
- * for every destination pixel position.
+ * QgsRasterProjector creates it and then calls srcIndexes() to get source pixel positions
+ * for every destination row. Once created, the class is only read, so the rows of a block
+ * may be calculated from several threads.
  */
 class ProjectorData
 {
   public:
     //! Initialize reprojector and calculate matrix
     ProjectorData( const QgsRectangle &extent, int width, int height, QgsRasterInterface *input, const QgsCoordinateTransform &inverseCt, QgsRasterProjector::Precision precision );
-    ~ProjectorData();
 
     ProjectorData( const ProjectorData &other ) = delete;
     ProjectorData &operator=( const ProjectorData &other ) = delete;
 
-    /** \brief Get source row and column indexes for current source extent and resolution
-        If source pixel is outside source extent srcRow and srcCol are left unchanged.
-        \returns true if inside source
+    /**
+     * Source points interpolated along the control point rows above and below a destination row,
+     * and coordinate buffers for exact transformation. They are reused for consecutive
+     * destination rows, every thread needs its own helper.
      */
-    bool srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    struct RowHelper
+    {
+      QVector< QgsPointXY > top;
+      QVector< QgsPointXY > bottom;
+      int matrixRow = -1;
+      QVector< double > x;
+      QVector< double > y;
+      QVector< double > z;
+    };
+
+    /** \brief Get source pixel indexes (source row * srcCols() + source column) for all columns of a destination row
+        The index is set to -1 for destination pixels outside of the source extent.
+        \param destRow destination row
+        \param helper interpolated points kept between calls, which should be made for ascending rows
+        \param srcIndexes array receiving one index for every destination column
+     */
+    void srcIndexes( int destRow, RowHelper &helper, qint64 *srcIndexes ) const;
 
     QgsRectangle srcExtent() const { return mSrcExtent; }
     int srcRows() const { return mSrcRows; }
@@ -141,17 +178,20 @@ class ProjectorData
   private:
 
     //! \brief get destination point for _current_ destination position
-    void destPointOnCPMatrix( int row, int col, double *theX, double *theY );
+    void destPointOnCPMatrix( int row, int col, double *theX, double *theY ) const;
 
     //! \brief Get matrix upper left row/col indexes for destination row/col
-    int matrixRow( int destRow );
-    int matrixCol( int destCol );
+    int matrixRow( int destRow ) const;
+    int matrixCol( int destCol ) const;
+
+    //! \brief Get source pixel index for a source point, or -1 if outside of the source
+    inline qint64 srcIndex( double x, double y ) const;
 
-    //! \brief Get precise source row and column indexes for current source extent and resolution
-    inline bool preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    //! \brief Get precise source pixel indexes for a destination row
+    void preciseSrcIndexes( int destRow, RowHelper &helper, qint64 *srcIndexes ) const;
 
-    //! \brief Get approximate source row and column indexes for current source extent and resolution
-    inline bool approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    //! \brief Get approximate source pixel indexes for a destination row
+    void approximateSrcIndexes( int destRow, RowHelper &helper, qint64 *srcIndexes ) const;
 
     //! \brief insert rows to matrix
     void insertRows( const QgsCoordinateTransform &ct );
@@ -183,10 +223,7 @@ class ProjectorData
     bool checkRows( const QgsCoordinateTransform &ct );
 
     //! Calculate array of src helper points
-    void calcHelper( int matrixRow, QgsPointXY *points );
-
-    //! Calc / switch helper
-    void nextHelper();
+    void calcHelper( int matrixRow, QgsPointXY *points ) const;
 
     //! Get mCPMatrix as string
     QString cpToString();
@@ -237,23 +274,12 @@ class ProjectorData
     //! Number of destination cols per matrix col
     double mDestColsPerMatrixCol;
 
-    //! Grid of source control points
-    QList< QList<QgsPointXY> > mCPMatrix;
+    //! Grid of source control points, row by row, point at row r and column c is at index r * mCPCols + c
+    QVector< QgsPointXY > mCPMatrix;
 
     //! Grid of source control points transformation possible indicator
-    /* Same size as mCPMatrix */
-    QList< QList<bool> > mCPLegalMatrix;
-
-    //! Array of source points for each destination column on top of current CPMatrix grid row
-    /* Warning: using QList is slow on access */
-    QgsPointXY *pHelperTop = nullptr;
-
-    //! Array of source points for each destination column on bottom of current CPMatrix grid row
-    /* Warning: using QList is slow on access */
-    QgsPointXY *pHelperBottom = nullptr;
-
-    //! Current mHelperTop matrix row
-    int mHelperTopRow;
+    /* Same size and layout as mCPMatrix */
+    QVector< bool > mCPLegalMatrix;
 
     //! Number of mCPMatrix columns
     int mCPCols;
@@ -35,6 +35,9 @@ QgsPostgresFeatureIterator::QgsPostgresFeatureIterator( QgsPostgresFeatureSource
   , mOrderByCompiled( false )
   , mLastFetch( false )
   , mFilterRequiresGeometry( false )
+  , mPipelineFetch( false )
+  , mFetchPending( false )
+  , mPendingFetchSize( 0 )
 {
   if ( !source->mTransactionConnection )
   {
@@ -47,6 +50,9 @@ QgsPostgresFeatureIterator::QgsPostgresFeatureIterator( QgsPostgresFeatureSource
     mIsTransactionConnection = true;
   }
 
+  // a fetch can only be left pending on a connection which is not shared with other iterators
+  mPipelineFetch = !mIsTransactionConnection;
+
   if ( !mConn )
   {
     mClosed = true;
@@ -252,41 +258,15 @@ bool QgsPostgresFeatureIterator::fetchFeature( QgsFeature &feature )
     QElapsedTimer timer;
     timer.start();
 
-    QString fetch = QStringLiteral( "FETCH FORWARD %1 FROM %2" ).arg( mFeatureQueueSize ).arg( mCursorName );
-    QgsDebugMsgLevel( QString( "fetching %1 features." ).arg( mFeatureQueueSize ), 4 );
-
     lock();
-    if ( mConn->PQsendQuery( fetch ) == 0 ) // fetch features asynchronously
-    {
-      QgsMessageLog::logMessage( QObject::tr( "Fetching from cursor %1 failed\nDatabase error: %2" ).arg( mCursorName, mConn->PQerrorMessage() ), QObject::tr( "PostGIS" ) );
-    }
+    if ( !mFetchPending )
+      sendFetch();
 
     QgsPostgresResult queryResult;
-    for ( ;; )
-    {
-      queryResult = mConn->PQgetResult();
-      if ( !queryResult.result() )
-        break;
-
-      if ( queryResult.PQresultStatus() != PGRES_TUPLES_OK )
-      {
-        QgsMessageLog::logMessage( QObject::tr( "Fetching from cursor %1 failed\nDatabase error: %2" ).arg( mCursorName, mConn->PQerrorMessage() ), QObject::tr( "PostGIS" ) );
-        break;
-      }
-
-      int rows = queryResult.PQntuples();
-      if ( rows == 0 )
-        continue;
-
-      mLastFetch = rows < mFeatureQueueSize;
-
-      for ( int row = 0; row < rows; row++ )
-      {
-        mFeatureQueue.enqueue( QgsFeature() );
-        getFeature( queryResult, row, mFeatureQueue.back() );
-      } // for each row in queue
-    }
-    unlock();
+    const int fetchSize = mPendingFetchSize;
+    const int rows = receiveFetch( queryResult ) ? queryResult.PQntuples() : 0;
+    if ( rows > 0 )
+      mLastFetch = rows < fetchSize;
 
     if ( timer.elapsed() > 500 && mFeatureQueueSize > 1 )
     {
@@ -296,6 +276,17 @@ bool QgsPostgresFeatureIterator::fetchFeature( QgsFeature &feature )
     {
       mFeatureQueueSize *= 2;
     }
+
+    // the server fetches the next rows while these ones are converted to features
+    if ( mPipelineFetch && rows > 0 && !mLastFetch )
+      sendFetch();
+
+    for ( int row = 0; row < rows; row++ )
+    {
+      mFeatureQueue.enqueue( QgsFeature() );
+      getFeature( queryResult, row, mFeatureQueue.back() );
+    } // for each row in queue
+    unlock();
   }
 
   if ( mFeatureQueue.empty() )
@@ -318,6 +309,54 @@ bool QgsPostgresFeatureIterator::fetchFeature( QgsFeature &feature )
   return true;
 }
 
+void QgsPostgresFeatureIterator::sendFetch()
+{
+  QString fetch = QStringLiteral( "FETCH FORWARD %1 FROM %2" ).arg( mFeatureQueueSize ).arg( mCursorName );
+  QgsDebugMsgLevel( QString( "fetching %1 features." ).arg( mFeatureQueueSize ), 4 );
+
+  mPendingFetchSize = mFeatureQueueSize;
+  mFetchPending = mConn->PQsendQuery( fetch ) != 0; // fetch features asynchronously
+  if ( !mFetchPending )
+  {
+    QgsMessageLog::logMessage( QObject::tr( "Fetching from cursor %1 failed\nDatabase error: %2" ).arg( mCursorName, mConn->PQerrorMessage() ), QObject::tr( "PostGIS" ) );
+  }
+}
+
+bool QgsPostgresFeatureIterator::receiveFetch( QgsPostgresResult &queryResult )
+{
+  mFetchPending = false;
+
+  // all results are read, so the connection is ready for the next query
+  bool ok = false;
+  while ( PGresult *result = mConn->PQgetResult() )
+  {
+    if ( ok )
+    {
+      QgsPostgresResult unexpected( result );
+      continue;
+    }
+
+    queryResult = result;
+    if ( queryResult.PQresultStatus() != PGRES_TUPLES_OK )
+    {
+      QgsMessageLog::logMessage( QObject::tr( "Fetching from cursor %1 failed\nDatabase error: %2" ).arg( mCursorName, mConn->PQerrorMessage() ), QObject::tr( "PostGIS" ) );
+      queryResult = nullptr;
+      continue;
+    }
+    ok = true;
+  }
+  return ok;
+}
+
+void QgsPostgresFeatureIterator::discardPendingFetch()
+{
+  if ( !mFetchPending )
+    return;
+
+  QgsPostgresResult queryResult;
+  receiveFetch( queryResult );
+}
+
 bool QgsPostgresFeatureIterator::nextFeatureFilterExpression( QgsFeature &f )
 {
   if ( !mExpressionCompiled )
@@ -379,6 +418,7 @@ bool QgsPostgresFeatureIterator::rewind()
   // move cursor to first record
 
   lock();
+  discardPendingFetch();
   mConn->PQexecNR( QStringLiteral( "move absolute 0 in %1" ).arg( mCursorName ) );
   unlock();
   mFeatureQueue.clear();
@@ -394,6 +434,7 @@ bool QgsPostgresFeatureIterator::close()
     return false;
 
   lock();
+  discardPendingFetch();
   mConn->closeCursor( mCursorName );
   unlock();
 
@@ -94,6 +94,18 @@ class QgsPostgresFeatureIterator : public QgsAbstractFeatureIteratorFromSource<Q
     void getFeatureAttribute( int idx, QgsPostgresResult &queryResult, int row, int &col, QgsFeature &feature );
     bool declareCursor( const QString &whereClause, long limit = -1, bool closeOnFail = true, const QString &orderBy = QString() );
 
+    //! Sends a FETCH of mFeatureQueueSize rows from the cursor, without waiting for its result
+    void sendFetch();
+
+    /**
+     * Waits for the result of the FETCH sent by sendFetch() and stores it in \a queryResult.
+     * \returns false if the fetch failed
+     */
+    bool receiveFetch( QgsPostgresResult &queryResult );
+
+    //! Reads and drops the result of a FETCH still pending on the connection
+    void discardPendingFetch();
+
     QString mCursorName;
 
     /**
@@ -125,6 +137,13 @@ class QgsPostgresFeatureIterator : public QgsAbstractFeatureIteratorFromSource<Q
     bool mLastFetch;
     bool mFilterRequiresGeometry;
 
+    //! Set to true if the next FETCH is sent while the rows of the current one are converted to features
+    bool mPipelineFetch;
+    //! Set to true while a FETCH sent by sendFetch() has not been received
+    bool mFetchPending;
+    //! Number of rows requested by the last FETCH
+    int mPendingFetchSize;
+
     QgsCoordinateTransform mTransform;
     QgsRectangle mFilterRect;
 };
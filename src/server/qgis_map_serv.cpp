@@ -22,6 +22,10 @@
 #include "qgsfcgiserverresponse.h"
 #include "qgsfcgiserverrequest.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
 #include <fcgi_stdio.h>
 #include <cstdlib>
 
@@ -37,13 +41,105 @@ int fcgi_accept()
 #endif
 }
 
+/**
+ * Thread accepting FastCGI requests and handling them with the server,
+ * used when QGIS_SERVER_REQUEST_THREADS is larger than one
+ */
+class QgsFcgiRequestThread : public QThread
+{
+  public:
+    QgsFcgiRequestThread( QgsServer &server, QMutex &acceptMutex )
+      : mServer( server )
+      , mAcceptMutex( acceptMutex )
+    {}
+
+  protected:
+    void run() override
+    {
+      FCGX_Request fcgiRequest;
+      FCGX_InitRequest( &fcgiRequest, 0, 0 );
+
+      for ( ;; )
+      {
+        int rc;
+        {
+          // accept() cannot be called concurrently on all platforms
+          QMutexLocker locker( &mAcceptMutex );
+          rc = FCGX_Accept_r( &fcgiRequest );
+        }
+        if ( rc < 0 )
+          break;
+
+        QgsFcgiServerRequest request( &fcgiRequest );
+        QgsFcgiServerResponse response( request.method(), &fcgiRequest );
+        if ( ! request.hasError() )
+        {
+          mServer.handleRequest( request, response );
+        }
+        else
+        {
+          response.sendError( 400, "Bad request" );
+        }
+        FCGX_Finish_r( &fcgiRequest );
+      }
+    }
+
+  private:
+    QgsServer &mServer;
+    QMutex &mAcceptMutex;
+};
+
 int main( int argc, char *argv[] )
 {
   QgsApplication app( argc, argv, getenv( "DISPLAY" ), QString(), QStringLiteral( "server" ) );
   QgsServer server;
+
+  // a CGI process handles a single request
+  const int requestThreads = FCGX_IsCGI() ? 1 : server.serverInterface()->serverSettings()->requestThreads();
+
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
-  server.initPython();
+  // plugins share the server interface between requests
+  if ( requestThreads > 1 )
+  {
+    QgsMessageLog::logMessage( QStringLiteral( "Python plugins are not loaded with several request threads" ), QStringLiteral( "Server" ), QgsMessageLog::WARNING );
+  }
+  else
+  {
+    server.initPython();
+  }
 #endif
+
+  if ( requestThreads > 1 )
+  {
+    FCGX_Init();
+
+    QMutex acceptMutex;
+    QList<QgsFcgiRequestThread *> threads;
+    int runningThreads = requestThreads;
+    for ( int i = 0; i < requestThreads; ++i )
+    {
+      QgsFcgiRequestThread *thread = new QgsFcgiRequestThread( server, acceptMutex );
+      QObject::connect( thread, &QThread::finished, &app, [&runningThreads, &app]
+      {
+        if ( --runningThreads == 0 )
+          app.quit();
+      } );
+      threads << thread;
+      thread->start();
+    }
+
+    // the main thread processes file system changes and log messages
+    app.exec();
+
+    Q_FOREACH ( QgsFcgiRequestThread *thread, threads )
+    {
+      thread->wait();
+    }
+    qDeleteAll( threads );
+    app.exitQgis();
+    return 0;
+  }
+
   // Starts FCGI loop
   while ( fcgi_accept() >= 0 )
   {
@@ -18,19 +18,22 @@
 #include "qgscapabilitiescache.h"
 #include "qgslogger.h"
 #include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
 
 QgsCapabilitiesCache::QgsCapabilitiesCache()
 {
-  QObject::connect( &mFileSystemWatcher, &QFileSystemWatcher::fileChanged, this, &QgsCapabilitiesCache::removeChangedEntry );
+  QObject::connect( &mFileSystemWatcher, &QFileSystemWatcher::fileChanged, this, &QgsCapabilitiesCache::fileChanged );
 }
 
 const QDomDocument *QgsCapabilitiesCache::searchCapabilitiesDocument( const QString &configFilePath, const QString &key )
 {
   QCoreApplication::processEvents(); //get updates from file system watcher
+  removeChangedEntries();
 
   if ( mCachedCapabilities.contains( configFilePath ) && mCachedCapabilities[ configFilePath ].contains( key ) )
   {
-    return &mCachedCapabilities[ configFilePath ][ key ];
+    return &mCachedCapabilities[ configFilePath ][ key ].document;
   }
   else
   {
@@ -43,29 +46,119 @@ void QgsCapabilitiesCache::insertCapabilitiesDocument( const QString &configFile
   if ( mCachedCapabilities.size() > 40 )
   {
     //remove another cache entry to avoid memory problems
-    QHash<QString, QHash<QString, QDomDocument> >::iterator capIt = mCachedCapabilities.begin();
-    mFileSystemWatcher.removePath( capIt.key() );
+    QHash<QString, QHash<QString, CapabilitiesEntry> >::iterator capIt = mCachedCapabilities.begin();
+    watchPath( capIt.key(), false );
+    mLayerElements.remove( capIt.key() );
     mCachedCapabilities.erase( capIt );
   }
 
   if ( !mCachedCapabilities.contains( configFilePath ) )
   {
-    mFileSystemWatcher.addPath( configFilePath );
-    mCachedCapabilities.insert( configFilePath, QHash<QString, QDomDocument>() );
+    watchPath( configFilePath, true );
+    mCachedCapabilities.insert( configFilePath, QHash<QString, CapabilitiesEntry>() );
   }
 
-  mCachedCapabilities[ configFilePath ].insert( key, doc->cloneNode().toDocument() );
+  CapabilitiesEntry entry;
+  entry.document = doc->cloneNode().toDocument();
+  entry.bytes = doc->toByteArray();
+  mCachedCapabilities[ configFilePath ].insert( key, entry );
+}
+
+QByteArray QgsCapabilitiesCache::searchCapabilitiesBytes( const QString &configFilePath, const QString &key )
+{
+  QCoreApplication::processEvents(); //get updates from file system watcher
+  removeChangedEntries();
+
+  return mCachedCapabilities.value( configFilePath ).value( key ).bytes;
+}
+
+QDomElement QgsCapabilitiesCache::searchLayerElement( const QString &configFilePath, const QByteArray &fingerprint )
+{
+  QHash<QString, LayerElements>::iterator layersIt = mLayerElements.find( configFilePath );
+  if ( layersIt == mLayerElements.end() )
+  {
+    return QDomElement();
+  }
+
+  QHash<QByteArray, QDomElement>::const_iterator elemIt = layersIt->elements.constFind( fingerprint );
+  if ( elemIt != layersIt->elements.constEnd() )
+  {
+    return elemIt.value();
+  }
+
+  // the layer did not change with the project file, keep its element
+  QDomElement element = layersIt->previousElements.take( fingerprint );
+  if ( !element.isNull() )
+  {
+    layersIt->elements.insert( fingerprint, element );
+  }
+  return element;
+}
+
+void QgsCapabilitiesCache::insertLayerElement( const QString &configFilePath, const QByteArray &fingerprint, const QDomElement &element )
+{
+  LayerElements &layers = mLayerElements[ configFilePath ];
+  layers.elements.insert( fingerprint, layers.document.importNode( element, true ).toElement() );
 }
 
 void QgsCapabilitiesCache::removeCapabilitiesDocument( const QString &path )
 {
   mCachedCapabilities.remove( path );
-  mFileSystemWatcher.removePath( path );
+  mLayerElements.remove( path );
+  watchPath( path, false );
 }
 
 void QgsCapabilitiesCache::removeChangedEntry( const QString &path )
 {
   QgsDebugMsg( "Remove capabilities cache entry because file changed" );
   mCachedCapabilities.remove( path );
-  mFileSystemWatcher.removePath( path );
+  watchPath( path, false );
+
+  // elements of unchanged layers are found again by their fingerprint
+  QHash<QString, LayerElements>::iterator layersIt = mLayerElements.find( path );
+  if ( layersIt != mLayerElements.end() )
+  {
+    layersIt->previousElements = layersIt->elements;
+    layersIt->elements.clear();
+  }
+}
+
+void QgsCapabilitiesCache::removeChangedEntries()
+{
+  QSet<QString> changed;
+  {
+    QMutexLocker locker( &mChangedMutex );
+    changed.swap( mChangedPaths );
+  }
+
+  Q_FOREACH ( const QString &path, changed )
+  {
+    removeChangedEntry( path );
+  }
+}
+
+void QgsCapabilitiesCache::fileChanged( const QString &path )
+{
+  // requests may be using the cache in other threads, the entry is removed later
+  QMutexLocker locker( &mChangedMutex );
+  mChangedPaths << path;
+}
+
+void QgsCapabilitiesCache::watchPath( const QString &path, bool watch )
+{
+  // the file system watcher must only be used from the thread of the cache
+  if ( QThread::currentThread() != thread() )
+  {
+    QMetaObject::invokeMethod( this, "watchPath", Qt::QueuedConnection, Q_ARG( QString, path ), Q_ARG( bool, watch ) );
+    return;
+  }
+
+  if ( watch && !mFileSystemWatcher.files().contains( path ) )
+  {
+    mFileSystemWatcher.addPath( path );
+  }
+  else if ( !watch && mFileSystemWatcher.files().contains( path ) )
+  {
+    mFileSystemWatcher.removePath( path );
+  }
 }
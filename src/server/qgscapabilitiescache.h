@@ -18,10 +18,13 @@
 #ifndef QGSCAPABILITIESCACHE_H
 #define QGSCAPABILITIESCACHE_H
 
+#include <QByteArray>
 #include <QDomDocument>
 #include <QFileSystemWatcher>
 #include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 #include "qgis_server.h"
 
 /** \ingroup server
@@ -46,19 +49,83 @@ class SERVER_EXPORT QgsCapabilitiesCache : public QObject
      */
     void insertCapabilitiesDocument( const QString &configFilePath, const QString &key, const QDomDocument *doc );
 
+    /** Returns the cached capabilities document serialized as XML, or an empty byte
+     * array if the document is not in cache. The document is serialized once, when inserted.
+     * \param configFilePath the project file path
+     * \param key key used to separate different version in different cache
+     * \since QGIS 3.0
+     */
+    QByteArray searchCapabilitiesBytes( const QString &configFilePath, const QString &key );
+
+    /** Returns a cached layer element of a capabilities document, or a null element.
+     * Layer elements are not removed when the project file changes: they are found by
+     * a fingerprint of the layer, which changes with the layer. The returned element
+     * belongs to the cache and must be imported in the capabilities document.
+     * \param configFilePath the project file path
+     * \param fingerprint identifies the layer and all the properties the element depends on
+     * \see insertLayerElement()
+     * \since QGIS 3.0
+     */
+    QDomElement searchLayerElement( const QString &configFilePath, const QByteArray &fingerprint );
+
+    /** Inserts a layer element of a capabilities document (creates a copy of the element).
+     * \param configFilePath the project file path
+     * \param fingerprint identifies the layer and all the properties the element depends on
+     * \param element the layer element
+     * \see searchLayerElement()
+     * \since QGIS 3.0
+     */
+    void insertLayerElement( const QString &configFilePath, const QByteArray &fingerprint, const QDomElement &element );
+
     /** Remove capabilities document
      * \param path the project file path
      * \since QGIS 2.16
      */
     void removeCapabilitiesDocument( const QString &path );
 
+    /** Removes the documents of the project files which changed since the last call.
+     * Changes are only recorded by the file system watcher, as the cache may be used by
+     * a running request. This must be called when no request uses the cache, it is also
+     * called by searchCapabilitiesDocument() and searchCapabilitiesBytes().
+     * \since QGIS 3.0
+     */
+    void removeChangedEntries();
+
   private:
-    QHash< QString, QHash< QString, QDomDocument > > mCachedCapabilities;
+
+    struct CapabilitiesEntry
+    {
+      QDomDocument document;
+      QByteArray bytes;
+    };
+
+    //! Layer elements by fingerprint, owned by a document of the cache
+    struct LayerElements
+    {
+      QDomDocument document;
+      QHash<QByteArray, QDomElement> elements;
+      //! Elements cached before the project file last changed, dropped at the next change
+      QHash<QByteArray, QDomElement> previousElements;
+    };
+
+    QHash< QString, QHash< QString, CapabilitiesEntry > > mCachedCapabilities;
+    QHash< QString, LayerElements > mLayerElements;
     QFileSystemWatcher mFileSystemWatcher;
 
-  private slots:
+    //! Protects mChangedPaths, which is filled in the thread of the cache
+    QMutex mChangedMutex;
+    //! Changed project files, removed by removeChangedEntries()
+    QSet<QString> mChangedPaths;
+
     //! Removes changed entry from this cache
     void removeChangedEntry( const QString &path );
+
+  private slots:
+    //! Records a changed project file
+    void fileChanged( const QString &path );
+
+    //! Adds or removes \a path from the file system watcher, in the thread of the cache
+    void watchPath( const QString &path, bool watch );
 };
 
 #endif // QGSCAPABILITIESCACHE_H
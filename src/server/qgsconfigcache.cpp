@@ -22,8 +22,60 @@
 #include "qgssldconfigparser.h"
 #include "qgsaccesscontrol.h"
 #include "qgsproject.h"
+#include "qgsvectorlayer.h"
+#include "qgsfeatureiterator.h"
 
 #include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+///@cond PRIVATE
+namespace
+{
+  /* Reads a project from any thread, and opens the connections of its vector
+   * layers by fetching a feature. The project is moved to \a thread, where the
+   * cache lives, as worker threads have no event loop.
+   */
+  QSharedPointer<QgsProject> readPreloadedProject( const QString &path, QThread *thread )
+  {
+    QSharedPointer<QgsProject> project( new QgsProject() );
+    if ( !project->read( path ) )
+    {
+      QgsMessageLog::logMessage( QStringLiteral( "Cannot preload the project %1" ).arg( path ), QStringLiteral( "Server" ), QgsMessageLog::WARNING );
+      return QSharedPointer<QgsProject>();
+    }
+
+    Q_FOREACH ( QgsMapLayer *layer, project->mapLayers() )
+    {
+      if ( QgsVectorLayer *vectorLayer = qobject_cast<QgsVectorLayer *>( layer ) )
+      {
+        QgsFeature feature;
+        vectorLayer->getFeatures( QgsFeatureRequest()
+                                  .setFlags( QgsFeatureRequest::NoGeometry )
+                                  .setSubsetOfAttributes( QgsAttributeList() )
+                                  .setLimit( 1 ) ).nextFeature( feature );
+      }
+    }
+
+    project->moveToThread( thread );
+    return project;
+  }
+
+  struct PreloadTask
+  {
+    QString path;
+    QThread *thread;
+    QSharedPointer<QgsProject> project;
+  };
+
+  void preload( PreloadTask *task )
+  {
+    task->project = readPreloadedProject( task->path, task->thread );
+  }
+}
+///@endcond
 
 QgsConfigCache *QgsConfigCache::instance()
 {
@@ -36,26 +88,56 @@ QgsConfigCache *QgsConfigCache::instance()
 }
 
 QgsConfigCache::QgsConfigCache()
+  : mMutex( QMutex::Recursive )
 {
   QObject::connect( &mFileSystemWatcher, &QFileSystemWatcher::fileChanged, this, &QgsConfigCache::removeChangedEntry );
 }
 
 const QgsProject *QgsConfigCache::project( const QString &path )
 {
-  if ( ! mProjectCache[ path ] )
+  // the cache keeps a reference until the entry is removed, and removed projects
+  // are kept until removeChangedEntries() is called
+  return projectSnapshot( path ).data();
+}
+
+QSharedPointer<const QgsProject> QgsConfigCache::projectSnapshot( const QString &path )
+{
   {
-    std::unique_ptr<QgsProject> prj( new QgsProject() );
-    if ( prj->read( path ) )
+    QMutexLocker locker( &mMutex );
+    QMap<QString, QSharedPointer<QgsProject> >::const_iterator preloaded = mPreloadedProjects.constFind( path );
+    if ( preloaded != mPreloadedProjects.constEnd() )
     {
-      mProjectCache.insert( path, prj.release() );
+      return preloaded.value();
     }
+
+    if ( QSharedPointer<QgsProject> *cached = mProjectCache.object( path ) )
+    {
+      return *cached;
+    }
+  }
+
+  // the project is read without holding the lock, so that requests for other
+  // projects are not blocked meanwhile
+  QSharedPointer<QgsProject> prj( new QgsProject() );
+  if ( !prj->read( path ) )
+  {
+    return QSharedPointer<const QgsProject>();
   }
 
-  return mProjectCache[ path ];
+  QMutexLocker locker( &mMutex );
+  // another request may have read the same project meanwhile, keep the first one
+  if ( QSharedPointer<QgsProject> *cached = mProjectCache.object( path ) )
+  {
+    return *cached;
+  }
+  mProjectCache.insert( path, new QSharedPointer<QgsProject>( prj ) );
+  watchPath( path, true );
+  return prj;
 }
 
 QgsServerProjectParser *QgsConfigCache::serverConfiguration( const QString &filePath )
 {
+  QMutexLocker locker( &mMutex );
   QgsMessageLog::logMessage(
     QStringLiteral( "Open the project file '%1'." )
     .arg( filePath ),
@@ -95,6 +177,7 @@ QgsWmsConfigParser *QgsConfigCache::wmsConfiguration(
   , const QMap<QString, QString> &parameterMap
 )
 {
+  QMutexLocker locker( &mMutex );
   QgsWmsConfigParser *p = mWMSConfigCache.object( filePath );
   if ( !p )
   {
@@ -144,6 +227,7 @@ QDomDocument *QgsConfigCache::xmlDocument( const QString &filePath )
   }
 
   // first get cache
+  QMutexLocker locker( &mMutex );
   QDomDocument *xmlDoc = mXmlDocumentCache.object( filePath );
   if ( !xmlDoc )
   {
@@ -159,7 +243,7 @@ QDomDocument *QgsConfigCache::xmlDocument( const QString &filePath )
       return nullptr;
     }
     mXmlDocumentCache.insert( filePath, xmlDoc );
-    mFileSystemWatcher.addPath( filePath );
+    watchPath( filePath, true );
     xmlDoc = mXmlDocumentCache.object( filePath );
     Q_ASSERT( xmlDoc );
   }
@@ -168,17 +252,181 @@ QDomDocument *QgsConfigCache::xmlDocument( const QString &filePath )
 
 void QgsConfigCache::removeChangedEntry( const QString &path )
 {
-  mWMSConfigCache.remove( path );
+  {
+    QMutexLocker locker( &mMutex );
 
-  //xml document must be removed last, as other config cache destructors may require it
-  mXmlDocumentCache.remove( path );
+    // preloaded projects are replaced once read again, so that requests never wait
+    if ( mPreloadedProjects.contains( path ) )
+    {
+      if ( mReloadingPaths.contains( path ) )
+      {
+        mPendingReloads << path;
+      }
+      else
+      {
+        mReloadingPaths << path;
+        QtConcurrent::run( this, &QgsConfigCache::reloadProject, path );
+      }
+      return;
+    }
 
-  mFileSystemWatcher.removePath( path );
+    // following requests read the project again, while running requests keep their
+    // snapshot. Configuration parsers are removed later by removeChangedEntries()
+    if ( QSharedPointer<QgsProject> *project = mProjectCache.object( path ) )
+    {
+      mChangedProjects << *project;
+      mProjectCache.remove( path );
+    }
+    if ( !mChangedPaths.contains( path ) )
+    {
+      mChangedPaths << path;
+    }
+
+    watchPath( path, false );
+  }
+
+  emit projectChanged( path );
 }
 
+void QgsConfigCache::removeChangedEntries()
+{
+  QMutexLocker locker( &mMutex );
+  if ( mChangedPaths.isEmpty() && mChangedProjects.isEmpty() )
+  {
+    return;
+  }
+
+  Q_FOREACH ( const QString &path, mChangedPaths )
+  {
+    removeConfiguration( path );
+  }
+  mChangedPaths.clear();
+
+  //parsers referencing these projects are gone
+  mChangedProjects.clear();
+}
 
 void QgsConfigCache::removeEntry( const QString &path )
 {
-  removeChangedEntry( path );
+  {
+    QMutexLocker locker( &mMutex );
+    mProjectCache.remove( path );
+    mPreloadedProjects.remove( path );
+    mPendingReloads.remove( path );
+    mChangedPaths.removeAll( path );
+    removeConfiguration( path );
+    watchPath( path, false );
+  }
+
+  emit projectChanged( path );
+}
+
+int QgsConfigCache::preloadProjects( const QStringList &paths, int threadCount )
+{
+  QList<PreloadTask> tasks;
+  Q_FOREACH ( const QString &path, paths )
+  {
+    PreloadTask task;
+    task.path = path;
+    task.thread = thread();
+    tasks << task;
+  }
+
+  // a dedicated pool, so that the thread count does not change the global pool
+  QThreadPool pool;
+  if ( threadCount > 0 )
+  {
+    pool.setMaxThreadCount( threadCount );
+  }
+  for ( int i = 0; i < tasks.size(); ++i )
+  {
+    QtConcurrent::run( &pool, preload, &tasks[i] );
+  }
+  pool.waitForDone();
+
+  int count = 0;
+  QMutexLocker locker( &mMutex );
+  Q_FOREACH ( const PreloadTask &task, tasks )
+  {
+    if ( !task.project )
+    {
+      continue;
+    }
+    mPreloadedProjects.insert( task.path, task.project );
+    mProjectCache.remove( task.path );
+    watchPath( task.path, true );
+    ++count;
+  }
+
+  QgsMessageLog::logMessage( QStringLiteral( "Preloaded %1 of %2 projects" ).arg( count ).arg( paths.size() ), QStringLiteral( "Server" ), QgsMessageLog::INFO );
+  return count;
 }
 
+void QgsConfigCache::reloadProject( const QString &path )
+{
+  QSharedPointer<QgsProject> project = readPreloadedProject( path, thread() );
+
+  bool reloadAgain = false;
+  {
+    QMutexLocker locker( &mMutex );
+    mReloadingPaths.remove( path );
+    reloadAgain = mPendingReloads.remove( path );
+
+    // the entry may have been removed while the project was read
+    if ( !mPreloadedProjects.contains( path ) )
+    {
+      return;
+    }
+
+    // a saved file may be replaced, which stops its watch
+    watchPath( path, true );
+
+    if ( project )
+    {
+      // configuration parsers may still reference the previous project
+      mChangedProjects << mPreloadedProjects.value( path );
+      mPreloadedProjects.insert( path, project );
+      if ( !mChangedPaths.contains( path ) )
+      {
+        mChangedPaths << path;
+      }
+    }
+  }
+
+  if ( project )
+  {
+    emit projectChanged( path );
+  }
+
+  if ( reloadAgain )
+  {
+    removeChangedEntry( path );
+  }
+}
+
+void QgsConfigCache::removeConfiguration( const QString &path )
+{
+  mWMSConfigCache.remove( path );
+
+  //xml document must be removed last, as other config cache destructors may require it
+  mXmlDocumentCache.remove( path );
+}
+
+void QgsConfigCache::watchPath( const QString &path, bool watch )
+{
+  // the file system watcher must only be used from the thread of the cache
+  if ( QThread::currentThread() != thread() )
+  {
+    QMetaObject::invokeMethod( this, "watchPath", Qt::QueuedConnection, Q_ARG( QString, path ), Q_ARG( bool, watch ) );
+    return;
+  }
+
+  if ( watch && !mFileSystemWatcher.files().contains( path ) )
+  {
+    mFileSystemWatcher.addPath( path );
+  }
+  else if ( !watch && mFileSystemWatcher.files().contains( path ) )
+  {
+    mFileSystemWatcher.removePath( path );
+  }
+}
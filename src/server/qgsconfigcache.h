@@ -23,8 +23,12 @@
 #include <QCache>
 #include <QFileSystemWatcher>
 #include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QDomDocument>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
 
 #include "qgis_server.h"
 #include "qgis_sip.h"
@@ -55,22 +59,84 @@ class SERVER_EXPORT QgsConfigCache : public QObject
      */
     const QgsProject *project( const QString &path );
 
+    /** Returns a shared snapshot of the project read from \a path, or a null pointer
+     *  if the project cannot be read. Projects are never modified once cached, and a
+     *  snapshot stays valid for as long as it is referenced, even if the project file
+     *  changes and the cache reads it again. Snapshots can be used from any thread.
+     * \param path the filename of the QGIS project
+     * \note not available in Python bindings
+     * \since QGIS 3.0
+     */
+    QSharedPointer<const QgsProject> projectSnapshot( const QString &path ) SIP_SKIP;
+
+    /** Removes the configurations of project files which changed since the last call,
+     *  and releases the projects they referenced.
+     *  Configuration parsers are returned as plain pointers, so this must only be
+     *  called when no request is using them.
+     * \since QGIS 3.0
+     */
+    void removeChangedEntries();
+
+    /** Reads the projects of \a paths and keeps them until removeEntry() is called.
+     *  The first feature of each vector layer is fetched, so that provider connections
+     *  are opened before the first request. When the file of a preloaded project
+     *  changes, the project is read again in the background and replaces the cached
+     *  one once ready, requests keep using the previous project meanwhile.
+     * \param paths the filenames of the QGIS projects
+     * \param threadCount number of threads reading the projects, 0 for the number of processor cores
+     * \returns the number of projects read
+     * \since QGIS 3.0
+     */
+    int preloadProjects( const QStringList &paths, int threadCount = 0 );
+
+  signals:
+
+    /** Emitted when the cached configuration of \a path is removed, because the
+     *  file changed or removeEntry() was called. This may be emitted from any thread.
+     * \since QGIS 3.0
+     */
+    void projectChanged( const QString &path );
+
   private:
     QgsConfigCache() SIP_FORCE;
 
+    //! Protects the caches, which are used by concurrent requests and the file system watcher
+    QMutex mMutex;
+
     //! Check for configuration file updates (remove entry from cache if file changes)
     QFileSystemWatcher mFileSystemWatcher;
 
     //! Returns xml document for project file / sld or 0 in case of errors
     QDomDocument *xmlDocument( const QString &filePath );
 
+    //! Removes the configurations of \a path, the mutex must be locked
+    void removeConfiguration( const QString &path );
+
     QCache<QString, QDomDocument> mXmlDocumentCache;
     QCache<QString, QgsWmsConfigParser> mWMSConfigCache;
-    QCache<QString, QgsProject> mProjectCache;
+    QCache<QString, QSharedPointer<QgsProject> > mProjectCache;
+
+    //! Changed files whose configurations are removed by removeChangedEntries()
+    QStringList mChangedPaths;
+    //! Projects of changed files, which may still be referenced by configuration parsers
+    QList< QSharedPointer<QgsProject> > mChangedProjects;
+
+    //! Preloaded projects, which are never evicted
+    QMap<QString, QSharedPointer<QgsProject> > mPreloadedProjects;
+    //! Preloaded projects being read again
+    QSet<QString> mReloadingPaths;
+    //! Preloaded projects whose file changed again while being read
+    QSet<QString> mPendingReloads;
+
+    //! Reads a preloaded project again and replaces the cached one, from a worker thread
+    void reloadProject( const QString &path );
 
   private slots:
     //! Removes changed entry from this cache
     void removeChangedEntry( const QString &path );
+
+    //! Adds or removes \a path from the file system watcher, in the thread of the cache
+    void watchPath( const QString &path, bool watch );
 };
 
 #endif // QGSCONFIGCACHE_H
@@ -26,6 +26,8 @@
 
 #include <QBuffer>
 
+struct FCGX_Request;
+
 /**
  * \ingroup server
  * QgsFcgiServerResquest
@@ -34,7 +36,18 @@
 class SERVER_EXPORT QgsFcgiServerRequest: public QgsServerRequest
 {
   public:
+
+    /**
+     * Constructor for the request accepted by FCGI_Accept()
+     */
     QgsFcgiServerRequest();
+
+    /**
+     * Constructor for a \a request accepted by FCGX_Accept_r(), which is
+     * used when several threads accept requests.
+     * \since QGIS 3.0
+     */
+    explicit QgsFcgiServerRequest( FCGX_Request *request );
     ~QgsFcgiServerRequest();
 
     virtual QByteArray data() const override;
@@ -45,8 +58,12 @@ class SERVER_EXPORT QgsFcgiServerRequest: public QgsServerRequest
     bool hasError() const { return mHasError; }
 
   private:
+    void init();
     void readData();
 
+    //! Returns the value of a CGI parameter, or nullptr if it is not defined
+    const char *param( const char *name ) const;
+
     // Log request info: print debug infos
     // about the request
     void printRequestInfos();
@@ -54,6 +71,7 @@ class SERVER_EXPORT QgsFcgiServerRequest: public QgsServerRequest
 
     QByteArray mData;
     bool       mHasError;
+    FCGX_Request *mRequest = nullptr;
 };
 
 #endif
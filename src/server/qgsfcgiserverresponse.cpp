@@ -30,8 +30,9 @@
 // QgsFcgiServerResponse
 //
 
-QgsFcgiServerResponse::QgsFcgiServerResponse( QgsServerRequest::Method method )
+QgsFcgiServerResponse::QgsFcgiServerResponse( QgsServerRequest::Method method, FCGX_Request *request )
   : mMethod( method )
+  , mRequest( request )
 {
   mBuffer.open( QIODevice::ReadWrite );
   setDefaultHeaders();
@@ -113,15 +114,17 @@ void QgsFcgiServerResponse::flush()
   if ( ! mHeadersSent )
   {
     // Send all headers
+    QByteArray headers;
     QMap<QString, QString>::const_iterator it;
     for ( it = mHeaders.constBegin(); it != mHeaders.constEnd(); ++it )
     {
-      fputs( it.key().toUtf8(), FCGI_stdout );
-      fputs( ": ", FCGI_stdout );
-      fputs( it.value().toUtf8(), FCGI_stdout );
-      fputs( "\n", FCGI_stdout );
+      headers.append( it.key().toUtf8() );
+      headers.append( ": " );
+      headers.append( it.value().toUtf8() );
+      headers.append( "\n" );
     }
-    fputs( "\n", FCGI_stdout );
+    headers.append( "\n" );
+    output( headers );
     mHeadersSent = true;
   }
 
@@ -135,17 +138,27 @@ void QgsFcgiServerResponse::flush()
   else if ( mBuffer.bytesAvailable() > 0 )
   {
     QByteArray &ba = mBuffer.buffer();
-    size_t count   = fwrite( ( void * )ba.data(), ba.size(), 1, FCGI_stdout );
+    output( ba );
 #ifdef QGISDEBUG
-    qDebug() << QStringLiteral( "Sent %1 blocks of %2 bytes" ).arg( count ).arg( ba.size() );
-#else
-    Q_UNUSED( count );
+    qDebug() << QStringLiteral( "Sent %1 bytes" ).arg( ba.size() );
 #endif
     // Reset the internal buffer
     ba.clear();
   }
 }
 
+void QgsFcgiServerResponse::output( const QByteArray &data )
+{
+  if ( mRequest )
+  {
+    FCGX_PutStr( data.constData(), data.size(), mRequest->out );
+  }
+  else
+  {
+    fwrite( ( void * )data.constData(), data.size(), 1, FCGI_stdout );
+  }
+}
+
 
 void QgsFcgiServerResponse::clear()
 {
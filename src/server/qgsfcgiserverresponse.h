@@ -27,6 +27,8 @@
 
 #include <QBuffer>
 
+struct FCGX_Request;
+
 /**
  * \ingroup server
  * QgsFcgiServerResponse
@@ -36,7 +38,11 @@ class SERVER_EXPORT QgsFcgiServerResponse: public QgsServerResponse
 {
   public:
 
-    QgsFcgiServerResponse( QgsServerRequest::Method method = QgsServerRequest::GetMethod );
+    /**
+     * Constructor. The response is written to the output stream of \a request
+     * if it is set, or to the stream of the request accepted by FCGI_Accept().
+     */
+    QgsFcgiServerResponse( QgsServerRequest::Method method = QgsServerRequest::GetMethod, FCGX_Request *request = nullptr );
     ~QgsFcgiServerResponse();
 
     void setHeader( const QString &key, const QString &value ) override;
@@ -73,12 +79,16 @@ class SERVER_EXPORT QgsFcgiServerResponse: public QgsServerResponse
     void setDefaultHeaders();
 
   private:
+    //! Writes \a data to the FastCGI output stream
+    void output( const QByteArray &data );
+
     QMap<QString, QString> mHeaders;
     QBuffer mBuffer;
     bool mFinished    = false;
     bool mHeadersSent = false;
     QgsServerRequest::Method mMethod;
     int mStatusCode = 0;
+    FCGX_Request *mRequest = nullptr;
 };
 
 #endif
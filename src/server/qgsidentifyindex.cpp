@@ -0,0 +1,119 @@
+/***************************************************************************
+                              qgsidentifyindex.cpp
+                              --------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsidentifyindex.h"
+#include "qgsexpressioncontext.h"
+#include "qgsfeatureiterator.h"
+#include "qgsfeaturerequest.h"
+#include "qgsrendercontext.h"
+#include "qgsrenderer.h"
+#include "qgsvectorlayer.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+//! Maximum number of visibility keys, as clients may query any scale
+static const int MAX_VISIBILITY_KEYS = 64;
+
+QgsIdentifyIndex::QgsIdentifyIndex( QgsVectorLayer *layer )
+  : mSubsetString( layer->subsetString() )
+{
+  QgsFeature feature;
+  QgsFeatureIterator it = layer->getFeatures();
+  while ( it.nextFeature( feature ) )
+  {
+    if ( feature.hasGeometry() )
+    {
+      mIndex.insertFeature( feature );
+    }
+    mFeatures.insert( feature.id(), feature );
+    mPositions.insert( feature.id(), mIds.size() );
+    mIds << feature.id();
+  }
+}
+
+QList<QgsFeature> QgsIdentifyIndex::features( const QgsFeatureRequest &request, QgsVectorLayer *layer, int limit ) const
+{
+  QList<QgsFeatureId> ids;
+  if ( request.filterRect().isNull() )
+  {
+    ids = mIds;
+  }
+  else
+  {
+    // the spatial index returns candidates in no particular order
+    ids = mIndex.intersects( request.filterRect() );
+    std::sort( ids.begin(), ids.end(), [this]( QgsFeatureId a, QgsFeatureId b )
+    {
+      return mPositions.value( a ) < mPositions.value( b );
+    } );
+  }
+
+  // acceptFeature() tests the exact geometry against the filter rectangle, then the other filters
+  QgsFeatureRequest filter( request );
+  if ( filter.filterType() == QgsFeatureRequest::FilterExpression )
+  {
+    QgsExpressionContext context( QgsExpressionContextUtils::globalProjectLayerScopes( layer ) );
+    filter.filterExpression()->prepare( &context );
+    filter.setExpressionContext( context );
+  }
+
+  QList<QgsFeature> result;
+  Q_FOREACH ( QgsFeatureId id, ids )
+  {
+    if ( limit >= 0 && result.size() >= limit )
+    {
+      break;
+    }
+
+    const QgsFeature &feature = mFeatures[id];
+    if ( filter.acceptFeature( feature ) )
+    {
+      result << feature;
+    }
+  }
+  return result;
+}
+
+bool QgsIdentifyIndex::willRenderFeature( const QString &visibilityKey, QgsFeatureRenderer *renderer,
+    const QgsFeature &feature, QgsRenderContext &context )
+{
+  {
+    QMutexLocker locker( &mVisibilityMutex );
+    QHash<QString, QHash<QgsFeatureId, bool> >::const_iterator visibility = mVisibility.constFind( visibilityKey );
+    if ( visibility != mVisibility.constEnd() )
+    {
+      QHash<QgsFeatureId, bool>::const_iterator it = visibility->constFind( feature.id() );
+      if ( it != visibility->constEnd() )
+      {
+        return it.value();
+      }
+    }
+  }
+
+  QgsFeature renderedFeature( feature );
+  const bool render = renderer->willRenderFeature( renderedFeature, context );
+
+  QMutexLocker locker( &mVisibilityMutex );
+  if ( !mVisibility.contains( visibilityKey ) && mVisibility.size() >= MAX_VISIBILITY_KEYS )
+  {
+    mVisibility.clear();
+  }
+  mVisibility[visibilityKey].insert( feature.id(), render );
+  return render;
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+                              qgsidentifyindex.h
+                              ------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSIDENTIFYINDEX_H
+#define QGSIDENTIFYINDEX_H
+
+#define SIP_NO_FILE
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include "qgis_server.h"
+#include "qgsfeature.h"
+#include "qgsspatialindex.h"
+
+class QgsFeatureRenderer;
+class QgsFeatureRequest;
+class QgsRenderContext;
+class QgsVectorLayer;
+
+/** \ingroup server
+ * In-memory copy of the features of a vector layer with a spatial index, used to
+ * answer GetFeatureInfo requests without querying the provider. The visibility of
+ * features for the renderer is cached as well, for each visibility key given by
+ * the caller.
+ *
+ * Indexes are created and released with their layer by QgsMSLayerCache.
+ * \since QGIS 3.0
+ */
+class SERVER_EXPORT QgsIdentifyIndex
+{
+  public:
+
+    //! Reads all the features of \a layer, with its current subset string
+    explicit QgsIdentifyIndex( QgsVectorLayer *layer );
+
+    //! Returns the subset string of the layer when it was read
+    QString subsetString() const { return mSubsetString; }
+
+    //! Returns the number of indexed features
+    int featureCount() const { return mIds.size(); }
+
+    /** Returns the features accepted by \a request, in the order the provider returned
+     *  them when the index was built, which is the order of a provider request for most
+     *  providers. Database providers, whose order is not stable, may return the
+     *  features of the same request in a different order.
+     *  Only the filter rectangle, which is tested against the exact geometry, and the
+     *  feature, feature ids and expression filters of the request are supported.
+     *  \param request the request
+     *  \param layer the indexed layer, for the expression context of the filter
+     *  \param limit the maximum number of features, -1 for all of them
+     */
+    QList<QgsFeature> features( const QgsFeatureRequest &request, QgsVectorLayer *layer, int limit = -1 ) const;
+
+    /** Returns whether \a renderer draws \a feature. The result is computed once per
+     *  feature and \a visibilityKey, which must identify the renderer and the properties
+     *  of the context it depends on (e.g. the scale).
+     *  The expression context of \a context must already hold \a feature.
+     */
+    bool willRenderFeature( const QString &visibilityKey, QgsFeatureRenderer *renderer,
+                            const QgsFeature &feature, QgsRenderContext &context );
+
+  private:
+    QString mSubsetString;
+    QgsSpatialIndex mIndex;
+    QHash<QgsFeatureId, QgsFeature> mFeatures;
+    //! Ids in provider order, for requests without filter rectangle
+    QList<QgsFeatureId> mIds;
+    //! Position of each feature in provider order
+    QHash<QgsFeatureId, int> mPositions;
+
+    QMutex mVisibilityMutex;
+    QHash<QString, QHash<QgsFeatureId, bool> > mVisibility;
+};
+
+#endif // QGSIDENTIFYINDEX_H
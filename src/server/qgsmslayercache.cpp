@@ -23,6 +23,10 @@
 #include "qgslogger.h"
 #include "qgsserversettings.h"
 #include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
 
 QgsMSLayerCache *QgsMSLayerCache::instance()
 {
@@ -34,7 +38,8 @@ QgsMSLayerCache *QgsMSLayerCache::instance()
 
 QgsMSLayerCache::QgsMSLayerCache()
 {
-  QObject::connect( &mFileSystemWatcher, &QFileSystemWatcher::fileChanged, this, &QgsMSLayerCache::removeProjectFileLayers );
+  mIdentifyIndexes.setMaxCost( 0 );
+  QObject::connect( &mFileSystemWatcher, &QFileSystemWatcher::fileChanged, this, &QgsMSLayerCache::projectFileChanged );
 }
 
 QgsMSLayerCache::~QgsMSLayerCache()
@@ -52,6 +57,62 @@ void QgsMSLayerCache::setMaxCacheLayers( int maxCacheLayers )
   mDefaultMaxLayers = maxCacheLayers;
 }
 
+void QgsMSLayerCache::setIdentifyIndexSize( int size )
+{
+  mIdentifyIndexes.setMaxCost( std::max( 0, size ) );
+  mUnindexedLayers.clear();
+}
+
+QSharedPointer<QgsIdentifyIndex> QgsMSLayerCache::identifyIndex( QgsVectorLayer *layer )
+{
+  if ( !layer || mIdentifyIndexes.maxCost() <= 0 || mUnindexedLayers.contains( layer ) )
+  {
+    return QSharedPointer<QgsIdentifyIndex>();
+  }
+
+  const IdentifyIndexKey key = qMakePair( static_cast<QgsMapLayer *>( layer ), layer->subsetString() );
+  if ( QSharedPointer<QgsIdentifyIndex> *cached = mIdentifyIndexes.object( key ) )
+  {
+    return *cached;
+  }
+
+  // only layers of the cache, as their indexes are removed with them
+  bool cachedLayer = false;
+  QHash<QPair<QString, QString>, QgsMSLayerCacheEntry>::const_iterator entryIt = mEntries.constBegin();
+  for ( ; entryIt != mEntries.constEnd() && !cachedLayer; ++entryIt )
+  {
+    cachedLayer = entryIt.value().layerPointer == layer;
+  }
+  if ( !cachedLayer )
+  {
+    return QSharedPointer<QgsIdentifyIndex>();
+  }
+
+  const long featureCount = layer->featureCount();
+  if ( featureCount < 0 || featureCount > mIdentifyIndexes.maxCost() )
+  {
+    mUnindexedLayers << layer;
+    return QSharedPointer<QgsIdentifyIndex>();
+  }
+
+  QgsMessageLog::logMessage( "Layer cache: index features of layer '" + layer->name() + "'", QStringLiteral( "Server" ), QgsMessageLog::INFO );
+  QSharedPointer<QgsIdentifyIndex> index( new QgsIdentifyIndex( layer ) );
+  mIdentifyIndexes.insert( key, new QSharedPointer<QgsIdentifyIndex>( index ), std::max( 1, index->featureCount() ) );
+  return index;
+}
+
+void QgsMSLayerCache::removeIdentifyIndexes( QgsMapLayer *layer )
+{
+  Q_FOREACH ( const IdentifyIndexKey &key, mIdentifyIndexes.keys() )
+  {
+    if ( key.first == layer )
+    {
+      mIdentifyIndexes.remove( key );
+    }
+  }
+  mUnindexedLayers.remove( layer );
+}
+
 void QgsMSLayerCache::insertLayer( const QString &url, const QString &layerName, QgsMapLayer *layer, const QString &configFile, const QList<QString> &tempFiles )
 {
   QgsMessageLog::logMessage( "Layer cache: insert Layer '" + layerName + "' configFile: " + configFile, QStringLiteral( "Server" ), QgsMessageLog::INFO );
@@ -79,7 +140,7 @@ void QgsMSLayerCache::insertLayer( const QString &url, const QString &layerName,
     if ( configIt == mConfigFiles.constEnd() )
     {
       mConfigFiles.insert( configFile, 1 );
-      mFileSystemWatcher.addPath( configFile );
+      watchPath( configFile );
     }
     else
     {
@@ -186,6 +247,7 @@ void QgsMSLayerCache::freeEntryResources( QgsMSLayerCacheEntry &entry )
   if ( QgsProject::instance()->mapLayer( entry.layerPointer->id() ) )
     QgsProject::instance()->removeMapLayer( entry.layerPointer->id() );
 
+  removeIdentifyIndexes( entry.layerPointer );
   delete entry.layerPointer;
 
   //remove the temporary files of a layer
@@ -231,3 +293,36 @@ void QgsMSLayerCache::removeProjectLayers( const QString &path )
 {
   removeProjectFileLayers( path );
 }
+
+void QgsMSLayerCache::removeChangedProjectFileLayers()
+{
+  QSet<QString> changed;
+  {
+    QMutexLocker locker( &mChangedMutex );
+    changed.swap( mChangedProjectFiles );
+  }
+
+  Q_FOREACH ( const QString &project, changed )
+  {
+    removeProjectFileLayers( project );
+  }
+}
+
+void QgsMSLayerCache::projectFileChanged( const QString &project )
+{
+  // requests may be using the layers in other threads, they are removed later
+  QMutexLocker locker( &mChangedMutex );
+  mChangedProjectFiles << project;
+}
+
+void QgsMSLayerCache::watchPath( const QString &path )
+{
+  // the file system watcher must only be used from the thread of the cache
+  if ( QThread::currentThread() != thread() )
+  {
+    QMetaObject::invokeMethod( this, "watchPath", Qt::QueuedConnection, Q_ARG( QString, path ) );
+    return;
+  }
+
+  mFileSystemWatcher.addPath( path );
+}
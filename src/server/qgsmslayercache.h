@@ -22,13 +22,21 @@
 
 
 #include <time.h>
+#include <QCache>
 #include <QFileSystemWatcher>
 #include <QMultiHash>
+#include <QMutex>
 #include <QObject>
 #include <QPair>
+#include <QSet>
+#include <QSharedPointer>
 #include <QString>
 
+#include "qgis_server.h"
+#include "qgsidentifyindex.h"
+
 class QgsMapLayer;
+class QgsVectorLayer;
 
 struct QgsMSLayerCacheEntry
 {
@@ -52,7 +60,7 @@ struct QgsMSLayerCacheEntry
 
 /** A singleton class that caches layer objects for the
 QGIS mapserver*/
-class QgsMSLayerCache: public QObject
+class SERVER_EXPORT QgsMSLayerCache: public QObject
 {
     Q_OBJECT
   public:
@@ -79,6 +87,22 @@ class QgsMSLayerCache: public QObject
 
     int projectsMaxLayers() const { return mProjectMaxLayers; }
 
+    /**
+      * Sets the maximum number of features held by the identify indexes.
+      * \param size the number of features, 0 to disable identify indexes
+      * \since QGIS 3.0
+      */
+    void setIdentifyIndexSize( int size );
+
+    /**
+      * Returns the identify index of a cached \a layer with its current subset string,
+      * which is built on first use if the layer has few enough features.
+      * \returns the index, or a null pointer if the layer is not in the cache, has
+      * too many features or identify indexes are disabled
+      * \since QGIS 3.0
+      */
+    QSharedPointer<QgsIdentifyIndex> identifyIndex( QgsVectorLayer *layer );
+
     void setProjectMaxLayers( int n ) { mProjectMaxLayers = n; }
 
     //for debugging
@@ -87,6 +111,14 @@ class QgsMSLayerCache: public QObject
     //! Expose method for use in server interface
     void removeProjectLayers( const QString &path );
 
+    /**
+      * Removes the layers of the project files which changed since the last call.
+      * Changes are only recorded by the file system watcher, as cached layers may
+      * be used by a running request. This must be called when no request uses them.
+      * \since QGIS 3.0
+      */
+    void removeChangedProjectFileLayers();
+
   protected:
     //! Protected singleton constructor
     QgsMSLayerCache();
@@ -119,10 +151,33 @@ class QgsMSLayerCache: public QObject
     //! Maximum number of layers in the cache, overrides DEFAULT_MAX_N_LAYERS if larger
     int mProjectMaxLayers = 100;
 
-  private slots:
+    typedef QPair<QgsMapLayer *, QString> IdentifyIndexKey;
+
+    //! Identify indexes by layer and subset string, with their number of features as cost
+    QCache<IdentifyIndexKey, QSharedPointer<QgsIdentifyIndex> > mIdentifyIndexes;
+
+    //! Layers with too many features to be indexed
+    QSet<QgsMapLayer *> mUnindexedLayers;
+
+    //! Removes the identify indexes of a layer
+    void removeIdentifyIndexes( QgsMapLayer *layer );
 
     //! Removes entries from a project (e.g. if a project file has changed)
     void removeProjectFileLayers( const QString &project );
+
+    //! Protects mChangedProjectFiles, which is filled in the thread of the cache
+    QMutex mChangedMutex;
+
+    //! Project files which changed, their layers are removed by removeChangedProjectFileLayers()
+    QSet<QString> mChangedProjectFiles;
+
+  private slots:
+
+    //! Records a changed project file
+    void projectFileChanged( const QString &project );
+
+    //! Adds \a path to the file system watcher, in the thread of the cache
+    void watchPath( const QString &path );
 };
 
 #endif
@@ -33,6 +33,7 @@
 #include "qgsmapserviceexception.h"
 #include "qgsnetworkaccessmanager.h"
 #include "qgsserverlogger.h"
+#include "qgsserverprofiler.h"
 #include "qgseditorwidgetregistry.h"
 #include "qgsserverrequest.h"
 #include "qgsbufferserverresponse.h"
@@ -45,6 +46,7 @@
 #include <QDomDocument>
 #include <QNetworkDiskCache>
 #include <QImage>
+#include <QReadWriteLock>
 #include <QSettings>
 #include <QDateTime>
 
@@ -67,6 +69,28 @@ QgsServerSettings QgsServer::sSettings;
 
 QgsServiceRegistry QgsServer::sServiceRegistry;
 
+///@cond PRIVATE
+
+//! Held for reading by concurrent requests and for writing by all other requests
+static QReadWriteLock sRequestLock;
+
+/**
+ * Returns true if the request only uses the project snapshot and per request copies
+ * of its layers, so that it can run concurrently with other such requests. Other
+ * requests use the global project instance and the configuration parsers.
+ */
+static bool isConcurrentRequest( const QgsServerRequest::Parameters &parameters )
+{
+  const QString service = parameters.value( QStringLiteral( "SERVICE" ) );
+  const QString request = parameters.value( QStringLiteral( "REQUEST" ) );
+  const QString format = parameters.value( QStringLiteral( "FORMAT" ) );
+  return ( service.isEmpty() || service.compare( QLatin1String( "WMS" ), Qt::CaseInsensitive ) == 0 )
+         && request.compare( QLatin1String( "GetMap" ), Qt::CaseInsensitive ) == 0
+         && format.compare( QLatin1String( "application/dxf" ), Qt::CaseInsensitive ) != 0;
+}
+
+///@endcond
+
 QgsServer::QgsServer( )
 {
   // QgsApplication must exist
@@ -224,6 +248,7 @@ bool QgsServer::init( )
   // init and configure cache
   QgsMSLayerCache::instance();
   QgsMSLayerCache::instance()->setMaxCacheLayers( sSettings.maxCacheLayers() );
+  QgsMSLayerCache::instance()->setIdentifyIndexSize( sSettings.identifyIndexSize() );
 
   // log settings currently used
   sSettings.logSummary();
@@ -282,6 +307,13 @@ bool QgsServer::init( )
   qDebug() << "Initializing server modules from " << modulePath << endl;
   sServiceRegistry.init( modulePath,  sServerInterface );
 
+  // read the preloaded projects before the first request
+  const QStringList preloadProjects = sSettings.preloadProjects();
+  if ( !preloadProjects.isEmpty() )
+  {
+    QgsConfigCache::instance()->preloadProjects( preloadProjects, sSettings.preloadThreads() );
+  }
+
   sInitialized = true;
   QgsMessageLog::logMessage( QStringLiteral( "Server initialized" ), QStringLiteral( "Server" ), QgsMessageLog::INFO );
   return true;
@@ -309,9 +341,43 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
 {
   QgsMessageLog::MessageLevel logLevel = QgsServerLogger::instance()->logLevel();
   QTime time; //used for measuring request time if loglevel < 1
-  QgsProject::instance()->removeAllMapLayers();
 
-  qApp->processEvents();
+  // aggregated timings are served without taking the request lock
+  if ( sSettings.metrics() && request.parameters().value( QStringLiteral( "SERVICE" ) ).compare( QLatin1String( "METRICS" ), Qt::CaseInsensitive ) == 0 )
+  {
+    response.setHeader( QStringLiteral( "Content-Type" ), QStringLiteral( "text/plain; version=0.0.4" ) );
+    response.write( QgsServerMetrics::instance()->prometheusText() );
+    response.finish();
+    return;
+  }
+
+  // the profiler is current in this thread until the request is finished
+  std::unique_ptr<QgsServerProfiler> profiler;
+  if ( sSettings.timingHeader() || sSettings.timingLog() || sSettings.metrics() )
+  {
+    profiler.reset( new QgsServerProfiler() );
+  }
+
+  // with several request threads, only requests working on project snapshots run
+  // concurrently, the others are executed one at a time
+  const bool concurrent = sSettings.requestThreads() > 1 && isConcurrentRequest( request.parameters() );
+  QReadLocker concurrentLocker( concurrent ? &sRequestLock : nullptr );
+  QWriteLocker exclusiveLocker( concurrent ? nullptr : &sRequestLock );
+  if ( !concurrent )
+  {
+    QgsProject::instance()->removeAllMapLayers();
+
+    qApp->processEvents();
+
+    // file system watchers only record changes, as the cached layers and documents
+    // may be in use by a request of another thread
+    QgsMSLayerCache::instance()->removeChangedProjectFileLayers();
+    sCapabilitiesCache->removeChangedEntries();
+  }
+
+  // configuration parsers are only used by requests running alone, so concurrent
+  // requests can release the ones of changed projects as well
+  mConfigCache->removeChangedEntries();
 
   if ( logLevel == QgsMessageLog::INFO )
   {
@@ -328,6 +394,7 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
   try
   {
     // TODO: split parse input into plain parse and processing from specific services
+    QgsServerProfiler::Scope scope( QStringLiteral( "parse" ) );
     requestHandler.parseInput();
   }
   catch ( QgsMapServiceException &e )
@@ -353,8 +420,13 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
       //Config file path
       QString configFilePath = configPath( *sConfigFilePath, parameterMap );
 
-      // load the project if needed and not empty
-      const QgsProject *project = mConfigCache->project( configFilePath );
+      // load the project if needed and not empty. The snapshot stays valid until the
+      // request is finished, even if the project file changes in the meantime
+      QSharedPointer<const QgsProject> project;
+      {
+        QgsServerProfiler::Scope scope( QStringLiteral( "project" ) );
+        project = mConfigCache->projectSnapshot( configFilePath );
+      }
       if ( ! project )
       {
         throw QgsServerException( QStringLiteral( "Project file error" ) );
@@ -388,7 +460,7 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
       QgsService *service = sServiceRegistry.getService( serviceString, versionString );
       if ( service )
       {
-        service->executeRequest( request, responseDecorator, project );
+        service->executeRequest( request, responseDecorator, project.data() );
       }
       else
       {
@@ -406,6 +478,12 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
       response.sendError( 500, ex.what() );
     }
   }
+  // Streamed responses have already sent their headers
+  if ( profiler && sSettings.timingHeader() && !response.headersSent() )
+  {
+    response.setHeader( QStringLiteral( "Server-Timing" ), profiler->serverTimingHeader() );
+  }
+
   // Terminate the response
   responseDecorator.finish();
 
@@ -417,6 +495,21 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
   {
     QgsMessageLog::logMessage( "Request finished in " + QString::number( time.elapsed() ) + " ms", QStringLiteral( "Server" ), QgsMessageLog::INFO );
   }
+
+  if ( profiler )
+  {
+    const QString service = request.parameters().value( QStringLiteral( "SERVICE" ) );
+    const QString requestName = request.parameters().value( QStringLiteral( "REQUEST" ) );
+    if ( sSettings.timingLog() )
+    {
+      // logged at the current level to bypass the log level filter
+      QgsMessageLog::logMessage( profiler->toJson( service, requestName ), QStringLiteral( "Server" ), logLevel );
+    }
+    if ( sSettings.metrics() )
+    {
+      QgsServerMetrics::instance()->addRequest( service, requestName, *profiler );
+    }
+  }
 }
 
 
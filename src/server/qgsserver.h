@@ -41,6 +41,7 @@
 #include "qgsserverfilter.h"
 #include "qgsserverinterfaceimpl.h"
 #include "qgis_server.h"
+#include "qgis_sip.h"
 #include "qgsserverrequest.h"
 
 class QgsServerResponse;
@@ -71,8 +72,12 @@ class SERVER_EXPORT QgsServer
      *
      * \param request a QgsServerRequest holding request parameters
      * \param response a QgsServerResponse for handling response I/O)
+     *
+     * The Python global interpreter lock is released while the request is handled, so
+     * that requests can be handled from several Python threads when QGIS_SERVER_REQUEST_THREADS
+     * is greater than 1.
      */
-    void handleRequest( QgsServerRequest &request, QgsServerResponse &response );
+    void handleRequest( QgsServerRequest &request, QgsServerResponse &response ) SIP_RELEASEGIL;
 
 
     //! Returns a pointer to the server interface
@@ -0,0 +1,260 @@
+/***************************************************************************
+                              qgsserverprofiler.cpp
+                              ---------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsserverprofiler.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThreadStorage>
+
+#include <algorithm>
+
+///@cond PRIVATE
+namespace
+{
+  // profilers are stack objects, the storage never owns one when its thread exits
+  QThreadStorage<QgsServerProfiler *> sCurrentProfiler;
+
+  // default buckets of Prometheus client libraries, in seconds
+  const double DURATION_BUCKETS[] = { 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 };
+  const int DURATION_BUCKET_COUNT = sizeof( DURATION_BUCKETS ) / sizeof( DURATION_BUCKETS[0] );
+
+  QString formatMilliseconds( double elapsed )
+  {
+    return QString::number( elapsed, 'f', 1 );
+  }
+
+  QString escapeQuoted( QString value )
+  {
+    return value.replace( '\\', QLatin1String( "\\\\" ) ).replace( '"', QLatin1String( "\\\"" ) );
+  }
+
+  QString escapeLabel( const QString &value )
+  {
+    return escapeQuoted( value ).replace( '\n', QLatin1String( "\\n" ) );
+  }
+
+  // label of the services and requests missing from the lists below
+  const QString OTHER_LABEL = QStringLiteral( "other" );
+
+  // requests of the services built with the server, with the case of their specifications
+  const char *const WMS_REQUESTS[] = { "GetCapabilities", "GetProjectSettings", "GetMap", "GetFeatureInfo", "GetContext",
+                                       "GetSchemaExtension", "GetStyle", "GetStyles", "DescribeLayer", "GetLegendGraphic",
+                                       "GetLegendGraphics", "GetPrint", nullptr
+                                     };
+  const char *const WFS_REQUESTS[] = { "GetCapabilities", "GetFeature", "DescribeFeatureType", "Transaction", nullptr };
+  const char *const WCS_REQUESTS[] = { "GetCapabilities", "DescribeCoverage", "GetCoverage", nullptr };
+
+  //! Returns the name in \a names equal to \a value regardless of case, or the "other" label
+  QString knownName( const QString &value, const char *const *names )
+  {
+    for ( ; *names; ++names )
+    {
+      if ( value.compare( QLatin1String( *names ), Qt::CaseInsensitive ) == 0 )
+        return QLatin1String( *names );
+    }
+    return OTHER_LABEL;
+  }
+
+  //! Returns the service and request labels of a request
+  QPair<QString, QString> requestLabels( const QString &service, const QString &request )
+  {
+    const QString serviceName = service.toUpper();
+    if ( serviceName == QLatin1String( "WMS" ) )
+      return qMakePair( serviceName, knownName( request, WMS_REQUESTS ) );
+    if ( serviceName == QLatin1String( "WFS" ) )
+      return qMakePair( serviceName, knownName( request, WFS_REQUESTS ) );
+    if ( serviceName == QLatin1String( "WCS" ) )
+      return qMakePair( serviceName, knownName( request, WCS_REQUESTS ) );
+    return qMakePair( OTHER_LABEL, OTHER_LABEL );
+  }
+}
+///@endcond
+
+QgsServerProfiler::Scope::Scope( const QString &phase, const QString &layer )
+  : mPhase( phase )
+  , mLayer( layer )
+{
+  mTimer.start();
+}
+
+QgsServerProfiler::Scope::~Scope()
+{
+  QgsServerProfiler::record( mPhase, mTimer.nsecsElapsed() / 1e6, mLayer );
+}
+
+QgsServerProfiler::QgsServerProfiler()
+  : mPrevious( sCurrentProfiler.localData() )
+{
+  mTimer.start();
+  sCurrentProfiler.setLocalData( this );
+}
+
+QgsServerProfiler::~QgsServerProfiler()
+{
+  sCurrentProfiler.setLocalData( mPrevious );
+}
+
+QgsServerProfiler *QgsServerProfiler::current()
+{
+  return sCurrentProfiler.hasLocalData() ? sCurrentProfiler.localData() : nullptr;
+}
+
+void QgsServerProfiler::record( const QString &phase, double elapsed, const QString &layer )
+{
+  if ( QgsServerProfiler *profiler = current() )
+  {
+    profiler->add( phase, elapsed, layer );
+  }
+}
+
+void QgsServerProfiler::add( const QString &phase, double elapsed, const QString &layer )
+{
+  for ( int i = 0; i < mTimings.size(); ++i )
+  {
+    if ( mTimings.at( i ).phase == phase && mTimings.at( i ).layer == layer )
+    {
+      mTimings[i].elapsed += elapsed;
+      return;
+    }
+  }
+  Timing timing;
+  timing.phase = phase;
+  timing.layer = layer;
+  timing.elapsed = elapsed;
+  mTimings << timing;
+}
+
+double QgsServerProfiler::elapsed() const
+{
+  return mTimer.nsecsElapsed() / 1e6;
+}
+
+QString QgsServerProfiler::serverTimingHeader() const
+{
+  QStringList metrics;
+  Q_FOREACH ( const Timing &timing, mTimings )
+  {
+    QString metric = timing.phase;
+    if ( !timing.layer.isEmpty() )
+    {
+      metric += QStringLiteral( ";desc=\"%1\"" ).arg( escapeQuoted( timing.layer ) );
+    }
+    metric += QStringLiteral( ";dur=%1" ).arg( formatMilliseconds( timing.elapsed ) );
+    metrics << metric;
+  }
+  metrics << QStringLiteral( "total;dur=%1" ).arg( formatMilliseconds( elapsed() ) );
+  return metrics.join( QStringLiteral( ", " ) );
+}
+
+QString QgsServerProfiler::toJson( const QString &service, const QString &request ) const
+{
+  QJsonArray timings;
+  Q_FOREACH ( const Timing &timing, mTimings )
+  {
+    QJsonObject object;
+    object.insert( QStringLiteral( "phase" ), timing.phase );
+    if ( !timing.layer.isEmpty() )
+    {
+      object.insert( QStringLiteral( "layer" ), timing.layer );
+    }
+    object.insert( QStringLiteral( "ms" ), formatMilliseconds( timing.elapsed ).toDouble() );
+    timings.append( object );
+  }
+
+  QJsonObject object;
+  object.insert( QStringLiteral( "service" ), service );
+  object.insert( QStringLiteral( "request" ), request );
+  object.insert( QStringLiteral( "total_ms" ), formatMilliseconds( elapsed() ).toDouble() );
+  object.insert( QStringLiteral( "timings" ), timings );
+  return QString::fromUtf8( QJsonDocument( object ).toJson( QJsonDocument::Compact ) );
+}
+
+QgsServerMetrics *QgsServerMetrics::instance()
+{
+  static QgsServerMetrics *sInstance = new QgsServerMetrics();
+  return sInstance;
+}
+
+void QgsServerMetrics::addRequest( const QString &service, const QString &request, const QgsServerProfiler &profiler )
+{
+  const double seconds = profiler.elapsed() / 1000;
+  const QList<QgsServerProfiler::Timing> timings = profiler.timings();
+
+  QMutexLocker locker( &mMutex );
+  Histogram &histogram = mRequests[ requestLabels( service, request )];
+  if ( histogram.buckets.isEmpty() )
+  {
+    histogram.buckets.fill( 0, DURATION_BUCKET_COUNT );
+  }
+  for ( int i = 0; i < DURATION_BUCKET_COUNT; ++i )
+  {
+    if ( seconds <= DURATION_BUCKETS[i] )
+    {
+      ++histogram.buckets[i];
+    }
+  }
+  ++histogram.count;
+  histogram.sum += seconds;
+
+  Q_FOREACH ( const QgsServerProfiler::Timing &timing, timings )
+  {
+    Counter &counter = mPhases[ qMakePair( timing.phase, timing.layer )];
+    ++counter.count;
+    counter.sum += timing.elapsed / 1000;
+  }
+}
+
+QByteArray QgsServerMetrics::prometheusText() const
+{
+  QMutexLocker locker( &mMutex );
+  QStringList lines;
+
+  lines << QStringLiteral( "# HELP qgis_server_request_duration_seconds Duration of the requests." )
+        << QStringLiteral( "# TYPE qgis_server_request_duration_seconds histogram" );
+  QList<Key> requests = mRequests.keys();
+  std::sort( requests.begin(), requests.end() );
+  Q_FOREACH ( const Key &key, requests )
+  {
+    const Histogram histogram = mRequests.value( key );
+    const QString labels = QStringLiteral( "service=\"%1\",request=\"%2\"" ).arg( escapeLabel( key.first ), escapeLabel( key.second ) );
+    for ( int i = 0; i < DURATION_BUCKET_COUNT; ++i )
+    {
+      lines << QStringLiteral( "qgis_server_request_duration_seconds_bucket{%1,le=\"%2\"} %3" ).arg( labels ).arg( DURATION_BUCKETS[i] ).arg( histogram.buckets.at( i ) );
+    }
+    lines << QStringLiteral( "qgis_server_request_duration_seconds_bucket{%1,le=\"+Inf\"} %2" ).arg( labels ).arg( histogram.count )
+          << QStringLiteral( "qgis_server_request_duration_seconds_sum{%1} %2" ).arg( labels ).arg( histogram.sum, 0, 'g', 10 )
+          << QStringLiteral( "qgis_server_request_duration_seconds_count{%1} %2" ).arg( labels ).arg( histogram.count );
+  }
+
+  lines << QStringLiteral( "# HELP qgis_server_phase_seconds Time spent in the phases of the requests, by layer." )
+        << QStringLiteral( "# TYPE qgis_server_phase_seconds summary" );
+  QList<Key> phases = mPhases.keys();
+  std::sort( phases.begin(), phases.end() );
+  Q_FOREACH ( const Key &key, phases )
+  {
+    const Counter counter = mPhases.value( key );
+    const QString labels = QStringLiteral( "phase=\"%1\",layer=\"%2\"" ).arg( escapeLabel( key.first ), escapeLabel( key.second ) );
+    lines << QStringLiteral( "qgis_server_phase_seconds_sum{%1} %2" ).arg( labels ).arg( counter.sum, 0, 'g', 10 )
+          << QStringLiteral( "qgis_server_phase_seconds_count{%1} %2" ).arg( labels ).arg( counter.count );
+  }
+
+  return ( lines.join( '\n' ) + '\n' ).toUtf8();
+}
@@ -0,0 +1,145 @@
+/***************************************************************************
+                              qgsserverprofiler.h
+                              -------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSSERVERPROFILER_H
+#define QGSSERVERPROFILER_H
+
+#define SIP_NO_FILE
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include "qgis_server.h"
+
+/** \ingroup server
+ * Collects the time spent in the phases of a request: project load, parsing,
+ * feature fetching, rendering, labeling, encoding...
+ *
+ * The profiler of a request is current in the thread handling the request
+ * during its lifetime, so that services record timings with the static
+ * record() method or a Scope without having access to the profiler.
+ * \since QGIS 3.0
+ */
+class SERVER_EXPORT QgsServerProfiler
+{
+  public:
+
+    //! Time spent in a phase, for a layer or for the whole request
+    struct Timing
+    {
+      QString phase;
+      QString layer;
+      double elapsed; //!< in milliseconds
+    };
+
+    //! Measures the time spent until the scope is destroyed
+    class SERVER_EXPORT Scope
+    {
+      public:
+        explicit Scope( const QString &phase, const QString &layer = QString() );
+        ~Scope();
+
+      private:
+        QString mPhase;
+        QString mLayer;
+        QElapsedTimer mTimer;
+    };
+
+    //! Starts profiling a request, the profiler becomes current in the thread
+    QgsServerProfiler();
+    ~QgsServerProfiler();
+
+    //! Returns the profiler of the request handled by the current thread, or nullptr
+    static QgsServerProfiler *current();
+
+    //! Adds a timing to the current profiler, if any
+    static void record( const QString &phase, double elapsed, const QString &layer = QString() );
+
+    //! Adds a timing, timings of the same phase and layer are summed
+    void add( const QString &phase, double elapsed, const QString &layer = QString() );
+
+    //! Returns the timings in the order of their first record
+    QList<Timing> timings() const { return mTimings; }
+
+    //! Returns the time elapsed since the request started, in milliseconds
+    double elapsed() const;
+
+    //! Returns the value of a Server-Timing response header
+    QString serverTimingHeader() const;
+
+    //! Returns the timings as a single line JSON object
+    QString toJson( const QString &service, const QString &request ) const;
+
+  private:
+    QElapsedTimer mTimer;
+    QList<Timing> mTimings;
+    QgsServerProfiler *mPrevious = nullptr;
+};
+
+/** \ingroup server
+ * Aggregates the timings of requests, exposed in the Prometheus text format.
+ * The metrics are thread safe.
+ * \since QGIS 3.0
+ */
+class SERVER_EXPORT QgsServerMetrics
+{
+  public:
+    static QgsServerMetrics *instance();
+
+    /** Adds the timings of a request. Service and request names are matched regardless
+     *  of case. Requests of services other than WMS, WFS and WCS, or not known by these
+     *  services, are counted with the "other" label, so that clients cannot create
+     *  series with arbitrary parameters.
+     */
+    void addRequest( const QString &service, const QString &request, const QgsServerProfiler &profiler );
+
+    //! Returns the metrics in the Prometheus text exposition format
+    QByteArray prometheusText() const;
+
+  private:
+    QgsServerMetrics() = default;
+
+    //! Service and request, or phase and layer
+    typedef QPair<QString, QString> Key;
+
+    struct Histogram
+    {
+      QVector<quint64> buckets;
+      quint64 count = 0;
+      double sum = 0; //!< in seconds
+    };
+
+    struct Counter
+    {
+      quint64 count = 0;
+      double sum = 0; //!< in seconds
+    };
+
+    mutable QMutex mMutex;
+    //! Request durations by service and request
+    QHash<Key, Histogram> mRequests;
+    //! Phase durations by phase and layer
+    QHash<Key, Counter> mPhases;
+};
+
+#endif // QGSSERVERPROFILER_H
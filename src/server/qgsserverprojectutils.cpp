@@ -100,6 +100,11 @@ int QgsServerProjectUtils::wmsMaxHeight( const QgsProject &project )
   return project.readNumEntry( QStringLiteral( "WMSMaxHeight" ), QStringLiteral( "/" ), -1 );
 }
 
+int QgsServerProjectUtils::wmsImageQuality( const QgsProject &project )
+{
+  return project.readNumEntry( QStringLiteral( "WMSImageQuality" ), QStringLiteral( "/" ), -1 );
+}
+
 bool QgsServerProjectUtils::wmsUseLayerIds( const QgsProject &project )
 {
   return project.readBoolEntry( QStringLiteral( "WMSUseLayerIDs" ), QStringLiteral( "/" ), false );
@@ -19,8 +19,10 @@
 #include "qgsserversettings.h"
 #include "qgsapplication.h"
 
+#include <QDir>
 #include <QSettings>
 
+#include <algorithm>
 #include <iostream>
 
 QgsServerSettings::QgsServerSettings()
@@ -130,6 +132,160 @@ void QgsServerSettings::initSettings()
                                QVariant()
                              };
   mSettings[ sCacheSize.envVar ] = sCacheSize;
+
+  // request threads
+  const Setting sRequestThreads = { QgsServerSettingsEnv::QGIS_SERVER_REQUEST_THREADS,
+                                    QgsServerSettingsEnv::DEFAULT_VALUE,
+                                    "Number of threads accepting FastCGI requests",
+                                    "/qgis/request_threads",
+                                    QVariant::Int,
+                                    QVariant( 1 ),
+                                    QVariant()
+                                  };
+  mSettings[ sRequestThreads.envVar ] = sRequestThreads;
+
+  // wms cache memory size
+  const Setting sWmsCacheMemorySize = { QgsServerSettingsEnv::QGIS_SERVER_WMS_CACHE_MEMORY_SIZE,
+                                        QgsServerSettingsEnv::DEFAULT_VALUE,
+                                        "Specify the size of the memory cache for rendered WMS images",
+                                        "/wms_cache/memory_size",
+                                        QVariant::LongLong,
+                                        QVariant( 0 ),
+                                        QVariant()
+                                      };
+  mSettings[ sWmsCacheMemorySize.envVar ] = sWmsCacheMemorySize;
+
+  // wms cache directory
+  const Setting sWmsCacheDir = { QgsServerSettingsEnv::QGIS_SERVER_WMS_CACHE_DIRECTORY,
+                                 QgsServerSettingsEnv::DEFAULT_VALUE,
+                                 "Specify the directory of the disk cache for rendered WMS images",
+                                 "/wms_cache/directory",
+                                 QVariant::String,
+                                 QVariant( "" ),
+                                 QVariant()
+                               };
+  mSettings[ sWmsCacheDir.envVar ] = sWmsCacheDir;
+
+  // wms cache disk size
+  const Setting sWmsCacheDiskSize = { QgsServerSettingsEnv::QGIS_SERVER_WMS_CACHE_DISK_SIZE,
+                                      QgsServerSettingsEnv::DEFAULT_VALUE,
+                                      "Specify the size of the disk cache for rendered WMS images",
+                                      "/wms_cache/disk_size",
+                                      QVariant::LongLong,
+                                      QVariant( 256 * 1024 * 1024 ),
+                                      QVariant()
+                                    };
+  mSettings[ sWmsCacheDiskSize.envVar ] = sWmsCacheDiskSize;
+
+  // wms metatile size
+  const Setting sWmsMetatileSize = { QgsServerSettingsEnv::QGIS_SERVER_WMS_METATILE_SIZE,
+                                     QgsServerSettingsEnv::DEFAULT_VALUE,
+                                     "Number of tiles per side of the metatiles rendered for cached WMS images",
+                                     "/wms_cache/metatile_size",
+                                     QVariant::Int,
+                                     QVariant( 1 ),
+                                     QVariant()
+                                   };
+  mSettings[ sWmsMetatileSize.envVar ] = sWmsMetatileSize;
+
+  // png8 dithering
+  const Setting sWmsPng8Dither = { QgsServerSettingsEnv::QGIS_SERVER_WMS_PNG8_DITHER,
+                                   QgsServerSettingsEnv::DEFAULT_VALUE,
+                                   "Apply the palette of 8 bit PNG images with error diffusion",
+                                   "/wms/png8_dither",
+                                   QVariant::Bool,
+                                   QVariant( false ),
+                                   QVariant()
+                                 };
+  mSettings[ sWmsPng8Dither.envVar ] = sWmsPng8Dither;
+
+  // png8 threads
+  const Setting sWmsPng8Threads = { QgsServerSettingsEnv::QGIS_SERVER_WMS_PNG8_THREADS,
+                                    QgsServerSettingsEnv::DEFAULT_VALUE,
+                                    "Number of threads computing the palette of 8 bit PNG images (0 for the number of cores)",
+                                    "/wms/png8_threads",
+                                    QVariant::Int,
+                                    QVariant( 1 ),
+                                    QVariant()
+                                  };
+  mSettings[ sWmsPng8Threads.envVar ] = sWmsPng8Threads;
+
+  // preloaded projects
+  const Setting sPreloadProjects = { QgsServerSettingsEnv::QGIS_SERVER_PRELOAD_PROJECTS,
+                                     QgsServerSettingsEnv::DEFAULT_VALUE,
+                                     "Projects read when the server starts and kept in memory",
+                                     "/qgis/preload_projects",
+                                     QVariant::String,
+                                     QVariant( "" ),
+                                     QVariant()
+                                   };
+  mSettings[ sPreloadProjects.envVar ] = sPreloadProjects;
+
+  // preload threads
+  const Setting sPreloadThreads = { QgsServerSettingsEnv::QGIS_SERVER_PRELOAD_THREADS,
+                                    QgsServerSettingsEnv::DEFAULT_VALUE,
+                                    "Number of threads reading the preloaded projects (0 for the number of cores)",
+                                    "/qgis/preload_threads",
+                                    QVariant::Int,
+                                    QVariant( 0 ),
+                                    QVariant()
+                                  };
+  mSettings[ sPreloadThreads.envVar ] = sPreloadThreads;
+
+  // identify index size
+  const Setting sIdentifyIndexSize = { QgsServerSettingsEnv::QGIS_SERVER_IDENTIFY_INDEX_SIZE,
+                                       QgsServerSettingsEnv::DEFAULT_VALUE,
+                                       "Maximum number of features indexed in memory for GetFeatureInfo (0 to disable)",
+                                       "/qgis/identify_index_size",
+                                       QVariant::Int,
+                                       QVariant( 0 ),
+                                       QVariant()
+                                     };
+  mSettings[ sIdentifyIndexSize.envVar ] = sIdentifyIndexSize;
+
+  // timing header
+  const Setting sTimingHeader = { QgsServerSettingsEnv::QGIS_SERVER_TIMING_HEADER,
+                                  QgsServerSettingsEnv::DEFAULT_VALUE,
+                                  "Add a Server-Timing header with the time spent in each phase of requests",
+                                  "/qgis/timing_header",
+                                  QVariant::Bool,
+                                  QVariant( false ),
+                                  QVariant()
+                                };
+  mSettings[ sTimingHeader.envVar ] = sTimingHeader;
+
+  // timing log
+  const Setting sTimingLog = { QgsServerSettingsEnv::QGIS_SERVER_TIMING_LOG,
+                               QgsServerSettingsEnv::DEFAULT_VALUE,
+                               "Log the time spent in each phase of requests as JSON",
+                               "/qgis/timing_log",
+                               QVariant::Bool,
+                               QVariant( false ),
+                               QVariant()
+                             };
+  mSettings[ sTimingLog.envVar ] = sTimingLog;
+
+  // metrics
+  const Setting sMetrics = { QgsServerSettingsEnv::QGIS_SERVER_METRICS,
+                             QgsServerSettingsEnv::DEFAULT_VALUE,
+                             "Serve aggregated request timings to SERVICE=METRICS requests",
+                             "/qgis/metrics",
+                             QVariant::Bool,
+                             QVariant( false ),
+                             QVariant()
+                           };
+  mSettings[ sMetrics.envVar ] = sMetrics;
+
+  // max threads per request
+  const Setting sMaxThreadsPerRequest = { QgsServerSettingsEnv::QGIS_SERVER_MAX_THREADS_PER_REQUEST,
+                                          QgsServerSettingsEnv::DEFAULT_VALUE,
+                                          "Number of threads rendering the layers of a WMS GetMap request",
+                                          "/qgis/max_threads_per_request",
+                                          QVariant::Int,
+                                          QVariant( 0 ),
+                                          QVariant()
+                                        };
+  mSettings[ sMaxThreadsPerRequest.envVar ] = sMaxThreadsPerRequest;
 }
 
 void QgsServerSettings::load()
@@ -305,3 +461,73 @@ QString QgsServerSettings::cacheDirectory() const
 {
   return value( QgsServerSettingsEnv::QGIS_SERVER_CACHE_DIRECTORY ).toString();
 }
+
+int QgsServerSettings::requestThreads() const
+{
+  return std::max( 1, value( QgsServerSettingsEnv::QGIS_SERVER_REQUEST_THREADS ).toInt() );
+}
+
+qint64 QgsServerSettings::wmsCacheMemorySize() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_WMS_CACHE_MEMORY_SIZE ).toLongLong();
+}
+
+QString QgsServerSettings::wmsCacheDirectory() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_WMS_CACHE_DIRECTORY ).toString();
+}
+
+qint64 QgsServerSettings::wmsCacheDiskSize() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_WMS_CACHE_DISK_SIZE ).toLongLong();
+}
+
+int QgsServerSettings::wmsMetatileSize() const
+{
+  return std::max( 1, value( QgsServerSettingsEnv::QGIS_SERVER_WMS_METATILE_SIZE ).toInt() );
+}
+
+bool QgsServerSettings::wmsPng8Dither() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_WMS_PNG8_DITHER ).toBool();
+}
+
+int QgsServerSettings::wmsPng8Threads() const
+{
+  return std::max( 0, value( QgsServerSettingsEnv::QGIS_SERVER_WMS_PNG8_THREADS ).toInt() );
+}
+
+QStringList QgsServerSettings::preloadProjects() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_PRELOAD_PROJECTS ).toString().split( QDir::listSeparator(), QString::SkipEmptyParts );
+}
+
+int QgsServerSettings::preloadThreads() const
+{
+  return std::max( 0, value( QgsServerSettingsEnv::QGIS_SERVER_PRELOAD_THREADS ).toInt() );
+}
+
+int QgsServerSettings::identifyIndexSize() const
+{
+  return std::max( 0, value( QgsServerSettingsEnv::QGIS_SERVER_IDENTIFY_INDEX_SIZE ).toInt() );
+}
+
+bool QgsServerSettings::timingHeader() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_TIMING_HEADER ).toBool();
+}
+
+bool QgsServerSettings::timingLog() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_TIMING_LOG ).toBool();
+}
+
+bool QgsServerSettings::metrics() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_METRICS ).toBool();
+}
+
+int QgsServerSettings::maxThreadsPerRequest() const
+{
+  return std::max( 0, value( QgsServerSettingsEnv::QGIS_SERVER_MAX_THREADS_PER_REQUEST ).toInt() );
+}
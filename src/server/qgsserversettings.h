@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <QMetaEnum>
+#include <QStringList>
 
 #include "qgsmessagelog.h"
 #include "qgis_server.h"
@@ -56,7 +57,21 @@ class SERVER_EXPORT QgsServerSettingsEnv : public QObject
       QGIS_PROJECT_FILE,
       MAX_CACHE_LAYERS,
       QGIS_SERVER_CACHE_DIRECTORY,
-      QGIS_SERVER_CACHE_SIZE
+      QGIS_SERVER_CACHE_SIZE,
+      QGIS_SERVER_REQUEST_THREADS,
+      QGIS_SERVER_WMS_CACHE_MEMORY_SIZE,
+      QGIS_SERVER_WMS_CACHE_DIRECTORY,
+      QGIS_SERVER_WMS_CACHE_DISK_SIZE,
+      QGIS_SERVER_WMS_METATILE_SIZE,
+      QGIS_SERVER_WMS_PNG8_DITHER,
+      QGIS_SERVER_WMS_PNG8_THREADS,
+      QGIS_SERVER_PRELOAD_PROJECTS,
+      QGIS_SERVER_PRELOAD_THREADS,
+      QGIS_SERVER_IDENTIFY_INDEX_SIZE,
+      QGIS_SERVER_TIMING_HEADER,
+      QGIS_SERVER_TIMING_LOG,
+      QGIS_SERVER_METRICS,
+      QGIS_SERVER_MAX_THREADS_PER_REQUEST
     };
     Q_ENUM( EnvVar )
 };
@@ -144,6 +159,101 @@ class SERVER_EXPORT QgsServerSettings
       */
     QString cacheDirectory() const;
 
+    /** Returns the number of threads accepting FastCGI requests. With more than
+      * one thread, WMS GetMap requests are executed concurrently on shared project
+      * snapshots while other requests are still executed one at a time.
+      * \returns the number of request threads.
+      * \since QGIS 3.0
+      */
+    int requestThreads() const;
+
+    /** Returns the size of the memory cache for rendered WMS GetMap images.
+      * \returns the cache size in bytes, 0 if images are not cached in memory.
+      * \since QGIS 3.0
+      */
+    qint64 wmsCacheMemorySize() const;
+
+    /** Returns the directory of the disk cache for rendered WMS GetMap images.
+      * \returns the directory or an empty string if images are not cached on disk.
+      * \since QGIS 3.0
+      */
+    QString wmsCacheDirectory() const;
+
+    /** Returns the size of the disk cache for rendered WMS GetMap images.
+      * \returns the cache size in bytes.
+      * \since QGIS 3.0
+      */
+    qint64 wmsCacheDiskSize() const;
+
+    /** Returns the number of tiles per side of the metatiles rendered for cached
+      * WMS GetMap requests aligned on a tile grid.
+      * \returns the metatile size, 1 if tiles are rendered one by one.
+      * \since QGIS 3.0
+      */
+    int wmsMetatileSize() const;
+
+    /** Returns true if the palette of 8 bit PNG images is applied with
+      * Floyd-Steinberg error diffusion.
+      * \since QGIS 3.0
+      */
+    bool wmsPng8Dither() const;
+
+    /** Returns the number of threads computing the palette of an 8 bit PNG image.
+      * \returns the number of threads, 0 for the number of processor cores.
+      * \since QGIS 3.0
+      */
+    int wmsPng8Threads() const;
+
+    /** Returns the projects read when the server starts, which are kept in
+      * memory and read again in the background when their file changes.
+      * Paths are separated by QDir::listSeparator().
+      * \returns the paths of the preloaded projects.
+      * \since QGIS 3.0
+      */
+    QStringList preloadProjects() const;
+
+    /** Returns the number of threads reading the preloaded projects.
+      * \returns the number of threads, 0 for the number of processor cores.
+      * \since QGIS 3.0
+      */
+    int preloadThreads() const;
+
+    /** Returns the maximum number of features kept in memory with a spatial
+      * index to answer WMS GetFeatureInfo requests. Layers with more features
+      * are queried from their provider.
+      * \returns the number of features, 0 if features are not indexed.
+      * \since QGIS 3.0
+      */
+    int identifyIndexSize() const;
+
+    /** Returns true if responses have a Server-Timing header with the time spent
+      * in each phase of the request. Streamed responses, whose headers are sent
+      * before the request is finished, do not have it.
+      * \since QGIS 3.0
+      */
+    bool timingHeader() const;
+
+    /** Returns true if the time spent in each phase of a request is logged as
+      * a JSON line once the request is finished.
+      * \since QGIS 3.0
+      */
+    bool timingLog() const;
+
+    /** Returns true if the timings of requests are aggregated and served in the
+      * Prometheus text format to requests with SERVICE=METRICS.
+      * \since QGIS 3.0
+      */
+    bool metrics() const;
+
+    /** Returns the maximum number of threads rendering the layers of a GetMap
+      * request. Each request then has its own thread pool and parallel rendering
+      * is used as soon as it is greater than 1.
+      * \returns the number of threads, 0 to use the global thread pool limited
+      * by maxThreads().
+      * \since QGIS 3.0
+      */
+    int maxThreadsPerRequest() const;
+
   private:
     void initSettings();
     QVariant value( QgsServerSettingsEnv::EnvVar envVar ) const;
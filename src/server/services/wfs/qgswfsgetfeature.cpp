@@ -20,6 +20,7 @@
  *                                                                         *
  ***************************************************************************/
 #include "qgswfsutils.h"
+#include "qgsserverprofiler.h"
 #include "qgsserverprojectutils.h"
 #include "qgsfields.h"
 #include "qgsexpression.h"
@@ -33,37 +34,38 @@
 #include "qgsproject.h"
 #include "qgsogcutils.h"
 #include "qgsjsonutils.h"
+#include "qgscoordinatetransform.h"
+#include "qgsexception.h"
 
 #include "qgswfsgetfeature.h"
+#include "qgswfsstreamwriter.h"
 
 #include <QStringList>
 
+#include <algorithm>
+
 namespace QgsWfs
 {
 
   namespace
   {
 
-    QString createFeatureGeoJSON( QgsFeature *feat, int prec, QgsCoordinateReferenceSystem &crs, const QgsAttributeList &attrIndexes,
-                                  const QSet<QString> &excludedAttributes, const QString &typeName, bool withGeom,
-                                  const QString &geometryName );
-
-    QDomElement createFeatureGML2( QgsFeature *feat, QDomDocument &doc, int prec, QgsCoordinateReferenceSystem &crs,
-                                   const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName,
-                                   bool withGeom, const QString &geometryName );
+    void writeFeatureGeoJSON( QgsWfsStreamWriter &writer, QgsFeature *feat, const QgsCoordinateTransform &transform,
+                              const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName,
+                              bool withGeom, const QString &geometryName );
 
-    QDomElement createFeatureGML3( QgsFeature *feat, QDomDocument &doc, int prec, QgsCoordinateReferenceSystem &crs,
-                                   const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName,
-                                   bool withGeom, const QString geometryName );
+    void writeFeatureGML( QgsWfsStreamWriter &writer, QgsFeature *feat, bool gml3, int prec, QgsCoordinateReferenceSystem &crs,
+                          const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName,
+                          bool withGeom, const QString &geometryName );
 
-    void startGetFeature( const QgsServerRequest &request, QgsServerResponse &response, const QgsProject *project, const QString &format,
-                          int prec, QgsCoordinateReferenceSystem &crs, QgsRectangle *rect, const QStringList &typeNames );
+    void startGetFeature( const QgsServerRequest &request, QgsServerResponse &response, QgsWfsStreamWriter &writer, const QgsProject *project,
+                          const QString &format, int prec, QgsCoordinateReferenceSystem &crs, QgsRectangle *rect, const QStringList &typeNames );
 
-    void setGetFeature( QgsServerResponse &response, const QString &format, QgsFeature *feat, int featIdx, int prec,
-                        QgsCoordinateReferenceSystem &crs, const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes,
-                        const QString &typeName, bool withGeom, const QString &geometryName );
+    void setGetFeature( QgsWfsStreamWriter &writer, const QString &format, QgsFeature *feat, int featIdx, int prec,
+                        QgsCoordinateReferenceSystem &crs, const QgsCoordinateTransform &transform, const QgsAttributeList &attrIndexes,
+                        const QSet<QString> &excludedAttributes, const QString &typeName, bool withGeom, const QString &geometryName );
 
-    void endGetFeature( QgsServerResponse &response, const QString &format );
+    void endGetFeature( QgsWfsStreamWriter &writer, const QString &format );
 
   }
 
@@ -162,6 +164,9 @@ namespace QgsWfs
     //there's LOTS of potential exit paths here, so we avoid having to restore the filters manually
     std::unique_ptr< QgsOWSServerFilterRestorer > filterRestorer( new QgsOWSServerFilterRestorer( accessControl ) );
 
+    // features are serialized in a buffer written to the response by chunks
+    QgsWfsStreamWriter writer( response );
+
     // features counters
     long sentFeatures = 0;
     long iteratedFeatures = 0;
@@ -190,6 +195,9 @@ namespace QgsWfs
         throw QgsRequestNotWellFormedException( QStringLiteral( "TypeName '%1' layer error" ).arg( typeName ) );
       }
 
+      // features are written while they are fetched
+      QgsServerProfiler::Scope profilerScope( QStringLiteral( "fetch" ), vlayer->name() );
+
       //test provider
       QgsVectorDataProvider *provider = vlayer->dataProvider();
       if ( !provider )
@@ -306,18 +314,24 @@ namespace QgsWfs
       {
         geometryName = QLatin1String( "NONE" );
       }
+      // GeoJSON geometries are in EPSG:4326
+      QgsCoordinateTransform jsonTransform;
+      if ( aRequest.outputFormat == QLatin1String( "GeoJSON" ) && layerCrs.isValid() )
+      {
+        jsonTransform = QgsCoordinateTransform( layerCrs, QgsCoordinateReferenceSystem( 4326, QgsCoordinateReferenceSystem::EpsgCrsId ) );
+      }
 
       // Iterate through features
       QgsFeatureIterator fit = vlayer->getFeatures( featureRequest );
       while ( fit.nextFeature( feature ) && ( aRequest.maxFeatures == -1 || sentFeatures < aRequest.maxFeatures ) )
       {
         if ( iteratedFeatures == aRequest.startIndex )
-          startGetFeature( request, response, project, aRequest.outputFormat, requestPrecision, requestCrs, &requestRect, typeNameList );
+          startGetFeature( request, response, writer, project, aRequest.outputFormat, requestPrecision, requestCrs, &requestRect, typeNameList );
 
         if ( iteratedFeatures >= aRequest.startIndex )
         {
-          setGetFeature( response, aRequest.outputFormat, &feature, sentFeatures, layerPrecision, layerCrs, attrIndexes, layerExcludedAttributes,
-                         typeName, withGeom, geometryName );
+          setGetFeature( writer, aRequest.outputFormat, &feature, sentFeatures, layerPrecision, layerCrs, jsonTransform, attrIndexes,
+                         layerExcludedAttributes, typeName, withGeom, geometryName );
           ++sentFeatures;
         }
         ++iteratedFeatures;
@@ -331,8 +345,8 @@ namespace QgsWfs
 
     // End of GetFeature
     if ( iteratedFeatures <= aRequest.startIndex )
-      startGetFeature( request, response, project, aRequest.outputFormat, requestPrecision, requestCrs, &requestRect, typeNameList );
-    endGetFeature( response, aRequest.outputFormat );
+      startGetFeature( request, response, writer, project, aRequest.outputFormat, requestPrecision, requestCrs, &requestRect, typeNameList );
+    endGetFeature( writer, aRequest.outputFormat );
 
   }
 
@@ -816,8 +830,8 @@ namespace QgsWfs
   namespace
   {
 
-    void startGetFeature( const QgsServerRequest &request, QgsServerResponse &response, const QgsProject *project, const QString &format,
-                          int prec, QgsCoordinateReferenceSystem &crs, QgsRectangle *rect, const QStringList &typeNames )
+    void startGetFeature( const QgsServerRequest &request, QgsServerResponse &response, QgsWfsStreamWriter &writer, const QgsProject *project,
+                          const QString &format, int prec, QgsCoordinateReferenceSystem &crs, QgsRectangle *rect, const QStringList &typeNames )
     {
       QString fcString;
 
@@ -849,7 +863,7 @@ namespace QgsWfs
         fcString = QStringLiteral( "{\"type\": \"FeatureCollection\",\n" );
         fcString += " \"bbox\": [ " + qgsDoubleToString( rect->xMinimum(), prec ) + ", " + qgsDoubleToString( rect->yMinimum(), prec ) + ", " + qgsDoubleToString( rect->xMaximum(), prec ) + ", " + qgsDoubleToString( rect->yMaximum(), prec ) + "],\n";
         fcString += QLatin1String( " \"features\": [\n" );
-        response.write( fcString.toUtf8() );
+        writer.writeText( fcString );
       }
       else
       {
@@ -897,8 +911,8 @@ namespace QgsWfs
         fcString += " xsi:schemaLocation=\"" + WFS_NAMESPACE + " http://schemas.opengis.net/wfs/1.0.0/wfs.xsd " + QGS_NAMESPACE + " " + hrefString.replace( QLatin1String( "&" ), QLatin1String( "&amp;" ) ) + "\"";
         fcString += QLatin1String( ">" );
 
-        response.write( fcString.toUtf8() );
-        response.flush();
+        writer.writeText( fcString );
+        writer.flush();
 
         QDomDocument doc;
         QDomElement bbElem = doc.createElement( QStringLiteral( "gml:boundedBy" ) );
@@ -928,97 +942,49 @@ namespace QgsWfs
             doc.appendChild( bbElem );
           }
         }
-        response.write( doc.toByteArray() );
-        response.flush();
+        writer.write( doc.toByteArray() );
+        writer.flush();
       }
     }
 
-    void setGetFeature( QgsServerResponse &response, const QString &format, QgsFeature *feat, int featIdx, int prec,
-                        QgsCoordinateReferenceSystem &crs, const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes,
-                        const QString &typeName, bool withGeom, const QString &geometryName )
+    void setGetFeature( QgsWfsStreamWriter &writer, const QString &format, QgsFeature *feat, int featIdx, int prec,
+                        QgsCoordinateReferenceSystem &crs, const QgsCoordinateTransform &transform, const QgsAttributeList &attrIndexes,
+                        const QSet<QString> &excludedAttributes, const QString &typeName, bool withGeom, const QString &geometryName )
     {
       if ( !feat->isValid() )
         return;
 
       if ( format == QLatin1String( "GeoJSON" ) )
       {
-        QString fcString;
-        if ( featIdx == 0 )
-          fcString += QLatin1String( "  " );
-        else
-          fcString += QLatin1String( " ," );
-        fcString += createFeatureGeoJSON( feat, prec, crs, attrIndexes, excludedAttributes, typeName, withGeom, geometryName );
-        fcString += QLatin1String( "\n" );
-
-        response.write( fcString.toUtf8() );
+        writer.write( featIdx == 0 ? "  " : " ," );
+        writeFeatureGeoJSON( writer, feat, transform, attrIndexes, excludedAttributes, typeName, withGeom, geometryName );
+        writer.write( '\n' );
       }
       else
       {
-        QDomDocument gmlDoc;
-        QDomElement featureElement;
-        if ( format == QLatin1String( "GML3" ) )
-        {
-          featureElement = createFeatureGML3( feat, gmlDoc, prec, crs, attrIndexes, excludedAttributes, typeName, withGeom, geometryName );
-          gmlDoc.appendChild( featureElement );
-        }
-        else
-        {
-          featureElement = createFeatureGML2( feat, gmlDoc, prec, crs, attrIndexes, excludedAttributes, typeName, withGeom, geometryName );
-          gmlDoc.appendChild( featureElement );
-        }
-        response.write( gmlDoc.toByteArray() );
+        writeFeatureGML( writer, feat, format == QLatin1String( "GML3" ), prec, crs, attrIndexes, excludedAttributes, typeName, withGeom, geometryName );
       }
 
       // Stream partial content
-      response.flush();
+      writer.flushChunk();
     }
 
-    void endGetFeature( QgsServerResponse &response, const QString &format )
+    void endGetFeature( QgsWfsStreamWriter &writer, const QString &format )
     {
-      QString fcString;
       if ( format == QLatin1String( "GeoJSON" ) )
       {
-        fcString += QLatin1String( " ]\n" );
-        fcString += QLatin1String( "}" );
+        writer.write( " ]\n}" );
       }
       else
       {
-        fcString = QStringLiteral( "</wfs:FeatureCollection>\n" );
+        writer.write( "</wfs:FeatureCollection>\n" );
       }
-      response.write( fcString.toUtf8() );
+      writer.flush();
     }
 
-
-    QString createFeatureGeoJSON( QgsFeature *feat, int prec, QgsCoordinateReferenceSystem &crs, const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName, bool withGeom, const QString &geometryName )
+    //! Returns the attributes of the feature published by WFS
+    QgsAttributeList exportedAttributes( const QgsFields &fields, const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes )
     {
-      QString id = QStringLiteral( "%1.%2" ).arg( typeName, FID_TO_STRING( feat->id() ) );
-
-      QgsJsonExporter exporter;
-      exporter.setSourceCrs( crs );
-      //QgsJsonExporter force transform geometry to ESPG:4326
-      //and the RFC 7946 GeoJSON specification recommends limiting coordinate precision to 6
-      Q_UNUSED( prec );
-      //exporter.setPrecision( prec );
-
-      //copy feature so we can modify its geometry as required
-      QgsFeature f( *feat );
-      QgsGeometry geom = feat->geometry();
-      exporter.setIncludeGeometry( false );
-      if ( !geom.isNull() && withGeom && geometryName != QLatin1String( "NONE" ) )
-      {
-        exporter.setIncludeGeometry( true );
-        if ( geometryName == QLatin1String( "EXTENT" ) )
-        {
-          QgsRectangle box = geom.boundingBox();
-          f.setGeometry( QgsGeometry::fromRect( box ) );
-        }
-        else if ( geometryName == QLatin1String( "CENTROID" ) )
-        {
-          f.setGeometry( geom.centroid() );
-        }
-      }
-
-      QgsFields fields = feat->fields();
       QgsAttributeList attrsToExport;
       for ( int i = 0; i < attrIndexes.count(); ++i )
       {
@@ -1027,190 +993,262 @@ namespace QgsWfs
         {
           continue;
         }
-        QString attributeName = fields.at( idx ).name();
         //skip attribute if it is excluded from WFS publication
-        if ( excludedAttributes.contains( attributeName ) )
+        if ( excludedAttributes.contains( fields.at( idx ).name() ) )
         {
           continue;
         }
-
         attrsToExport << idx;
       }
-
-      exporter.setIncludeAttributes( !attrsToExport.isEmpty() );
-      exporter.setAttributes( attrsToExport );
-
-      return exporter.exportFeature( f, QVariantMap(), id );
+      return attrsToExport;
     }
 
-
-    QDomElement createFeatureGML2( QgsFeature *feat, QDomDocument &doc, int prec, QgsCoordinateReferenceSystem &crs, const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName, bool withGeom, const QString &geometryName )
+    void writeFeatureGeoJSON( QgsWfsStreamWriter &writer, QgsFeature *feat, const QgsCoordinateTransform &transform,
+                              const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName,
+                              bool withGeom, const QString &geometryName )
     {
-      //gml:FeatureMember
-      QDomElement featureElement = doc.createElement( QStringLiteral( "gml:featureMember" )/*wfs:FeatureMember*/ );
+      // same layout as QgsJsonExporter::exportFeature
+      // the RFC 7946 GeoJSON specification recommends limiting coordinate precision to 6
+      const int prec = 6;
 
-      //qgs:%TYPENAME%
-      QDomElement typeNameElement = doc.createElement( "qgs:" + typeName /*qgs:%TYPENAME%*/ );
-      typeNameElement.setAttribute( QStringLiteral( "fid" ), typeName + "." + QString::number( feat->id() ) );
-      featureElement.appendChild( typeNameElement );
+      writer.write( "{\n   \"type\":\"Feature\",\n   \"id\":" );
+      writer.writeJsonString( QStringLiteral( "%1.%2" ).arg( typeName, FID_TO_STRING( feat->id() ) ) );
+      writer.write( ",\n" );
 
+      QgsGeometry geom;
       if ( withGeom && geometryName != QLatin1String( "NONE" ) )
       {
-        //add geometry column (as gml)
-        QgsGeometry geom = feat->geometry();
-
-        QDomElement geomElem = doc.createElement( QStringLiteral( "qgs:geometry" ) );
-        QDomElement gmlElem;
-        if ( geometryName == QLatin1String( "EXTENT" ) )
+        geom = feat->geometry();
+        if ( !geom.isNull() && geometryName == QLatin1String( "EXTENT" ) )
         {
-          QgsGeometry bbox = QgsGeometry::fromRect( geom.boundingBox() );
-          gmlElem = QgsOgcUtils::geometryToGML( bbox, doc, prec );
+          geom = QgsGeometry::fromRect( geom.boundingBox() );
         }
-        else if ( geometryName == QLatin1String( "CENTROID" ) )
+        else if ( !geom.isNull() && geometryName == QLatin1String( "CENTROID" ) )
         {
-          QgsGeometry centroid = geom.centroid();
-          gmlElem = QgsOgcUtils::geometryToGML( centroid, doc, prec );
+          geom = geom.centroid();
         }
-        else
+      }
+
+      if ( !geom.isNull() )
+      {
+        if ( transform.isValid() )
         {
-          QgsAbstractGeometry *abstractGeom = geom.geometry();
-          if ( abstractGeom )
+          try
+          {
+            QgsGeometry transformed = geom;
+            if ( transformed.transform( transform ) == 0 )
+              geom = transformed;
+          }
+          catch ( QgsCsException &cse )
           {
-            gmlElem = abstractGeom->asGML2( doc, prec, "http://www.opengis.net/gml" );
+            Q_UNUSED( cse );
           }
         }
 
-        if ( !gmlElem.isNull() )
+        if ( QgsWkbTypes::flatType( geom.geometry()->wkbType() ) != QgsWkbTypes::Point )
         {
           QgsRectangle box = geom.boundingBox();
-          QDomElement bbElem = doc.createElement( QStringLiteral( "gml:boundedBy" ) );
-          QDomElement boxElem = QgsOgcUtils::rectangleToGMLBox( &box, doc, prec );
-
-          if ( crs.isValid() )
-          {
-            boxElem.setAttribute( QStringLiteral( "srsName" ), crs.authid() );
-            gmlElem.setAttribute( QStringLiteral( "srsName" ), crs.authid() );
-          }
+          writer.write( "   \"bbox\":[" );
+          writer.writeNumber( box.xMinimum(), prec );
+          writer.write( ", " );
+          writer.writeNumber( box.yMinimum(), prec );
+          writer.write( ", " );
+          writer.writeNumber( box.xMaximum(), prec );
+          writer.write( ", " );
+          writer.writeNumber( box.yMaximum(), prec );
+          writer.write( "],\n" );
+        }
+        writer.write( "   \"geometry\":\n   " );
+        if ( !writer.writeGeometryJSON( *geom.geometry(), prec ) )
+        {
+          writer.writeText( geom.exportToGeoJSON( prec ) );
+        }
+        writer.write( ",\n" );
+      }
+      else
+      {
+        writer.write( "   \"geometry\":null,\n" );
+      }
 
-          bbElem.appendChild( boxElem );
-          typeNameElement.appendChild( bbElem );
+      // properties are written in the fields order
+      QgsFields fields = feat->fields();
+      QgsAttributeList attrsToExport = exportedAttributes( fields, attrIndexes, excludedAttributes );
+      std::sort( attrsToExport.begin(), attrsToExport.end() );
+      attrsToExport.erase( std::unique( attrsToExport.begin(), attrsToExport.end() ), attrsToExport.end() );
 
-          geomElem.appendChild( gmlElem );
-          typeNameElement.appendChild( geomElem );
-        }
+      writer.write( "   \"properties\":" );
+      if ( attrsToExport.isEmpty() )
+      {
+        writer.write( "null\n}" );
+        return;
       }
 
-      //read all attribute values from the feature
+      writer.write( "{\n" );
       QgsAttributes featureAttributes = feat->attributes();
-      QgsFields fields = feat->fields();
-      for ( int i = 0; i < attrIndexes.count(); ++i )
+      for ( int i = 0; i < attrsToExport.count(); ++i )
       {
-        int idx = attrIndexes[i];
-        if ( idx >= fields.count() )
-        {
-          continue;
-        }
-        QString attributeName = fields.at( idx ).name();
-        //skip attribute if it is excluded from WFS publication
-        if ( excludedAttributes.contains( attributeName ) )
+        int idx = attrsToExport[i];
+        if ( i > 0 )
+          writer.write( ",\n" );
+        writer.write( "      " );
+        writer.writeJsonString( fields.at( idx ).name() );
+        writer.write( ':' );
+
+        const QVariant &value = featureAttributes.at( idx );
+        switch ( value.isNull() ? QVariant::Invalid : value.type() )
         {
-          continue;
+          case QVariant::Invalid:
+          case QVariant::Int:
+          case QVariant::UInt:
+          case QVariant::LongLong:
+          case QVariant::ULongLong:
+          case QVariant::Double:
+          case QVariant::Bool:
+          case QVariant::StringList:
+          case QVariant::List:
+          case QVariant::Map:
+            writer.writeText( QgsJsonUtils::encodeValue( value ) );
+            break;
+
+          default:
+            writer.writeJsonString( value.toString() );
+            break;
         }
-
-        QDomElement fieldElem = doc.createElement( "qgs:" + attributeName.replace( QStringLiteral( " " ), QStringLiteral( "_" ) ) );
-        QDomText fieldText = doc.createTextNode( featureAttributes[idx].toString() );
-        fieldElem.appendChild( fieldText );
-        typeNameElement.appendChild( fieldElem );
       }
-
-      return featureElement;
+      writer.write( "\n   }\n}" );
     }
 
-    QDomElement createFeatureGML3( QgsFeature *feat, QDomDocument &doc, int prec, QgsCoordinateReferenceSystem &crs, const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName, bool withGeom, const QString geometryName )
+    void writeFeatureGML( QgsWfsStreamWriter &writer, QgsFeature *feat, bool gml3, int prec, QgsCoordinateReferenceSystem &crs,
+                          const QgsAttributeList &attrIndexes, const QSet<QString> &excludedAttributes, const QString &typeName,
+                          bool withGeom, const QString &geometryName )
     {
-      //gml:FeatureMember
-      QDomElement featureElement = doc.createElement( QStringLiteral( "gml:featureMember" )/*wfs:FeatureMember*/ );
-
-      //qgs:%TYPENAME%
-      QDomElement typeNameElement = doc.createElement( "qgs:" + typeName /*qgs:%TYPENAME%*/ );
-      typeNameElement.setAttribute( QStringLiteral( "gml:id" ), typeName + "." + QString::number( feat->id() ) );
-      featureElement.appendChild( typeNameElement );
+      // same layout as a QDomDocument holding the gml:featureMember element
+      const QString srsName = crs.isValid() ? crs.authid() : QString();
 
+      // EXTENT and CENTROID geometries are built by QgsOgcUtils
+      QgsGeometry geom;
+      QByteArray ogcGeometry;
+      bool hasGeometry = false;
       if ( withGeom && geometryName != QLatin1String( "NONE" ) )
       {
-        //add geometry column (as gml)
-        QgsGeometry geom = feat->geometry();
+        geom = feat->geometry();
+        if ( geometryName == QLatin1String( "EXTENT" ) || geometryName == QLatin1String( "CENTROID" ) )
+        {
+          QgsGeometry ogcGeom = geometryName == QLatin1String( "EXTENT" ) ? QgsGeometry::fromRect( geom.boundingBox() ) : geom.centroid();
+          QDomDocument doc;
+          QDomElement gmlElem = gml3 ? QgsOgcUtils::geometryToGML( ogcGeom, doc, QStringLiteral( "GML3" ), prec )
+                                : QgsOgcUtils::geometryToGML( ogcGeom, doc, prec );
+          if ( !gmlElem.isNull() )
+          {
+            if ( !srsName.isEmpty() )
+            {
+              gmlElem.setAttribute( QStringLiteral( "srsName" ), srsName );
+            }
+            doc.appendChild( gmlElem );
+            ogcGeometry = doc.toByteArray();
+            hasGeometry = true;
+          }
+        }
+        else
+        {
+          hasGeometry = geom.geometry();
+        }
+      }
 
-        QDomElement geomElem = doc.createElement( QStringLiteral( "qgs:geometry" ) );
-        QDomElement gmlElem;
-        if ( geometryName == QLatin1String( "EXTENT" ) )
+      QgsFields fields = feat->fields();
+      const QgsAttributeList attrsToExport = exportedAttributes( fields, attrIndexes, excludedAttributes );
+
+      //gml:FeatureMember and qgs:%TYPENAME%
+      writer.write( "<gml:featureMember>\n <qgs:" );
+      writer.writeText( typeName );
+      writer.write( gml3 ? " gml:id=\"" : " fid=\"" );
+      writer.writeXmlAttribute( typeName );
+      writer.write( '.' );
+      writer.writeNumber( static_cast<qint64>( feat->id() ) );
+      if ( !hasGeometry && attrsToExport.isEmpty() )
+      {
+        writer.write( "\"/>\n</gml:featureMember>\n" );
+        return;
+      }
+      writer.write( "\">\n" );
+
+      if ( hasGeometry )
+      {
+        QgsRectangle box = geom.boundingBox();
+        writer.write( "  <gml:boundedBy>\n" );
+        writer.write( gml3 ? "   <gml:Envelope" : "   <gml:Box" );
+        if ( !srsName.isEmpty() )
         {
-          QgsGeometry bbox = QgsGeometry::fromRect( geom.boundingBox() );
-          gmlElem = QgsOgcUtils::geometryToGML( bbox, doc, QStringLiteral( "GML3" ), prec );
+          writer.write( " srsName=\"" );
+          writer.writeXmlAttribute( srsName );
+          writer.write( '"' );
         }
-        else if ( geometryName == QLatin1String( "CENTROID" ) )
+        if ( gml3 )
         {
-          QgsGeometry centroid = geom.centroid();
-          gmlElem = QgsOgcUtils::geometryToGML( centroid, doc, QStringLiteral( "GML3" ), prec );
+          writer.write( ">\n    <gml:lowerCorner>" );
+          writer.writeNumber( box.xMinimum(), prec );
+          writer.write( ' ' );
+          writer.writeNumber( box.yMinimum(), prec );
+          writer.write( "</gml:lowerCorner>\n    <gml:upperCorner>" );
+          writer.writeNumber( box.xMaximum(), prec );
+          writer.write( ' ' );
+          writer.writeNumber( box.yMaximum(), prec );
+          writer.write( "</gml:upperCorner>\n   </gml:Envelope>\n" );
         }
         else
         {
-          QgsAbstractGeometry *abstractGeom = geom.geometry();
-          if ( abstractGeom )
-          {
-            gmlElem = abstractGeom->asGML3( doc, prec, "http://www.opengis.net/gml" );
-          }
+          writer.write( ">\n    <gml:coordinates cs=\",\" ts=\" \">" );
+          writer.writeNumber( box.xMinimum(), prec );
+          writer.write( ',' );
+          writer.writeNumber( box.yMinimum(), prec );
+          writer.write( ' ' );
+          writer.writeNumber( box.xMaximum(), prec );
+          writer.write( ',' );
+          writer.writeNumber( box.yMaximum(), prec );
+          writer.write( "</gml:coordinates>\n   </gml:Box>\n" );
         }
+        writer.write( "  </gml:boundedBy>\n  <qgs:geometry>\n" );
 
-        if ( !gmlElem.isNull() )
+        if ( !ogcGeometry.isEmpty() )
         {
-          QgsRectangle box = geom.boundingBox();
-          QDomElement bbElem = doc.createElement( QStringLiteral( "gml:boundedBy" ) );
-          QDomElement boxElem = QgsOgcUtils::rectangleToGMLEnvelope( &box, doc, prec );
-
-          if ( crs.isValid() )
+          writer.writeIndented( ogcGeometry, 3 );
+        }
+        else if ( !writer.writeGeometryGML( *geom.geometry(), gml3, prec, 3, srsName ) )
+        {
+          // curved geometries are still saved through the DOM
+          QDomDocument doc;
+          QDomElement gmlElem = gml3 ? geom.geometry()->asGML3( doc, prec, "http://www.opengis.net/gml" )
+                                : geom.geometry()->asGML2( doc, prec, "http://www.opengis.net/gml" );
+          if ( !srsName.isEmpty() )
           {
-            boxElem.setAttribute( QStringLiteral( "srsName" ), crs.authid() );
-            gmlElem.setAttribute( QStringLiteral( "srsName" ), crs.authid() );
+            gmlElem.setAttribute( QStringLiteral( "srsName" ), srsName );
           }
-
-          bbElem.appendChild( boxElem );
-          typeNameElement.appendChild( bbElem );
-
-          geomElem.appendChild( gmlElem );
-          typeNameElement.appendChild( geomElem );
+          doc.appendChild( gmlElem );
+          writer.writeIndented( doc.toByteArray(), 3 );
         }
+        writer.write( "  </qgs:geometry>\n" );
       }
 
       //read all attribute values from the feature
       QgsAttributes featureAttributes = feat->attributes();
-      QgsFields fields = feat->fields();
-      for ( int i = 0; i < attrIndexes.count(); ++i )
+      Q_FOREACH ( int idx, attrsToExport )
       {
-        int idx = attrIndexes[i];
-        if ( idx >= fields.count() )
-        {
-          continue;
-        }
         QString attributeName = fields.at( idx ).name();
-        //skip attribute if it is excluded from WFS publication
-        if ( excludedAttributes.contains( attributeName ) )
-        {
-          continue;
-        }
-
-        QDomElement fieldElem = doc.createElement( "qgs:" + attributeName.replace( QStringLiteral( " " ), QStringLiteral( "_" ) ) );
-        QDomText fieldText = doc.createTextNode( featureAttributes[idx].toString() );
-        fieldElem.appendChild( fieldText );
-        typeNameElement.appendChild( fieldElem );
+        attributeName.replace( ' ', '_' );
+        writer.write( "  <qgs:" );
+        writer.writeText( attributeName );
+        writer.write( '>' );
+        writer.writeXmlText( featureAttributes[idx].toString() );
+        writer.write( "</qgs:" );
+        writer.writeText( attributeName );
+        writer.write( ">\n" );
       }
 
-      return featureElement;
+      writer.write( " </qgs:" );
+      writer.writeText( typeName );
+      writer.write( ">\n</gml:featureMember>\n" );
     }
 
-
-
-
   } // namespace
 
 } // samespace QgsWfs
@@ -0,0 +1,661 @@
+/***************************************************************************
+                              qgswfsstreamwriter.cpp
+                              -------------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "qgswfsstreamwriter.h"
+#include "qgsserverresponse.h"
+#include "qgslinestring.h"
+#include "qgsmultilinestring.h"
+#include "qgsmultipoint.h"
+#include "qgsmultipolygon.h"
+#include "qgspoint.h"
+#include "qgspolygon.h"
+#include "qgswkbtypes.h"
+#include "qgis.h"
+
+#include <clocale>
+#include <cstdio>
+#include <cstring>
+
+namespace QgsWfs
+{
+
+  ///@cond PRIVATE
+  static const char *GML_NS = "http://www.opengis.net/gml";
+  ///@endcond
+
+  QgsWfsStreamWriter::QgsWfsStreamWriter( QgsServerResponse &response, int chunkSize )
+    : mResponse( response )
+    , mChunkSize( chunkSize )
+  {
+    // the buffer keeps its capacity when cleared
+    mBuffer.reserve( chunkSize + chunkSize / 4 );
+    // printf follows the C locale set by the application
+    mDecimalPoint = QByteArray( std::localeconv()->decimal_point );
+  }
+
+  void QgsWfsStreamWriter::writeText( const QString &text )
+  {
+    writeString( text, NoEscape );
+  }
+
+  void QgsWfsStreamWriter::writeXmlText( const QString &text )
+  {
+    writeString( text, XmlText );
+  }
+
+  void QgsWfsStreamWriter::writeXmlAttribute( const QString &text )
+  {
+    writeString( text, XmlAttribute );
+  }
+
+  void QgsWfsStreamWriter::writeJsonString( const QString &text )
+  {
+    mBuffer.append( '"' );
+    writeString( text, Json );
+    mBuffer.append( '"' );
+  }
+
+  void QgsWfsStreamWriter::writeString( const QString &text, Escape escape )
+  {
+    const QChar *chars = text.constData();
+    const int size = text.size();
+    for ( int i = 0; i < size; ++i )
+    {
+      const ushort c = chars[i].unicode();
+      if ( c < 0x80 )
+      {
+        switch ( escape )
+        {
+          case NoEscape:
+            break;
+
+          case XmlText:
+          case XmlAttribute:
+            if ( c == '<' )
+            {
+              mBuffer.append( "&lt;" );
+              continue;
+            }
+            if ( c == '&' )
+            {
+              mBuffer.append( "&amp;" );
+              continue;
+            }
+            if ( c == '>' && i >= 2 && chars[i - 1] == QLatin1Char( ']' ) && chars[i - 2] == QLatin1Char( ']' ) )
+            {
+              mBuffer.append( "&gt;" );
+              continue;
+            }
+            if ( c == '\r' )
+            {
+              mBuffer.append( "&#xd;" );
+              continue;
+            }
+            if ( escape == XmlAttribute )
+            {
+              if ( c == '"' )
+              {
+                mBuffer.append( "&quot;" );
+                continue;
+              }
+              if ( c == '\n' )
+              {
+                mBuffer.append( "&#xa;" );
+                continue;
+              }
+              if ( c == '\t' )
+              {
+                mBuffer.append( "&#x9;" );
+                continue;
+              }
+            }
+            break;
+
+          case Json:
+            switch ( c )
+            {
+              case '\\':
+                mBuffer.append( "\\\\" );
+                continue;
+              case '"':
+                mBuffer.append( "\\\"" );
+                continue;
+              case '\r':
+                mBuffer.append( "\\r" );
+                continue;
+              case '\b':
+                mBuffer.append( "\\b" );
+                continue;
+              case '\t':
+                mBuffer.append( "\\t" );
+                continue;
+              case '/':
+                mBuffer.append( "\\/" );
+                continue;
+              case '\n':
+                mBuffer.append( "\\n" );
+                continue;
+              default:
+                break;
+            }
+            break;
+        }
+        mBuffer.append( static_cast<char>( c ) );
+      }
+      else if ( c < 0x800 )
+      {
+        mBuffer.append( static_cast<char>( 0xc0 | ( c >> 6 ) ) );
+        mBuffer.append( static_cast<char>( 0x80 | ( c & 0x3f ) ) );
+      }
+      else if ( QChar::isSurrogate( c ) )
+      {
+        if ( QChar::isHighSurrogate( c ) && i + 1 < size && chars[i + 1].isLowSurrogate() )
+        {
+          const uint ucs4 = QChar::surrogateToUcs4( c, chars[++i].unicode() );
+          mBuffer.append( static_cast<char>( 0xf0 | ( ucs4 >> 18 ) ) );
+          mBuffer.append( static_cast<char>( 0x80 | ( ( ucs4 >> 12 ) & 0x3f ) ) );
+          mBuffer.append( static_cast<char>( 0x80 | ( ( ucs4 >> 6 ) & 0x3f ) ) );
+          mBuffer.append( static_cast<char>( 0x80 | ( ucs4 & 0x3f ) ) );
+        }
+        else
+        {
+          // unpaired surrogate, replaced as QString::toUtf8() does
+          mBuffer.append( '?' );
+        }
+      }
+      else
+      {
+        mBuffer.append( static_cast<char>( 0xe0 | ( c >> 12 ) ) );
+        mBuffer.append( static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3f ) ) );
+        mBuffer.append( static_cast<char>( 0x80 | ( c & 0x3f ) ) );
+      }
+    }
+  }
+
+  void QgsWfsStreamWriter::writeNumber( double value, int precision )
+  {
+    char number[64];
+    int length = std::snprintf( number, sizeof( number ), "%.*f", precision, value );
+    if ( length < 0 || length >= static_cast<int>( sizeof( number ) ) )
+    {
+      // very large numbers
+      writeText( qgsDoubleToString( value, precision ) );
+      return;
+    }
+
+    char *decimalPoint = nullptr;
+    if ( mDecimalPoint.size() == 1 )
+    {
+      decimalPoint = std::strchr( number, mDecimalPoint.at( 0 ) );
+    }
+    else if ( !mDecimalPoint.isEmpty() )
+    {
+      decimalPoint = std::strstr( number, mDecimalPoint.constData() );
+      if ( decimalPoint )
+      {
+        const int pointSize = mDecimalPoint.size();
+        std::memmove( decimalPoint + 1, decimalPoint + pointSize, length - ( decimalPoint - number ) - pointSize + 1 );
+        length -= pointSize - 1;
+      }
+    }
+
+    if ( decimalPoint )
+    {
+      *decimalPoint = '.';
+      // strip trailing zeros as qgsDoubleToString() does
+      if ( precision > 0 )
+      {
+        while ( length > 0 && number[length - 1] == '0' )
+          --length;
+        if ( length > 0 && number[length - 1] == '.' )
+          --length;
+      }
+    }
+    mBuffer.append( number, length );
+  }
+
+  void QgsWfsStreamWriter::writeNumber( qint64 value )
+  {
+    char digits[24];
+    int pos = sizeof( digits );
+    quint64 absolute = value < 0 ? 0 - static_cast<quint64>( value ) : static_cast<quint64>( value );
+    do
+    {
+      digits[--pos] = static_cast<char>( '0' + absolute % 10 );
+      absolute /= 10;
+    }
+    while ( absolute );
+    if ( value < 0 )
+      digits[--pos] = '-';
+    mBuffer.append( digits + pos, static_cast<int>( sizeof( digits ) ) - pos );
+  }
+
+  void QgsWfsStreamWriter::writeIndent( int depth )
+  {
+    for ( int i = 0; i < depth; ++i )
+      mBuffer.append( ' ' );
+  }
+
+  void QgsWfsStreamWriter::writeIndented( const QByteArray &xml, int depth )
+  {
+    int start = 0;
+    while ( start < xml.size() )
+    {
+      int end = xml.indexOf( '\n', start );
+      end = end < 0 ? xml.size() : end + 1;
+      writeIndent( depth );
+      mBuffer.append( xml.constData() + start, end - start );
+      start = end;
+    }
+  }
+
+  void QgsWfsStreamWriter::flush()
+  {
+    if ( !mBuffer.isEmpty() )
+    {
+      mResponse.write( mBuffer );
+      mBuffer.resize( 0 );
+    }
+    mResponse.flush();
+  }
+
+  void QgsWfsStreamWriter::writeElementStart( const char *name, int depth, const QString &srsName )
+  {
+    writeIndent( depth );
+    mBuffer.append( '<' );
+    mBuffer.append( name );
+    mBuffer.append( " xmlns=\"" );
+    mBuffer.append( GML_NS );
+    mBuffer.append( '"' );
+    if ( !srsName.isEmpty() )
+    {
+      mBuffer.append( " srsName=\"" );
+      writeXmlAttribute( srsName );
+      mBuffer.append( '"' );
+    }
+    mBuffer.append( ">\n" );
+  }
+
+  void QgsWfsStreamWriter::writeElementEnd( const char *name, int depth )
+  {
+    writeIndent( depth );
+    mBuffer.append( "</" );
+    mBuffer.append( name );
+    mBuffer.append( ">\n" );
+  }
+
+  void QgsWfsStreamWriter::writeCoordinatesGML( const QgsLineString &line, bool gml3, int precision, bool is3D )
+  {
+    const int count = line.numPoints();
+    for ( int i = 0; i < count; ++i )
+    {
+      if ( i > 0 )
+        mBuffer.append( ' ' );
+      writeNumber( line.xAt( i ), precision );
+      mBuffer.append( gml3 ? ' ' : ',' );
+      writeNumber( line.yAt( i ), precision );
+      if ( gml3 && is3D )
+      {
+        mBuffer.append( ' ' );
+        writeNumber( line.zAt( i ), precision );
+      }
+    }
+  }
+
+  bool QgsWfsStreamWriter::writeLineGML( const QgsLineString &line, const char *name, bool gml3, int precision, int depth, const QString &srsName )
+  {
+    writeElementStart( name, depth, srsName );
+    writeIndent( depth + 1 );
+    if ( gml3 )
+    {
+      mBuffer.append( "<posList xmlns=\"" );
+      mBuffer.append( GML_NS );
+      mBuffer.append( line.is3D() ? "\" srsDimension=\"3\">" : "\" srsDimension=\"2\">" );
+      writeCoordinatesGML( line, true, precision, line.is3D() );
+      mBuffer.append( "</posList>\n" );
+    }
+    else
+    {
+      mBuffer.append( "<coordinates xmlns=\"" );
+      mBuffer.append( GML_NS );
+      mBuffer.append( "\">" );
+      writeCoordinatesGML( line, false, precision, false );
+      mBuffer.append( "</coordinates>\n" );
+    }
+    writeElementEnd( name, depth );
+    return true;
+  }
+
+  bool QgsWfsStreamWriter::writePolygonGML( const QgsAbstractGeometry &geometry, bool gml3, int precision, int depth, const QString &srsName )
+  {
+    const QgsPolygonV2 *polygon = dynamic_cast<const QgsPolygonV2 *>( &geometry );
+    if ( !polygon || !dynamic_cast<const QgsLineString *>( polygon->exteriorRing() ) )
+      return false;
+    for ( int i = 0, n = polygon->numInteriorRings(); i < n; ++i )
+    {
+      if ( !dynamic_cast<const QgsLineString *>( polygon->interiorRing( i ) ) )
+        return false;
+    }
+
+    const QgsLineString *exterior = static_cast<const QgsLineString *>( polygon->exteriorRing() );
+    writeElementStart( "Polygon", depth, srsName );
+    if ( gml3 )
+    {
+      writeElementStart( "exterior", depth + 1 );
+      writeLineGML( *exterior, "LinearRing", true, precision, depth + 2, QString() );
+      writeElementEnd( "exterior", depth + 1 );
+      for ( int i = 0, n = polygon->numInteriorRings(); i < n; ++i )
+      {
+        writeElementStart( "interior", depth + 1 );
+        writeLineGML( *static_cast<const QgsLineString *>( polygon->interiorRing( i ) ), "LinearRing", true, precision, depth + 2, QString() );
+        writeElementEnd( "interior", depth + 1 );
+      }
+    }
+    else
+    {
+      writeElementStart( "outerBoundaryIs", depth + 1 );
+      writeLineGML( *exterior, "LinearRing", false, precision, depth + 2, QString() );
+      writeElementEnd( "outerBoundaryIs", depth + 1 );
+      // GML2 polygons always have an innerBoundaryIs element holding all interior rings
+      if ( polygon->numInteriorRings() == 0 )
+      {
+        writeIndent( depth + 1 );
+        mBuffer.append( "<innerBoundaryIs xmlns=\"" );
+        mBuffer.append( GML_NS );
+        mBuffer.append( "\"/>\n" );
+      }
+      else
+      {
+        writeElementStart( "innerBoundaryIs", depth + 1 );
+        for ( int i = 0, n = polygon->numInteriorRings(); i < n; ++i )
+        {
+          writeLineGML( *static_cast<const QgsLineString *>( polygon->interiorRing( i ) ), "LinearRing", false, precision, depth + 2, QString() );
+        }
+        writeElementEnd( "innerBoundaryIs", depth + 1 );
+      }
+    }
+    writeElementEnd( "Polygon", depth );
+    return true;
+  }
+
+  bool QgsWfsStreamWriter::writeGeometryGML( const QgsAbstractGeometry &geometry, bool gml3, int precision, int depth, const QString &srsName )
+  {
+    const int start = mBuffer.size();
+    switch ( QgsWkbTypes::flatType( geometry.wkbType() ) )
+    {
+      case QgsWkbTypes::Point:
+      {
+        const QgsPoint *point = dynamic_cast<const QgsPoint *>( &geometry );
+        if ( !point )
+          return false;
+        writeElementStart( "Point", depth, srsName );
+        writeIndent( depth + 1 );
+        if ( gml3 )
+        {
+          mBuffer.append( "<pos xmlns=\"" );
+          mBuffer.append( GML_NS );
+          mBuffer.append( point->is3D() ? "\" srsDimension=\"3\">" : "\" srsDimension=\"2\">" );
+          writeNumber( point->x(), precision );
+          mBuffer.append( ' ' );
+          writeNumber( point->y(), precision );
+          if ( point->is3D() )
+          {
+            mBuffer.append( ' ' );
+            writeNumber( point->z(), precision );
+          }
+          mBuffer.append( "</pos>\n" );
+        }
+        else
+        {
+          mBuffer.append( "<coordinates xmlns=\"" );
+          mBuffer.append( GML_NS );
+          mBuffer.append( "\">" );
+          writeNumber( point->x(), precision );
+          mBuffer.append( ',' );
+          writeNumber( point->y(), precision );
+          mBuffer.append( "</coordinates>\n" );
+        }
+        writeElementEnd( "Point", depth );
+        return true;
+      }
+
+      case QgsWkbTypes::LineString:
+      {
+        const QgsLineString *line = dynamic_cast<const QgsLineString *>( &geometry );
+        return line && writeLineGML( *line, "LineString", gml3, precision, depth, srsName );
+      }
+
+      case QgsWkbTypes::Polygon:
+        return writePolygonGML( geometry, gml3, precision, depth, srsName );
+
+      case QgsWkbTypes::MultiPoint:
+      case QgsWkbTypes::MultiLineString:
+      case QgsWkbTypes::MultiPolygon:
+      {
+        const QgsWkbTypes::Type type = QgsWkbTypes::flatType( geometry.wkbType() );
+        const QgsGeometryCollection *collection = nullptr;
+        const char *name = nullptr;
+        const char *member = nullptr;
+        if ( type == QgsWkbTypes::MultiPoint )
+        {
+          collection = dynamic_cast<const QgsMultiPointV2 *>( &geometry );
+          name = "MultiPoint";
+          member = "pointMember";
+        }
+        else if ( type == QgsWkbTypes::MultiLineString )
+        {
+          collection = dynamic_cast<const QgsMultiLineString *>( &geometry );
+          name = gml3 ? "MultiCurve" : "MultiLineString";
+          member = gml3 ? "curveMember" : "lineStringMember";
+        }
+        else
+        {
+          collection = dynamic_cast<const QgsMultiPolygonV2 *>( &geometry );
+          name = "MultiPolygon";
+          member = "polygonMember";
+        }
+        if ( !collection )
+          return false;
+
+        if ( collection->numGeometries() == 0 )
+        {
+          writeIndent( depth );
+          mBuffer.append( '<' );
+          mBuffer.append( name );
+          mBuffer.append( " xmlns=\"" );
+          mBuffer.append( GML_NS );
+          mBuffer.append( '"' );
+          if ( !srsName.isEmpty() )
+          {
+            mBuffer.append( " srsName=\"" );
+            writeXmlAttribute( srsName );
+            mBuffer.append( '"' );
+          }
+          mBuffer.append( "/>\n" );
+          return true;
+        }
+
+        writeElementStart( name, depth, srsName );
+        for ( int i = 0, n = collection->numGeometries(); i < n; ++i )
+        {
+          writeElementStart( member, depth + 1 );
+          if ( !writeGeometryGML( *collection->geometryN( i ), gml3, precision, depth + 2, QString() ) )
+          {
+            // unexpected member type, let the caller write the whole geometry
+            mBuffer.resize( start );
+            return false;
+          }
+          writeElementEnd( member, depth + 1 );
+        }
+        writeElementEnd( name, depth );
+        return true;
+      }
+
+      default:
+        return false;
+    }
+  }
+
+  void QgsWfsStreamWriter::writeCoordinatesJSON( const QgsLineString &line, int precision )
+  {
+    mBuffer.append( "[ " );
+    for ( int i = 0, n = line.numPoints(); i < n; ++i )
+    {
+      if ( i > 0 )
+        mBuffer.append( ", " );
+      mBuffer.append( '[' );
+      writeNumber( line.xAt( i ), precision );
+      mBuffer.append( ", " );
+      writeNumber( line.yAt( i ), precision );
+      mBuffer.append( ']' );
+    }
+    mBuffer.append( ']' );
+  }
+
+  bool QgsWfsStreamWriter::writePolygonJSON( const QgsAbstractGeometry &geometry, int precision )
+  {
+    const QgsPolygonV2 *polygon = dynamic_cast<const QgsPolygonV2 *>( &geometry );
+    if ( !polygon || !dynamic_cast<const QgsLineString *>( polygon->exteriorRing() ) )
+      return false;
+    for ( int i = 0, n = polygon->numInteriorRings(); i < n; ++i )
+    {
+      if ( !dynamic_cast<const QgsLineString *>( polygon->interiorRing( i ) ) )
+        return false;
+    }
+
+    writeCoordinatesJSON( *static_cast<const QgsLineString *>( polygon->exteriorRing() ), precision );
+    for ( int i = 0, n = polygon->numInteriorRings(); i < n; ++i )
+    {
+      mBuffer.append( ", " );
+      writeCoordinatesJSON( *static_cast<const QgsLineString *>( polygon->interiorRing( i ) ), precision );
+    }
+    return true;
+  }
+
+  bool QgsWfsStreamWriter::writeGeometryJSON( const QgsAbstractGeometry &geometry, int precision )
+  {
+    const int start = mBuffer.size();
+    switch ( QgsWkbTypes::flatType( geometry.wkbType() ) )
+    {
+      case QgsWkbTypes::Point:
+      {
+        const QgsPoint *point = dynamic_cast<const QgsPoint *>( &geometry );
+        if ( !point )
+          return false;
+        mBuffer.append( "{\"type\": \"Point\", \"coordinates\": [" );
+        writeNumber( point->x(), precision );
+        mBuffer.append( ", " );
+        writeNumber( point->y(), precision );
+        mBuffer.append( "]}" );
+        return true;
+      }
+
+      case QgsWkbTypes::LineString:
+      {
+        const QgsLineString *line = dynamic_cast<const QgsLineString *>( &geometry );
+        if ( !line )
+          return false;
+        mBuffer.append( "{\"type\": \"LineString\", \"coordinates\": " );
+        writeCoordinatesJSON( *line, precision );
+        mBuffer.append( '}' );
+        return true;
+      }
+
+      case QgsWkbTypes::Polygon:
+        mBuffer.append( "{\"type\": \"Polygon\", \"coordinates\": [" );
+        if ( !writePolygonJSON( geometry, precision ) )
+        {
+          mBuffer.resize( start );
+          return false;
+        }
+        mBuffer.append( "] }" );
+        return true;
+
+      case QgsWkbTypes::MultiPoint:
+      {
+        const QgsMultiPointV2 *multiPoint = dynamic_cast<const QgsMultiPointV2 *>( &geometry );
+        if ( !multiPoint )
+          return false;
+        mBuffer.append( "{\"type\": \"MultiPoint\", \"coordinates\": [ " );
+        bool first = true;
+        for ( int i = 0, n = multiPoint->numGeometries(); i < n; ++i )
+        {
+          const QgsPoint *point = dynamic_cast<const QgsPoint *>( multiPoint->geometryN( i ) );
+          if ( !point )
+            continue;
+          if ( !first )
+            mBuffer.append( ", " );
+          first = false;
+          mBuffer.append( '[' );
+          writeNumber( point->x(), precision );
+          mBuffer.append( ", " );
+          writeNumber( point->y(), precision );
+          mBuffer.append( ']' );
+        }
+        mBuffer.append( "] }" );
+        return true;
+      }
+
+      case QgsWkbTypes::MultiLineString:
+      {
+        const QgsMultiLineString *multiLine = dynamic_cast<const QgsMultiLineString *>( &geometry );
+        if ( !multiLine )
+          return false;
+        mBuffer.append( "{\"type\": \"MultiLineString\", \"coordinates\": [" );
+        for ( int i = 0, n = multiLine->numGeometries(); i < n; ++i )
+        {
+          const QgsLineString *line = dynamic_cast<const QgsLineString *>( multiLine->geometryN( i ) );
+          if ( !line )
+          {
+            mBuffer.resize( start );
+            return false;
+          }
+          if ( i > 0 )
+            mBuffer.append( ", " );
+          writeCoordinatesJSON( *line, precision );
+        }
+        mBuffer.append( "] }" );
+        return true;
+      }
+
+      case QgsWkbTypes::MultiPolygon:
+      {
+        const QgsMultiPolygonV2 *multiPolygon = dynamic_cast<const QgsMultiPolygonV2 *>( &geometry );
+        if ( !multiPolygon )
+          return false;
+        mBuffer.append( "{\"type\": \"MultiPolygon\", \"coordinates\": [" );
+        for ( int i = 0, n = multiPolygon->numGeometries(); i < n; ++i )
+        {
+          if ( i > 0 )
+            mBuffer.append( ", " );
+          mBuffer.append( '[' );
+          if ( !writePolygonJSON( *multiPolygon->geometryN( i ), precision ) )
+          {
+            mBuffer.resize( start );
+            return false;
+          }
+          mBuffer.append( ']' );
+        }
+        mBuffer.append( "] }" );
+        return true;
+      }
+
+      default:
+        return false;
+    }
+  }
+
+} // namespace QgsWfs
@@ -0,0 +1,135 @@
+/***************************************************************************
+                              qgswfsstreamwriter.h
+                              -------------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSWFSSTREAMWRITER_H
+#define QGSWFSSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QString>
+
+class QgsAbstractGeometry;
+class QgsLineString;
+class QgsServerResponse;
+
+namespace QgsWfs
+{
+
+  /** Serializes GetFeature responses straight to UTF-8 bytes in a reusable
+   *  buffer, which is written to the response by chunks so that the memory
+   *  used does not depend on the number of features.
+   *
+   *  Geometries are written with the same layout as QgsAbstractGeometry::asGML2(),
+   *  asGML3() and asJSON() once saved by QDomDocument.
+   * \since QGIS 3.0
+   */
+  class QgsWfsStreamWriter
+  {
+    public:
+
+      //! Size in bytes of the chunks written to the response
+      static const int CHUNK_SIZE = 64 * 1024;
+
+      /** Constructor
+       *  \param response the response to write to
+       *  \param chunkSize the size in bytes of the chunks written to the response
+       */
+      explicit QgsWfsStreamWriter( QgsServerResponse &response, int chunkSize = CHUNK_SIZE );
+
+      //! Writes ASCII text
+      void write( const char *text ) { mBuffer.append( text ); }
+
+      //! Writes bytes
+      void write( const QByteArray &bytes ) { mBuffer.append( bytes ); }
+
+      //! Writes a character
+      void write( char c ) { mBuffer.append( c ); }
+
+      //! Writes text as UTF-8
+      void writeText( const QString &text );
+
+      //! Writes the content of an XML element, escaped as QDomDocument does
+      void writeXmlText( const QString &text );
+
+      //! Writes the value of an XML attribute, escaped as QDomDocument does
+      void writeXmlAttribute( const QString &text );
+
+      //! Writes a quoted JSON string, escaped as QgsJsonUtils::encodeValue() does
+      void writeJsonString( const QString &text );
+
+      //! Writes a number formatted as qgsDoubleToString() does
+      void writeNumber( double value, int precision );
+
+      //! Writes an integer
+      void writeNumber( qint64 value );
+
+      //! Writes the indentation of a QDomDocument element at \a depth
+      void writeIndent( int depth );
+
+      //! Writes an XML fragment saved by QDomDocument, indented at \a depth
+      void writeIndented( const QByteArray &xml, int depth );
+
+      /** Writes a geometry as GML
+       *  \param geometry the geometry to write
+       *  \param gml3 true for GML3, false for GML2
+       *  \param precision number of decimals of coordinates
+       *  \param depth depth of the geometry element
+       *  \param srsName srsName attribute of the geometry element, may be empty
+       *  \returns false if the geometry type is not supported, nothing is written then
+       */
+      bool writeGeometryGML( const QgsAbstractGeometry &geometry, bool gml3, int precision, int depth, const QString &srsName );
+
+      /** Writes a geometry as GeoJSON
+       *  \returns false if the geometry type is not supported, nothing is written then
+       */
+      bool writeGeometryJSON( const QgsAbstractGeometry &geometry, int precision );
+
+      //! Writes the buffer to the response once it holds a whole chunk
+      void flushChunk()
+      {
+        if ( mBuffer.size() >= mChunkSize )
+          flush();
+      }
+
+      //! Writes the buffer to the response and flushes the response
+      void flush();
+
+    private:
+      enum Escape
+      {
+        NoEscape,
+        XmlText,
+        XmlAttribute,
+        Json
+      };
+
+      void writeString( const QString &text, Escape escape );
+      void writeElementStart( const char *name, int depth, const QString &srsName = QString() );
+      void writeElementEnd( const char *name, int depth );
+      void writeCoordinatesGML( const QgsLineString &line, bool gml3, int precision, bool is3D );
+      void writeCoordinatesJSON( const QgsLineString &line, int precision );
+      bool writeLineGML( const QgsLineString &line, const char *name, bool gml3, int precision, int depth, const QString &srsName );
+      bool writePolygonGML( const QgsAbstractGeometry &geometry, bool gml3, int precision, int depth, const QString &srsName );
+      bool writePolygonJSON( const QgsAbstractGeometry &geometry, int precision );
+
+      QgsServerResponse &mResponse;
+      QByteArray mBuffer;
+      int mChunkSize;
+      QByteArray mDecimalPoint;
+  };
+
+} // namespace QgsWfs
+
+#endif
@@ -0,0 +1,508 @@
+/***************************************************************************
+                              qgscolorcubequantizer.cpp
+
+  Color reduction on a reduced color cube histogram
+  -------------------------------------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgscolorcubequantizer.h"
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace QgsWms
+{
+
+  ///@cond PRIVATE
+  namespace
+  {
+    // 5 bits per color channel and 3 bits of alpha
+    const int BIN_COUNT = 1 << 18;
+
+    // fully transparent pixels have their own bin, after the color bins, so that they
+    // never share a palette entry with visible colors
+    const int TRANSPARENT_BIN = BIN_COUNT;
+    const int HISTOGRAM_SIZE = BIN_COUNT + 1;
+
+    // below this number of pixels, threads cost more than they save
+    const int MIN_PARALLEL_PIXELS = 512 * 512;
+
+    inline int binOf( QRgb pixel )
+    {
+      if ( qAlpha( pixel ) == 0 )
+        return TRANSPARENT_BIN;
+      return ( ( qRed( pixel ) >> 3 ) << 13 ) | ( ( qGreen( pixel ) >> 3 ) << 8 )
+             | ( ( qBlue( pixel ) >> 3 ) << 3 ) | ( qAlpha( pixel ) >> 5 );
+    }
+
+    /* Pixels of ARGB32, RGB32 and ARGB32_Premultiplied images are read in place,
+     * other formats are converted first. All transparent pixels are the same color.
+     */
+    class PixelReader
+    {
+      public:
+        explicit PixelReader( const QImage &image )
+          : mImage( image )
+        {
+          if ( mImage.format() != QImage::Format_ARGB32 && mImage.format() != QImage::Format_RGB32
+               && mImage.format() != QImage::Format_ARGB32_Premultiplied )
+          {
+            mImage = mImage.convertToFormat( QImage::Format_ARGB32 );
+          }
+          mPremultiplied = mImage.format() == QImage::Format_ARGB32_Premultiplied;
+          mBits = mImage.constBits();
+          mBytesPerLine = mImage.bytesPerLine();
+        }
+
+        int width() const { return mImage.width(); }
+        int height() const { return mImage.height(); }
+
+        const QRgb *line( int y ) const
+        {
+          return reinterpret_cast< const QRgb * >( mBits + static_cast< qptrdiff >( y ) * mBytesPerLine );
+        }
+
+        QRgb pixel( QRgb value ) const
+        {
+          if ( qAlpha( value ) == 0 )
+            return 0;
+          return mPremultiplied ? qUnpremultiply( value ) : value;
+        }
+
+      private:
+        QImage mImage;
+        const uchar *mBits = nullptr;
+        int mBytesPerLine = 0;
+        bool mPremultiplied = false;
+    };
+
+    struct Bin
+    {
+      quint32 count;
+      // sums of the bits dropped from each channel, to get the mean color of the bin
+      quint64 red;
+      quint64 green;
+      quint64 blue;
+      quint64 alpha;
+    };
+
+    struct Stripe
+    {
+      const PixelReader *reader;
+      int rowBegin;
+      int rowEnd;
+      std::vector< Bin > bins;
+      // for mapping
+      const std::vector< qint16 > *binIndex;
+      uchar *outBits;
+      int outBytesPerLine;
+    };
+
+    void accumulateStripe( Stripe &stripe )
+    {
+      if ( stripe.bins.empty() )
+        stripe.bins.resize( HISTOGRAM_SIZE, Bin() );
+
+      const PixelReader &reader = *stripe.reader;
+      const int width = reader.width();
+      Bin *bins = stripe.bins.data();
+      for ( int y = stripe.rowBegin; y < stripe.rowEnd; ++y )
+      {
+        const QRgb *line = reader.line( y );
+        // rendered maps have long runs of the same color
+        QRgb previous = line[0] + 1;
+        QRgb pixel = 0;
+        Bin *bin = nullptr;
+        for ( int x = 0; x < width; ++x )
+        {
+          if ( line[x] != previous )
+          {
+            previous = line[x];
+            pixel = reader.pixel( previous );
+            bin = bins + binOf( pixel );
+          }
+          ++bin->count;
+          bin->red += qRed( pixel ) & 7;
+          bin->green += qGreen( pixel ) & 7;
+          bin->blue += qBlue( pixel ) & 7;
+          bin->alpha += qAlpha( pixel ) & 31;
+        }
+      }
+    }
+
+    void mapStripe( Stripe &stripe )
+    {
+      const PixelReader &reader = *stripe.reader;
+      const int width = reader.width();
+      const qint16 *binIndex = stripe.binIndex->data();
+      for ( int y = stripe.rowBegin; y < stripe.rowEnd; ++y )
+      {
+        const QRgb *line = reader.line( y );
+        uchar *out = stripe.outBits + static_cast< qptrdiff >( y ) * stripe.outBytesPerLine;
+        QRgb previous = line[0] + 1;
+        uchar index = 0;
+        for ( int x = 0; x < width; ++x )
+        {
+          if ( line[x] != previous )
+          {
+            previous = line[x];
+            index = static_cast< uchar >( binIndex[ binOf( reader.pixel( previous ) )] );
+          }
+          out[x] = index;
+        }
+      }
+    }
+
+    QList< Stripe > stripes( const PixelReader &reader, int threadCount )
+    {
+      int count = 1;
+      if ( static_cast< qint64 >( reader.width() ) * reader.height() >= MIN_PARALLEL_PIXELS )
+      {
+        count = threadCount > 0 ? threadCount : QThread::idealThreadCount();
+        count = std::max( 1, std::min( count, reader.height() ) );
+      }
+
+      QList< Stripe > result;
+      for ( int i = 0; i < count; ++i )
+      {
+        Stripe stripe;
+        stripe.reader = &reader;
+        stripe.rowBegin = static_cast< int >( static_cast< qint64 >( reader.height() ) * i / count );
+        stripe.rowEnd = static_cast< int >( static_cast< qint64 >( reader.height() ) * ( i + 1 ) / count );
+        stripe.binIndex = nullptr;
+        stripe.outBits = nullptr;
+        stripe.outBytesPerLine = 0;
+        result << stripe;
+      }
+      return result;
+    }
+
+    // occupied histogram bin with its mean color
+    struct Entry
+    {
+      int bin;
+      quint32 count;
+      int channels[4];
+    };
+
+    struct ChannelLess
+    {
+      explicit ChannelLess( int channel ) : mChannel( channel ) {}
+      bool operator()( const Entry &a, const Entry &b ) const { return a.channels[mChannel] < b.channels[mChannel]; }
+      int mChannel;
+    };
+
+    struct Box
+    {
+      int begin;
+      int end;
+      quint64 count;
+    };
+
+    /* Palette of an image, with the palette index of each histogram bin.
+     */
+    class ColorCube
+    {
+      public:
+        ColorCube( const PixelReader &reader, int nColors, int threadCount );
+
+        const QVector< QRgb > &palette() const { return mPalette; }
+        const std::vector< qint16 > &binIndex() const { return mBinIndex; }
+
+        //! Returns the palette index of a color, which may be out of the histogram
+        int index( QRgb color )
+        {
+          qint16 &cached = mBinIndex[ binOf( color )];
+          if ( cached < 0 )
+            cached = nearest( color );
+          return cached;
+        }
+
+      private:
+        void splitBox( std::vector< Entry > &entries, const Box &box, Box &lower, Box &upper ) const;
+        qint16 nearest( QRgb color ) const;
+
+        QVector< QRgb > mPalette;
+        std::vector< qint16 > mBinIndex;
+    };
+
+    ColorCube::ColorCube( const PixelReader &reader, int nColors, int threadCount )
+      : mBinIndex( HISTOGRAM_SIZE, -1 )
+    {
+      nColors = std::max( 1, std::min( nColors, 256 ) );
+
+      // partial histograms of row stripes, merged in the first one
+      QList< Stripe > parts = stripes( reader, threadCount );
+      if ( parts.size() > 1 )
+        QtConcurrent::blockingMap( parts, accumulateStripe );
+      else
+        accumulateStripe( parts[0] );
+
+      std::vector< Bin > &bins = parts[0].bins;
+      for ( int i = 1; i < parts.size(); ++i )
+      {
+        const std::vector< Bin > &partBins = parts.at( i ).bins;
+        for ( int b = 0; b < HISTOGRAM_SIZE; ++b )
+        {
+          bins[b].count += partBins[b].count;
+          bins[b].red += partBins[b].red;
+          bins[b].green += partBins[b].green;
+          bins[b].blue += partBins[b].blue;
+          bins[b].alpha += partBins[b].alpha;
+        }
+      }
+
+      std::vector< Entry > entries;
+      quint64 total = 0;
+      for ( int b = 0; b < BIN_COUNT; ++b )
+      {
+        const Bin &bin = bins[b];
+        if ( bin.count == 0 )
+          continue;
+
+        const quint64 half = bin.count / 2;
+        Entry entry;
+        entry.bin = b;
+        entry.count = bin.count;
+        entry.channels[0] = ( ( ( b >> 13 ) & 31 ) << 3 ) + static_cast< int >( ( bin.red + half ) / bin.count );
+        entry.channels[1] = ( ( ( b >> 8 ) & 31 ) << 3 ) + static_cast< int >( ( bin.green + half ) / bin.count );
+        entry.channels[2] = ( ( ( b >> 3 ) & 31 ) << 3 ) + static_cast< int >( ( bin.blue + half ) / bin.count );
+        entry.channels[3] = ( ( b & 7 ) << 5 ) + static_cast< int >( ( bin.alpha + half ) / bin.count );
+        entries.push_back( entry );
+        total += bin.count;
+      }
+      const bool hasTransparent = bins[ TRANSPARENT_BIN ].count > 0;
+      parts.clear();
+
+      // transparent pixels get the first palette entry, unless it is the only one and
+      // visible colors need it
+      const bool reserveTransparent = hasTransparent && ( nColors > 1 || entries.empty() );
+      if ( reserveTransparent )
+      {
+        mBinIndex[ TRANSPARENT_BIN ] = 0;
+        mPalette << qRgba( 0, 0, 0, 0 );
+      }
+      if ( entries.empty() )
+        return;
+
+      // median cut of the box holding the most pixels, until there are enough boxes
+      const int boxCount = reserveTransparent ? nColors - 1 : nColors;
+      std::vector< Box > boxes;
+      boxes.push_back( Box{ 0, static_cast< int >( entries.size() ), total } );
+      while ( static_cast< int >( boxes.size() ) < boxCount )
+      {
+        int largest = -1;
+        for ( int i = 0; i < static_cast< int >( boxes.size() ); ++i )
+        {
+          if ( boxes[i].end - boxes[i].begin > 1 && ( largest < 0 || boxes[i].count > boxes[largest].count ) )
+            largest = i;
+        }
+        if ( largest < 0 )
+          break;
+
+        Box lower, upper;
+        splitBox( entries, boxes[largest], lower, upper );
+        boxes[largest] = lower;
+        boxes.push_back( upper );
+      }
+
+      // the weighted mean color of each box
+      mPalette.reserve( mPalette.size() + static_cast< int >( boxes.size() ) );
+      for ( int i = 0; i < static_cast< int >( boxes.size() ); ++i )
+      {
+        const Box &box = boxes[i];
+        const qint16 index = static_cast< qint16 >( mPalette.size() );
+        quint64 sums[4] = { 0, 0, 0, 0 };
+        for ( int e = box.begin; e < box.end; ++e )
+        {
+          for ( int c = 0; c < 4; ++c )
+            sums[c] += static_cast< quint64 >( entries[e].channels[c] ) * entries[e].count;
+          mBinIndex[ entries[e].bin ] = index;
+        }
+        const quint64 half = box.count / 2;
+        mPalette << qRgba( static_cast< int >( ( sums[0] + half ) / box.count ),
+                           static_cast< int >( ( sums[1] + half ) / box.count ),
+                           static_cast< int >( ( sums[2] + half ) / box.count ),
+                           static_cast< int >( ( sums[3] + half ) / box.count ) );
+      }
+
+      if ( hasTransparent && !reserveTransparent )
+        mBinIndex[ TRANSPARENT_BIN ] = nearest( qRgba( 0, 0, 0, 0 ) );
+    }
+
+    void ColorCube::splitBox( std::vector< Entry > &entries, const Box &box, Box &lower, Box &upper ) const
+    {
+      int minimum[4] = { 255, 255, 255, 255 };
+      int maximum[4] = { 0, 0, 0, 0 };
+      for ( int e = box.begin; e < box.end; ++e )
+      {
+        for ( int c = 0; c < 4; ++c )
+        {
+          minimum[c] = std::min( minimum[c], entries[e].channels[c] );
+          maximum[c] = std::max( maximum[c], entries[e].channels[c] );
+        }
+      }
+      int channel = 0;
+      for ( int c = 1; c < 4; ++c )
+      {
+        if ( maximum[c] - minimum[c] > maximum[channel] - minimum[channel] )
+          channel = c;
+      }
+
+      std::sort( entries.begin() + box.begin, entries.begin() + box.end, ChannelLess( channel ) );
+
+      // split at the median pixel, keeping at least one bin on each side
+      const quint64 half = box.count / 2;
+      quint64 count = 0;
+      int split = box.begin + 1;
+      for ( int e = box.begin; e < box.end - 1; ++e )
+      {
+        count += entries[e].count;
+        split = e + 1;
+        if ( count >= half )
+          break;
+      }
+
+      lower = Box{ box.begin, split, count };
+      upper = Box{ split, box.end, box.count - count };
+    }
+
+    qint16 ColorCube::nearest( QRgb color ) const
+    {
+      qint16 result = 0;
+      int minDistance = std::numeric_limits< int >::max();
+      for ( int i = 0; i < mPalette.size(); ++i )
+      {
+        const QRgb entry = mPalette.at( i );
+        // visible colors never get the transparent entry, even when nearly transparent
+        if ( qAlpha( entry ) == 0 && qAlpha( color ) > 0 && mPalette.size() > 1 )
+          continue;
+        const int dr = qRed( entry ) - qRed( color );
+        const int dg = qGreen( entry ) - qGreen( color );
+        const int db = qBlue( entry ) - qBlue( color );
+        const int da = qAlpha( entry ) - qAlpha( color );
+        const int distance = dr * dr + dg * dg + db * db + da * da;
+        if ( distance < minDistance )
+        {
+          minDistance = distance;
+          result = static_cast< qint16 >( i );
+        }
+      }
+      return result;
+    }
+
+    /* Floyd-Steinberg error diffusion of the color channels. The alpha channel
+     * is not diffused, so that transparent areas stay clean.
+     */
+    void ditherImage( const PixelReader &reader, ColorCube &cube, QImage &result )
+    {
+      const int width = reader.width();
+      const QVector< QRgb > &palette = cube.palette();
+
+      // errors multiplied by 16, with a margin of one pixel on each side
+      std::vector< int > currentErrors( ( width + 2 ) * 3, 0 );
+      std::vector< int > nextErrors( ( width + 2 ) * 3, 0 );
+
+      for ( int y = 0; y < reader.height(); ++y )
+      {
+        std::swap( currentErrors, nextErrors );
+        std::fill( nextErrors.begin(), nextErrors.end(), 0 );
+
+        const QRgb *line = reader.line( y );
+        uchar *out = result.scanLine( y );
+        for ( int x = 0; x < width; ++x )
+        {
+          const QRgb pixel = reader.pixel( line[x] );
+          if ( qAlpha( pixel ) == 0 )
+          {
+            out[x] = static_cast< uchar >( cube.index( pixel ) );
+            continue;
+          }
+
+          const int *error = &currentErrors[( x + 1 ) * 3];
+          const int red = qBound( 0, qRed( pixel ) + error[0] / 16, 255 );
+          const int green = qBound( 0, qGreen( pixel ) + error[1] / 16, 255 );
+          const int blue = qBound( 0, qBlue( pixel ) + error[2] / 16, 255 );
+          const int index = cube.index( qRgba( red, green, blue, qAlpha( pixel ) ) );
+          out[x] = static_cast< uchar >( index );
+
+          const QRgb color = palette.at( index );
+          const int diffs[3] = { red - qRed( color ), green - qGreen( color ), blue - qBlue( color ) };
+          for ( int c = 0; c < 3; ++c )
+          {
+            currentErrors[( x + 2 ) * 3 + c] += diffs[c] * 7;
+            nextErrors[x * 3 + c] += diffs[c] * 3;
+            nextErrors[( x + 1 ) * 3 + c] += diffs[c] * 5;
+            nextErrors[( x + 2 ) * 3 + c] += diffs[c];
+          }
+        }
+      }
+    }
+  }
+  ///@endcond
+
+  void colorCubePalette( QVector<QRgb> &colorTable, int nColors, const QImage &inputImage, int threadCount )
+  {
+    colorTable.clear();
+    if ( inputImage.isNull() )
+      return;
+
+    PixelReader reader( inputImage );
+    ColorCube cube( reader, nColors, threadCount );
+    colorTable = cube.palette();
+  }
+
+  QImage colorCubeQuantize( const QImage &inputImage, int nColors, bool dither, int threadCount )
+  {
+    if ( inputImage.isNull() )
+      return QImage();
+
+    PixelReader reader( inputImage );
+    ColorCube cube( reader, nColors, threadCount );
+
+    QImage result( reader.width(), reader.height(), QImage::Format_Indexed8 );
+    result.setDotsPerMeterX( inputImage.dotsPerMeterX() );
+    result.setDotsPerMeterY( inputImage.dotsPerMeterY() );
+
+    if ( dither )
+    {
+      ditherImage( reader, cube, result );
+    }
+    else
+    {
+      // every pixel is in an occupied bin, so the bin index is read only
+      QList< Stripe > parts = stripes( reader, threadCount );
+      uchar *bits = result.bits();
+      for ( int i = 0; i < parts.size(); ++i )
+      {
+        parts[i].binIndex = &cube.binIndex();
+        parts[i].outBits = bits;
+        parts[i].outBytesPerLine = result.bytesPerLine();
+      }
+      if ( parts.size() > 1 )
+        QtConcurrent::blockingMap( parts, mapStripe );
+      else
+        mapStripe( parts[0] );
+    }
+
+    result.setColorTable( cube.palette() );
+    return result;
+  }
+
+} // namespace QgsWms
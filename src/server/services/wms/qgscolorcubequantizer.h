@@ -0,0 +1,60 @@
+/***************************************************************************
+                              qgscolorcubequantizer.h
+
+  Color reduction on a reduced color cube histogram
+  -------------------------------------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSCOLORCUBEQUANTIZER_H
+#define QGSCOLORCUBEQUANTIZER_H
+
+#include <QVector>
+#include <QImage>
+
+/**
+ * \ingroup server
+ * Color cube quantizer
+ */
+
+namespace QgsWms
+{
+
+  /**
+   * Computes a palette of at most \a nColors colors with a median cut over a
+   * histogram of the image colors reduced to 5 bits per color channel and
+   * 3 bits of alpha. Each histogram cell keeps the mean of its colors, so
+   * that images with at most \a nColors colors, no two of them in the same
+   * cell, get their exact colors. Fully transparent pixels have their own
+   * palette entry, the first one, unless \a nColors is 1.
+   * \param colorTable receives the palette
+   * \param nColors maximum number of colors, at most 256
+   * \param inputImage the image
+   * \param threadCount number of threads accumulating the histogram of large
+   * images, 0 for the number of processor cores
+   */
+  void colorCubePalette( QVector<QRgb> &colorTable, int nColors, const QImage &inputImage, int threadCount = 1 );
+
+  /**
+   * Converts an image to an indexed image with a palette computed by colorCubePalette().
+   * \param inputImage the image
+   * \param nColors maximum number of colors, at most 256
+   * \param dither true to diffuse the color errors with the Floyd-Steinberg algorithm
+   * \param threadCount number of threads, 0 for the number of processor cores
+   * \returns an image in QImage::Format_Indexed8
+   */
+  QImage colorCubeQuantize( const QImage &inputImage, int nColors, bool dither = false, int threadCount = 1 );
+
+} // namespace QgsWms
+
+#endif
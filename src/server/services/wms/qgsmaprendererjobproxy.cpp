@@ -20,23 +20,54 @@
 #include "qgsmessagelog.h"
 #include "qgsmaprendererparalleljob.h"
 #include "qgsmaprenderercustompainterjob.h"
+#include "qgsserverprofiler.h"
 
 namespace QgsWms
 {
+  ///@cond PRIVATE
+  namespace
+  {
+    // the rendering time of a layer includes fetching its features
+    void recordRenderingTimes( const QgsMapRendererJob &renderJob )
+    {
+      if ( !QgsServerProfiler::current() )
+      {
+        return;
+      }
+
+      const QHash<QgsMapLayer *, int> times = renderJob.perLayerRenderingTime();
+      for ( QHash<QgsMapLayer *, int>::const_iterator it = times.constBegin(); it != times.constEnd(); ++it )
+      {
+        QgsServerProfiler::record( QStringLiteral( "render" ), it.value(), it.key()->name() );
+      }
+      if ( renderJob.labelingTime() >= 0 )
+      {
+        QgsServerProfiler::record( QStringLiteral( "label" ), renderJob.labelingTime() );
+      }
+    }
+  }
+  ///@endcond
 
   QgsMapRendererJobProxy::QgsMapRendererJobProxy(
     bool parallelRendering
     , int maxThreads
     , QgsAccessControl *accessControl
+    , int maxThreadsPerRequest
   )
     :
-    mParallelRendering( parallelRendering )
+    mParallelRendering( parallelRendering || maxThreadsPerRequest > 1 )
+    , mMaxThreadsPerRequest( maxThreadsPerRequest )
     , mAccessControl( accessControl )
   {
 #ifndef HAVE_SERVER_PYTHON_PLUGINS
     Q_UNUSED( mAccessControl );
 #endif
-    if ( mParallelRendering )
+    if ( mParallelRendering && mMaxThreadsPerRequest > 0 )
+    {
+      // concurrent requests do not share the global thread pool
+      QgsMessageLog::logMessage( QStringLiteral( "Parallel rendering activated with %1 threads per request" ).arg( mMaxThreadsPerRequest ), QStringLiteral( "server" ), QgsMessageLog::INFO );
+    }
+    else if ( mParallelRendering )
     {
       QgsApplication::setMaxThreads( maxThreads );
       QgsMessageLog::logMessage( QStringLiteral( "Parallel rendering activated with %1 threads" ).arg( maxThreads ), QStringLiteral( "server" ), QgsMessageLog::INFO );
@@ -52,11 +83,13 @@ namespace QgsWms
     if ( mParallelRendering )
     {
       QgsMapRendererParallelJob renderJob( mapSettings );
+      renderJob.setMaxThreads( mMaxThreadsPerRequest );
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
       renderJob.setFeatureFilterProvider( mAccessControl );
 #endif
       renderJob.start();
       renderJob.waitForFinished();
+      recordRenderingTimes( renderJob );
       *image = renderJob.renderedImage();
       mPainter.reset( new QPainter( image ) );
     }
@@ -68,6 +101,7 @@ namespace QgsWms
       renderJob.setFeatureFilterProvider( mAccessControl );
 #endif
       renderJob.renderSynchronously();
+      recordRenderingTimes( renderJob );
     }
   }
 
@@ -34,12 +34,18 @@ namespace QgsWms
     public:
 
       /** Constructor.
+        * \param parallelRendering renders the layers in parallel
+        * \param maxThreads the maximum number of threads of the global thread pool
         * \param accessControl Does not take ownership of QgsAccessControl
+        * \param maxThreadsPerRequest the number of threads of the job, which then renders
+        * the layers in parallel on its own thread pool if greater than 1. 0 uses the
+        * global thread pool.
         */
       QgsMapRendererJobProxy(
         bool parallelRendering
         , int maxThreads
         , QgsAccessControl *accessControl
+        , int maxThreadsPerRequest = 0
       );
 
       /** Sequential or parallel map rendering according to qsettings.
@@ -55,6 +61,7 @@ namespace QgsWms
 
     private:
       bool mParallelRendering;
+      int mMaxThreadsPerRequest = 0;
       QgsAccessControl *mAccessControl = nullptr;
       std::unique_ptr<QPainter> mPainter;
   };
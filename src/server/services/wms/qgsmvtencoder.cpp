@@ -0,0 +1,497 @@
+/***************************************************************************
+                              qgsmvtencoder.cpp
+                              -----------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsmvtencoder.h"
+#include "qgscoordinatetransform.h"
+#include "qgsexception.h"
+#include "qgsfeatureiterator.h"
+
+#include <QHash>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+namespace QgsWms
+{
+
+  ///@cond PRIVATE
+  namespace
+  {
+    // wire types of the protobuf encoding
+    enum WireType
+    {
+      Varint = 0,
+      Fixed64 = 1,
+      LengthDelimited = 2
+    };
+
+    // fields of the messages of vector_tile.proto
+    const int TILE_LAYERS = 3;
+
+    const int LAYER_NAME = 1;
+    const int LAYER_FEATURES = 2;
+    const int LAYER_KEYS = 3;
+    const int LAYER_VALUES = 4;
+    const int LAYER_EXTENT = 5;
+    const int LAYER_VERSION = 15;
+
+    const int FEATURE_ID = 1;
+    const int FEATURE_TAGS = 2;
+    const int FEATURE_TYPE = 3;
+    const int FEATURE_GEOMETRY = 4;
+
+    const int VALUE_STRING = 1;
+    const int VALUE_DOUBLE = 3;
+    const int VALUE_UINT = 5;
+    const int VALUE_SINT = 6;
+    const int VALUE_BOOL = 7;
+
+    // geometry types and commands
+    const int GEOM_POINT = 1;
+    const int GEOM_LINESTRING = 2;
+    const int GEOM_POLYGON = 3;
+
+    const int CMD_MOVE_TO = 1;
+    const int CMD_LINE_TO = 2;
+    const int CMD_CLOSE_PATH = 7;
+
+    void writeVarint( QByteArray &out, quint64 value )
+    {
+      while ( value >= 0x80 )
+      {
+        out.append( static_cast<char>( ( value & 0x7f ) | 0x80 ) );
+        value >>= 7;
+      }
+      out.append( static_cast<char>( value ) );
+    }
+
+    void writeKey( QByteArray &out, int field, WireType type )
+    {
+      writeVarint( out, ( static_cast<quint32>( field ) << 3 ) | type );
+    }
+
+    void writeVarintField( QByteArray &out, int field, quint64 value )
+    {
+      writeKey( out, field, Varint );
+      writeVarint( out, value );
+    }
+
+    void writeBytesField( QByteArray &out, int field, const QByteArray &bytes )
+    {
+      writeKey( out, field, LengthDelimited );
+      writeVarint( out, bytes.size() );
+      out.append( bytes );
+    }
+
+    void writePackedField( QByteArray &out, int field, const QVector<quint32> &values )
+    {
+      QByteArray packed;
+      Q_FOREACH ( quint32 value, values )
+      {
+        writeVarint( packed, value );
+      }
+      writeBytesField( out, field, packed );
+    }
+
+    quint64 zigZag( qint64 value )
+    {
+      return ( static_cast<quint64>( value ) << 1 ) ^ static_cast<quint64>( value >> 63 );
+    }
+
+    quint32 zigZag( qint32 value )
+    {
+      return ( static_cast<quint32>( value ) << 1 ) ^ static_cast<quint32>( value >> 31 );
+    }
+
+    quint32 commandInteger( int command, int count )
+    {
+      return ( command & 0x7 ) | ( static_cast<quint32>( count ) << 3 );
+    }
+
+    // Returns the encoded Value message, or an empty array for null values
+    QByteArray encodeValue( const QVariant &value )
+    {
+      QByteArray out;
+      if ( value.isNull() )
+      {
+        return out;
+      }
+
+      switch ( value.type() )
+      {
+        case QVariant::Bool:
+          writeVarintField( out, VALUE_BOOL, value.toBool() ? 1 : 0 );
+          break;
+
+        case QVariant::Int:
+        case QVariant::LongLong:
+          writeVarintField( out, VALUE_SINT, zigZag( static_cast<qint64>( value.toLongLong() ) ) );
+          break;
+
+        case QVariant::UInt:
+        case QVariant::ULongLong:
+          writeVarintField( out, VALUE_UINT, value.toULongLong() );
+          break;
+
+        case QVariant::Double:
+        {
+          const double number = value.toDouble();
+          quint64 bits;
+          std::memcpy( &bits, &number, sizeof( bits ) );
+          uchar bytes[sizeof( bits )];
+          qToLittleEndian( bits, bytes );
+          writeKey( out, VALUE_DOUBLE, Fixed64 );
+          out.append( reinterpret_cast<const char *>( bytes ), sizeof( bytes ) );
+          break;
+        }
+
+        default:
+          writeBytesField( out, VALUE_STRING, value.toString().toUtf8() );
+          break;
+      }
+      return out;
+    }
+
+    // Returns twice the signed area of the ring, which is positive for
+    // clockwise rings as the y axis of the tile points down
+    qint64 doubleArea( const QVector<QPoint> &ring )
+    {
+      qint64 area = 0;
+      for ( int i = 0, j = ring.size() - 1; i < ring.size(); j = i++ )
+      {
+        area += static_cast<qint64>( ring.at( j ).x() ) * ring.at( i ).y()
+                - static_cast<qint64>( ring.at( i ).x() ) * ring.at( j ).y();
+      }
+      return area;
+    }
+
+    // Clipping may return collections, only the parts of the type of the feature are kept
+    void collectParts( const QgsGeometry &geometry, QgsWkbTypes::GeometryType type, QList<QgsGeometry> &parts )
+    {
+      if ( geometry.isMultipart() )
+      {
+        Q_FOREACH ( const QgsGeometry &part, geometry.asGeometryCollection() )
+        {
+          collectParts( part, type, parts );
+        }
+      }
+      else if ( geometry.type() == type )
+      {
+        parts << geometry;
+      }
+    }
+  }
+  ///@endcond
+
+  QgsMvtEncoder::QgsMvtEncoder( const QgsRectangle &tileExtent, int extent, int buffer )
+    : mTileExtent( tileExtent )
+    , mExtent( extent )
+    , mScaleX( extent / tileExtent.width() )
+    , mScaleY( extent / tileExtent.height() )
+    , mSimplifier( QgsMapToPixelSimplifier::SimplifyGeometry, std::min( tileExtent.width(), tileExtent.height() ) / extent )
+  {
+    const double bufferX = buffer / mScaleX;
+    const double bufferY = buffer / mScaleY;
+    mClipExtent = QgsRectangle( tileExtent.xMinimum() - bufferX, tileExtent.yMinimum() - bufferY,
+                                tileExtent.xMaximum() + bufferX, tileExtent.yMaximum() + bufferY );
+  }
+
+  int QgsMvtEncoder::addLayer( const QString &name, const QgsFields &fields, const QgsAttributeList &attributes,
+                               QgsFeatureIterator &iterator, const QgsCoordinateTransform &transform )
+  {
+    // features are written as they are read, keys and values once all of them are known
+    QByteArray layer;
+    writeVarintField( layer, LAYER_VERSION, 2 );
+    writeBytesField( layer, LAYER_NAME, name.toUtf8() );
+
+    QByteArray keys;
+    QHash<int, int> keyIndexes;
+    QByteArray values;
+    QHash<QByteArray, int> valueIndexes;
+
+    int featureCount = 0;
+    QgsFeature feature;
+    QVector<quint32> tags;
+    while ( iterator.nextFeature( feature ) )
+    {
+      if ( !feature.hasGeometry() )
+      {
+        continue;
+      }
+
+      QgsGeometry geometry = feature.geometry();
+      if ( transform.isValid() )
+      {
+        try
+        {
+          if ( geometry.transform( transform ) != 0 )
+          {
+            continue;
+          }
+        }
+        catch ( QgsCsException & )
+        {
+          continue;
+        }
+      }
+
+      mGeometry.clear();
+      mCursor = QPoint();
+      const int type = encodeGeometry( geometry );
+      if ( type == 0 )
+      {
+        continue;
+      }
+
+      tags.clear();
+      Q_FOREACH ( int idx, attributes )
+      {
+        const QByteArray value = encodeValue( feature.attribute( idx ) );
+        if ( value.isEmpty() )
+        {
+          continue;
+        }
+
+        int keyIndex = keyIndexes.value( idx, -1 );
+        if ( keyIndex < 0 )
+        {
+          keyIndex = keyIndexes.size();
+          keyIndexes.insert( idx, keyIndex );
+          writeBytesField( keys, LAYER_KEYS, fields.at( idx ).name().toUtf8() );
+        }
+
+        // encoded values are their own key
+        int valueIndex = valueIndexes.value( value, -1 );
+        if ( valueIndex < 0 )
+        {
+          valueIndex = valueIndexes.size();
+          valueIndexes.insert( value, valueIndex );
+          writeBytesField( values, LAYER_VALUES, value );
+        }
+
+        tags << keyIndex << valueIndex;
+      }
+
+      QByteArray featureMessage;
+      if ( feature.id() >= 0 )
+      {
+        writeVarintField( featureMessage, FEATURE_ID, feature.id() );
+      }
+      if ( !tags.isEmpty() )
+      {
+        writePackedField( featureMessage, FEATURE_TAGS, tags );
+      }
+      writeVarintField( featureMessage, FEATURE_TYPE, type );
+      writePackedField( featureMessage, FEATURE_GEOMETRY, mGeometry );
+      writeBytesField( layer, LAYER_FEATURES, featureMessage );
+      ++featureCount;
+    }
+
+    if ( featureCount > 0 )
+    {
+      layer.append( keys );
+      layer.append( values );
+      writeVarintField( layer, LAYER_EXTENT, mExtent );
+      writeBytesField( mTile, TILE_LAYERS, layer );
+    }
+    return featureCount;
+  }
+
+  int QgsMvtEncoder::encodeGeometry( const QgsGeometry &geometry )
+  {
+    const QgsWkbTypes::GeometryType type = geometry.type();
+    QgsGeometry clipped = geometry;
+    if ( type != QgsWkbTypes::PointGeometry )
+    {
+      // simplifying to the grid first makes clipping cheaper
+      QgsGeometry simplified = mSimplifier.simplify( geometry );
+      const QgsRectangle bbox = simplified.boundingBox();
+      if ( !bbox.intersects( mClipExtent ) )
+      {
+        return 0;
+      }
+      clipped = mClipExtent.contains( bbox ) ? simplified : simplified.clipped( mClipExtent );
+    }
+
+    QList<QgsGeometry> parts;
+    collectParts( clipped, type, parts );
+
+    QgsMultiPoint points;
+    Q_FOREACH ( const QgsGeometry &part, parts )
+    {
+      switch ( type )
+      {
+        case QgsWkbTypes::PointGeometry:
+          points << part.asPoint();
+          break;
+
+        case QgsWkbTypes::LineGeometry:
+          encodeLine( part.asPolyline() );
+          break;
+
+        case QgsWkbTypes::PolygonGeometry:
+          encodePolygon( part.asPolygon() );
+          break;
+
+        case QgsWkbTypes::UnknownGeometry:
+        case QgsWkbTypes::NullGeometry:
+          break;
+      }
+    }
+    if ( !points.isEmpty() )
+    {
+      encodePoints( points );
+    }
+
+    if ( mGeometry.isEmpty() )
+    {
+      return 0;
+    }
+
+    switch ( type )
+    {
+      case QgsWkbTypes::PointGeometry:
+        return GEOM_POINT;
+      case QgsWkbTypes::LineGeometry:
+        return GEOM_LINESTRING;
+      case QgsWkbTypes::PolygonGeometry:
+        return GEOM_POLYGON;
+      default:
+        return 0;
+    }
+  }
+
+  void QgsMvtEncoder::encodePoints( const QgsMultiPoint &points )
+  {
+    QVector<QPoint> quantized;
+    Q_FOREACH ( const QgsPointXY &point, points )
+    {
+      if ( mClipExtent.contains( point ) )
+      {
+        quantized << toGrid( point );
+      }
+    }
+
+    if ( !quantized.isEmpty() )
+    {
+      appendCommand( CMD_MOVE_TO, quantized, 0, quantized.size() );
+    }
+  }
+
+  void QgsMvtEncoder::encodeLine( const QgsPolyline &line )
+  {
+    QVector<QPoint> quantized;
+    Q_FOREACH ( const QgsPointXY &point, line )
+    {
+      const QPoint gridPoint = toGrid( point );
+      if ( quantized.isEmpty() || quantized.last() != gridPoint )
+      {
+        quantized << gridPoint;
+      }
+    }
+
+    if ( quantized.size() >= 2 )
+    {
+      appendCommand( CMD_MOVE_TO, quantized, 0, 1 );
+      appendCommand( CMD_LINE_TO, quantized, 1, quantized.size() - 1 );
+    }
+  }
+
+  void QgsMvtEncoder::encodePolygon( const QgsPolygon &polygon )
+  {
+    if ( polygon.isEmpty() )
+    {
+      return;
+    }
+
+    // holes of collapsed exterior rings are dropped with them
+    const QVector<QPoint> exterior = quantizedRing( polygon.at( 0 ), true );
+    if ( exterior.isEmpty() )
+    {
+      return;
+    }
+    appendRing( exterior );
+
+    for ( int i = 1; i < polygon.size(); ++i )
+    {
+      const QVector<QPoint> interior = quantizedRing( polygon.at( i ), false );
+      if ( !interior.isEmpty() )
+      {
+        appendRing( interior );
+      }
+    }
+  }
+
+  QVector<QPoint> QgsMvtEncoder::quantizedRing( const QgsPolyline &ring, bool exterior ) const
+  {
+    QVector<QPoint> quantized;
+    Q_FOREACH ( const QgsPointXY &point, ring )
+    {
+      const QPoint gridPoint = toGrid( point );
+      if ( quantized.isEmpty() || quantized.last() != gridPoint )
+      {
+        quantized << gridPoint;
+      }
+    }
+
+    // the ring is closed by the ClosePath command
+    if ( quantized.size() > 1 && quantized.first() == quantized.last() )
+    {
+      quantized.removeLast();
+    }
+
+    const qint64 area = quantized.size() < 3 ? 0 : doubleArea( quantized );
+    if ( area == 0 )
+    {
+      return QVector<QPoint>();
+    }
+
+    // exterior rings have a positive area and interior rings a negative one
+    if ( ( area > 0 ) != exterior )
+    {
+      std::reverse( quantized.begin(), quantized.end() );
+    }
+    return quantized;
+  }
+
+  void QgsMvtEncoder::appendCommand( int command, const QVector<QPoint> &points, int from, int count )
+  {
+    mGeometry << commandInteger( command, count );
+    for ( int i = from; i < from + count; ++i )
+    {
+      const QPoint &point = points.at( i );
+      mGeometry << zigZag( static_cast<qint32>( point.x() - mCursor.x() ) )
+                << zigZag( static_cast<qint32>( point.y() - mCursor.y() ) );
+      mCursor = point;
+    }
+  }
+
+  void QgsMvtEncoder::appendRing( const QVector<QPoint> &ring )
+  {
+    appendCommand( CMD_MOVE_TO, ring, 0, 1 );
+    appendCommand( CMD_LINE_TO, ring, 1, ring.size() - 1 );
+    mGeometry << commandInteger( CMD_CLOSE_PATH, 1 );
+  }
+
+  QPoint QgsMvtEncoder::toGrid( const QgsPointXY &point ) const
+  {
+    return QPoint( qRound( ( point.x() - mTileExtent.xMinimum() ) * mScaleX ),
+                   qRound( ( mTileExtent.yMaximum() - point.y() ) * mScaleY ) );
+  }
+
+} // namespace QgsWms
@@ -0,0 +1,121 @@
+/***************************************************************************
+                              qgsmvtencoder.h
+                              ---------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSMVTENCODER_H
+#define QGSMVTENCODER_H
+
+#include <QByteArray>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+
+#include "qgsfeature.h"
+#include "qgsgeometry.h"
+#include "qgsmaptopixelgeometrysimplifier.h"
+#include "qgsrectangle.h"
+
+class QgsCoordinateTransform;
+class QgsFeatureIterator;
+
+namespace QgsWms
+{
+
+  /** \ingroup server
+   * Encodes features as a Mapbox Vector Tile (version 2 of the specification).
+   *
+   * Geometries are simplified to the tile grid with QgsMapToPixelSimplifier,
+   * clipped to the tile and its buffer, and quantized to the grid. Each layer
+   * is written to the protobuf stream while its features are iterated.
+   * \since QGIS 3.0
+   */
+  class QgsMvtEncoder
+  {
+    public:
+
+      //! Default size of the tile grid
+      static const int DEFAULT_EXTENT = 4096;
+
+      //! Default buffer around the tile, in grid units
+      static const int DEFAULT_BUFFER = 64;
+
+      /** Constructor.
+        * \param tileExtent the extent of the tile, in map units
+        * \param extent the size of the tile grid
+        * \param buffer the buffer around the tile in grid units, geometries are clipped to it
+        */
+      explicit QgsMvtEncoder( const QgsRectangle &tileExtent, int extent = DEFAULT_EXTENT, int buffer = DEFAULT_BUFFER );
+
+      /** Encodes a layer of the tile. Layers without features are not written.
+        * \param name the name of the layer in the tile
+        * \param fields the fields of the features
+        * \param attributes indexes of the attributes written as tags
+        * \param iterator the features, only their part within the buffer of the tile is written
+        * \param transform transforms the features to map coordinates, may be invalid if no
+        * transformation is needed
+        * \returns the number of written features
+        */
+      int addLayer( const QString &name, const QgsFields &fields, const QgsAttributeList &attributes,
+                    QgsFeatureIterator &iterator, const QgsCoordinateTransform &transform );
+
+      //! Returns the extent of the tile with its buffer, in map units
+      QgsRectangle clipExtent() const { return mClipExtent; }
+
+      //! Returns the encoded tile
+      QByteArray tile() const { return mTile; }
+
+    private:
+
+      /** Appends the command integers of the geometry to mGeometry
+        * \returns the geometry type of the tile feature, 0 if nothing is left of the geometry
+        */
+      int encodeGeometry( const QgsGeometry &geometry );
+
+      void encodePoints( const QgsMultiPoint &points );
+      void encodeLine( const QgsPolyline &line );
+      void encodePolygon( const QgsPolygon &polygon );
+
+      //! Returns the ring quantized to the grid, oriented as exterior or interior ring
+      QVector<QPoint> quantizedRing( const QgsPolyline &ring, bool exterior ) const;
+
+      //! Appends a command with its points, as deltas from the cursor
+      void appendCommand( int command, const QVector<QPoint> &points, int from, int count );
+
+      //! Appends a closed ring, as returned by quantizedRing()
+      void appendRing( const QVector<QPoint> &ring );
+
+      QPoint toGrid( const QgsPointXY &point ) const;
+
+      QgsRectangle mTileExtent;
+      int mExtent;
+      //! Tile extent with its buffer, in map units
+      QgsRectangle mClipExtent;
+      //! Grid units per map unit, horizontally and vertically
+      double mScaleX;
+      double mScaleY;
+      QgsMapToPixelSimplifier mSimplifier;
+
+      //! Command integers of the current feature
+      QVector<quint32> mGeometry;
+      //! Position of the cursor in the current feature
+      QPoint mCursor;
+
+      QByteArray mTile;
+  };
+
+} // namespace QgsWms
+
+#endif // QGSMVTENCODER_H
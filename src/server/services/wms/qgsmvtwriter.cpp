@@ -0,0 +1,47 @@
+/***************************************************************************
+                              qgsmvtwriter.cpp
+                              ----------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsmvtwriter.h"
+#include "qgswmsrenderer.h"
+
+namespace QgsWms
+{
+
+  bool isMvtFormat( const QString &format )
+  {
+    return format.compare( MVT_CONTENT_TYPE, Qt::CaseInsensitive ) == 0
+           || format.compare( QLatin1String( "application/x-protobuf" ), Qt::CaseInsensitive ) == 0
+           || format.compare( QLatin1String( "mvt" ), Qt::CaseInsensitive ) == 0;
+  }
+
+  void writeAsMvt( QgsServerInterface *serverIface, const QgsProject *project,
+                   const QString &version, const QgsServerRequest &request,
+                   QgsServerResponse &response )
+  {
+    Q_UNUSED( version );
+
+    // as GetMap, only relies on the project as it may run concurrently with other requests
+    QgsServerRequest::Parameters params = request.parameters();
+    QgsRenderer renderer( serverIface, project, params, nullptr );
+
+    const QByteArray tile = renderer.getMvt();
+
+    response.setHeader( QStringLiteral( "Content-Type" ), MVT_CONTENT_TYPE );
+    response.write( tile );
+  }
+
+} // namespace QgsWms
@@ -0,0 +1,41 @@
+/***************************************************************************
+                              qgsmvtwriter.h
+                              --------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSMVTWRITER_H
+#define QGSMVTWRITER_H
+
+#include "qgsmodule.h"
+
+namespace QgsWms
+{
+
+  //! Content type of Mapbox Vector Tiles
+  const QString MVT_CONTENT_TYPE = QStringLiteral( "application/vnd.mapbox-vector-tile" );
+
+  /** Returns true if \a format is a GetMap format of Mapbox Vector Tiles
+   */
+  bool isMvtFormat( const QString &format );
+
+  /** Output GetMap response as a Mapbox Vector Tile
+   */
+  void writeAsMvt( QgsServerInterface *serverIface, const QgsProject *project,
+                   const QString &version, const QgsServerRequest &request,
+                   QgsServerResponse &response );
+
+} // namespace QgsWms
+
+#endif // QGSMVTWRITER_H
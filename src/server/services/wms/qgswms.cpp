@@ -22,6 +22,7 @@
 #include "qgsmodule.h"
 #include "qgswmsutils.h"
 #include "qgsdxfwriter.h"
+#include "qgsmvtwriter.h"
 #include "qgswmsgetcapabilities.h"
 #include "qgswmsgetmap.h"
 #include "qgswmsgetstyles.h"
@@ -98,6 +99,10 @@ namespace QgsWms
           {
             writeAsDxf( mServerIface, project, versionString, request, response );
           }
+          else if ( isMvtFormat( format ) )
+          {
+            writeAsMvt( mServerIface, project, versionString, request, response );
+          }
           else
           {
             writeGetMap( mServerIface, project, versionString, request, response );
@@ -38,6 +38,10 @@
 
 #include "qgsexception.h"
 #include "qgsexpressionnodeimpl.h"
+#include "qgscapabilitiescache.h"
+#include "qgsreadwritecontext.h"
+
+#include <QCryptographicHash>
 
 
 namespace QgsWms
@@ -48,6 +52,8 @@ namespace QgsWms
 
     void appendLayerProjectSettings( QDomDocument &doc, QDomElement &layerElem, QgsMapLayer *currentLayer );
 
+    QByteArray layerFingerprint( const QByteArray &context, QgsMapLayer *layer );
+
     void appendDrawingOrder( QDomDocument &doc, QDomElement &parentElem, QgsServerInterface *serverIface,
                              const QgsProject *project );
 
@@ -104,24 +110,22 @@ namespace QgsWms
       cache = accessControl->fillCacheKey( cacheKeyList );
 #endif
 
-    QDomDocument doc;
     QString cacheKey = cacheKeyList.join( QStringLiteral( "-" ) );
-    const QDomDocument *capabilitiesDocument = capabilitiesCache->searchCapabilitiesDocument( configFilePath, cacheKey );
-    if ( !capabilitiesDocument ) //capabilities xml not in cache. Create a new one
+    QByteArray capabilitiesBytes = capabilitiesCache->searchCapabilitiesBytes( configFilePath, cacheKey );
+    if ( capabilitiesBytes.isEmpty() ) //capabilities xml not in cache. Create a new one
     {
       QgsMessageLog::logMessage( QStringLiteral( "Capabilities document not found in cache" ) );
 
-      doc = getCapabilities( serverIface, project, version, request, projectSettings );
+      QDomDocument doc = getCapabilities( serverIface, project, version, request, projectSettings );
 
       if ( cache )
       {
         capabilitiesCache->insertCapabilitiesDocument( configFilePath, cacheKey, &doc );
-        capabilitiesDocument = capabilitiesCache->searchCapabilitiesDocument( configFilePath, cacheKey );
+        capabilitiesBytes = capabilitiesCache->searchCapabilitiesBytes( configFilePath, cacheKey );
       }
       else
       {
-        doc = doc.cloneNode().toDocument();
-        capabilitiesDocument = &doc;
+        capabilitiesBytes = doc.toByteArray();
       }
     }
     else
@@ -130,7 +134,7 @@ namespace QgsWms
     }
 
     response.setHeader( QStringLiteral( "Content-Type" ), QStringLiteral( "text/xml; charset=utf-8" ) );
-    response.write( capabilitiesDocument->toByteArray() );
+    response.write( capabilitiesBytes );
   }
 
   QDomDocument getCapabilities( QgsServerInterface *serverIface, const QgsProject *project,
@@ -475,6 +479,7 @@ namespace QgsWms
     appendFormat( elem, QStringLiteral( "image/png; mode=8bit" ) );
     appendFormat( elem, QStringLiteral( "image/png; mode=1bit" ) );
     appendFormat( elem, QStringLiteral( "application/dxf" ) );
+    appendFormat( elem, QStringLiteral( "application/vnd.mapbox-vector-tile" ) );
     elem.appendChild( dcpTypeElem.cloneNode().toElement() ); //this is the same as for 'GetCapabilities'
     requestElem.appendChild( elem );
 
@@ -824,6 +829,18 @@ namespace QgsWms
       bool siaFormat = QgsServerProjectUtils::wmsInfoFormatSia2045( *project );
       QStringList restrictedLayers = QgsServerProjectUtils::wmsRestrictedLayers( *project );
 
+      // layer elements are cached with everything they depend on outside of the layer
+      QgsCapabilitiesCache *capabilitiesCache = serverIface->capabilitiesCache();
+      const QString configFilePath = serverIface->configFilePath();
+      QStringList fingerprintContext;
+      fingerprintContext << version
+                         << QString::number( projectSettings )
+                         << QString::number( useLayerIds )
+                         << QString::number( siaFormat )
+                         << serviceUrl( request, project ).toString()
+                         << QgsServerProjectUtils::wmsOutputCrsList( *project );
+      const QByteArray context = fingerprintContext.join( '\n' ).toUtf8();
+
       QList< QgsLayerTreeNode * > layerTreeGroupChildren = layerTreeGroup->children();
       for ( int i = 0; i < layerTreeGroupChildren.size(); ++i )
       {
@@ -902,6 +919,16 @@ namespace QgsWms
             continue;
           }
 
+          QByteArray layerContext = context;
+          layerContext += project->nonIdentifiableLayers().contains( l->id() ) ? '0' : '1';
+          const QByteArray fingerprint = layerFingerprint( layerContext, l );
+          const QDomElement cachedElem = capabilitiesCache->searchLayerElement( configFilePath, fingerprint );
+          if ( !cachedElem.isNull() )
+          {
+            parentLayer.appendChild( doc.importNode( cachedElem, true ) );
+            continue;
+          }
+
           QString wmsName =  l->name();
           if ( useLayerIds )
           {
@@ -1105,6 +1132,8 @@ namespace QgsWms
           {
             appendLayerProjectSettings( doc, layerElem, l );
           }
+
+          capabilitiesCache->insertLayerElement( configFilePath, fingerprint, layerElem );
         }
 
         parentLayer.appendChild( layerElem );
@@ -1627,6 +1656,32 @@ namespace QgsWms
       }
     }
 
+    QByteArray layerFingerprint( const QByteArray &context, QgsMapLayer *layer )
+    {
+      QCryptographicHash hash( QCryptographicHash::Md5 );
+      hash.addData( context );
+
+      // the project definition of the layer, with its styles
+      QDomDocument layerDoc;
+      QDomElement layerXml = layerDoc.createElement( QStringLiteral( "maplayer" ) );
+      layer->writeLayerXml( layerXml, layerDoc, QgsReadWriteContext() );
+      layerDoc.appendChild( layerXml );
+      hash.addData( layerDoc.toByteArray() );
+
+      // and what the provider reports
+      hash.addData( layer->extent().toString( 17 ).toUtf8() );
+      if ( QgsVectorLayer *vLayer = qobject_cast<QgsVectorLayer *>( layer ) )
+      {
+        const QgsFields fields = vLayer->fields();
+        for ( int idx = 0; idx < fields.count(); ++idx )
+        {
+          const QgsField field = fields.at( idx );
+          hash.addData( QStringLiteral( "%1 %2 %3 %4" ).arg( field.name(), field.typeName() ).arg( field.length() ).arg( field.precision() ).toUtf8() );
+        }
+      }
+      return hash.result();
+    }
+
     void appendLayerProjectSettings( QDomDocument &doc, QDomElement &layerElem, QgsMapLayer *currentLayer )
     {
       if ( !currentLayer )
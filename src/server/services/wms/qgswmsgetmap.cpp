@@ -20,13 +20,208 @@
  ***************************************************************************/
 #include "qgswmsutils.h"
 #include "qgswmsgetmap.h"
+#include "qgswmsmapcache.h"
+#include "qgswmsparameters.h"
 #include "qgswmsrenderer.h"
+#include "qgscoordinatereferencesystem.h"
+#include "qgsserverprojectutils.h"
+#include "qgsserversettings.h"
 
+#include <QDateTime>
+#include <QFileInfo>
 #include <QImage>
+#include <QSet>
 
 namespace QgsWms
 {
 
+  ///@cond PRIVATE
+
+  //! Largest side in pixels of a rendered metatile
+  static const int MAX_METATILE_SIDE = 4096;
+
+  static QString formatCoordinate( double value )
+  {
+    return QString::number( value, 'g', 12 );
+  }
+
+  /* Returns the normalized request without its BBOX: the project and requested layers
+   * modification times and the sorted parameters. Returns an empty key if the
+   * request cannot be cached.
+   */
+  static QByteArray requestKey( QgsServerInterface *serverIface, const QgsProject *project,
+                                const QgsServerRequest::Parameters &params )
+  {
+    QStringList keys;
+    const QString projectPath = serverIface->configFilePath();
+    keys << projectPath << QString::number( QFileInfo( projectPath ).lastModified().toMSecsSinceEpoch() );
+
+    // file based layers may be updated without the project, other sources are only
+    // refreshed when the project changes
+    const QSet<QString> nicknames = QgsWmsParameters( params ).allLayersNickname().toSet();
+    const bool useLayerIds = QgsServerProjectUtils::wmsUseLayerIds( *project );
+    Q_FOREACH ( QgsMapLayer *layer, project->mapLayers() )
+    {
+      QString nickname = useLayerIds ? layer->id() : layer->shortName();
+      if ( nickname.isEmpty() )
+      {
+        nickname = layer->name();
+      }
+      if ( !nicknames.contains( nickname ) )
+      {
+        continue;
+      }
+      const QFileInfo source( layer->source().section( '|', 0, 0 ) );
+      if ( source.isFile() )
+      {
+        keys << QString::number( source.lastModified().toMSecsSinceEpoch() );
+      }
+    }
+
+    // parameters are sorted by name in the map
+    for ( auto it = params.constBegin(); it != params.constEnd(); ++it )
+    {
+      if ( it.key() != QLatin1String( "BBOX" ) )
+      {
+        keys << it.key() + '=' + it.value();
+      }
+    }
+
+#ifdef HAVE_SERVER_PYTHON_PLUGINS
+    QgsAccessControl *accessControl = serverIface->accessControls();
+    if ( accessControl && !accessControl->fillCacheKey( keys ) )
+    {
+      return QByteArray();
+    }
+#endif
+
+    return keys.join( '\n' ).toUtf8();
+  }
+
+  /* Returns true if the extent is a cell of the grid of extents of the same size
+   * anchored at the origin, the cell is returned in column and row.
+   */
+  static bool gridCell( const QgsRectangle &extent, qint64 &column, qint64 &row )
+  {
+    const double width = extent.width();
+    const double height = extent.height();
+    if ( width <= 0 || height <= 0 )
+    {
+      return false;
+    }
+    column = qRound64( extent.xMinimum() / width );
+    row = qRound64( extent.yMinimum() / height );
+    return qAbs( column * width - extent.xMinimum() ) <= 1e-6 * width
+           && qAbs( row * height - extent.yMinimum() ) <= 1e-6 * height;
+  }
+
+  static QByteArray cellKey( const QByteArray &requestKey, double width, double height, qint64 column, qint64 row )
+  {
+    return requestKey + QStringLiteral( "\ntile:%1:%2:%3:%4" ).arg( formatCoordinate( width ), formatCoordinate( height ) ).arg( column ).arg( row ).toUtf8();
+  }
+
+  static QgsWmsMapCache::Image renderImage( QgsServerInterface *serverIface, const QgsProject *project,
+      const QgsServerRequest::Parameters &params, std::unique_ptr<QImage> &image )
+  {
+    // GetMap only relies on the project, as it may run concurrently with other requests
+    QgsRenderer renderer( serverIface, project, params, nullptr );
+
+    image.reset( renderer.getMap() );
+    if ( !image )
+    {
+      throw QgsServiceException( QStringLiteral( "UnknownError" ),
+                                 QStringLiteral( "Failed to compute GetMap image" ) );
+    }
+
+    QgsWmsMapCache::Image encoded;
+    const QString format = params.value( QStringLiteral( "FORMAT" ), QStringLiteral( "PNG" ) );
+    encoded.data = encodeImage( *image, format, renderer.getImageQuality(), encoded.contentType,
+                                 serverIface->serverSettings() );
+    return encoded;
+  }
+
+  /* Renders the metatile containing the requested cell, caches all its tiles and
+   * returns the requested one. Returns false if the request cannot be rendered
+   * as a metatile.
+   */
+  static bool renderMetatile( QgsServerInterface *serverIface, const QgsProject *project,
+                              const QgsServerRequest::Parameters &params, const QByteArray &key,
+                              const QgsRectangle &extent, qint64 column, qint64 row,
+                              QgsWmsMapCache &cache, QgsWmsMapCache::Image &result )
+  {
+    const int size = cache.metatileSize();
+    const int width = params.value( QStringLiteral( "WIDTH" ) ).toInt();
+    const int height = params.value( QStringLiteral( "HEIGHT" ) ).toInt();
+    if ( size <= 1 || width <= 0 || height <= 0
+         || width * size > MAX_METATILE_SIDE || height * size > MAX_METATILE_SIDE )
+    {
+      return false;
+    }
+
+    const int maxWidth = QgsServerProjectUtils::wmsMaxWidth( *project );
+    const int maxHeight = QgsServerProjectUtils::wmsMaxHeight( *project );
+    if ( ( maxWidth > 0 && width * size > maxWidth ) || ( maxHeight > 0 && height * size > maxHeight ) )
+    {
+      return false;
+    }
+
+    // the rendered extent must be in map axis order
+    const QString crs = params.value( QStringLiteral( "CRS" ), params.value( QStringLiteral( "SRS" ) ) );
+    const QString version = params.value( QStringLiteral( "VERSION" ), QStringLiteral( "1.3.0" ) );
+    if ( crs.compare( QLatin1String( "CRS:84" ), Qt::CaseInsensitive ) == 0
+         || ( version != QLatin1String( "1.1.1" ) && QgsCoordinateReferenceSystem::fromOgcWmsCrs( crs ).hasAxisInverted() ) )
+    {
+      return false;
+    }
+
+    const double cellWidth = extent.width();
+    const double cellHeight = extent.height();
+    const qint64 firstColumn = column - ( ( column % size ) + size ) % size;
+    const qint64 firstRow = row - ( ( row % size ) + size ) % size;
+    const QgsRectangle metaExtent( firstColumn * cellWidth, firstRow * cellHeight,
+                                   ( firstColumn + size ) * cellWidth, ( firstRow + size ) * cellHeight );
+
+    QgsServerRequest::Parameters metaParams = params;
+    metaParams[ QStringLiteral( "BBOX" )] = QStringLiteral( "%1,%2,%3,%4" ).arg( formatCoordinate( metaExtent.xMinimum() ),
+                                            formatCoordinate( metaExtent.yMinimum() ),
+                                            formatCoordinate( metaExtent.xMaximum() ),
+                                            formatCoordinate( metaExtent.yMaximum() ) );
+    metaParams[ QStringLiteral( "WIDTH" )] = QString::number( width * size );
+    metaParams[ QStringLiteral( "HEIGHT" )] = QString::number( height * size );
+
+    QgsRenderer renderer( serverIface, project, metaParams, nullptr );
+    std::unique_ptr<QImage> metaImage( renderer.getMap() );
+    if ( !metaImage || metaImage->width() != width * size || metaImage->height() != height * size )
+    {
+      return false;
+    }
+
+    const QString projectPath = serverIface->configFilePath();
+    const QString format = params.value( QStringLiteral( "FORMAT" ), QStringLiteral( "PNG" ) );
+    for ( int j = 0; j < size; ++j )
+    {
+      for ( int i = 0; i < size; ++i )
+      {
+        // image rows go down while grid rows go up
+        const qint64 tileColumn = firstColumn + i;
+        const qint64 tileRow = firstRow + size - 1 - j;
+
+        QgsWmsMapCache::Image tile;
+        tile.data = encodeImage( metaImage->copy( i * width, j * height, width, height ), format,
+                                 renderer.getImageQuality(), tile.contentType, serverIface->serverSettings() );
+        cache.insert( projectPath, cellKey( key, cellWidth, cellHeight, tileColumn, tileRow ), tile );
+
+        if ( tileColumn == column && tileRow == row )
+        {
+          result = tile;
+        }
+      }
+    }
+    return true;
+  }
+
+  ///@endcond
+
   void writeGetMap( QgsServerInterface *serverIface, const QgsProject *project,
                     const QString &version, const QgsServerRequest &request,
                     QgsServerResponse &response )
@@ -34,19 +229,51 @@ namespace QgsWms
     Q_UNUSED( version );
 
     QgsServerRequest::Parameters params = request.parameters();
-    QgsRenderer renderer( serverIface, project, params, getConfigParser( serverIface ) );
+    QgsWmsMapCache *cache = QgsWmsMapCache::instance( *serverIface->serverSettings() );
+    if ( !cache->isEnabled() )
+    {
+      std::unique_ptr<QImage> image;
+      const QgsWmsMapCache::Image result = renderImage( serverIface, project, params, image );
+      response.setHeader( QStringLiteral( "Content-Type" ), result.contentType );
+      response.write( result.data );
+      return;
+    }
 
-    std::unique_ptr<QImage> result( renderer.getMap() );
-    if ( result )
+    const QString projectPath = serverIface->configFilePath();
+    const QByteArray baseKey = requestKey( serverIface, project, params );
+    const QgsRectangle extent = parseBbox( params.value( QStringLiteral( "BBOX" ) ) );
+    qint64 column = 0;
+    qint64 row = 0;
+    const bool aligned = !baseKey.isEmpty() && gridCell( extent, column, row );
+    QByteArray key;
+    if ( aligned )
     {
-      QString format = params.value( QStringLiteral( "FORMAT" ), QStringLiteral( "PNG" ) );
-      writeImage( response, *result, format, renderer.getImageQuality() );
+      key = cellKey( baseKey, extent.width(), extent.height(), column, row );
     }
-    else
+    else if ( !baseKey.isEmpty() )
     {
-      throw QgsServiceException( QStringLiteral( "UnknownError" ),
-                                 QStringLiteral( "Failed to compute GetMap image" ) );
+      key = baseKey + QStringLiteral( "\nbbox:%1,%2,%3,%4" ).arg( formatCoordinate( extent.xMinimum() ),
+             formatCoordinate( extent.yMinimum() ),
+             formatCoordinate( extent.xMaximum() ),
+             formatCoordinate( extent.yMaximum() ) ).toUtf8();
     }
+
+    QgsWmsMapCache::Image result;
+    if ( key.isEmpty() || !cache->find( projectPath, key, result ) )
+    {
+      if ( !aligned || !renderMetatile( serverIface, project, params, baseKey, extent, column, row, *cache, result ) )
+      {
+        std::unique_ptr<QImage> image;
+        result = renderImage( serverIface, project, params, image );
+        if ( !key.isEmpty() )
+        {
+          cache->insert( projectPath, key, result );
+        }
+      }
+    }
+
+    response.setHeader( QStringLiteral( "Content-Type" ), result.contentType );
+    response.write( result.data );
   }
 
 } // samespace QgsWms
@@ -0,0 +1,248 @@
+/***************************************************************************
+                              qgswmsmapcache.cpp
+                              -------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgswmsmapcache.h"
+#include "qgsconfigcache.h"
+#include "qgsmessagelog.h"
+#include "qgsserversettings.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <limits>
+
+namespace QgsWms
+{
+
+  QgsWmsMapCache *QgsWmsMapCache::instance( const QgsServerSettings &settings )
+  {
+    static QgsWmsMapCache *sInstance = new QgsWmsMapCache( settings );
+    return sInstance;
+  }
+
+  QgsWmsMapCache::QgsWmsMapCache( const QgsServerSettings &settings )
+    : mDirectory( settings.wmsCacheDirectory() )
+    , mDiskSize( settings.wmsCacheDiskSize() )
+    , mMetatileSize( settings.wmsMetatileSize() )
+  {
+    const qint64 memorySize = std::max( qint64( 0 ), settings.wmsCacheMemorySize() );
+    mMemoryCache.setMaxCost( static_cast<int>( std::min( memorySize, qint64( std::numeric_limits<int>::max() ) ) ) );
+
+    if ( !mDirectory.isEmpty() )
+    {
+      if ( QDir().mkpath( mDirectory ) )
+      {
+        mDiskUsage = diskUsage();
+        pruneDisk();
+      }
+      else
+      {
+        QgsMessageLog::logMessage( QStringLiteral( "Cannot create the WMS cache directory %1" ).arg( mDirectory ), QStringLiteral( "Server" ), QgsMessageLog::WARNING );
+        mDirectory.clear();
+      }
+    }
+
+    if ( isEnabled() )
+    {
+      // the signal may be emitted from any request thread, the cache is thread safe
+      QObject::connect( QgsConfigCache::instance(), &QgsConfigCache::projectChanged, [this]( const QString & path )
+      {
+        removeProject( path );
+      } );
+    }
+  }
+
+  bool QgsWmsMapCache::isEnabled() const
+  {
+    return mMemoryCache.maxCost() > 0 || !mDirectory.isEmpty();
+  }
+
+  bool QgsWmsMapCache::find( const QString &projectPath, const QByteArray &key, Image &image )
+  {
+    const QByteArray memoryKey = projectPath.toUtf8() + '\n' + key;
+    {
+      QMutexLocker locker( &mMutex );
+      if ( Entry *entry = mMemoryCache.object( memoryKey ) )
+      {
+        image = entry->image;
+        return true;
+      }
+    }
+
+    if ( mDirectory.isEmpty() || !readFile( filePath( projectPath, key ), image ) )
+    {
+      return false;
+    }
+
+    QMutexLocker locker( &mMutex );
+    mMemoryCache.insert( memoryKey, new Entry{ projectPath, image }, image.data.size() );
+    return true;
+  }
+
+  void QgsWmsMapCache::insert( const QString &projectPath, const QByteArray &key, const Image &image )
+  {
+    if ( mMemoryCache.maxCost() > 0 )
+    {
+      QMutexLocker locker( &mMutex );
+      mMemoryCache.insert( projectPath.toUtf8() + '\n' + key, new Entry{ projectPath, image }, image.data.size() );
+    }
+
+    if ( !mDirectory.isEmpty() )
+    {
+      writeFile( filePath( projectPath, key ), image );
+    }
+  }
+
+  void QgsWmsMapCache::removeProject( const QString &projectPath )
+  {
+    QMutexLocker locker( &mMutex );
+    Q_FOREACH ( const QByteArray &key, mMemoryCache.keys() )
+    {
+      Entry *entry = mMemoryCache.object( key );
+      if ( entry && entry->projectPath == projectPath )
+      {
+        mMemoryCache.remove( key );
+      }
+    }
+
+    if ( !mDirectory.isEmpty() )
+    {
+      QDir( QStringLiteral( "%1/%2" ).arg( mDirectory, projectDirectory( projectPath ) ) ).removeRecursively();
+      mDiskUsage = diskUsage();
+    }
+  }
+
+  QString QgsWmsMapCache::projectDirectory( const QString &projectPath ) const
+  {
+    return QString::fromLatin1( QCryptographicHash::hash( projectPath.toUtf8(), QCryptographicHash::Sha1 ).toHex() );
+  }
+
+  QString QgsWmsMapCache::filePath( const QString &projectPath, const QByteArray &key ) const
+  {
+    // spread files in sub directories to keep directories small
+    const QString keyHash = QString::fromLatin1( QCryptographicHash::hash( key, QCryptographicHash::Sha1 ).toHex() );
+    return QStringLiteral( "%1/%2/%3/%4" ).arg( mDirectory, projectDirectory( projectPath ), keyHash.left( 2 ), keyHash );
+  }
+
+  bool QgsWmsMapCache::readFile( const QString &path, Image &image ) const
+  {
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) )
+    {
+      return false;
+    }
+
+    // the content type on the first line, then the encoded image
+    const QByteArray contentType = file.readLine().trimmed();
+    if ( contentType.isEmpty() )
+    {
+      return false;
+    }
+    image.contentType = QString::fromLatin1( contentType );
+    image.data = file.readAll();
+    return !image.data.isEmpty();
+  }
+
+  void QgsWmsMapCache::writeFile( const QString &path, const Image &image )
+  {
+    QFileInfo info( path );
+    if ( !QDir().mkpath( info.absolutePath() ) )
+    {
+      return;
+    }
+
+    // QSaveFile replaces the file at once, so that concurrent readers never see partial images
+    QSaveFile file( path );
+    if ( !file.open( QIODevice::WriteOnly ) )
+    {
+      return;
+    }
+    file.write( image.contentType.toLatin1() + '\n' );
+    file.write( image.data );
+    if ( !file.commit() )
+    {
+      QgsMessageLog::logMessage( QStringLiteral( "Cannot write the WMS cache file %1" ).arg( path ), QStringLiteral( "Server" ), QgsMessageLog::WARNING );
+      return;
+    }
+
+    QMutexLocker locker( &mMutex );
+    mDiskUsage += image.contentType.size() + 1 + image.data.size();
+    if ( mDiskUsage > mDiskSize )
+    {
+      pruneDisk();
+    }
+  }
+
+  void QgsWmsMapCache::pruneDisk()
+  {
+    if ( mDiskUsage <= mDiskSize )
+    {
+      return;
+    }
+
+    QList< QFileInfo > files;
+    QDirIterator it( mDirectory, QDir::Files, QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+      it.next();
+      files << it.fileInfo();
+    }
+    std::sort( files.begin(), files.end(), []( const QFileInfo & a, const QFileInfo & b )
+    {
+      return a.lastModified() < b.lastModified();
+    } );
+
+    // remove a bit more than needed, so that the directory is not scanned for each new image
+    const qint64 targetUsage = mDiskSize - mDiskSize / 10;
+    mDiskUsage = 0;
+    Q_FOREACH ( const QFileInfo &file, files )
+    {
+      mDiskUsage += file.size();
+    }
+    Q_FOREACH ( const QFileInfo &file, files )
+    {
+      if ( mDiskUsage <= targetUsage )
+      {
+        break;
+      }
+      if ( QFile::remove( file.absoluteFilePath() ) )
+      {
+        mDiskUsage -= file.size();
+      }
+    }
+  }
+
+  qint64 QgsWmsMapCache::diskUsage() const
+  {
+    qint64 usage = 0;
+    QDirIterator it( mDirectory, QDir::Files, QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+      it.next();
+      usage += it.fileInfo().size();
+    }
+    return usage;
+  }
+
+} // namespace QgsWms
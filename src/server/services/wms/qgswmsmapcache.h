@@ -0,0 +1,106 @@
+/***************************************************************************
+                              qgswmsmapcache.h
+                              -------------------
+  begin                : October 2026
+  copyright            : (C) 2026 by QGIS project
+  email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSWMSMAPCACHE_H
+#define QGSWMSMAPCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+
+class QgsServerSettings;
+
+namespace QgsWms
+{
+
+  /** Cache of encoded GetMap images, with a memory tier bounded by
+   *  QGIS_SERVER_WMS_CACHE_MEMORY_SIZE and a disk tier in
+   *  QGIS_SERVER_WMS_CACHE_DIRECTORY bounded by QGIS_SERVER_WMS_CACHE_DISK_SIZE.
+   *
+   *  Images are stored per project and all images of a project are removed when
+   *  QgsConfigCache reports that the project changed. The cache is thread safe.
+   * \since QGIS 3.0
+   */
+  class QgsWmsMapCache
+  {
+    public:
+
+      //! Encoded image
+      struct Image
+      {
+        QString contentType;
+        QByteArray data;
+      };
+
+      /** Returns the cache configured from the settings of the first call.
+       */
+      static QgsWmsMapCache *instance( const QgsServerSettings &settings );
+
+      //! Returns true if images are cached in memory or on disk
+      bool isEnabled() const;
+
+      //! Returns the number of tiles per side of the rendered metatiles
+      int metatileSize() const { return mMetatileSize; }
+
+      /** Searches an image
+       *  \param projectPath the project of the image
+       *  \param key the normalized request of the image
+       *  \param image receives the image if found
+       *  \returns true if the image was found
+       */
+      bool find( const QString &projectPath, const QByteArray &key, Image &image );
+
+      /** Inserts an image
+       *  \param projectPath the project of the image
+       *  \param key the normalized request of the image
+       *  \param image the encoded image
+       */
+      void insert( const QString &projectPath, const QByteArray &key, const Image &image );
+
+      //! Removes all the images of a project
+      void removeProject( const QString &projectPath );
+
+    private:
+      struct Entry
+      {
+        QString projectPath;
+        Image image;
+      };
+
+      explicit QgsWmsMapCache( const QgsServerSettings &settings );
+
+      QString projectDirectory( const QString &projectPath ) const;
+      QString filePath( const QString &projectPath, const QByteArray &key ) const;
+      bool readFile( const QString &path, Image &image ) const;
+      void writeFile( const QString &path, const Image &image );
+
+      //! Removes the oldest files until the disk tier is below its size
+      void pruneDisk();
+      qint64 diskUsage() const;
+
+      QMutex mMutex;
+      QCache<QByteArray, Entry> mMemoryCache;
+      QString mDirectory;
+      qint64 mDiskSize = 0;
+      qint64 mDiskUsage = 0;
+      int mMetatileSize = 1;
+  };
+
+} // namespace QgsWms
+
+#endif
@@ -60,6 +60,9 @@
 #include "qgsserverprojectutils.h"
 #include "qgsgui.h"
 #include "qgsmaplayerstylemanager.h"
+#include "qgsmslayercache.h"
+#include "qgsmvtencoder.h"
+#include "qgsserverprofiler.h"
 #include "qgswkbtypes.h"
 #include "qgsannotationmanager.h"
 #include "qgsannotation.h"
@@ -132,6 +135,7 @@ namespace QgsWms
       delete mConfigParser;
       mConfigParser = nullptr;
     }
+    qDeleteAll( mLayerCopies );
   }
 
 
@@ -437,9 +441,14 @@ namespace QgsWms
     QList<QgsMapLayer *> layers;
     QList<QgsWmsParametersLayer> params = mWmsParameters.layersParameters();
 
-    // init layer restorer before doing anything
+    // init layer restorer before doing anything. Concurrent requests share the
+    // project layers, so they work on copies of the requested layers instead
     std::unique_ptr<QgsLayerRestorer> restorer;
-    restorer.reset( new QgsLayerRestorer( mNicknameLayers.values() ) );
+    mCopyLayers = mSettings.requestThreads() > 1;
+    if ( !mCopyLayers )
+    {
+      restorer.reset( new QgsLayerRestorer( mNicknameLayers.values() ) );
+    }
 
     // init stylized layers according to LAYERS/STYLES or SLD
     QString sld = mWmsParameters.sld();
@@ -629,6 +638,92 @@ namespace QgsWms
     return dxf;
   }
 
+  QByteArray QgsRenderer::getMvt()
+  {
+    QgsMapSettings mapSettings;
+    configureMapExtent( mapSettings );
+    const QgsRectangle tileExtent = mapSettings.extent();
+    if ( tileExtent.isEmpty() )
+    {
+      throw QgsBadRequestException( QStringLiteral( "InvalidParameterValue" ), QStringLiteral( "Invalid BBOX parameter" ) );
+    }
+
+    // scale of the tile displayed with WIDTH pixels, for the scale based visibility of layers
+    double scaleDenominator = -1;
+    if ( mWmsParameters.widthAsInt() > 0 )
+    {
+      QgsScaleCalculator scaleCalc( 25.4 / 0.28, mapSettings.destinationCrs().mapUnits() );
+      scaleDenominator = scaleCalc.calculate( tileExtent, mWmsParameters.widthAsInt() );
+    }
+
+    // get layers parameters
+    QList<QgsWmsParametersLayer> params = mWmsParameters.layersParameters();
+
+    // init layer restorer before doing anything. As for GetMap, concurrent
+    // requests work on copies of the requested layers
+    std::unique_ptr<QgsLayerRestorer> restorer;
+    mCopyLayers = mSettings.requestThreads() > 1;
+    if ( !mCopyLayers )
+    {
+      restorer.reset( new QgsLayerRestorer( mNicknameLayers.values() ) );
+    }
+
+    // styles are not encoded, only the layers are taken from LAYERS
+    QList<QgsMapLayer *> layers = stylizedLayers( params );
+    removeUnwantedLayers( layers, scaleDenominator );
+
+    QgsMvtEncoder encoder( tileExtent );
+    Q_FOREACH ( QgsMapLayer *layer, layers )
+    {
+      QgsVectorLayer *vlayer = qobject_cast<QgsVectorLayer *>( layer );
+      if ( !vlayer )
+      {
+        continue;
+      }
+
+      Q_FOREACH ( QgsWmsParametersLayer param, params )
+      {
+        if ( param.mNickname == layerNickname( *layer ) )
+        {
+          checkLayerReadPermissions( layer );
+
+          setLayerFilter( layer, param.mFilter );
+
+          setLayerAccessControlFilter( layer );
+
+          break;
+        }
+      }
+
+      QgsServerProfiler::Scope profilerScope( QStringLiteral( "fetch" ), layer->name() );
+
+      // the attributes published by GetFeatureInfo
+      const QgsFields fields = vlayer->fields();
+      const QSet<QString> &excludedAttributes = vlayer->excludeAttributesWms();
+      QStringList attributes;
+      for ( int idx = 0; idx < fields.count(); ++idx )
+      {
+        if ( !excludedAttributes.contains( fields.at( idx ).name() ) )
+        {
+          attributes << fields.at( idx ).name();
+        }
+      }
+
+      QgsFeatureRequest request;
+      request.setFilterRect( mapSettings.mapToLayerCoordinates( layer, encoder.clipExtent() ) );
+#ifdef HAVE_SERVER_PYTHON_PLUGINS
+      mAccessControl->filterFeatures( vlayer, request );
+      attributes = mAccessControl->layerAttributes( vlayer, attributes );
+#endif
+      request.setSubsetOfAttributes( attributes, fields );
+
+      QgsFeatureIterator fit = vlayer->getFeatures( request );
+      encoder.addLayer( layerNickname( *layer ), fields, request.subsetOfAttributes(), fit, mapSettings.layerTransform( layer ) );
+    }
+
+    return encoder.tile();
+  }
+
   static void infoPointToMapCoordinates( int i, int j, QgsPointXY *infoPoint, const QgsMapSettings &mapSettings )
   {
     //check if i, j are in the pixel range of the image
@@ -1136,6 +1231,42 @@ namespace QgsWms
     mapSettings.setOutputSize( QSize( paintDevice->width(), paintDevice->height() ) );
     mapSettings.setOutputDpi( paintDevice->logicalDpiX() );
 
+    configureMapExtent( mapSettings );
+
+    /* Define the background color
+     * Transparent or colored
+     */
+    //is format jpeg?
+    QString format = mParameters.value( QStringLiteral( "FORMAT" ) );
+    bool jpeg = format.compare( QLatin1String( "jpg" ), Qt::CaseInsensitive ) == 0
+                || format.compare( QLatin1String( "jpeg" ), Qt::CaseInsensitive ) == 0
+                || format.compare( QLatin1String( "image/jpeg" ), Qt::CaseInsensitive ) == 0;
+
+    //transparent parameter
+    bool transparent = mParameters.value( QStringLiteral( "TRANSPARENT" ) ).compare( QLatin1String( "true" ), Qt::CaseInsensitive ) == 0;
+
+    //background  color
+    QString bgColorString = mParameters.value( "BGCOLOR" );
+    if ( bgColorString.startsWith( "0x", Qt::CaseInsensitive ) )
+    {
+      bgColorString.replace( 0, 2, "#" );
+    }
+    QColor backgroundColor;
+    backgroundColor.setNamedColor( bgColorString );
+
+    //set background color
+    if ( transparent && !jpeg )
+    {
+      mapSettings.setBackgroundColor( QColor( 0, 0, 0, 0 ) );
+    }
+    else if ( backgroundColor.isValid() )
+    {
+      mapSettings.setBackgroundColor( backgroundColor );
+    }
+  }
+
+  void QgsRenderer::configureMapExtent( QgsMapSettings &mapSettings ) const
+  {
     //map extent
     QgsRectangle mapExtent = mWmsParameters.bboxAsRectangle();
     if ( !mWmsParameters.bbox().isEmpty() && mapExtent.isEmpty() )
@@ -1173,37 +1304,6 @@ namespace QgsWms
     }
 
     mapSettings.setExtent( mapExtent );
-
-    /* Define the background color
-     * Transparent or colored
-     */
-    //is format jpeg?
-    QString format = mParameters.value( QStringLiteral( "FORMAT" ) );
-    bool jpeg = format.compare( QLatin1String( "jpg" ), Qt::CaseInsensitive ) == 0
-                || format.compare( QLatin1String( "jpeg" ), Qt::CaseInsensitive ) == 0
-                || format.compare( QLatin1String( "image/jpeg" ), Qt::CaseInsensitive ) == 0;
-
-    //transparent parameter
-    bool transparent = mParameters.value( QStringLiteral( "TRANSPARENT" ) ).compare( QLatin1String( "true" ), Qt::CaseInsensitive ) == 0;
-
-    //background  color
-    QString bgColorString = mParameters.value( "BGCOLOR" );
-    if ( bgColorString.startsWith( "0x", Qt::CaseInsensitive ) )
-    {
-      bgColorString.replace( 0, 2, "#" );
-    }
-    QColor backgroundColor;
-    backgroundColor.setNamedColor( bgColorString );
-
-    //set background color
-    if ( transparent && !jpeg )
-    {
-      mapSettings.setBackgroundColor( QColor( 0, 0, 0, 0 ) );
-    }
-    else if ( backgroundColor.isValid() )
-    {
-      mapSettings.setBackgroundColor( backgroundColor );
-    }
   }
 
   void QgsRenderer::initializeSLDParser( QStringList &layersList, QStringList &stylesList )
@@ -1261,6 +1361,8 @@ namespace QgsWms
       return false;
     }
 
+    QgsServerProfiler::Scope profilerScope( QStringLiteral( "fetch" ), layer->name() );
+
     //we need a selection rect (0.01 of map width)
     QgsRectangle mapRect = mapSettings.extent();
     QgsRectangle layerRect = mapSettings.mapToLayerCoordinates( layer, mapRect );
@@ -1324,7 +1426,32 @@ namespace QgsWms
     fReq.setSubsetOfAttributes( attributes, layer->pendingFields() );
 #endif
 
-    QgsFeatureIterator fit = layer->getFeatures( fReq );
+    // layers filtered by the request are not indexed, as each filter would need its own index
+    QSharedPointer<QgsIdentifyIndex> index;
+    if ( !mParameters.contains( QStringLiteral( "FILTER" ) ) )
+    {
+      index = QgsMSLayerCache::instance()->identifyIndex( layer );
+    }
+
+    // renderers of SLD parameters are not the ones of the layer styles
+    QString visibilityKey;
+    if ( index && !mParameters.contains( QStringLiteral( "SLD" ) ) && !mParameters.contains( QStringLiteral( "SLD_BODY" ) ) )
+    {
+      visibilityKey = QStringLiteral( "%1\n%2" ).arg( layer->styleManager()->currentStyle(), qgsDoubleToString( renderContext.rendererScale() ) );
+    }
+
+    QgsFeatureIterator fit;
+    QList<QgsFeature> indexedFeatures;
+    if ( index )
+    {
+      indexedFeatures = index->features( fReq, layer, nFeatures );
+    }
+    else
+    {
+      fit = layer->getFeatures( fReq );
+    }
+    QList<QgsFeature>::const_iterator indexedIt = indexedFeatures.constBegin();
+
     QgsFeatureRenderer *r2 = layer->renderer();
     if ( r2 )
     {
@@ -1332,8 +1459,13 @@ namespace QgsWms
     }
 
     bool featureBBoxInitialized = false;
-    while ( fit.nextFeature( feature ) )
+    while ( index ? indexedIt != indexedFeatures.constEnd() : fit.nextFeature( feature ) )
     {
+      if ( index )
+      {
+        feature = *indexedIt++;
+      }
+
       if ( layer->wkbType() == QgsWkbTypes::NoGeometry && ! searchRect.isEmpty() )
       {
         break;
@@ -1355,7 +1487,8 @@ namespace QgsWms
         renderContext.expressionContext().setFeature( feature );
 
         //check if feature is rendered at all
-        bool render = r2->willRenderFeature( feature, renderContext );
+        bool render = visibilityKey.isEmpty() ? r2->willRenderFeature( feature, renderContext )
+                      : index->willRenderFeature( visibilityKey, r2, feature, renderContext );
         if ( !render )
         {
           continue;
@@ -2374,7 +2507,7 @@ namespace QgsWms
   {
 
     // First taken from QGIS project
-    int imageQuality = mConfigParser->imageQuality();
+    int imageQuality = QgsServerProjectUtils::wmsImageQuality( *mProject );
 
     // Then checks if a parameter is given, if so use it instead
     if ( mParameters.contains( QStringLiteral( "IMAGE_QUALITY" ) ) )
@@ -2513,6 +2646,12 @@ namespace QgsWms
 
   QString QgsRenderer::layerNickname( const QgsMapLayer &layer ) const
   {
+    QHash<const QgsMapLayer *, QString>::const_iterator copyIt = mLayerCopyNicknames.constFind( &layer );
+    if ( copyIt != mLayerCopyNicknames.constEnd() )
+    {
+      return copyIt.value();
+    }
+
     QString name = layer.shortName();
     if ( QgsServerProjectUtils::wmsUseLayerIds( *mProject ) )
     {
@@ -2693,7 +2832,7 @@ namespace QgsWms
     return highlightLayers;
   }
 
-  QList<QgsMapLayer *> QgsRenderer::sldStylizedLayers( const QString &sld ) const
+  QList<QgsMapLayer *> QgsRenderer::sldStylizedLayers( const QString &sld )
   {
     QList<QgsMapLayer *> layers;
 
@@ -2718,9 +2857,10 @@ namespace QgsWms
             QString err;
             if ( mNicknameLayers.contains( lname ) && !mRestrictedLayers.contains( lname ) )
             {
-              mNicknameLayers[lname]->readSld( namedElem, err );
-              mNicknameLayers[lname]->setCustomProperty( "readSLD", true );
-              layers.append( mNicknameLayers[lname] );
+              QgsMapLayer *layer = nicknameLayer( lname );
+              layer->readSld( namedElem, err );
+              layer->setCustomProperty( "readSLD", true );
+              layers.append( layer );
             }
             else
             {
@@ -2735,7 +2875,7 @@ namespace QgsWms
     return layers;
   }
 
-  QList<QgsMapLayer *> QgsRenderer::stylizedLayers( const QList<QgsWmsParametersLayer> &params ) const
+  QList<QgsMapLayer *> QgsRenderer::stylizedLayers( const QList<QgsWmsParametersLayer> &params )
   {
     QList<QgsMapLayer *> layers;
 
@@ -2745,16 +2885,17 @@ namespace QgsWms
       QString style = param.mStyle;
       if ( mNicknameLayers.contains( nickname ) && !mRestrictedLayers.contains( nickname ) )
       {
+        QgsMapLayer *layer = nicknameLayer( nickname );
         if ( !style.isEmpty() )
         {
-          bool rc = mNicknameLayers[nickname]->styleManager()->setCurrentStyle( style );
+          bool rc = layer->styleManager()->setCurrentStyle( style );
           if ( ! rc )
           {
             throw QgsMapServiceException( QStringLiteral( "StyleNotDefined" ), QStringLiteral( "Style \"%1\" does not exist for layer \"%2\"" ).arg( style, nickname ) );
           }
         }
 
-        layers.append( mNicknameLayers[nickname] );
+        layers.append( layer );
       }
       else
       {
@@ -2766,6 +2907,26 @@ namespace QgsWms
     return layers;
   }
 
+  QgsMapLayer *QgsRenderer::nicknameLayer( const QString &nickname )
+  {
+    QgsMapLayer *layer = mNicknameLayers.value( nickname );
+    if ( !layer || !mCopyLayers || mLayerCopyNicknames.contains( layer ) )
+    {
+      return layer;
+    }
+
+    // the copy also has its own data provider, which is not shared with other requests
+    QgsMapLayer *copy = layer->clone();
+    if ( !copy )
+    {
+      throw QgsException( QStringLiteral( "Unable to copy the layer \"%1\"" ).arg( nickname ) );
+    }
+    mLayerCopies.append( copy );
+    mLayerCopyNicknames.insert( copy, nickname );
+    mNicknameLayers[ nickname ] = copy;
+    return copy;
+  }
+
   QPainter *QgsRenderer::layersRendering( const QgsMapSettings &mapSettings, QImage &image, HitTest *hitTest ) const
   {
     QPainter *painter;
@@ -2779,7 +2940,7 @@ namespace QgsWms
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
       mAccessControl->resolveFilterFeatures( mapSettings.layers() );
 #endif
-      QgsMapRendererJobProxy renderJob( mSettings.parallelRendering(), mSettings.maxThreads(), mAccessControl );
+      QgsMapRendererJobProxy renderJob( mSettings.parallelRendering(), mSettings.maxThreads(), mAccessControl, mSettings.maxThreadsPerRequest() );
       renderJob.render( mapSettings, &image );
       painter = renderJob.takePainter();
     }
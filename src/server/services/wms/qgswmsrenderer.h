@@ -24,6 +24,7 @@
 #include "qgsserversettings.h"
 #include "qgswmsparameters.h"
 #include <QDomDocument>
+#include <QHash>
 #include <QMap>
 #include <QPair>
 #include <QString>
@@ -108,6 +109,12 @@ namespace QgsWms
        \since QGIS 3.0*/
       QgsDxfExport getDxf( const QMap<QString, QString> &options );
 
+      /** Returns the map as a Mapbox Vector Tile. The vector layers of the LAYERS
+       parameter are encoded with their WMS filters, geometries are clipped to BBOX.
+       \returns the encoded tile
+       \since QGIS 3.0*/
+      QByteArray getMvt();
+
       /** Returns printed page as binary
         \param formatString out: format of the print output (e.g. pdf, svg, png, ...)
         \returns printed page as binary or 0 in case of error*/
@@ -147,10 +154,14 @@ namespace QgsWms
       void annotationsRendering( QPainter *painter ) const;
 
       // Return a list of layers stylized with LAYERS/STYLES parameters
-      QList<QgsMapLayer *> stylizedLayers( const QList<QgsWmsParametersLayer> &params ) const;
+      QList<QgsMapLayer *> stylizedLayers( const QList<QgsWmsParametersLayer> &params );
 
       // Return a list of layers stylized with SLD parameter
-      QList<QgsMapLayer *> sldStylizedLayers( const QString &sld ) const;
+      QList<QgsMapLayer *> sldStylizedLayers( const QString &sld );
+
+      // Return the layer with the nickname, or a copy of it owned by the renderer
+      // if layers are copied
+      QgsMapLayer *nicknameLayer( const QString &nickname );
 
       // Set layer opacity
       void setLayerOpacity( QgsMapLayer *layer, int opacity ) const;
@@ -204,6 +215,12 @@ namespace QgsWms
        */
       void configureMapSettings( const QPaintDevice *paintDevice, QgsMapSettings &mapSettings ) const;
 
+      /** Configures the extent and the destination CRS of mapSettings to the
+       * parameters BBOX and CRS.
+       * may throw an exception
+       */
+      void configureMapExtent( QgsMapSettings &mapSettings ) const;
+
       /**
        * If the parameter SLD exists, mSLDParser is configured appropriately. The lists are
        * set to the layer and style names according to the SLD
@@ -328,6 +345,12 @@ namespace QgsWms
       QStringList mRestrictedLayers;
       QMap<QString, QgsMapLayer *> mNicknameLayers;
 
+      //! Concurrent requests style and filter copies of the project layers
+      bool mCopyLayers = false;
+      QList<QgsMapLayer *> mLayerCopies;
+      //! Copies have their own layer id, so their nickname is kept
+      QHash<const QgsMapLayer *, QString> mLayerCopyNicknames;
+
     public:
 
       //! Return the image quality to use for getMap request
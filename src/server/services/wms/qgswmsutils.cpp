@@ -21,9 +21,13 @@
 
 #include "qgsmodule.h"
 #include "qgswmsutils.h"
-#include "qgsmediancut.h"
+#include "qgscolorcubequantizer.h"
 #include "qgsconfigcache.h"
+#include "qgsserverprofiler.h"
 #include "qgsserverprojectutils.h"
+#include "qgsserversettings.h"
+
+#include <QBuffer>
 
 namespace QgsWms
 {
@@ -117,13 +121,13 @@ namespace QgsWms
 
 
   // Write image response
-  void writeImage( QgsServerResponse &response, QImage &img, const QString &formatStr,
-                   int imageQuality )
+  QByteArray encodeImage( const QImage &img, const QString &formatStr, int imageQuality,
+                          QString &contentType, const QgsServerSettings *settings )
   {
+    QgsServerProfiler::Scope scope( QStringLiteral( "encode" ) );
     ImageOutputFormat outputFormat = parseImageFormat( formatStr );
     QImage  result;
     QString saveFormat;
-    QString contentType;
     switch ( outputFormat )
     {
       case PNG:
@@ -132,16 +136,11 @@ namespace QgsWms
         saveFormat = "PNG";
         break;
       case PNG8:
-      {
-        QVector<QRgb> colorTable;
-        medianCut( colorTable, 256, img );
-        result = img.convertToFormat( QImage::Format_Indexed8, colorTable,
-                                      Qt::ColorOnly | Qt::ThresholdDither |
-                                      Qt::ThresholdAlphaDither | Qt::NoOpaqueDetection );
-      }
-      contentType = "image/png";
-      saveFormat = "PNG";
-      break;
+        result = colorCubeQuantize( img, 256, settings && settings->wmsPng8Dither(),
+                                    settings ? settings->wmsPng8Threads() : 1 );
+        contentType = "image/png";
+        saveFormat = "PNG";
+        break;
       case PNG16:
         result = img.convertToFormat( QImage::Format_ARGB4444_Premultiplied );
         contentType = "image/png";
@@ -165,16 +164,26 @@ namespace QgsWms
         break;
     }
 
-    if ( outputFormat != UNKN )
-    {
-      response.setHeader( "Content-Type", contentType );
-      result.save( response.io(), qPrintable( saveFormat ), imageQuality );
-    }
-    else
+    if ( outputFormat == UNKN )
     {
       throw QgsServiceException( "InvalidFormat",
                                  QString( "Output format '%1' is not supported in the GetMap request" ).arg( formatStr ) );
     }
+
+    QByteArray data;
+    QBuffer buffer( &data );
+    buffer.open( QIODevice::WriteOnly );
+    result.save( &buffer, qPrintable( saveFormat ), imageQuality );
+    return data;
+  }
+
+  void writeImage( QgsServerResponse &response, QImage &img, const QString &formatStr,
+                   int imageQuality, const QgsServerSettings *settings )
+  {
+    QString contentType;
+    QByteArray data = encodeImage( img, formatStr, imageQuality, contentType, settings );
+    response.setHeader( "Content-Type", contentType );
+    response.write( data );
   }
 
   QgsRectangle parseBbox( const QString &bboxStr )
@@ -28,6 +28,7 @@
 #include "qgswmsserviceexception.h"
 
 class QgsRectangle;
+class QgsServerSettings;
 
 /**
  * \ingroup server
@@ -73,10 +74,22 @@ namespace QgsWms
    */
   ImageOutputFormat parseImageFormat( const QString &format );
 
+  /** Encode an image in the format of the FORMAT parameter
+   *  \param img the image to encode
+   *  \param formatStr the FORMAT parameter
+   *  \param imageQuality the quality of lossy formats, -1 for the default
+   *  \param contentType receives the content type of the encoded image
+   *  \param settings the server settings of the PNG8 quantization, defaults are used if null
+   *  \returns the encoded image
+   *  \throws QgsServiceException if the format is not supported
+   */
+  QByteArray encodeImage( const QImage &img, const QString &formatStr, int imageQuality,
+                          QString &contentType, const QgsServerSettings *settings = nullptr );
+
   /** Write image response
    */
   void writeImage( QgsServerResponse &response, QImage &img, const QString &formatStr,
-                   int imageQuality = -1 );
+                   int imageQuality = -1, const QgsServerSettings *settings = nullptr );
 
   /**
    * Parse bbox parameter
@@ -0,0 +1,179 @@
+/***************************************************************************
+  expressionbench.cpp - Benchmark of expression evaluation
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <iostream>
+
+#include "qgsapplication.h"
+#include "qgsexpression.h"
+#include "qgsexpressioncontext.h"
+#include "qgsfeature.h"
+#include "qgsfields.h"
+
+void usage( const QString &appName )
+{
+  std::cerr << "QGIS expression benchmark\n"
+            << "Usage: " << appName.toLocal8Bit().constData() << " [options] [EXPRESSION...]\n"
+            << "  options:\n"
+            << "\t[--features features]\tnumber of evaluated features, default 100000\n"
+            << "\t[--iterations iterations]\tnumber of passes over the features, default 5\n"
+            << "\t[--help]\t\tthis text\n\n"
+            << "Prints evaluations per second of the node tree, of the compiled program and of\n"
+            << "the compiled program evaluated over blocks of features for each expression. Features have an integer field 'id', a double field 'value',\n"
+            << "a string field 'name' and a double field 'ratio' which is NULL for every tenth\n"
+            << "feature. A default set of symbology and filter expressions is used if no\n"
+            << "expression is given.\n";
+}
+
+//! Returns the number of evaluations per second
+double measure( QgsExpression &expression, QgsExpressionContext &context, const QList< QgsFeature > &features, int iterations, QVariant &checksum )
+{
+  QElapsedTimer timer;
+  timer.start();
+  double sum = 0;
+  for ( int i = 0; i < iterations; ++i )
+  {
+    Q_FOREACH ( const QgsFeature &feature, features )
+    {
+      context.setFeature( feature );
+      const QVariant value = expression.evaluate( &context );
+      sum += value.toDouble();
+    }
+  }
+  checksum = sum;
+  const double seconds = std::max( timer.nsecsElapsed() / 1e9, 1e-9 );
+  return static_cast< double >( features.size() ) * iterations / seconds;
+}
+
+//! Returns the number of evaluations per second of QgsExpression::evaluateFeatures()
+double measureBlocks( QgsExpression &expression, QgsExpressionContext &context, const QList< QgsFeature > &features, int iterations, QVariant &checksum )
+{
+  QElapsedTimer timer;
+  timer.start();
+  double sum = 0;
+  for ( int i = 0; i < iterations; ++i )
+  {
+    const QVariantList values = expression.evaluateFeatures( features, &context );
+    Q_FOREACH ( const QVariant &value, values )
+      sum += value.toDouble();
+  }
+  checksum = sum;
+  const double seconds = std::max( timer.nsecsElapsed() / 1e9, 1e-9 );
+  return static_cast< double >( features.size() ) * iterations / seconds;
+}
+
+int main( int argc, char *argv[] )
+{
+  QgsApplication app( argc, argv, false );
+
+  int featureCount = 100000;
+  int iterations = 5;
+  QStringList expressions;
+
+  const QStringList args = QCoreApplication::arguments();
+  for ( int i = 1; i < args.size(); ++i )
+  {
+    const QString arg = args.at( i );
+    const bool hasValue = i + 1 < args.size();
+    if ( arg == QLatin1String( "--features" ) && hasValue )
+      featureCount = args.at( ++i ).toInt();
+    else if ( arg == QLatin1String( "--iterations" ) && hasValue )
+      iterations = args.at( ++i ).toInt();
+    else if ( arg.startsWith( QLatin1String( "--" ) ) )
+    {
+      usage( args.at( 0 ) );
+      return arg == QLatin1String( "--help" ) ? 0 : 1;
+    }
+    else
+      expressions << arg;
+  }
+
+  if ( featureCount <= 0 || iterations <= 0 )
+  {
+    usage( args.at( 0 ) );
+    return 1;
+  }
+
+  if ( expressions.isEmpty() )
+  {
+    expressions << QStringLiteral( "value * 2 + 1" )
+                << QStringLiteral( "value > 500 and id % 3 = 0" )
+                << QStringLiteral( "(value - 100) / (ratio + 1) >= 2 or ratio is null" )
+                << QStringLiteral( "id in (1, 5, 42, 99, 1000)" )
+                << QStringLiteral( "case when value < 250 then 1 when value < 500 then 2 when value < 750 then 3 else 4 end" )
+                << QStringLiteral( "sqrt(value) * 3 + abs(ratio - 0.5)" )
+                << QStringLiteral( "name = 'feature 42'" )
+                << QStringLiteral( "scale_linear(value, 0, 1000, 1, 10)" );
+  }
+
+  QgsApplication::initQgis();
+
+  QgsFields fields;
+  fields.append( QgsField( QStringLiteral( "id" ), QVariant::Int ) );
+  fields.append( QgsField( QStringLiteral( "value" ), QVariant::Double ) );
+  fields.append( QgsField( QStringLiteral( "name" ), QVariant::String ) );
+  fields.append( QgsField( QStringLiteral( "ratio" ), QVariant::Double ) );
+
+  QList< QgsFeature > features;
+  for ( int i = 0; i < featureCount; ++i )
+  {
+    QgsFeature feature( fields, i );
+    feature.setAttributes( QgsAttributes() << i
+                           << static_cast< double >( ( i * 7919 ) % 1000 )
+                           << QStringLiteral( "feature %1" ).arg( i )
+                           << ( i % 10 == 0 ? QVariant( QVariant::Double ) : QVariant( ( i % 100 ) / 100.0 ) ) );
+    features << feature;
+  }
+
+  QgsExpressionContext context = QgsExpressionContextUtils::createFeatureBasedContext( QgsFeature( fields ), fields );
+
+  Q_FOREACH ( const QString &string, expressions )
+  {
+    QgsExpression tree( string );
+    if ( tree.hasParserError() )
+    {
+      std::cerr << "Invalid expression " << string.toLocal8Bit().constData() << ": " << tree.parserErrorString().toLocal8Bit().constData() << std::endl;
+      return 1;
+    }
+    tree.prepare( &context );
+
+    QgsExpression compiled( string );
+    compiled.prepare( &context );
+    compiled.compile( &context );
+
+    QVariant treeChecksum;
+    QVariant compiledChecksum;
+    QVariant blockChecksum;
+    const double treeRate = measure( tree, context, features, iterations, treeChecksum );
+    const double compiledRate = measure( compiled, context, features, iterations, compiledChecksum );
+    const double blockRate = measureBlocks( compiled, context, features, iterations, blockChecksum );
+
+    std::cout << string.toLocal8Bit().constData() << "\n"
+              << "  tree:     " << static_cast< qint64 >( treeRate ) << " evaluations/s\n"
+              << "  compiled: " << static_cast< qint64 >( compiledRate ) << " evaluations/s ("
+              << compiledRate / treeRate << "x)"
+              << ( treeChecksum == compiledChecksum ? "" : " RESULTS DIFFER" ) << "\n"
+              << "  blocks:   " << static_cast< qint64 >( blockRate ) << " evaluations/s ("
+              << blockRate / treeRate << "x)"
+              << ( treeChecksum == blockChecksum ? "" : " RESULTS DIFFER" ) << std::endl;
+  }
+
+  QgsApplication::exitQgis();
+  return 0;
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+  ninecellfilterbench.cpp - Benchmark of the nine cell raster filters
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+#include "qgsapplication.h"
+#include "qgsaspectfilter.h"
+#include "qgshillshadefilter.h"
+#include "qgsslopefilter.h"
+#include "qgstotalcurvaturefilter.h"
+
+void usage( const QString &appName )
+{
+  std::cerr << "QGIS nine cell filter benchmark\n"
+            << "Usage: " << appName.toLocal8Bit().constData() << " [options]\n"
+            << "  options:\n"
+            << "\t[--width width]\twidth of the synthetic DEM, default 2000\n"
+            << "\t[--height height]\theight of the synthetic DEM, default 500\n"
+            << "\t[--iterations iterations]\tnumber of passes over the DEM, default 10\n"
+            << "\t[--help]\t\tthis text\n\n"
+            << "Prints processed cells per second of the per cell path and of the row kernels\n"
+            << "of the slope, aspect, hillshade and total curvature filters. No raster IO is measured.\n";
+}
+
+QgsNineCellFilter *createFilter( const QString &name )
+{
+  QgsNineCellFilter *filter = nullptr;
+  if ( name == QLatin1String( "slope" ) )
+    filter = new QgsSlopeFilter( QString(), QString(), QStringLiteral( "GTiff" ) );
+  else if ( name == QLatin1String( "aspect" ) )
+    filter = new QgsAspectFilter( QString(), QString(), QStringLiteral( "GTiff" ) );
+  else if ( name == QLatin1String( "hillshade" ) )
+    filter = new QgsHillshadeFilter( QString(), QString(), QStringLiteral( "GTiff" ), 315, 45 );
+  else
+    filter = new QgsTotalCurvatureFilter( QString(), QString(), QStringLiteral( "GTiff" ) );
+  filter->setCellSizeX( 10 );
+  filter->setCellSizeY( 10 );
+  filter->setInputNodataValue( -9999 );
+  filter->setOutputNodataValue( -9999 );
+  return filter;
+}
+
+//! Returns the number of processed cells per second
+double measure( QgsNineCellFilter *filter, bool rows, QVector< float > &dem, int width, int height, int iterations, double &checksum )
+{
+  QVector< float > result( width );
+  double sum = 0;
+  QElapsedTimer timer;
+  timer.start();
+  for ( int i = 0; i < iterations; ++i )
+  {
+    for ( int row = 0; row < height; ++row )
+    {
+      float *above = dem.data() + row * ( width + 2 );
+      float *current = above + width + 2;
+      float *below = current + width + 2;
+      if ( rows )
+      {
+        filter->processNineCellRow( above, current, below, result.data(), width );
+      }
+      else
+      {
+        for ( int col = 0; col < width; ++col )
+        {
+          result[col] = filter->processNineCellWindow( &above[col], &above[col + 1], &above[col + 2],
+                        &current[col], &current[col + 1], &current[col + 2],
+                        &below[col], &below[col + 1], &below[col + 2] );
+        }
+      }
+      sum += result.at( row % width );
+    }
+  }
+  checksum = sum;
+  const double seconds = std::max( timer.nsecsElapsed() / 1e9, 1e-9 );
+  return static_cast< double >( width ) * height * iterations / seconds;
+}
+
+int main( int argc, char *argv[] )
+{
+  QgsApplication app( argc, argv, false );
+
+  int width = 2000;
+  int height = 500;
+  int iterations = 10;
+
+  const QStringList args = QCoreApplication::arguments();
+  for ( int i = 1; i < args.size(); ++i )
+  {
+    const QString arg = args.at( i );
+    const bool hasValue = i + 1 < args.size();
+    if ( arg == QLatin1String( "--width" ) && hasValue )
+      width = args.at( ++i ).toInt();
+    else if ( arg == QLatin1String( "--height" ) && hasValue )
+      height = args.at( ++i ).toInt();
+    else if ( arg == QLatin1String( "--iterations" ) && hasValue )
+      iterations = args.at( ++i ).toInt();
+    else
+    {
+      usage( args.at( 0 ) );
+      return arg == QLatin1String( "--help" ) ? 0 : 1;
+    }
+  }
+
+  if ( width <= 0 || height <= 0 || iterations <= 0 )
+  {
+    usage( args.at( 0 ) );
+    return 1;
+  }
+
+  QgsApplication::initQgis();
+
+  // a nodata border around a smooth surface with some noise
+  QVector< float > dem( ( width + 2 ) * ( height + 2 ), -9999 );
+  for ( int row = 1; row <= height; ++row )
+  {
+    for ( int col = 1; col <= width; ++col )
+      dem[ row * ( width + 2 ) + col ] = 500 + 200 * std::sin( row * 0.011 ) * std::cos( col * 0.017 ) + ( ( row * 31 + col * 17 ) % 11 ) * 0.1;
+  }
+
+  const QStringList filters = QStringList() << QStringLiteral( "slope" ) << QStringLiteral( "aspect" ) << QStringLiteral( "hillshade" ) << QStringLiteral( "curvature" );
+  Q_FOREACH ( const QString &name, filters )
+  {
+    std::unique_ptr< QgsNineCellFilter > filter( createFilter( name ) );
+    double cellChecksum = 0;
+    double rowChecksum = 0;
+    const double cellRate = measure( filter.get(), false, dem, width, height, iterations, cellChecksum );
+    const double rowRate = measure( filter.get(), true, dem, width, height, iterations, rowChecksum );
+
+    std::cout << name.toLocal8Bit().constData() << "\n"
+              << "  cells: " << static_cast< qint64 >( cellRate ) << " cells/s\n"
+              << "  rows:  " << static_cast< qint64 >( rowRate ) << " cells/s ("
+              << rowRate / cellRate << "x)"
+              << ( std::fabs( cellChecksum - rowChecksum ) <= 1e-3 * std::max( 1.0, std::fabs( cellChecksum ) ) ? "" : " RESULTS DIFFER" ) << std::endl;
+  }
+
+  QgsApplication::exitQgis();
+  return 0;
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+  png8bench.cpp - Benchmark of the 8 bit PNG palette quantization
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <iostream>
+
+#include "qgscolorcubequantizer.h"
+#include "qgsmediancut.h"
+
+void usage( const QString &appName )
+{
+  std::cerr << "QGIS 8 bit PNG quantization benchmark\n"
+            << "Usage: " << appName.toLocal8Bit().constData() << " [options] IMAGE\n"
+            << "  options:\n"
+            << "\t[--iterations iterations]\tnumber of quantized images per measurement, default 10\n"
+            << "\t[--threads threads]\tnumber of threads of the color cube quantizer, default 0 (number of processor cores)\n"
+            << "\t[--help]\t\tthis text\n\n"
+            << "Prints the time to convert the image to 256 colors with the median cut used until now\n"
+            << "and with the color cube quantizer, with and without dithering.\n";
+}
+
+template <typename Quantize>
+void measure( const char *label, int iterations, const QImage &image, Quantize quantize )
+{
+  QElapsedTimer timer;
+  timer.start();
+  QImage result;
+  for ( int i = 0; i < iterations; ++i )
+  {
+    result = quantize( image );
+  }
+  const double milliseconds = std::max( timer.nsecsElapsed() / 1e6, 1e-6 ) / iterations;
+  std::cout << label << ": " << milliseconds << " ms/image ("
+            << result.colorCount() << " colors)" << std::endl;
+}
+
+struct MedianCut
+{
+  QImage operator()( const QImage &image ) const
+  {
+    QVector<QRgb> colorTable;
+    QgsWms::medianCut( colorTable, 256, image );
+    return image.convertToFormat( QImage::Format_Indexed8, colorTable,
+                                  Qt::ColorOnly | Qt::ThresholdDither |
+                                  Qt::ThresholdAlphaDither | Qt::NoOpaqueDetection );
+  }
+};
+
+struct ColorCube
+{
+  ColorCube( bool dither, int threads ) : mDither( dither ), mThreads( threads ) {}
+  QImage operator()( const QImage &image ) const
+  {
+    return QgsWms::colorCubeQuantize( image, 256, mDither, mThreads );
+  }
+  bool mDither;
+  int mThreads;
+};
+
+int main( int argc, char *argv[] )
+{
+  QCoreApplication app( argc, argv );
+
+  int iterations = 10;
+  int threads = 0;
+  QString imageFile;
+
+  const QStringList args = QCoreApplication::arguments();
+  for ( int i = 1; i < args.size(); ++i )
+  {
+    const QString arg = args.at( i );
+    const bool hasValue = i + 1 < args.size();
+    if ( arg == QLatin1String( "--iterations" ) && hasValue )
+      iterations = args.at( ++i ).toInt();
+    else if ( arg == QLatin1String( "--threads" ) && hasValue )
+      threads = args.at( ++i ).toInt();
+    else if ( arg.startsWith( QLatin1String( "--" ) ) )
+    {
+      usage( args.at( 0 ) );
+      return arg == QLatin1String( "--help" ) ? 0 : 1;
+    }
+    else
+      imageFile = arg;
+  }
+
+  if ( imageFile.isEmpty() || iterations <= 0 )
+  {
+    usage( args.at( 0 ) );
+    return 1;
+  }
+
+  QImage image( imageFile );
+  if ( image.isNull() )
+  {
+    std::cerr << "Cannot read image " << imageFile.toLocal8Bit().constData() << std::endl;
+    return 1;
+  }
+  // rendered maps are premultiplied
+  image = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+  std::cout << "Image of " << image.width() << "x" << image.height() << std::endl;
+
+  measure( "Median cut", iterations, image, MedianCut() );
+  measure( "Color cube, 1 thread", iterations, image, ColorCube( false, 1 ) );
+  measure( "Color cube, parallel", iterations, image, ColorCube( false, threads ) );
+  measure( "Color cube with dithering", iterations, image, ColorCube( true, threads ) );
+  return 0;
+}
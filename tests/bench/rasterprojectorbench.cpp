@@ -0,0 +1,165 @@
+/***************************************************************************
+  rasterprojectorbench.cpp - Benchmark of raster reprojection
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#include "qgsapplication.h"
+#include "qgscoordinatetransform.h"
+#include "qgsrasterblock.h"
+#include "qgsrasterdataprovider.h"
+#include "qgsrasterlayer.h"
+#include "qgsrasterprojector.h"
+
+/**
+ * Returns a copy of the block read by the first request for every following request,
+ * so that the benchmark measures reprojection without raster IO.
+ */
+class CachedInput : public QgsRasterInterface
+{
+  public:
+    explicit CachedInput( QgsRasterInterface *input )
+      : QgsRasterInterface( input )
+    {}
+
+    QgsRasterInterface *clone() const override { return new CachedInput( mInput ); }
+    Qgis::DataType dataType( int bandNo ) const override { return mInput->dataType( bandNo ); }
+    int bandCount() const override { return mInput->bandCount(); }
+
+    QgsRasterBlock *block( int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback = nullptr ) override
+    {
+      if ( !mBlock || mExtent != extent || mBlock->width() != width || mBlock->height() != height )
+      {
+        mBlock.reset( mInput->block( bandNo, extent, width, height, feedback ) );
+        mExtent = extent;
+      }
+      QgsRasterBlock *block = new QgsRasterBlock( mBlock->dataType(), width, height );
+      if ( mBlock->hasNoDataValue() )
+        block->setNoDataValue( mBlock->noDataValue() );
+      block->setData( mBlock->data() );
+      return block;
+    }
+
+  private:
+    std::unique_ptr< QgsRasterBlock > mBlock;
+    QgsRectangle mExtent;
+};
+
+void usage( const QString &appName )
+{
+  std::cerr << "QGIS raster projector benchmark\n"
+            << "Usage: " << appName.toLocal8Bit().constData() << " [options] RASTER\n"
+            << "  options:\n"
+            << "\t[--crs authid]\tdestination CRS, default EPSG:3857\n"
+            << "\t[--width width]\twidth of the reprojected block, default 2048\n"
+            << "\t[--height height]\theight of the reprojected block, default 2048\n"
+            << "\t[--iterations iterations]\tnumber of reprojected blocks per measurement, default 10\n"
+            << "\t[--threads threads]\tmaximum number of threads, default 0 (number of processor cores)\n"
+            << "\t[--help]\t\tthis text\n\n"
+            << "Prints reprojected pixels per second for approximate and exact precision, with the\n"
+            << "source block cached after the first iteration.\n";
+}
+
+int main( int argc, char *argv[] )
+{
+  QgsApplication app( argc, argv, false );
+
+  QString destCrs = QStringLiteral( "EPSG:3857" );
+  int width = 2048;
+  int height = 2048;
+  int iterations = 10;
+  int threads = 0;
+  QString rasterFile;
+
+  const QStringList args = QCoreApplication::arguments();
+  for ( int i = 1; i < args.size(); ++i )
+  {
+    const QString arg = args.at( i );
+    const bool hasValue = i + 1 < args.size();
+    if ( arg == QLatin1String( "--crs" ) && hasValue )
+      destCrs = args.at( ++i );
+    else if ( arg == QLatin1String( "--width" ) && hasValue )
+      width = args.at( ++i ).toInt();
+    else if ( arg == QLatin1String( "--height" ) && hasValue )
+      height = args.at( ++i ).toInt();
+    else if ( arg == QLatin1String( "--iterations" ) && hasValue )
+      iterations = args.at( ++i ).toInt();
+    else if ( arg == QLatin1String( "--threads" ) && hasValue )
+      threads = args.at( ++i ).toInt();
+    else if ( arg.startsWith( QLatin1String( "--" ) ) )
+    {
+      usage( args.at( 0 ) );
+      return arg == QLatin1String( "--help" ) ? 0 : 1;
+    }
+    else
+      rasterFile = arg;
+  }
+
+  if ( rasterFile.isEmpty() || width <= 0 || height <= 0 || iterations <= 0 )
+  {
+    usage( args.at( 0 ) );
+    return 1;
+  }
+
+  QgsApplication::initQgis();
+
+  QgsRasterLayer layer( rasterFile, QStringLiteral( "raster" ) );
+  if ( !layer.isValid() )
+  {
+    std::cerr << "Cannot open raster " << rasterFile.toLocal8Bit().constData() << std::endl;
+    return 1;
+  }
+
+  QgsCoordinateReferenceSystem crs( destCrs );
+  if ( !crs.isValid() )
+  {
+    std::cerr << "Invalid CRS " << destCrs.toLocal8Bit().constData() << std::endl;
+    return 1;
+  }
+  QgsRectangle extent = QgsCoordinateTransform( layer.crs(), crs ).transformBoundingBox( layer.extent() );
+
+  CachedInput input( layer.dataProvider() );
+  const QList< QgsRasterProjector::Precision > precisions = QList< QgsRasterProjector::Precision >() << QgsRasterProjector::Approximate << QgsRasterProjector::Exact;
+  for ( QgsRasterProjector::Precision precision : precisions )
+  {
+    QgsRasterProjector projector;
+    projector.setInput( &input );
+    projector.setCrs( layer.crs(), crs );
+    projector.setPrecision( precision );
+    projector.setThreadCount( threads );
+
+    //the first block fills the input cache
+    delete projector.block( 1, extent, width, height );
+
+    QElapsedTimer timer;
+    timer.start();
+    for ( int i = 0; i < iterations; ++i )
+    {
+      delete projector.block( 1, extent, width, height );
+    }
+    const double seconds = std::max( timer.nsecsElapsed() / 1e9, 1e-9 );
+    std::cout << QgsRasterProjector::precisionLabel( precision ).toLocal8Bit().constData() << ": "
+              << static_cast< qint64 >( static_cast< double >( width ) * height * iterations / seconds ) << " pixels/s ("
+              << iterations << " blocks of " << width << "x" << height << " in " << seconds << " s)" << std::endl;
+  }
+
+  QgsApplication::exitQgis();
+  return 0;
+}
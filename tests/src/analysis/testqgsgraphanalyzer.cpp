@@ -0,0 +1,576 @@
+/***************************************************************************
+     testqgsgraphanalyzer.cpp
+     --------------------------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS project
+    Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <limits>
+#include <memory>
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include "qgstest.h"
+#include "qgstestutils.h"
+
+#include "qgsgraph.h"
+#include "qgscompactgraph.h"
+#include "qgscontractionhierarchy.h"
+#include "qgsgraphanalyzer.h"
+#include "qgsgraphsearch.h"
+#include "qgsgraphbuilder.h"
+#include "qgsnetworkanalysisalgorithms.h"
+#include "qgsnetworkdistancestrategy.h"
+#include "qgsprocessingcontext.h"
+#include "qgsprocessingfeedback.h"
+#include "qgsprocessingregistry.h"
+#include "qgsprocessingutils.h"
+#include "qgsvectordataprovider.h"
+#include "qgsvectorlayer.h"
+#include "qgsvectorlayerdirector.h"
+
+/** \ingroup UnitTests
+ * This is a unit test for the network analysis search engines
+ */
+class TestQgsGraphAnalyzer : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init() {}
+    void cleanup() {}
+
+    void testShortestPathTree();
+    void testShortestPath_data();
+    void testShortestPath();
+    void testUnreachable();
+    void testInvalidCriterion();
+    void testCosts();
+    void testCompactGraph();
+    void testContractionHierarchy();
+    void testContractionHierarchyCorruptFile();
+    void testTiePoints();
+    void testCostMatrixAlgorithm();
+
+  private:
+    QgsGraph *mGraph = nullptr;
+};
+
+void TestQgsGraphAnalyzer::initTestCase()
+{
+  QgsApplication::init();
+  QgsApplication::initQgis();
+
+  // grid of 10 x 10 vertices, 1 unit apart, with bidirectional edges between neighbors.
+  // Strategy 0 is the edge length, strategy 1 penalizes edges crossing the grid diagonal
+  mGraph = new QgsGraph();
+  for ( int row = 0; row < 10; ++row )
+  {
+    for ( int col = 0; col < 10; ++col )
+    {
+      mGraph->addVertex( QgsPointXY( col, row ) );
+    }
+  }
+
+  for ( int row = 0; row < 10; ++row )
+  {
+    for ( int col = 0; col < 10; ++col )
+    {
+      int idx = row * 10 + col;
+      if ( col < 9 )
+      {
+        double penalty = col == row ? 10.0 : 1.0;
+        mGraph->addEdge( idx, idx + 1, QVector< QVariant >() << 1.0 << penalty );
+        mGraph->addEdge( idx + 1, idx, QVector< QVariant >() << 1.0 << penalty );
+      }
+      if ( row < 9 )
+      {
+        mGraph->addEdge( idx, idx + 10, QVector< QVariant >() << 1.0 << 1.0 );
+        mGraph->addEdge( idx + 10, idx, QVector< QVariant >() << 1.0 << 1.0 );
+      }
+    }
+  }
+}
+
+void TestQgsGraphAnalyzer::cleanupTestCase()
+{
+  delete mGraph;
+  QgsApplication::exitQgis();
+}
+
+void TestQgsGraphAnalyzer::testShortestPathTree()
+{
+  QgsGraphSearch search( mGraph, 1 );
+  for ( int start = 0; start < mGraph->vertexCount(); start += 7 )
+  {
+    QVector< int > expectedTree;
+    QVector< double > expectedCost;
+    QgsGraphAnalyzer::dijkstra( mGraph, start, 1, &expectedTree, &expectedCost );
+
+    QVector< int > tree;
+    QVector< double > cost;
+    search.shortestPathTree( start, &tree, &cost );
+
+    QCOMPARE( cost, expectedCost );
+    QCOMPARE( tree.size(), expectedTree.size() );
+    QCOMPARE( tree.at( start ), -1 );
+    for ( int i = 0; i < tree.size(); ++i )
+    {
+      if ( i == start )
+        continue;
+      // equal cost paths may use a different inbound edge, but it must lead to the vertex
+      // and agree with the tree cost
+      const QgsGraphEdge &edge = mGraph->edge( tree.at( i ) );
+      QCOMPARE( edge.inVertex(), i );
+      QGSCOMPARENEAR( cost.at( edge.outVertex() ) + edge.cost( 1 ).toDouble(), cost.at( i ), 1e-9 );
+    }
+  }
+}
+
+void TestQgsGraphAnalyzer::testShortestPath_data()
+{
+  QTest::addColumn<int>( "algorithm" );
+  QTest::addColumn<int>( "criterion" );
+
+  QTest::newRow( "dijkstra length" ) << static_cast< int >( QgsGraphSearch::Dijkstra ) << 0;
+  QTest::newRow( "dijkstra penalty" ) << static_cast< int >( QgsGraphSearch::Dijkstra ) << 1;
+  QTest::newRow( "astar length" ) << static_cast< int >( QgsGraphSearch::AStar ) << 0;
+  QTest::newRow( "astar penalty" ) << static_cast< int >( QgsGraphSearch::AStar ) << 1;
+  QTest::newRow( "bidirectional length" ) << static_cast< int >( QgsGraphSearch::Bidirectional ) << 0;
+  QTest::newRow( "bidirectional penalty" ) << static_cast< int >( QgsGraphSearch::Bidirectional ) << 1;
+}
+
+void TestQgsGraphAnalyzer::testShortestPath()
+{
+  QFETCH( int, algorithm );
+  QFETCH( int, criterion );
+
+  QgsGraphSearch search( mGraph, criterion );
+  QCOMPARE( search.heuristicScale(), 1.0 );
+
+  for ( int start = 0; start < mGraph->vertexCount(); start += 11 )
+  {
+    QVector< double > expectedCost;
+    QgsGraphAnalyzer::dijkstra( mGraph, start, criterion, nullptr, &expectedCost );
+
+    for ( int end = 0; end < mGraph->vertexCount(); end += 3 )
+    {
+      QVector< int > path;
+      double cost = search.shortestPath( start, end, static_cast< QgsGraphSearch::Algorithm >( algorithm ), &path );
+      QGSCOMPARENEAR( cost, expectedCost.at( end ), 1e-9 );
+
+      // path must be connected and sum up to the returned cost
+      int vertex = start;
+      double pathCost = 0.0;
+      Q_FOREACH ( int edgeIdx, path )
+      {
+        const QgsGraphEdge &edge = mGraph->edge( edgeIdx );
+        QCOMPARE( edge.outVertex(), vertex );
+        pathCost += edge.cost( criterion ).toDouble();
+        vertex = edge.inVertex();
+      }
+      QCOMPARE( vertex, end );
+      QGSCOMPARENEAR( pathCost, cost, 1e-9 );
+    }
+  }
+
+  QVector< int > path;
+  QGSCOMPARENEAR( QgsGraphAnalyzer::shortestPath( mGraph, 0, 99, criterion, static_cast< QgsGraphSearch::Algorithm >( algorithm ), &path ),
+                  18.0, 1e-9 );
+  QCOMPARE( path.size(), 18 );
+}
+
+void TestQgsGraphAnalyzer::testUnreachable()
+{
+  QgsGraph graph;
+  graph.addVertex( QgsPointXY( 0, 0 ) );
+  graph.addVertex( QgsPointXY( 1, 0 ) );
+  graph.addVertex( QgsPointXY( 2, 0 ) );
+  graph.addEdge( 0, 1, QVector< QVariant >() << 1.0 );
+
+  QgsGraphSearch search( &graph, 0 );
+  QVector< int > path;
+  QCOMPARE( search.shortestPath( 0, 1, QgsGraphSearch::Bidirectional, &path ), 1.0 );
+  QCOMPARE( path, QVector< int >() << 0 );
+  QCOMPARE( search.shortestPath( 1, 0, QgsGraphSearch::AStar, &path ), std::numeric_limits<double>::infinity() );
+  QVERIFY( path.isEmpty() );
+  QCOMPARE( search.shortestPath( 0, 2, QgsGraphSearch::Dijkstra, &path ), std::numeric_limits<double>::infinity() );
+  QCOMPARE( search.shortestPath( 2, 2, QgsGraphSearch::Dijkstra, &path ), 0.0 );
+}
+
+void TestQgsGraphAnalyzer::testInvalidCriterion()
+{
+  QVERIFY( QgsGraphSearch( mGraph, 0 ).isValid() );
+  QVERIFY( QgsGraphSearch( mGraph, 1 ).isValid() );
+
+  const double inf = std::numeric_limits<double>::infinity();
+  QList< QgsGraphSearch > searches;
+  searches << QgsGraphSearch( mGraph, -1 ) << QgsGraphSearch( mGraph, 2 ) << QgsGraphSearch( QgsCompactGraph( *mGraph ), -1 );
+  Q_FOREACH ( QgsGraphSearch search, searches )
+  {
+    QVERIFY( !search.isValid() );
+
+    QVector< int > tree;
+    QVector< double > costs;
+    search.shortestPathTree( 0, &tree, &costs );
+    QCOMPARE( tree, QVector< int >( 100, -1 ) );
+    QCOMPARE( costs, QVector< double >( 100, inf ) );
+
+    QVector< int > path;
+    QCOMPARE( search.shortestPath( 0, 99, QgsGraphSearch::Dijkstra, &path ), inf );
+    QCOMPARE( search.shortestPath( 0, 99, QgsGraphSearch::AStar, &path ), inf );
+    QCOMPARE( search.shortestPath( 0, 99, QgsGraphSearch::Bidirectional, &path ), inf );
+    QVERIFY( path.isEmpty() );
+    QCOMPARE( search.costs( 0, QVector< int >() << 1 << 99 ), QVector< double >( 2, inf ) );
+  }
+
+  // out of range vertices are unreachable too
+  QgsGraphSearch search( mGraph, 0 );
+  QCOMPARE( search.shortestPath( -1, 5 ), inf );
+  QCOMPARE( search.shortestPath( 5, 100 ), inf );
+  QVector< int > tree;
+  search.shortestPathTree( 100, &tree, nullptr );
+  QCOMPARE( tree, QVector< int >( 100, -1 ) );
+}
+
+void TestQgsGraphAnalyzer::testCosts()
+{
+  QgsGraphSearch search( mGraph, 1 );
+  QVector<double> tree;
+  search.shortestPathTree( 11, nullptr, &tree );
+
+  // duplicated and invalid end vertices are allowed
+  QVector<int> ends;
+  ends << 0 << 99 << 11 << 45 << 99 << -1 << 100;
+  QVector<double> costs = search.costs( 11, ends );
+  QCOMPARE( costs.size(), ends.size() );
+  for ( int i = 0; i < 5; ++i )
+    QGSCOMPARENEAR( costs.at( i ), tree.at( ends.at( i ) ), 0.000001 );
+  QVERIFY( std::isinf( costs.at( 5 ) ) );
+  QVERIFY( std::isinf( costs.at( 6 ) ) );
+
+  // searches are reusable
+  QCOMPARE( search.costs( 11, ends ), costs );
+  QVERIFY( std::isinf( search.costs( -1, ends ).at( 0 ) ) );
+}
+
+void TestQgsGraphAnalyzer::testCompactGraph()
+{
+  QgsCompactGraph compact( *mGraph );
+  QCOMPARE( compact.vertexCount(), mGraph->vertexCount() );
+  QCOMPARE( compact.edgeCount(), mGraph->edgeCount() );
+  QCOMPARE( compact.strategyCount(), 2 );
+  QCOMPARE( compact.findVertex( QgsPointXY( 3, 4 ) ), 43 );
+  QCOMPARE( compact.findVertex( QgsPointXY( 30, 4 ) ), -1 );
+
+  // edges are grouped by outgoing vertex and keep their source attributes
+  for ( int v = 0; v < compact.vertexCount(); ++v )
+  {
+    QCOMPARE( compact.vertexPoint( v ), mGraph->vertex( v ).point() );
+    QCOMPARE( compact.outEdgesEnd( v ) - compact.outEdgesBegin( v ), mGraph->vertex( v ).outEdges().size() );
+    QCOMPARE( compact.inEdges( v ).size(), mGraph->vertex( v ).inEdges().size() );
+    for ( int e = compact.outEdgesBegin( v ); e < compact.outEdgesEnd( v ); ++e )
+    {
+      const QgsGraphEdge &source = mGraph->edge( compact.sourceEdgeId( e ) );
+      QCOMPARE( compact.edgeOutVertex( e ), v );
+      QCOMPARE( compact.edgeInVertex( e ), source.inVertex() );
+      QCOMPARE( compact.edgeCost( e, 0 ), source.cost( 0 ).toDouble() );
+      QCOMPARE( compact.edgeCost( e, 1 ), source.cost( 1 ).toDouble() );
+    }
+    Q_FOREACH ( int e, compact.inEdges( v ) )
+    {
+      QCOMPARE( compact.edgeInVertex( e ), v );
+    }
+  }
+
+  // searches on the compact graph return compact edge indices
+  QVector< double > expectedCost;
+  QgsGraphAnalyzer::dijkstra( mGraph, 5, 1, nullptr, &expectedCost );
+  QgsGraphSearch search( compact, 1 );
+  for ( int end = 0; end < compact.vertexCount(); ++end )
+  {
+    QVector< int > path;
+    QGSCOMPARENEAR( search.shortestPath( 5, end, QgsGraphSearch::Bidirectional, &path ), expectedCost.at( end ), 1e-9 );
+    int vertex = 5;
+    Q_FOREACH ( int e, path )
+    {
+      QCOMPARE( compact.edgeOutVertex( e ), vertex );
+      vertex = compact.edgeInVertex( e );
+    }
+    QCOMPARE( vertex, end );
+  }
+
+  std::unique_ptr< QgsGraph > roundTrip( compact.toGraph() );
+  QCOMPARE( roundTrip->edgeCount(), mGraph->edgeCount() );
+  for ( int e = 0; e < roundTrip->edgeCount(); ++e )
+  {
+    QCOMPARE( roundTrip->edge( e ).outVertex(), mGraph->edge( e ).outVertex() );
+    QCOMPARE( roundTrip->edge( e ).inVertex(), mGraph->edge( e ).inVertex() );
+    QCOMPARE( roundTrip->edge( e ).cost( 1 ).toDouble(), mGraph->edge( e ).cost( 1 ).toDouble() );
+  }
+}
+
+void TestQgsGraphAnalyzer::testContractionHierarchy()
+{
+  QgsCompactGraph compact( *mGraph );
+  QgsContractionHierarchy hierarchy( compact, 1 );
+  QVERIFY( hierarchy.isValid() );
+  QCOMPARE( hierarchy.vertexCount(), mGraph->vertexCount() );
+  QCOMPARE( hierarchy.findVertex( QgsPointXY( 3, 4 ) ), 43 );
+
+  QVector< int > ends;
+  for ( int end = 0; end < mGraph->vertexCount(); end += 3 )
+    ends << end;
+  QVector< int > starts;
+  for ( int start = 0; start < mGraph->vertexCount(); start += 11 )
+    starts << start;
+
+  QVector< QVector< double > > matrix = hierarchy.costMatrix( starts, ends );
+  QCOMPARE( matrix.size(), starts.size() );
+  for ( int row = 0; row < starts.size(); ++row )
+  {
+    QVector< double > expectedCost;
+    QgsGraphAnalyzer::dijkstra( mGraph, starts.at( row ), 1, nullptr, &expectedCost );
+
+    QVector< double > costs = hierarchy.costs( starts.at( row ), ends );
+    for ( int column = 0; column < ends.size(); ++column )
+    {
+      const double expected = expectedCost.at( ends.at( column ) );
+      QGSCOMPARENEAR( matrix.at( row ).at( column ), expected, 1e-9 );
+      QGSCOMPARENEAR( costs.at( column ), expected, 1e-9 );
+
+      // unpacked paths use the QgsGraph edge indices
+      QVector< int > path;
+      QGSCOMPARENEAR( hierarchy.shortestPath( starts.at( row ), ends.at( column ), &path ), expected, 1e-9 );
+      int vertex = starts.at( row );
+      double pathCost = 0.0;
+      Q_FOREACH ( int edgeIdx, path )
+      {
+        const QgsGraphEdge &edge = mGraph->edge( edgeIdx );
+        QCOMPARE( edge.outVertex(), vertex );
+        pathCost += edge.cost( 1 ).toDouble();
+        vertex = edge.inVertex();
+      }
+      QCOMPARE( vertex, ends.at( column ) );
+      QGSCOMPARENEAR( pathCost, expected, 1e-9 );
+    }
+  }
+
+  // round trip through a file
+  QTemporaryDir dir;
+  const QString path = dir.path() + "/hierarchy.qgsch";
+  QVERIFY( hierarchy.writeToFile( path ) );
+
+  QgsContractionHierarchy loaded;
+  QVERIFY( !loaded.isValid() );
+  QVERIFY( !loaded.readFromFile( dir.path() + "/missing.qgsch" ) );
+  QVERIFY( loaded.readFromFile( path ) );
+  QVERIFY( loaded.isValid() );
+  QCOMPARE( loaded.criterion(), 1 );
+  QCOMPARE( loaded.shortcutCount(), hierarchy.shortcutCount() );
+  QCOMPARE( loaded.costMatrix( starts, ends ), matrix );
+}
+
+void TestQgsGraphAnalyzer::testContractionHierarchyCorruptFile()
+{
+  QgsContractionHierarchy hierarchy( QgsCompactGraph( *mGraph ), 0 );
+  QVERIFY( hierarchy.shortcutCount() > 0 );
+  QTemporaryDir dir;
+  const QString path = dir.path() + "/hierarchy.qgsch";
+  QVERIFY( hierarchy.writeToFile( path ) );
+
+  // file content, in writeToFile() order
+  quint32 magic = 0;
+  quint32 version = 0;
+  qint32 criterion = 0;
+  QVector< double > x, y, upCosts, downCosts;
+  QVector< int > upOffsets, upTargets, upEdges, downOffsets, downTargets, downEdges;
+  QVector< int > edgeFrom, edgeTo, edgeSource, edgeFirst, edgeSecond;
+  {
+    QFile file( path );
+    QVERIFY( file.open( QIODevice::ReadOnly ) );
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_0 );
+    stream >> magic >> version >> criterion >> x >> y
+           >> upOffsets >> upTargets >> upCosts >> upEdges
+           >> downOffsets >> downTargets >> downCosts >> downEdges
+           >> edgeFrom >> edgeTo >> edgeSource >> edgeFirst >> edgeSecond;
+    QCOMPARE( stream.status(), QDataStream::Ok );
+  }
+  const int shortcut = edgeSource.indexOf( -1 );
+  QVERIFY( shortcut > 0 );
+
+  // writes the content with a single value changed and checks it is rejected
+  auto corrupted = [ & ]( QVector< int > &values, int index, int value ) -> bool
+  {
+    const int original = values.at( index );
+    values[ index ] = value;
+    const QString corruptPath = dir.path() + "/corrupt.qgsch";
+    {
+      QFile file( corruptPath );
+      if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        return false;
+      QDataStream stream( &file );
+      stream.setVersion( QDataStream::Qt_5_0 );
+      stream << magic << version << criterion << x << y
+             << upOffsets << upTargets << upCosts << upEdges
+             << downOffsets << downTargets << downCosts << downEdges
+             << edgeFrom << edgeTo << edgeSource << edgeFirst << edgeSecond;
+    }
+    values[ index ] = original;
+
+    QgsContractionHierarchy loaded;
+    return !loaded.readFromFile( corruptPath ) && !loaded.isValid();
+  };
+
+  // an unchanged value is accepted
+  QVERIFY( !corrupted( upTargets, 0, upTargets.at( 0 ) ) );
+  QVERIFY( corrupted( upTargets, 0, x.size() ) );
+  QVERIFY( corrupted( downTargets, 0, -1 ) );
+  QVERIFY( corrupted( upOffsets, 1, upTargets.size() + 1 ) );
+  QVERIFY( corrupted( downOffsets, 2, downOffsets.at( 1 ) - 1 ) );
+  QVERIFY( corrupted( upEdges, 0, edgeSource.size() ) );
+  QVERIFY( corrupted( downEdges, 0, -1 ) );
+  QVERIFY( corrupted( edgeFrom, 0, x.size() ) );
+  QVERIFY( corrupted( edgeTo, 0, -5 ) );
+  QVERIFY( corrupted( edgeSource, 0, -2 ) );
+  QVERIFY( corrupted( edgeFirst, shortcut, shortcut ) );
+  QVERIFY( corrupted( edgeSecond, shortcut, edgeSource.size() ) );
+}
+
+void TestQgsGraphAnalyzer::testTiePoints()
+{
+  QgsVectorLayer layer( QStringLiteral( "LineString?crs=EPSG:3857" ), QStringLiteral( "network" ), QStringLiteral( "memory" ) );
+  QVERIFY( layer.isValid() );
+  QgsFeature f1;
+  f1.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "LineString(0 0, 10 0, 10 10)" ) ) );
+  QgsFeature f2;
+  f2.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "LineString(0 5, 5 5)" ) ) );
+  QgsFeatureList features;
+  features << f1 << f2;
+  QVERIFY( layer.dataProvider()->addFeatures( features ) );
+
+  QgsVectorLayerDirector director( &layer, -1, QStringLiteral( "yes" ), QStringLiteral( "1" ), QStringLiteral( "2" ), QgsVectorLayerDirector::DirectionBoth );
+  director.addStrategy( new QgsNetworkDistanceStrategy() );
+  QgsGraphBuilder builder( layer.crs(), false, 0.0, QStringLiteral( "NONE" ) );
+
+  // (5 2.5) is as close to both lines, the first segment in layer order wins
+  QVector< QgsPointXY > points;
+  points << QgsPointXY( 3, 1 ) << QgsPointXY( 11, 4 ) << QgsPointXY( 4, 5.2 ) << QgsPointXY( 20, 20 ) << QgsPointXY( 5, 2.5 );
+  QVector< QgsPointXY > snapped;
+  director.makeGraph( &builder, points, snapped );
+
+  QCOMPARE( snapped.size(), 5 );
+  QCOMPARE( snapped.at( 0 ), QgsPointXY( 3, 0 ) );
+  QCOMPARE( snapped.at( 1 ), QgsPointXY( 10, 4 ) );
+  QCOMPARE( snapped.at( 2 ), QgsPointXY( 4, 5 ) );
+  QCOMPARE( snapped.at( 3 ), QgsPointXY( 10, 10 ) );
+  QCOMPARE( snapped.at( 4 ), QgsPointXY( 5, 0 ) );
+
+  // tie points split the segments they are tied to
+  std::unique_ptr< QgsGraph > graph( builder.graph() );
+  QCOMPARE( graph->vertexCount(), 9 );
+  QCOMPARE( graph->edgeCount(), 14 );
+  const int tied = graph->findVertex( QgsPointXY( 3, 0 ) );
+  QVERIFY( tied >= 0 );
+  QCOMPARE( graph->vertex( tied ).outEdges().size(), 2 );
+
+  // without additional points nothing is tied
+  QgsGraphBuilder plainBuilder( layer.crs(), false, 0.0, QStringLiteral( "NONE" ) );
+  director.makeGraph( &plainBuilder, QVector< QgsPointXY >(), snapped );
+  QVERIFY( snapped.isEmpty() );
+  std::unique_ptr< QgsGraph > plainGraph( plainBuilder.graph() );
+  QCOMPARE( plainGraph->vertexCount(), 5 );
+  QCOMPARE( plainGraph->edgeCount(), 6 );
+}
+
+void TestQgsGraphAnalyzer::testCostMatrixAlgorithm()
+{
+  QVERIFY( QgsApplication::processingRegistry()->addProvider( new QgsNetworkAnalysisAlgorithms() ) );
+  const QgsProcessingAlgorithm *alg = QgsApplication::processingRegistry()->algorithmById( QStringLiteral( "network:costmatrix" ) );
+  QVERIFY( alg );
+
+  // along the equator web mercator units match ellipsoidal distances
+  QgsVectorLayer *network = new QgsVectorLayer( QStringLiteral( "LineString?crs=EPSG:3857" ), QStringLiteral( "network" ), QStringLiteral( "memory" ) );
+  QgsFeature f1;
+  f1.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "LineString(0 0, 200 0)" ) ) );
+  QgsFeature f2;
+  f2.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "LineString(300 300, 400 300)" ) ) );
+  QgsFeatureList features;
+  features << f1 << f2;
+  network->dataProvider()->addFeatures( features );
+
+  QgsVectorLayer *origins = new QgsVectorLayer( QStringLiteral( "Point?crs=EPSG:3857" ), QStringLiteral( "origins" ), QStringLiteral( "memory" ) );
+  QgsFeature o1;
+  o1.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "Point(10 5)" ) ) );
+  QgsFeature o2;
+  o2.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "Point(150 -20)" ) ) );
+  features.clear();
+  features << o1 << o2;
+  origins->dataProvider()->addFeatures( features );
+  QList< QgsFeatureId > originIds;
+  Q_FOREACH ( const QgsFeature &feature, features )
+    originIds << feature.id();
+
+  QgsVectorLayer *destinations = new QgsVectorLayer( QStringLiteral( "Point?crs=EPSG:3857" ), QStringLiteral( "destinations" ), QStringLiteral( "memory" ) );
+  QgsFeature d1;
+  d1.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "Point(50 -3)" ) ) );
+  QgsFeature d2;
+  d2.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "Point(350 310)" ) ) );
+  QgsFeature d3;
+  d3.setGeometry( QgsGeometry::fromWkt( QStringLiteral( "Point(10 5)" ) ) );
+  features.clear();
+  features << d1 << d2 << d3;
+  destinations->dataProvider()->addFeatures( features );
+  QList< QgsFeatureId > destinationIds;
+  Q_FOREACH ( const QgsFeature &feature, features )
+    destinationIds << feature.id();
+
+  QgsProcessingContext context;
+  context.temporaryLayerStore()->addMapLayers( QList< QgsMapLayer * >() << network << origins << destinations );
+  QgsProcessingFeedback feedback;
+
+  QVariantMap parameters;
+  parameters.insert( QStringLiteral( "INPUT" ), network->id() );
+  parameters.insert( QStringLiteral( "ORIGINS" ), origins->id() );
+  parameters.insert( QStringLiteral( "DESTINATIONS" ), destinations->id() );
+  parameters.insert( QStringLiteral( "OUTPUT_LAYER" ), QStringLiteral( "memory:" ) );
+  bool ok = false;
+  QVariantMap results = alg->run( parameters, context, &feedback, &ok );
+  QVERIFY( ok );
+
+  QgsVectorLayer *matrix = qobject_cast< QgsVectorLayer * >( QgsProcessingUtils::mapLayerFromString( results.value( QStringLiteral( "OUTPUT_LAYER" ) ).toString(), context ) );
+  QVERIFY( matrix );
+  QCOMPARE( matrix->featureCount(), 6L );
+
+  // rows are ordered by origin, then destination. Points are tied to the network first.
+  QList< QVariant > expected;
+  expected << 40.0 << QVariant() << 0.0 << 100.0 << QVariant() << 140.0;
+  QgsFeatureIterator it = matrix->getFeatures();
+  QgsFeature f;
+  int row = 0;
+  while ( it.nextFeature( f ) )
+  {
+    QCOMPARE( f.attribute( QStringLiteral( "origin_id" ) ).toLongLong(), originIds.at( row / 3 ) );
+    QCOMPARE( f.attribute( QStringLiteral( "destination_id" ) ).toLongLong(), destinationIds.at( row % 3 ) );
+    if ( expected.at( row ).isNull() )
+      QVERIFY( f.attribute( QStringLiteral( "cost" ) ).isNull() );
+    else
+      QGSCOMPARENEAR( f.attribute( QStringLiteral( "cost" ) ).toDouble(), expected.at( row ).toDouble(), 0.01 );
+    ++row;
+  }
+  QCOMPARE( row, 6 );
+}
+
+QGSTEST_MAIN( TestQgsGraphAnalyzer )
+#include "testqgsgraphanalyzer.moc"
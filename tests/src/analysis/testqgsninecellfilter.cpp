@@ -0,0 +1,185 @@
+/***************************************************************************
+  testqgsninecellfilter.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgstest.h"
+
+#include "qgsapplication.h"
+#include "qgsaspectfilter.h"
+#include "qgshillshadefilter.h"
+#include "qgsslopefilter.h"
+#include "qgstestutils.h"
+#include "qgstotalcurvaturefilter.h"
+
+#include <QTemporaryDir>
+#include <QVector>
+
+#include <gdal.h>
+
+#include <algorithm>
+#include <cmath>
+
+class TestQgsNineCellFilter : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void slope();
+    void aspect();
+    void hillshade();
+    void totalCurvature();
+
+  private:
+    void checkFilter( QgsNineCellFilter &filter, const QString &output );
+    QVector< float > readRaster( const QString &path ) const;
+
+    QTemporaryDir mTempDir;
+    QString mInputFile;
+    QVector< float > mInput;
+
+    //more rows than a single tile, to test the tile borders
+    static const int X_SIZE = 57;
+    static const int Y_SIZE = 300;
+};
+
+void TestQgsNineCellFilter::initTestCase()
+{
+  QgsApplication::init();
+  QgsApplication::initQgis();
+  GDALAllRegister();
+
+  mInputFile = mTempDir.path() + "/dem.tif";
+  mInput.resize( X_SIZE * Y_SIZE );
+  for ( int row = 0; row < Y_SIZE; ++row )
+  {
+    for ( int col = 0; col < X_SIZE; ++col )
+    {
+      float value = 100 + 20 * std::sin( row * 0.13 ) * std::cos( col * 0.21 ) + ( ( row * 31 + col * 17 ) % 7 );
+      if ( ( row * X_SIZE + col ) % 97 == 0 )
+        value = -9999;
+      mInput[ row * X_SIZE + col ] = value;
+    }
+  }
+
+  GDALDriverH driver = GDALGetDriverByName( "GTiff" );
+  QVERIFY( driver );
+  GDALDatasetH dataset = GDALCreate( driver, mInputFile.toUtf8().constData(), X_SIZE, Y_SIZE, 1, GDT_Float32, nullptr );
+  QVERIFY( dataset );
+  double geoTransform[6] = { 1000, 10, 0, 5000, 0, -10 };
+  GDALSetGeoTransform( dataset, geoTransform );
+  GDALRasterBandH band = GDALGetRasterBand( dataset, 1 );
+  GDALSetRasterNoDataValue( band, -9999 );
+  QCOMPARE( GDALRasterIO( band, GF_Write, 0, 0, X_SIZE, Y_SIZE, mInput.data(), X_SIZE, Y_SIZE, GDT_Float32, 0, 0 ), CE_None );
+  GDALClose( dataset );
+}
+
+void TestQgsNineCellFilter::cleanupTestCase()
+{
+  QgsApplication::exitQgis();
+}
+
+QVector< float > TestQgsNineCellFilter::readRaster( const QString &path ) const
+{
+  QVector< float > values;
+  GDALDatasetH dataset = GDALOpen( path.toUtf8().constData(), GA_ReadOnly );
+  if ( !dataset )
+    return values;
+
+  values.resize( X_SIZE * Y_SIZE );
+  if ( GDALRasterIO( GDALGetRasterBand( dataset, 1 ), GF_Read, 0, 0, X_SIZE, Y_SIZE, values.data(), X_SIZE, Y_SIZE, GDT_Float32, 0, 0 ) != CE_None )
+    values.clear();
+  GDALClose( dataset );
+  return values;
+}
+
+void TestQgsNineCellFilter::checkFilter( QgsNineCellFilter &filter, const QString &output )
+{
+  filter.setThreadCount( 1 );
+  QCOMPARE( filter.processRaster(), 0 );
+  const QVector< float > single = readRaster( output );
+  QCOMPARE( single.size(), X_SIZE * Y_SIZE );
+
+  //reference values, calculated cell by cell from the input padded with nodata. Rows are
+  //calculated by the single precision batch kernels, so values are only equal up to rounding
+  const float nodata = static_cast< float >( filter.inputNodataValue() );
+  auto inputValue = [this, nodata]( int row, int col )
+  {
+    return row < 0 || col < 0 || row >= Y_SIZE || col >= X_SIZE ? nodata : mInput.at( row * X_SIZE + col );
+  };
+  for ( int row = 0; row < Y_SIZE; ++row )
+  {
+    for ( int col = 0; col < X_SIZE; ++col )
+    {
+      float window[9];
+      for ( int i = 0; i < 9; ++i )
+        window[i] = inputValue( row - 1 + i / 3, col - 1 + i % 3 );
+      const float expected = filter.processNineCellWindow( &window[0], &window[1], &window[2],
+                             &window[3], &window[4], &window[5],
+                             &window[6], &window[7], &window[8] );
+      const float actual = single.at( row * X_SIZE + col );
+      if ( std::isnan( expected ) )
+        QVERIFY( std::isnan( actual ) );
+      else if ( expected == filter.outputNodataValue() )
+        QCOMPARE( actual, expected );
+      else
+        QGSCOMPARENEAR( actual, expected, 0.001 * std::max( 1.0f, std::fabs( expected ) ) );
+    }
+  }
+
+  //multi-threaded processing must give identical results
+  filter.setThreadCount( 4 );
+  QCOMPARE( filter.processRaster(), 0 );
+  const QVector< float > multi = readRaster( output );
+  QCOMPARE( multi.size(), X_SIZE * Y_SIZE );
+  for ( int i = 0; i < single.size(); ++i )
+  {
+    if ( std::isnan( single.at( i ) ) )
+      QVERIFY( std::isnan( multi.at( i ) ) );
+    else
+      QCOMPARE( multi.at( i ), single.at( i ) );
+  }
+}
+
+void TestQgsNineCellFilter::slope()
+{
+  const QString output = mTempDir.path() + "/slope.tif";
+  QgsSlopeFilter filter( mInputFile, output, QStringLiteral( "GTiff" ) );
+  checkFilter( filter, output );
+}
+
+void TestQgsNineCellFilter::aspect()
+{
+  const QString output = mTempDir.path() + "/aspect.tif";
+  QgsAspectFilter filter( mInputFile, output, QStringLiteral( "GTiff" ) );
+  checkFilter( filter, output );
+}
+
+void TestQgsNineCellFilter::hillshade()
+{
+  const QString output = mTempDir.path() + "/hillshade.tif";
+  QgsHillshadeFilter filter( mInputFile, output, QStringLiteral( "GTiff" ), 315, 45 );
+  checkFilter( filter, output );
+}
+
+void TestQgsNineCellFilter::totalCurvature()
+{
+  const QString output = mTempDir.path() + "/curvature.tif";
+  QgsTotalCurvatureFilter filter( mInputFile, output, QStringLiteral( "GTiff" ) );
+  checkFilter( filter, output );
+}
+
+QGSTEST_MAIN( TestQgsNineCellFilter )
+#include "testqgsninecellfilter.moc"
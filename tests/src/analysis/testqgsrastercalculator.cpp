@@ -16,12 +16,16 @@ Email                : nyall dot dawson at gmail dot com
 
 #include "qgsrastercalculator.h"
 #include "qgsrastercalcnode.h"
+#include "qgsrastercalcprogram.h"
 #include "qgsrasterdataprovider.h"
 #include "qgsrasterlayer.h"
 #include "qgsrastermatrix.h"
 #include "qgsapplication.h"
 #include "qgsproject.h"
 
+#include <cmath>
+#include <memory>
+
 Q_DECLARE_METATYPE( QgsRasterCalcNode::Operator )
 
 
@@ -55,7 +59,10 @@ class TestQgsRasterCalculator : public QObject
     void rasterRefOp();
     void dualOpRasterRaster(); //test dual op on raster ref and raster ref
 
+    void compiledProgram_data();
+    void compiledProgram(); //test compiled programs against the node tree
     void calcWithLayers();
+    void calcWithLayersTiles(); //test calculation split in several tiles
     void calcWithReprojectedLayers();
 
   private:
@@ -421,6 +428,71 @@ void TestQgsRasterCalculator::dualOpRasterRaster()
   QCOMPARE( result.data()[5], -9999.0 );
 }
 
+void TestQgsRasterCalculator::compiledProgram_data()
+{
+  QTest::addColumn< QString >( "formula" );
+
+  QTest::newRow( "raster" ) << QStringLiteral( "\"raster1\"" );
+  QTest::newRow( "number" ) << QStringLiteral( "3 * 2 + 1" );
+  QTest::newRow( "raster and number" ) << QStringLiteral( "\"raster1\" * 2 - 1" );
+  QTest::newRow( "number and raster" ) << QStringLiteral( "10 / \"raster1\"" );
+  QTest::newRow( "raster and raster" ) << QStringLiteral( "\"raster1\" + \"raster2\" * \"raster1\"" );
+  QTest::newRow( "functions" ) << QStringLiteral( "sqrt( \"raster1\" ) + log10( \"raster2\" ) - sin( 2 )" );
+  QTest::newRow( "power" ) << QStringLiteral( "\"raster1\" ^ ( 0.5 + \"raster2\" )" );
+  QTest::newRow( "logical" ) << QStringLiteral( "( \"raster1\" > 1 AND \"raster2\" <= 13 ) OR \"raster1\" = -2" );
+  QTest::newRow( "sign" ) << QStringLiteral( "-\"raster2\" / ( \"raster1\" - \"raster1\" )" );
+}
+
+void TestQgsRasterCalculator::compiledProgram()
+{
+  QFETCH( QString, formula );
+
+  QgsRasterBlock m1( Qgis::Float32, 4, 5 );
+  m1.setNoDataValue( -1.0 );
+  QgsRasterBlock m2( Qgis::Float32, 4, 5 );
+  m2.setNoDataValue( -2.0 );
+  for ( int i = 0; i < 20; ++i )
+  {
+    m1.setValue( i / 4, i % 4, ( i * 7 ) % 9 - 2.0 );
+    m2.setValue( i / 4, i % 4, ( i * 5 ) % 17 - 2.0 );
+  }
+  QMap<QString, QgsRasterBlock *> rasterData;
+  rasterData.insert( QStringLiteral( "raster1" ), &m1 );
+  rasterData.insert( QStringLiteral( "raster2" ), &m2 );
+
+  QString error;
+  std::unique_ptr< QgsRasterCalcNode > node( QgsRasterCalcNode::parseRasterCalcString( formula, error ) );
+  QVERIFY( node.get() );
+
+  QgsRasterCalcProgram program( node.get(), -9999 );
+  QVERIFY( program.isValid() );
+  QVector< QgsRasterBlock * > inputs;
+  Q_FOREACH ( const QString &name, program.rasterNames() )
+    inputs << rasterData.value( name );
+
+  //evaluate in two tiles, reusing the scratch buffers
+  QVector< float > values( 20 );
+  QVector< QVector< double > > scratch;
+  program.evaluate( inputs, 0, 2, 4, scratch, values.data() );
+  program.evaluate( inputs, 2, 3, 4, scratch, values.data() + 8 );
+
+  QgsRasterMatrix result;
+  result.setNodataValue( -9999 );
+  for ( int row = 0; row < 5; ++row )
+  {
+    QVERIFY( node->calculate( rasterData, result, row ) );
+    for ( int col = 0; col < 4; ++col )
+    {
+      const float expected = static_cast< float >( result.isNumber() ? result.number() : result.data()[col] );
+      const float actual = values.at( row * 4 + col );
+      if ( std::isnan( expected ) )
+        QVERIFY( std::isnan( actual ) );
+      else
+        QCOMPARE( actual, expected );
+    }
+  }
+}
+
 void TestQgsRasterCalculator::calcWithLayers()
 {
   QgsRasterCalculatorEntry entry1;
@@ -532,5 +604,50 @@ void TestQgsRasterCalculator::calcWithReprojectedLayers()
   delete block;
 }
 
+void TestQgsRasterCalculator::calcWithLayersTiles()
+{
+  QgsRasterCalculatorEntry entry1;
+  entry1.bandNumber = 1;
+  entry1.raster = mpLandsatRasterLayer;
+  entry1.ref = QStringLiteral( "landsat@1" );
+
+  QVector<QgsRasterCalculatorEntry> entries;
+  entries << entry1;
+
+  QgsCoordinateReferenceSystem crs;
+  crs.createFromId( 32633, QgsCoordinateReferenceSystem::EpsgCrsId );
+  QgsRectangle extent( 781662, 3339523, 793062, 3350923 );
+
+  QTemporaryFile tmpFile;
+  tmpFile.open(); // fileName is no avialable until open
+  QString tmpName = tmpFile.fileName();
+  tmpFile.close();
+
+  //large enough for several tiles
+  const int columns = 300;
+  const int rows = 700;
+  QgsRasterCalculator rc( QStringLiteral( "\"landsat@1\" * 2 + 1" ),
+                          tmpName,
+                          QStringLiteral( "GTiff" ),
+                          extent, crs, columns, rows, entries );
+  QCOMPARE( rc.processCalculation(), 0 );
+
+  std::unique_ptr< QgsRasterBlock > input( mpLandsatRasterLayer->dataProvider()->block( 1, extent, columns, rows ) );
+  std::unique_ptr< QgsRasterLayer > result( new QgsRasterLayer( tmpName, QStringLiteral( "result" ) ) );
+  QCOMPARE( result->width(), columns );
+  QCOMPARE( result->height(), rows );
+  std::unique_ptr< QgsRasterBlock > block( result->dataProvider()->block( 1, extent, columns, rows ) );
+  for ( int row = 0; row < rows; ++row )
+  {
+    for ( int col = 0; col < columns; ++col )
+    {
+      if ( input->isNoData( row, col ) )
+        QVERIFY( block->isNoData( row, col ) );
+      else
+        QCOMPARE( block->value( row, col ), input->value( row, col ) * 2 + 1 );
+    }
+  }
+}
+
 QGSTEST_MAIN( TestQgsRasterCalculator )
 #include "testqgsrastercalculator.moc"
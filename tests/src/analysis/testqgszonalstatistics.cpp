@@ -14,14 +14,21 @@
  ***************************************************************************/
 
 #include <QDir>
+#include <QTemporaryDir>
 #include "qgstest.h"
 
 #include "qgsapplication.h"
 #include "qgsfeatureiterator.h"
+#include "qgsvectordataprovider.h"
 #include "qgsvectorlayer.h"
 #include "qgsrasterlayer.h"
 #include "qgszonalstatistics.h"
 #include "qgsproject.h"
+#include "qgsgeometry.h"
+
+#include <gdal.h>
+
+#include <cmath>
 
 /** \ingroup UnitTests
  * This is a unit test for the zonal statistics class
@@ -37,6 +44,7 @@ class TestQgsZonalStatistics : public QObject
     void cleanup() {}
 
     void testStatistics();
+    void testMethods();
 
   private:
     QgsVectorLayer *mVectorLayer = nullptr;
@@ -181,5 +189,93 @@ void TestQgsZonalStatistics::testStatistics()
   QCOMPARE( f.attribute( "myqgis2__4" ).toDouble(), 0.13888888888889 );
 }
 
+void TestQgsZonalStatistics::testMethods()
+{
+  //a raster with several cache blocks and polygons of varying size, with holes and multiple parts
+  QTemporaryDir tempDir;
+  const QString rasterFile = tempDir.path() + "/values.tif";
+  const int xSize = 600;
+  const int ySize = 300;
+  QVector< float > values( xSize * ySize );
+  for ( int i = 0; i < values.size(); ++i )
+    values[i] = i % 89 == 0 ? -9999 : ( i * 37 ) % 101;
+
+  GDALDatasetH dataset = GDALCreate( GDALGetDriverByName( "GTiff" ), rasterFile.toUtf8().constData(), xSize, ySize, 1, GDT_Float32, nullptr );
+  QVERIFY( dataset );
+  double geoTransform[6] = { 0, 10, 0, 3000, 0, -10 };
+  GDALSetGeoTransform( dataset, geoTransform );
+  GDALRasterBandH band = GDALGetRasterBand( dataset, 1 );
+  GDALSetRasterNoDataValue( band, -9999 );
+  QCOMPARE( GDALRasterIO( band, GF_Write, 0, 0, xSize, ySize, values.data(), xSize, ySize, GDT_Float32, 0, 0 ), CE_None );
+  GDALClose( dataset );
+  QgsRasterLayer rasterLayer( rasterFile, QStringLiteral( "raster" ), QStringLiteral( "gdal" ) );
+  QVERIFY( rasterLayer.isValid() );
+
+  QgsVectorLayer polygonLayer( QStringLiteral( "MultiPolygon?field=id:integer" ), QStringLiteral( "polygons" ), QStringLiteral( "memory" ) );
+  QVERIFY( polygonLayer.isValid() );
+  QgsFeatureList features;
+  for ( int i = 0; i < 200; ++i )
+  {
+    const double centerX = -300 + std::fmod( i * 733.37, 6600 );
+    const double centerY = -200 + std::fmod( i * 451.13, 3400 );
+    const double radius = 3.3 + ( i % 17 ) * ( i % 5 == 0 ? 71.7 : 7.9 );
+    QString wkt = QStringLiteral( "MultiPolygon(((" );
+    const int vertices = 3 + i % 11;
+    for ( int v = 0; v <= vertices; ++v )
+    {
+      const double angle = 2 * M_PI * ( v % vertices ) / vertices;
+      const double r = radius * ( ( v % vertices ) % 2 == 0 ? 1.0 : 0.55 );
+      wkt += QStringLiteral( "%1 %2," ).arg( centerX + r * std::cos( angle ), 0, 'f', 6 ).arg( centerY + r * std::sin( angle ), 0, 'f', 6 );
+    }
+    wkt.chop( 1 );
+    wkt += ')';
+    if ( i % 3 == 0 && vertices >= 8 )
+      wkt += QStringLiteral( ",(%1 %2,%3 %2,%3 %4,%1 %2)" ).arg( centerX - radius * 0.2 ).arg( centerY - radius * 0.2 ).arg( centerX + radius * 0.3 ).arg( centerY + radius * 0.25 );
+    wkt += ')';
+    if ( i % 4 == 0 )
+      wkt += QStringLiteral( ",((%1 %2,%3 %2,%3 %4,%1 %4,%1 %2))" ).arg( centerX + radius * 1.5 ).arg( centerY + 0.37 ).arg( centerX + radius * 2.5 + 13.3 ).arg( centerY + radius + 27.1 );
+    wkt += ')';
+
+    QgsFeature f( polygonLayer.fields() );
+    f.setAttribute( 0, i );
+    f.setGeometry( QgsGeometry::fromWkt( wkt ) );
+    QVERIFY( f.hasGeometry() );
+    features << f;
+  }
+  QVERIFY( polygonLayer.dataProvider()->addFeatures( features ) );
+
+  QgsZonalStatistics middlePoint( &polygonLayer, &rasterLayer, QStringLiteral( "m" ), 1, QgsZonalStatistics::All );
+  middlePoint.setMethod( QgsZonalStatistics::MiddlePointTest );
+  QCOMPARE( middlePoint.calculateStatistics( nullptr ), 0 );
+
+  QgsZonalStatistics scanline( &polygonLayer, &rasterLayer, QStringLiteral( "s" ), 1, QgsZonalStatistics::All );
+  QCOMPARE( scanline.method(), QgsZonalStatistics::Scanline );
+  scanline.setThreadCount( 1 );
+  QCOMPARE( scanline.calculateStatistics( nullptr ), 0 );
+
+  QgsZonalStatistics threaded( &polygonLayer, &rasterLayer, QStringLiteral( "t" ), 1, QgsZonalStatistics::All );
+  threaded.setThreadCount( 4 );
+  QCOMPARE( threaded.calculateStatistics( nullptr ), 0 );
+
+  const QStringList statistics = QStringList() << QStringLiteral( "count" ) << QStringLiteral( "sum" ) << QStringLiteral( "mean" )
+                                 << QStringLiteral( "median" ) << QStringLiteral( "stdev" ) << QStringLiteral( "min" )
+                                 << QStringLiteral( "max" ) << QStringLiteral( "range" ) << QStringLiteral( "minority" )
+                                 << QStringLiteral( "majority" ) << QStringLiteral( "variety" ) << QStringLiteral( "variance" );
+  int featuresWithCells = 0;
+  QgsFeature f;
+  QgsFeatureIterator it = polygonLayer.getFeatures();
+  while ( it.nextFeature( f ) )
+  {
+    if ( f.attribute( "mcount" ).toDouble() > 1 )
+      ++featuresWithCells;
+    for ( const QString &statistic : statistics )
+    {
+      QCOMPARE( f.attribute( 's' + statistic ), f.attribute( 'm' + statistic ) );
+      QCOMPARE( f.attribute( 't' + statistic ), f.attribute( 'm' + statistic ) );
+    }
+  }
+  QVERIFY( featuresWithCells > 100 );
+}
+
 QGSTEST_MAIN( TestQgsZonalStatistics )
 #include "testqgszonalstatistics.moc"
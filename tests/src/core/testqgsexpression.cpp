@@ -17,6 +17,8 @@
 #include <QString>
 #include <QtConcurrentMap>
 
+#include <limits>
+
 #include <qgsapplication.h>
 //header for class being tested
 #include "qgsexpression.h"
@@ -44,6 +46,67 @@ static void _parseAndEvalExpr( int arg )
   }
 }
 
+struct CompiledEvaluation
+{
+  QgsExpression expression;
+  QgsExpressionContext context;
+  QList<QgsFeature> features;
+  bool block;
+  QVariantList results;
+};
+
+static void _evaluateCompiled( CompiledEvaluation &evaluation )
+{
+  if ( evaluation.block )
+  {
+    evaluation.results = evaluation.expression.evaluateFeatures( evaluation.features, &evaluation.context );
+    return;
+  }
+  Q_FOREACH ( const QgsFeature &feature, evaluation.features )
+  {
+    evaluation.context.setFeature( feature );
+    evaluation.results << evaluation.expression.evaluate( &evaluation.context );
+  }
+}
+
+//! Iterator over a list of features, counting the features fetched from it
+class CountingFeatureIterator : public QgsAbstractFeatureIterator
+{
+  public:
+    CountingFeatureIterator( const QgsFeatureRequest &request, const QgsFeatureList &features, int *fetched )
+      : QgsAbstractFeatureIterator( request )
+      , mFeatures( features )
+      , mFetched( fetched )
+    {}
+
+    bool rewind() override
+    {
+      mIndex = 0;
+      return true;
+    }
+
+    bool close() override
+    {
+      mClosed = true;
+      return true;
+    }
+
+  protected:
+    bool fetchFeature( QgsFeature &f ) override
+    {
+      if ( mIndex >= mFeatures.size() )
+        return false;
+      f = mFeatures.at( mIndex++ );
+      ++*mFetched;
+      return true;
+    }
+
+  private:
+    QgsFeatureList mFeatures;
+    int mIndex = 0;
+    int *mFetched = nullptr;
+};
+
 class TestQgsExpression: public QObject
 {
     Q_OBJECT
@@ -1340,6 +1403,102 @@ class TestQgsExpression: public QObject
       }
     }
 
+    void eval_get_feature_context_data()
+    {
+      eval_get_feature_data();
+    }
+
+    void eval_get_feature_context()
+    {
+      QFETCH( QString, string );
+      QFETCH( bool, featureMatched );
+      QFETCH( int, featureId );
+
+      // with a context the lookups are answered by an index
+      QgsExpressionContext context;
+      QgsExpression exp( string );
+      QVERIFY( exp.prepare( &context ) );
+      for ( int i = 0; i < 2; ++i )
+      {
+        QVariant res = exp.evaluate( &context );
+        QCOMPARE( exp.hasEvalError(), false );
+        QCOMPARE( res.canConvert<QgsFeature>(), featureMatched );
+        if ( featureMatched )
+          QCOMPARE( res.value<QgsFeature>().id(), ( long long )featureId );
+      }
+    }
+
+    void eval_get_feature_index_edits()
+    {
+      QgsExpressionContext context;
+      QgsExpression exp( QStringLiteral( "attribute(get_feature('test','col1',12), 'col2')" ) );
+      QVERIFY( exp.prepare( &context ) );
+      QVERIFY( exp.evaluate( &context ).isNull() );
+
+      // the index follows the edits of the layer
+      QVERIFY( mMemoryLayer->startEditing() );
+      QVERIFY( mMemoryLayer->changeAttributeValue( 2, 0, 12 ) );
+      QCOMPARE( exp.evaluate( &context ).toString(), QStringLiteral( "test2" ) );
+      QVERIFY( mMemoryLayer->rollBack() );
+      QVERIFY( exp.evaluate( &context ).isNull() );
+
+      // numeric values match as numbers
+      QgsExpression numeric( QStringLiteral( "get_feature('test','col1','11.0')" ) );
+      QVERIFY( numeric.prepare( &context ) );
+      QCOMPARE( numeric.evaluate( &context ).value<QgsFeature>().id(), 2LL );
+    }
+
+    void eval_get_feature_string_keys()
+    {
+      QgsVectorLayer *layer = new QgsVectorLayer( QStringLiteral( "Point?field=code:string&field=num:double" ), QStringLiteral( "codes" ), QStringLiteral( "memory" ) );
+      QVERIFY( layer->isValid() );
+      QgsFeatureList features;
+      const QStringList codes = QStringList() << QStringLiteral( "1" ) << QStringLiteral( "01" ) << QStringLiteral( "1.0" ) << QStringLiteral( "abc" );
+      for ( int i = 0; i < codes.size(); ++i )
+      {
+        QgsFeature f( layer->dataProvider()->fields(), i + 1 );
+        f.setAttributes( QgsAttributes() << codes.at( i ) << ( i + 1 ) * 1.5 );
+        features << f;
+      }
+      layer->dataProvider()->addFeatures( features );
+      QgsProject::instance()->addMapLayer( layer );
+
+      QList< QPair< QString, QVariant > > lookups;
+      // string fields match the exact string
+      lookups << qMakePair( QStringLiteral( "get_feature('codes','code','1')" ), QVariant( 1LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','code',1)" ), QVariant( 1LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','code','01')" ), QVariant( 2LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','code','1.0')" ), QVariant( 3LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','code','abc')" ), QVariant( 4LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','code','001')" ), QVariant() )
+              << qMakePair( QStringLiteral( "get_feature('codes','code','1.00')" ), QVariant() )
+              // numeric fields match numbers
+              << qMakePair( QStringLiteral( "get_feature('codes','num','1.5')" ), QVariant( 1LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','num','03.00')" ), QVariant( 2LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','num',4.5)" ), QVariant( 3LL ) )
+              << qMakePair( QStringLiteral( "get_feature('codes','num','x')" ), QVariant() );
+
+      // without a context, with the first lookup of a context, which uses a request, and with the index
+      QgsExpressionContext context;
+      for ( int pass = 0; pass < 3; ++pass )
+      {
+        for ( int i = 0; i < lookups.size(); ++i )
+        {
+          QgsExpression exp( lookups.at( i ).first );
+          QVERIFY( exp.prepare( &context ) );
+          const QVariant res = pass == 0 ? exp.evaluate() : exp.evaluate( &context );
+          const QVariant expected = lookups.at( i ).second;
+          const QString message = QStringLiteral( "%1, pass %2" ).arg( lookups.at( i ).first ).arg( pass );
+          QVERIFY2( !exp.hasEvalError(), message.toLocal8Bit().constData() );
+          QVERIFY2( res.canConvert<QgsFeature>() == expected.isValid(), message.toLocal8Bit().constData() );
+          if ( expected.isValid() )
+            QVERIFY2( res.value<QgsFeature>().id() == expected.toLongLong(), message.toLocal8Bit().constData() );
+        }
+      }
+
+      QgsProject::instance()->removeMapLayer( layer->id() );
+    }
+
     void aggregate_data()
     {
       QTest::addColumn<QString>( "string" );
@@ -2236,6 +2395,103 @@ class TestQgsExpression: public QObject
       QCOMPARE( out.toInt(), result.toInt() );
     }
 
+    void eval_spatial_operator_prepared()
+    {
+      const QString constant = QStringLiteral( "POLYGON((0 0, 10 0, 10 10, 0 10, 0 0))" );
+      const QgsGeometry constantGeom = QgsGeometry::fromWkt( constant );
+
+      // inside, outside, on the boundary, crossing, containing, overlapping, and disjoint
+      // with an intersecting bounding box
+      QStringList wkts;
+      wkts << QStringLiteral( "POINT(5 5)" )
+           << QStringLiteral( "POINT(20 20)" )
+           << QStringLiteral( "POINT(10 5)" )
+           << QStringLiteral( "LINESTRING(-5 5, 5 5)" )
+           << QStringLiteral( "POLYGON((2 2, 4 2, 4 4, 2 4, 2 2))" )
+           << QStringLiteral( "POLYGON((-1 -1, 11 -1, 11 11, -1 11, -1 -1))" )
+           << QStringLiteral( "POLYGON((5 5, 15 5, 15 15, 5 15, 5 5))" )
+           << QStringLiteral( "LINESTRING(9.5 11, 11 9.5)" );
+      QgsFeatureList features;
+      Q_FOREACH ( const QString &wkt, wkts )
+      {
+        QgsFeature f;
+        f.setGeometry( QgsGeometry::fromWkt( wkt ) );
+        features << f;
+      }
+
+      QStringList predicates;
+      predicates << QStringLiteral( "intersects" ) << QStringLiteral( "disjoint" ) << QStringLiteral( "touches" )
+                 << QStringLiteral( "crosses" ) << QStringLiteral( "contains" ) << QStringLiteral( "overlaps" )
+                 << QStringLiteral( "within" );
+      Q_FOREACH ( const QString &predicate, predicates )
+      {
+        // the constant is the first and the second operand, so the prepared engine is used
+        // for both the predicate and its converse
+        for ( int constantFirst = 0; constantFirst < 2; ++constantFirst )
+        {
+          const QString string = constantFirst ? QStringLiteral( "%1( geom_from_wkt('%2'), $geometry )" ).arg( predicate, constant )
+                                 : QStringLiteral( "%1( $geometry, geom_from_wkt('%2') )" ).arg( predicate, constant );
+
+          QVariantList expected;
+          Q_FOREACH ( const QgsFeature &f, features )
+          {
+            const QgsGeometry first = constantFirst ? constantGeom : f.geometry();
+            const QgsGeometry second = constantFirst ? f.geometry() : constantGeom;
+            bool result = false;
+            if ( predicate == QLatin1String( "intersects" ) )
+              result = first.intersects( second );
+            else if ( predicate == QLatin1String( "disjoint" ) )
+              result = first.disjoint( second );
+            else if ( predicate == QLatin1String( "touches" ) )
+              result = first.touches( second );
+            else if ( predicate == QLatin1String( "crosses" ) )
+              result = first.crosses( second );
+            else if ( predicate == QLatin1String( "contains" ) )
+              result = first.contains( second );
+            else if ( predicate == QLatin1String( "overlaps" ) )
+              result = first.overlaps( second );
+            else
+              result = first.within( second );
+            expected << ( result ? 1 : 0 );
+          }
+
+          // the constant is prepared once it is seen again, so the features are evaluated twice
+          QgsExpressionContext context = QgsExpressionContextUtils::createFeatureBasedContext( features.first(), QgsFields() );
+          QgsExpression exp( string );
+          QVERIFY( exp.prepare( &context ) );
+          for ( int pass = 0; pass < 2; ++pass )
+          {
+            for ( int i = 0; i < features.size(); ++i )
+            {
+              context.setFeature( features.at( i ) );
+              const QVariant out = exp.evaluate( &context );
+              QVERIFY2( !exp.hasEvalError(), string.toLocal8Bit().constData() );
+              QVERIFY2( out.toInt() == expected.at( i ).toInt(), QStringLiteral( "%1 with %2, pass %3" ).arg( string, wkts.at( i ) ).arg( pass ).toLocal8Bit().constData() );
+            }
+          }
+
+          // context copies share the prepared geometries and evaluate in several threads
+          QList< CompiledEvaluation > evaluations;
+          for ( int i = 0; i < 8; ++i )
+          {
+            CompiledEvaluation evaluation;
+            evaluation.expression = exp;
+            evaluation.context = context;
+            for ( int j = 0; j < 50; ++j )
+              evaluation.features << features;
+            evaluation.block = false;
+            evaluations << evaluation;
+          }
+          QtConcurrent::blockingMap( evaluations, _evaluateCompiled );
+          Q_FOREACH ( const CompiledEvaluation &evaluation, evaluations )
+          {
+            for ( int i = 0; i < evaluation.results.size(); ++i )
+              QCOMPARE( evaluation.results.at( i ).toInt(), expected.at( i % features.size() ).toInt() );
+          }
+        }
+      }
+    }
+
     void eval_geometry_method_data()
     {
       QTest::addColumn<QString>( "string" );
@@ -2759,6 +3015,304 @@ class TestQgsExpression: public QObject
       QCOMPARE( result.toString(), QString( "f2" ) );
     }
 
+    void compiled_evaluation_data()
+    {
+      evaluation_data();
+    }
+
+    void compiled_evaluation()
+    {
+      QFETCH( QString, string );
+
+      QgsExpressionContext context;
+      QgsExpression tree( string );
+      tree.prepare( &context );
+      QVariant expected = tree.evaluate( &context );
+
+      QgsExpression compiled( string );
+      compiled.prepare( &context );
+      QVERIFY( compiled.compile( &context ) );
+      QVERIFY( compiled.isCompiled() );
+      QVariant result = compiled.evaluate( &context );
+
+      QCOMPARE( compiled.hasEvalError(), tree.hasEvalError() );
+      QCOMPARE( compiled.evalErrorString(), tree.evalErrorString() );
+      QCOMPARE( result.type(), expected.type() );
+      QCOMPARE( result.isNull(), expected.isNull() );
+      QCOMPARE( result.toString(), expected.toString() );
+    }
+
+    void compiled_columns()
+    {
+      QgsFields fields;
+      fields.append( QgsField( QStringLiteral( "x1" ), QVariant::Int ) );
+      fields.append( QgsField( QStringLiteral( "x2" ), QVariant::Double ) );
+      fields.append( QgsField( QStringLiteral( "x3" ), QVariant::String ) );
+      fields.append( QgsField( QStringLiteral( "x4" ), QVariant::LongLong ) );
+
+      QList< QgsFeature > features;
+      QgsFeature f1( fields, 1 );
+      f1.setAttributes( QgsAttributes() << 20 << QVariant( QVariant::Double ) << QStringLiteral( "5" ) << QVariant( 7LL ) );
+      features << f1;
+      QgsFeature f2( fields, 2 );
+      f2.setAttributes( QgsAttributes() << QVariant( QVariant::Int ) << 3.5 << QStringLiteral( "abc" ) << QVariant( -2LL ) );
+      features << f2;
+      QgsFeature f3( fields, 3 );
+      f3.setAttributes( QgsAttributes() << 0 << std::numeric_limits<double>::quiet_NaN() << QVariant( QVariant::String ) << QVariant( 0LL ) );
+      features << f3;
+
+      QStringList expressions;
+      expressions << QStringLiteral( "x1 + x4" )
+                  << QStringLiteral( "x1 * 2.5 - x2" )
+                  << QStringLiteral( "x1 / x4" )
+                  << QStringLiteral( "x1 % x4" )
+                  << QStringLiteral( "x1 // 3" )
+                  << QStringLiteral( "x2 ^ 2" )
+                  << QStringLiteral( "-x1" )
+                  << QStringLiteral( "-x2" )
+                  << QStringLiteral( "-x3" )
+                  << QStringLiteral( "not x1" )
+                  << QStringLiteral( "x1 > x4 and x2 is not null" )
+                  << QStringLiteral( "x1 < 10 or x2 >= 3.5" )
+                  << QStringLiteral( "x3 || 'a'" )
+                  << QStringLiteral( "x3 + x1" )
+                  << QStringLiteral( "x3 = '5'" )
+                  << QStringLiteral( "x3 = 5" )
+                  << QStringLiteral( "x1 is x4" )
+                  << QStringLiteral( "x1 in (1, 2, 20)" )
+                  << QStringLiteral( "x3 not in ('a', 'abc', NULL)" )
+                  << QStringLiteral( "x2 in (3.5, 'x')" )
+                  << QStringLiteral( "case when x1 > 10 then 'big' when x1 is null then x3 else x2 end" )
+                  << QStringLiteral( "case when x2 then 1 end" )
+                  << QStringLiteral( "abs(x1 - 30) + round(x2)" )
+                  << QStringLiteral( "coalesce(x1, x4) * 2" )
+                  << QStringLiteral( "if(x1 > 5, x3, 'small')" )
+                  << QStringLiteral( "to_int(x3) + x1" )
+                  << QStringLiteral( "x3 like 'a%'" )
+                  << QStringLiteral( "$id * 2 + x1" )
+                  << QStringLiteral( "unknown + 1" );
+
+      Q_FOREACH ( const QString &string, expressions )
+      {
+        QgsExpressionContext context = QgsExpressionContextUtils::createFeatureBasedContext( features.first(), fields );
+        QgsExpression tree( string );
+        tree.prepare( &context );
+        QgsExpression compiled( string );
+        compiled.prepare( &context );
+        QVERIFY( compiled.compile( &context ) );
+
+        Q_FOREACH ( const QgsFeature &feature, features )
+        {
+          context.setFeature( feature );
+          QVariant expected = tree.evaluate( &context );
+          QVariant result = compiled.evaluate( &context );
+
+          const QString message = QStringLiteral( "%1 for feature %2" ).arg( string ).arg( feature.id() );
+          QVERIFY2( compiled.evalErrorString() == tree.evalErrorString(), message.toLocal8Bit().constData() );
+          QVERIFY2( result.type() == expected.type(), message.toLocal8Bit().constData() );
+          QVERIFY2( result.isNull() == expected.isNull(), message.toLocal8Bit().constData() );
+          QVERIFY2( result.toString() == expected.toString(), message.toLocal8Bit().constData() );
+        }
+      }
+
+      // preparing again discards the program
+      QgsExpression exp( QStringLiteral( "x1 + 1" ) );
+      QgsExpressionContext context = QgsExpressionContextUtils::createFeatureBasedContext( f1, fields );
+      exp.prepare( &context );
+      QVERIFY( exp.compile( &context ) );
+      QgsExpression copy( exp );
+      QVERIFY( copy.isCompiled() );
+      QCOMPARE( copy.evaluate( &context ).toLongLong(), 21LL );
+      copy.prepare( &context );
+      QVERIFY( !copy.isCompiled() );
+      QVERIFY( exp.isCompiled() );
+      QCOMPARE( copy.evaluate( &context ).toLongLong(), 21LL );
+    }
+
+    void evaluate_features()
+    {
+      QgsFields fields;
+      fields.append( QgsField( QStringLiteral( "x1" ), QVariant::Int ) );
+      fields.append( QgsField( QStringLiteral( "x2" ), QVariant::Double ) );
+      fields.append( QgsField( QStringLiteral( "x3" ), QVariant::String ) );
+
+      // more features than a block
+      QList< QgsFeature > features;
+      for ( int i = 0; i < 2500; ++i )
+      {
+        QgsFeature f( fields, i );
+        f.setAttributes( QgsAttributes() << ( i % 7 == 0 ? QVariant( QVariant::Int ) : QVariant( i ) )
+                         << static_cast< double >( i % 100 ) / 4
+                         << ( i % 1000 == 999 ? QStringLiteral( "abc" ) : QString::number( i % 13 ) ) );
+        features << f;
+      }
+
+      QStringList expressions;
+      expressions << QStringLiteral( "x1 * 2 + x2" )
+                  << QStringLiteral( "x1 > 1000 and x2 < 10 or x1 is null" )
+                  << QStringLiteral( "x1 in (1, 5, 1024, 2048)" )
+                  << QStringLiteral( "case when x2 > 20 then x3 when x1 % 2 = 0 then 'even' end" )
+                  << QStringLiteral( "coalesce(x1, -1) + to_int(x3)" )
+                  << QStringLiteral( "$id - x1" )
+                  << QStringLiteral( "x3 + x2" );
+
+      Q_FOREACH ( const QString &string, expressions )
+      {
+        QgsExpressionContext context = QgsExpressionContextUtils::createFeatureBasedContext( features.first(), fields );
+        QgsExpression tree( string );
+        tree.prepare( &context );
+
+        QVariantList expected;
+        QString expectedError;
+        Q_FOREACH ( const QgsFeature &feature, features )
+        {
+          context.setFeature( feature );
+          expected << tree.evaluate( &context );
+          if ( expectedError.isNull() )
+            expectedError = tree.evalErrorString();
+        }
+
+        // evaluated feature by feature without a program, in blocks with a program
+        QgsExpression batch( string );
+        batch.prepare( &context );
+        for ( int pass = 0; pass < 2; ++pass )
+        {
+          if ( pass == 1 )
+            QVERIFY( batch.compile( &context ) );
+
+          const QVariantList results = batch.evaluateFeatures( features, &context );
+          QCOMPARE( results.size(), expected.size() );
+          QCOMPARE( batch.evalErrorString(), expectedError );
+          for ( int i = 0; i < results.size(); ++i )
+          {
+            const QString message = QStringLiteral( "%1 for feature %2" ).arg( string ).arg( i );
+            QVERIFY2( results.at( i ).type() == expected.at( i ).type(), message.toLocal8Bit().constData() );
+            QVERIFY2( results.at( i ).isNull() == expected.at( i ).isNull(), message.toLocal8Bit().constData() );
+            QVERIFY2( results.at( i ).toString() == expected.at( i ).toString(), message.toLocal8Bit().constData() );
+          }
+        }
+      }
+
+      QgsExpression empty( QStringLiteral( "x1 +" ) );
+      QgsExpressionContext context;
+      QCOMPARE( empty.evaluateFeatures( features.mid( 0, 3 ), &context ).size(), 3 );
+      QVERIFY( empty.hasEvalError() );
+    }
+
+    void filter_blocks()
+    {
+      QgsFields fields;
+      fields.append( QgsField( QStringLiteral( "x" ), QVariant::Int ) );
+      QgsFeatureList features;
+      for ( int i = 0; i < 3000; ++i )
+      {
+        QgsFeature f( fields, i );
+        f.setAttributes( QgsAttributes() << i );
+        features << f;
+      }
+
+      QgsExpressionContext context;
+      context.setFields( fields );
+
+      Q_FOREACH ( const QString &filter, QStringList() << QStringLiteral( "x >= 0" ) << QStringLiteral( "x % 2 = 0" ) )
+      {
+        // by default, an iterator stopped early fetches no feature after the last one it returned
+        QgsFeatureRequest request;
+        request.setFilterExpression( filter );
+        request.setExpressionContext( context );
+        int fetched = 0;
+        QgsFeatureIterator it( new CountingFeatureIterator( request, features, &fetched ) );
+        QgsFeature f;
+        QList< QgsFeatureId > ids;
+        for ( int i = 0; i < 3 && it.nextFeature( f ); ++i )
+          ids << f.id();
+        QCOMPARE( ids.size(), 3 );
+        QCOMPARE( fetched, static_cast< int >( ids.last() ) + 1 );
+        it.close();
+
+        // all the features read by blocks are the same as feature by feature
+        QList< QgsFeatureId > expected;
+        request.setExpressionContext( context );
+        fetched = 0;
+        it = QgsFeatureIterator( new CountingFeatureIterator( request, features, &fetched ) );
+        while ( it.nextFeature( f ) )
+          expected << f.id();
+
+        request.setFlags( QgsFeatureRequest::EvaluateFilterInBlocks );
+        request.setExpressionContext( context );
+        fetched = 0;
+        QList< QgsFeatureId > blockIds;
+        it = QgsFeatureIterator( new CountingFeatureIterator( request, features, &fetched ) );
+        while ( it.nextFeature( f ) )
+          blockIds << f.id();
+        QCOMPARE( blockIds, expected );
+        QCOMPARE( fetched, features.size() );
+
+        // blocks never fetch more features than the limit of the request
+        request.setLimit( 3 );
+        request.setExpressionContext( context );
+        fetched = 0;
+        ids.clear();
+        it = QgsFeatureIterator( new CountingFeatureIterator( request, features, &fetched ) );
+        while ( it.nextFeature( f ) )
+          ids << f.id();
+        QCOMPARE( ids, expected.mid( 0, 3 ) );
+        QVERIFY( fetched <= static_cast< int >( ids.last() ) + 1 );
+      }
+    }
+
+    void compiled_concurrent()
+    {
+      QgsFields fields;
+      fields.append( QgsField( QStringLiteral( "x1" ), QVariant::Int ) );
+      fields.append( QgsField( QStringLiteral( "x2" ), QVariant::Double ) );
+      fields.append( QgsField( QStringLiteral( "x3" ), QVariant::String ) );
+
+      QList< QgsFeature > features;
+      for ( int i = 0; i < 3000; ++i )
+      {
+        QgsFeature f( fields, i );
+        f.setAttributes( QgsAttributes() << i << i / 8.0 << QString::number( i % 97 ) );
+        features << f;
+      }
+
+      const QString string = QStringLiteral( "case when x1 % 3 = 0 then x1 * 2 + x2 else length(x3) - x2 end" );
+      QgsExpressionContext context = QgsExpressionContextUtils::createFeatureBasedContext( features.first(), fields );
+      QgsExpression tree( string );
+      tree.prepare( &context );
+      QVariantList expected;
+      Q_FOREACH ( const QgsFeature &feature, features )
+      {
+        context.setFeature( feature );
+        expected << tree.evaluate( &context );
+      }
+
+      QgsExpression compiled( string );
+      compiled.prepare( &context );
+      QVERIFY( compiled.compile( &context ) );
+
+      // copies share the program, each one is evaluated by its own thread
+      QList< CompiledEvaluation > evaluations;
+      for ( int i = 0; i < 8; ++i )
+      {
+        CompiledEvaluation evaluation;
+        evaluation.expression = compiled;
+        evaluation.context = context;
+        evaluation.features = features;
+        evaluation.block = i % 2 == 1;
+        evaluations << evaluation;
+      }
+      QtConcurrent::blockingMap( evaluations, _evaluateCompiled );
+
+      Q_FOREACH ( const CompiledEvaluation &evaluation, evaluations )
+      {
+        QVERIFY( evaluation.expression.isCompiled() );
+        QCOMPARE( evaluation.results.size(), expected.size() );
+        for ( int i = 0; i < expected.size(); ++i )
+          QCOMPARE( evaluation.results.at( i ).toDouble(), expected.at( i ).toDouble() );
+      }
+    }
+
     void test_env()
     {
       QgsExpressionContext context;
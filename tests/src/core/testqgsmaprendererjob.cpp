@@ -32,6 +32,10 @@
 #include <qgsfield.h>
 #include <qgis.h> //defines GEOWkt
 #include "qgsmaprenderersequentialjob.h"
+#include "qgsmaprendererparalleljob.h"
+#include "qgspallabeling.h"
+#include "qgsvectorlayerlabeling.h"
+#include "qgsfontutils.h"
 #include <qgsmaplayer.h>
 #include <qgsreadwritecontext.h>
 #include <qgsvectorlayer.h>
@@ -79,6 +83,9 @@ class TestQgsMapRendererJob : public QObject
     void testFourAdjacentTiles_data();
     void testFourAdjacentTiles();
 
+    //! Rendering on the thread pool of a job gives the same image as the global thread pool
+    void testParallelJobMaxThreads();
+
   private:
     QString mEncoding;
     QgsVectorFileWriter::WriterError mError;
@@ -332,6 +339,63 @@ void TestQgsMapRendererJob::testFourAdjacentTiles()
   QVERIFY( result );
 }
 
+void TestQgsMapRendererJob::testParallelJobMaxThreads()
+{
+  QgsVectorLayer *polygonsLayer = new QgsVectorLayer( TEST_DATA_DIR + QStringLiteral( "/france_parts.shp" ), QStringLiteral( "polygons" ), QStringLiteral( "ogr" ) );
+  QgsVectorLayer *linesLayer = new QgsVectorLayer( TEST_DATA_DIR + QStringLiteral( "/lines.shp" ), QStringLiteral( "lines" ), QStringLiteral( "ogr" ) );
+  QgsVectorLayer *pointsLayer = new QgsVectorLayer( TEST_DATA_DIR + QStringLiteral( "/points.shp" ), QStringLiteral( "points" ), QStringLiteral( "ogr" ) );
+  QVERIFY( polygonsLayer->isValid() );
+  QVERIFY( linesLayer->isValid() );
+  QVERIFY( pointsLayer->isValid() );
+
+  // labels are drawn on the thread pool of the job too
+  QgsPalLayerSettings settings;
+  settings.fieldName = QStringLiteral( "Class" );
+  QgsTextFormat format;
+  format.setFont( QgsFontUtils::getStandardTestFont( QStringLiteral( "Bold" ) ) );
+  format.setSize( 12 );
+  settings.setFormat( format );
+  pointsLayer->setLabeling( new QgsVectorLayerSimpleLabeling( settings ) );
+
+  QgsProject::instance()->addMapLayers( QList<QgsMapLayer *>() << polygonsLayer << linesLayer << pointsLayer );
+
+  QgsMapSettings mapSettings;
+  mapSettings.setLayers( QList<QgsMapLayer *>() << pointsLayer << linesLayer << polygonsLayer );
+  mapSettings.setExtent( QgsRectangle( -118, 22, -83, 46 ) );
+  mapSettings.setOutputSize( QSize( 512, 512 ) );
+  mapSettings.setOutputDpi( 96 );
+  mapSettings.setFlag( QgsMapSettings::Antialiasing );
+  mapSettings.setFlag( QgsMapSettings::DrawLabeling );
+
+  QgsMapRendererParallelJob globalPoolJob( mapSettings );
+  QCOMPARE( globalPoolJob.maxThreads(), 0 );
+  globalPoolJob.start();
+  globalPoolJob.waitForFinished();
+  const QImage expected = globalPoolJob.renderedImage();
+  QVERIFY( !expected.isNull() );
+
+  Q_FOREACH ( int maxThreads, QList<int>() << 1 << 2 )
+  {
+    QgsMapRendererParallelJob job( mapSettings );
+    job.setMaxThreads( maxThreads );
+    QCOMPARE( job.maxThreads(), maxThreads );
+    job.start();
+    job.waitForFinished();
+    QVERIFY( job.errors().isEmpty() );
+    QCOMPARE( job.renderedImage(), expected );
+  }
+
+  // the job pool can be dropped again
+  QgsMapRendererParallelJob job( mapSettings );
+  job.setMaxThreads( 2 );
+  job.setMaxThreads( 0 );
+  QCOMPARE( job.maxThreads(), 0 );
+  job.start();
+  job.waitForFinished();
+  QCOMPARE( job.renderedImage(), expected );
+
+  QgsProject::instance()->removeMapLayers( QStringList() << polygonsLayer->id() << linesLayer->id() << pointsLayer->id() );
+}
 
 QGSTEST_MAIN( TestQgsMapRendererJob )
 #include "testqgsmaprendererjob.moc"
@@ -0,0 +1,126 @@
+/***************************************************************************
+  testqgsrasterprojector.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgstest.h"
+#include <QObject>
+#include <QString>
+
+#include "qgsapplication.h"
+#include "qgscoordinatetransform.h"
+#include "qgsrasterblock.h"
+#include "qgsrasterdataprovider.h"
+#include "qgsrasterlayer.h"
+#include "qgsrasterprojector.h"
+
+#include <memory>
+
+/** \ingroup UnitTests
+ * This is a unit test for the QgsRasterProjector class.
+ */
+class TestQgsRasterProjector : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void threads_data();
+    void threads();
+
+  private:
+    QgsRasterBlock *project( QgsRasterProjector::Precision precision, int threadCount );
+
+    QgsRasterLayer *mRasterLayer = nullptr;
+    QgsCoordinateReferenceSystem mDestCrs;
+    QgsRectangle mDestExtent;
+};
+
+//larger than a single stripe of the parallel fill
+static const int WIDTH = 700;
+static const int HEIGHT = 500;
+
+void TestQgsRasterProjector::initTestCase()
+{
+  QgsApplication::init();
+  QgsApplication::initQgis();
+
+  mRasterLayer = new QgsRasterLayer( QStringLiteral( TEST_DATA_DIR ) + "/landsat.tif", QStringLiteral( "landsat" ) );
+  QVERIFY( mRasterLayer->isValid() );
+
+  mDestCrs = QgsCoordinateReferenceSystem( QStringLiteral( "EPSG:4326" ) );
+  QgsCoordinateTransform ct( mRasterLayer->crs(), mDestCrs );
+  mDestExtent = ct.transformBoundingBox( mRasterLayer->extent() );
+  //a bit larger than the raster, to get no data pixels around it
+  mDestExtent.scale( 1.2 );
+}
+
+void TestQgsRasterProjector::cleanupTestCase()
+{
+  delete mRasterLayer;
+  QgsApplication::exitQgis();
+}
+
+QgsRasterBlock *TestQgsRasterProjector::project( QgsRasterProjector::Precision precision, int threadCount )
+{
+  QgsRasterProjector projector;
+  projector.setInput( mRasterLayer->dataProvider() );
+  projector.setCrs( mRasterLayer->crs(), mDestCrs );
+  projector.setPrecision( precision );
+  projector.setThreadCount( threadCount );
+  return projector.block( 1, mDestExtent, WIDTH, HEIGHT );
+}
+
+void TestQgsRasterProjector::threads_data()
+{
+  QTest::addColumn< int >( "precision" );
+
+  QTest::newRow( "approximate" ) << static_cast< int >( QgsRasterProjector::Approximate );
+  QTest::newRow( "exact" ) << static_cast< int >( QgsRasterProjector::Exact );
+}
+
+void TestQgsRasterProjector::threads()
+{
+  QFETCH( int, precision );
+
+  std::unique_ptr< QgsRasterBlock > single( project( static_cast< QgsRasterProjector::Precision >( precision ), 1 ) );
+  std::unique_ptr< QgsRasterBlock > multi( project( static_cast< QgsRasterProjector::Precision >( precision ), 4 ) );
+  QVERIFY( single->isValid() );
+  QVERIFY( multi->isValid() );
+  QCOMPARE( single->width(), WIDTH );
+  QCOMPARE( single->height(), HEIGHT );
+
+  int dataPixels = 0;
+  int noDataPixels = 0;
+  for ( int row = 0; row < HEIGHT; ++row )
+  {
+    for ( int col = 0; col < WIDTH; ++col )
+    {
+      QCOMPARE( multi->isNoData( row, col ), single->isNoData( row, col ) );
+      if ( single->isNoData( row, col ) )
+      {
+        ++noDataPixels;
+        continue;
+      }
+      QCOMPARE( multi->value( row, col ), single->value( row, col ) );
+      ++dataPixels;
+    }
+  }
+  QVERIFY( dataPixels > WIDTH * HEIGHT / 2 );
+  QVERIFY( noDataPixels > 0 );
+}
+
+QGSTEST_MAIN( TestQgsRasterProjector )
+#include "testqgsrasterprojector.moc"
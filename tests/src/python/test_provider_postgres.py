@@ -718,6 +718,84 @@ class TestPyQgsPostgresProvider(unittest.TestCase, ProviderTestCase):
         self.assertEqual(desclist, [])
         self.assertEqual(errmsg, "")
 
+    def pipelineLayer(self):
+        """Returns a layer of 3000 points, many more than the rows of the first fetches of an iterator"""
+        self.execSQLCommand('DROP TABLE IF EXISTS qgis_test."pipeline_data" CASCADE')
+        self.execSQLCommand('CREATE TABLE qgis_test."pipeline_data" ( pk integer NOT NULL PRIMARY KEY, value integer, geom public.geometry(Point, 4326))')
+        self.execSQLCommand('INSERT INTO qgis_test."pipeline_data" (pk, value, geom) '
+                            'SELECT i, i * 2, ST_SetSRID(ST_MakePoint(i % 100, i / 100), 4326) FROM generate_series(1, 3000) i')
+        vl = QgsVectorLayer(self.dbconn + ' sslmode=disable key=\'pk\' srid=4326 type=POINT table="qgis_test"."pipeline_data" (geom) sql=', 'pipeline', 'postgres')
+        self.assertTrue(vl.isValid())
+        return vl
+
+    def testPipelinedFetch(self):
+        """Features fetched in pipelined batches are all returned once"""
+        vl = self.pipelineLayer()
+        self.assertEqual(vl.featureCount(), 3000)
+        pks = [f['pk'] for f in vl.getFeatures()]
+        self.assertEqual(len(pks), vl.featureCount())
+        self.assertEqual(sorted(pks), list(range(1, 3001)))
+        for f in vl.getFeatures(QgsFeatureRequest().setFilterExpression('"pk" <= 1500')):
+            self.assertEqual(f['value'], f['pk'] * 2)
+
+    def testPipelinedFetchRewindClose(self):
+        """rewind() and close() discard the fetch sent ahead"""
+        vl = self.pipelineLayer()
+        it = vl.getFeatures(QgsFeatureRequest().setFlags(QgsFeatureRequest.NoGeometry))
+        # after the first batches, the next one is in flight
+        first = [next(it)['pk'] for i in range(10)]
+        self.assertTrue(it.rewind())
+        pks = [f['pk'] for f in it]
+        self.assertEqual(pks[:10], first)
+        self.assertEqual(len(pks), 3000)
+
+        it = vl.getFeatures()
+        for i in range(10):
+            next(it)
+        self.assertTrue(it.close())
+        with self.assertRaises(StopIteration):
+            next(it)
+
+        # the connection is usable by the next iterators
+        self.assertEqual(len([f for f in vl.getFeatures()]), 3000)
+
+    def testPipelinedFetchEarlyStop(self):
+        """Iterators stopped early release their connection without a query in flight"""
+        vl = self.pipelineLayer()
+        for i in range(20):
+            it = vl.getFeatures()
+            for j in range(5 + i * 10):
+                next(it)
+            del it
+
+        request = QgsFeatureRequest().setFilterExpression('"value" < 20')
+        self.assertEqual(sorted([f['pk'] for f in vl.getFeatures(request)]), list(range(1, 10)))
+        self.assertEqual(len([f for f in vl.getFeatures()]), 3000)
+
+    def testTransactionFetch(self):
+        """Iterators on a transaction connection fetch without pipelining"""
+        vl = self.pipelineLayer()
+        tg = QgsTransactionGroup()
+        tg.addLayer(vl)
+        self.assertTrue(vl.startEditing())
+        try:
+            it = vl.getFeatures()
+            first = [next(it)['pk'] for i in range(100)]
+            self.assertEqual(len(first), 100)
+            # another iterator shares the connection while the first one is open
+            self.assertEqual(len([f for f in vl.getFeatures()]), 3000)
+            rest = [f['pk'] for f in it]
+            self.assertEqual(sorted(first + rest), list(range(1, 3001)))
+
+            it = vl.getFeatures()
+            for i in range(10):
+                next(it)
+            del it
+            self.assertEqual(vl.featureCount(), 3000)
+            self.assertEqual(len([f for f in vl.getFeatures(QgsFeatureRequest().setFilterExpression('"pk" > 2990'))]), 10)
+        finally:
+            vl.rollBack()
+
 
 class TestPyQgsPostgresProviderCompoundKey(unittest.TestCase, ProviderTestCase):
 
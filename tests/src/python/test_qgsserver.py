@@ -36,6 +36,7 @@ import urllib.request
 import urllib.parse
 import urllib.error
 import email
+import json
 
 from io import StringIO
 from qgis.server import QgsServer, QgsServerRequest, QgsBufferServerRequest, QgsBufferServerResponse
@@ -304,6 +305,22 @@ class TestQgsServer(QgsServerTestBase):
         for id, req in tests:
             self.wfs_getfeature_compare(id, req)
 
+    def test_getfeature_geojson(self):
+        project = self.testdata_path + "test_project_wfs.qgs"
+        query_string = '?MAP=%s&SERVICE=WFS&VERSION=1.0.0&REQUEST=GetFeature&TYPENAME=testlayer&OUTPUTFORMAT=GeoJSON' % urllib.parse.quote(project)
+        header, body = self._execute_request(query_string)
+        self.assert_headers(header, body)
+        self.assertTrue(b'Content-Type: application/json; charset=utf-8' in header)
+
+        collection = json.loads(body.decode('utf-8'))
+        self.assertEqual(collection['type'], 'FeatureCollection')
+        self.assertEqual([f['id'] for f in collection['features']], ['testlayer.0', 'testlayer.1', 'testlayer.2'])
+        feature = collection['features'][0]
+        self.assertEqual(feature['geometry']['type'], 'Point')
+        self.assertEqual(feature['geometry']['coordinates'], [8.203496, 44.901483])
+        self.assertEqual(feature['properties']['name'], 'one')
+        self.assertEqual(feature['properties']['utf8nameè'], 'one èé')
+
     def test_wfs_getcapabilities_url(self):
         """Check that URL in GetCapabilities response is complete"""
         # empty url in project
@@ -0,0 +1,109 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for the projects preloaded by the QgsServer configuration cache.
+
+From build dir, run: ctest -R PyQgsServerConfigCache -V
+
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS project'
+__date__ = '17/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import json
+import os
+import shutil
+import tempfile
+import time
+
+from qgis.core import (QgsProject,
+                       QgsVectorLayer,
+                       QgsCoordinateReferenceSystem)
+from qgis.server import QgsConfigCache
+from qgis.testing import unittest
+import sip
+
+from test_qgsserver import QgsServerTestBase
+
+
+class TestQgsServerConfigCache(QgsServerTestBase):
+
+    def setUp(self):
+        super().setUp()
+        self.temp_dir = tempfile.mkdtemp()
+        self.project_path = os.path.join(self.temp_dir, 'project.qgs')
+
+        points = {'type': 'FeatureCollection',
+                  'features': [{'type': 'Feature',
+                                'properties': {'id': 1},
+                                'geometry': {'type': 'Point', 'coordinates': [1, 1]}}]}
+        self.layer_path = os.path.join(self.temp_dir, 'points.geojson')
+        with open(self.layer_path, 'w') as f:
+            json.dump(points, f)
+
+    def tearDown(self):
+        QgsConfigCache.instance().removeEntry(self.project_path)
+        shutil.rmtree(self.temp_dir, True)
+
+    def write_project(self, title):
+        """Writes the project with title, replacing the file at once"""
+        project = QgsProject()
+        project.setTitle(title)
+        project.setCrs(QgsCoordinateReferenceSystem('EPSG:4326'))
+        layer = QgsVectorLayer(self.layer_path, 'points', 'ogr')
+        self.assertTrue(layer.isValid())
+        project.addMapLayer(layer)
+
+        temp_path = os.path.join(self.temp_dir, 'writing.qgs')
+        self.assertTrue(project.write(temp_path))
+        os.replace(temp_path, self.project_path)
+
+    def test_preload(self):
+        """Preloaded projects are returned until they are read again"""
+        self.write_project('first')
+        cache = QgsConfigCache.instance()
+        self.assertEqual(cache.preloadProjects([self.project_path]), 1)
+        # projects which cannot be read are not counted
+        self.assertEqual(cache.preloadProjects([os.path.join(self.temp_dir, 'missing.qgs')]), 0)
+
+        # project() returns the snapshot of the preloaded project, every time
+        project = cache.project(self.project_path)
+        self.assertIsNotNone(project)
+        self.assertEqual(project.title(), 'first')
+        self.assertEqual(sip.unwrapinstance(cache.project(self.project_path)), sip.unwrapinstance(project))
+
+    def test_reload(self):
+        """A preloaded project is replaced once read again after its file changed"""
+        self.write_project('first')
+        cache = QgsConfigCache.instance()
+        self.assertEqual(cache.preloadProjects([self.project_path]), 1)
+        previous = sip.unwrapinstance(cache.project(self.project_path))
+
+        changed = []
+        cache.projectChanged.connect(changed.append)
+        try:
+            self.write_project('second')
+
+            # the change is notified by the event loop, then the project is read in the background
+            for attempt in range(100):
+                self.app.processEvents()
+                if self.project_path in changed:
+                    break
+                time.sleep(0.05)
+            self.assertIn(self.project_path, changed)
+        finally:
+            cache.projectChanged.disconnect(changed.append)
+
+        project = cache.project(self.project_path)
+        self.assertEqual(project.title(), 'second')
+        self.assertNotEqual(sip.unwrapinstance(project), previous)
+
+
+if __name__ == '__main__':
+    unittest.main()
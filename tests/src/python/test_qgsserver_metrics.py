@@ -0,0 +1,111 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsServer request timings and metrics.
+
+From build dir, run: ctest -R PyQgsServerMetrics -V
+
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS project'
+__date__ = '17/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import os
+
+# settings are read once, when the first server is created
+os.environ['QGIS_SERVER_TIMING_HEADER'] = 'true'
+os.environ['QGIS_SERVER_METRICS'] = 'true'
+
+import re
+import urllib.parse
+
+from qgis.testing import unittest
+
+from test_qgsserver import QgsServerTestBase
+
+
+class TestQgsServerMetrics(QgsServerTestBase):
+
+    def request(self, service, request):
+        project = self.testdata_path + "test_project.qgs"
+        qs = '?MAP=%s&SERVICE=%s&REQUEST=%s' % (urllib.parse.quote(project), urllib.parse.quote(service), urllib.parse.quote(request))
+        return self._execute_request(qs)
+
+    def metrics(self):
+        """Returns the samples of the metrics endpoint, by metric name and labels"""
+        header, body = self._execute_request('?SERVICE=METRICS')
+        self.assertIn(b'Content-Type: text/plain; version=0.0.4', header)
+        samples = {}
+        for line in body.decode('utf-8').splitlines():
+            if line.startswith('#'):
+                continue
+            match = re.match(r'^(\w+)(\{.*\})? (\S+)$', line)
+            self.assertIsNotNone(match, line)
+            samples[match.group(1) + (match.group(2) or '')] = float(match.group(3))
+        return samples
+
+    def request_count(self, samples, service, request):
+        return samples.get('qgis_server_request_duration_seconds_count{service="%s",request="%s"}' % (service, request), 0)
+
+    def test_server_timing_header(self):
+        header, body = self.request('WMS', 'GetCapabilities')
+        self.assertIn(b'<WMS_Capabilities', body)
+        timing = re.search(rb'^Server-Timing: (.*)$', header, re.M)
+        self.assertIsNotNone(timing, header)
+        metrics = [m.strip() for m in timing.group(1).decode('utf-8').split(',')]
+        names = [m.split(';')[0] for m in metrics]
+        self.assertIn('parse', names)
+        self.assertIn('project', names)
+        self.assertEqual(names[-1], 'total')
+        for metric in metrics:
+            self.assertRegex(metric, r';dur=\d+(\.\d+)?$')
+
+        # the metrics endpoint is not timed
+        header, body = self._execute_request('?SERVICE=METRICS')
+        self.assertNotIn(b'Server-Timing', header)
+
+    def test_metrics(self):
+        before = self.metrics()
+
+        # request names are matched regardless of case
+        for name in ('GetCapabilities', 'getcapabilities', 'GETCAPABILITIES'):
+            self.request('wms', name)
+        # unknown requests and services do not create series
+        self.request('WMS', 'NoSuchRequest')
+        self.request('WMS', 'GetCapabilities"\n{le="1"}')
+        self.request('NOSUCHSERVICE', 'GetCapabilities')
+        self.request('NoSuchService2', 'NoSuchRequest2')
+
+        after = self.metrics()
+        self.assertEqual(self.request_count(after, 'WMS', 'GetCapabilities') - self.request_count(before, 'WMS', 'GetCapabilities'), 3)
+        self.assertEqual(self.request_count(after, 'WMS', 'other') - self.request_count(before, 'WMS', 'other'), 2)
+        self.assertEqual(self.request_count(after, 'other', 'other') - self.request_count(before, 'other', 'other'), 2)
+
+        requests = set(re.search(r'service="([^"]*)",request="([^"]*)"', key).groups()
+                       for key in after if key.startswith('qgis_server_request_duration_seconds'))
+        known = {'GetCapabilities', 'GetProjectSettings', 'GetMap', 'GetFeatureInfo', 'GetContext',
+                 'GetSchemaExtension', 'GetStyle', 'GetStyles', 'DescribeLayer', 'GetLegendGraphic',
+                 'GetLegendGraphics', 'GetPrint', 'GetFeature', 'DescribeFeatureType', 'Transaction',
+                 'DescribeCoverage', 'GetCoverage', 'other'}
+        for service, request in requests:
+            self.assertIn(service, ('WMS', 'WFS', 'WCS', 'other'))
+            self.assertIn(request, known)
+
+        # the histogram buckets are cumulative and end with the count
+        labels = '{service="WMS",request="GetCapabilities"'
+        buckets = [value for key, value in sorted(after.items()) if key.startswith('qgis_server_request_duration_seconds_bucket' + labels)]
+        self.assertEqual(after['qgis_server_request_duration_seconds_bucket%s,le="+Inf"}' % labels], after['qgis_server_request_duration_seconds_count%s}' % labels])
+        self.assertTrue(all(value <= after['qgis_server_request_duration_seconds_count%s}' % labels] for value in buckets))
+
+        # phases are recorded as well
+        self.assertGreater(after.get('qgis_server_phase_seconds_count{phase="parse",layer=""}', 0), before.get('qgis_server_phase_seconds_count{phase="parse",layer=""}', 0))
+
+
+if __name__ == '__main__':
+    unittest.main()
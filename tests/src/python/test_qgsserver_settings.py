@@ -115,6 +115,105 @@ class TestQgsServerSettings(unittest.TestCase):
         self.assertEqual(self.settings.maxThreads(), 5)
         os.environ.pop(env)
 
+    def test_env_request_threads(self):
+        env = "QGIS_SERVER_REQUEST_THREADS"
+
+        self.assertEqual(self.settings.requestThreads(), 1)
+
+        os.environ[env] = "4"
+        self.settings.load()
+        self.assertEqual(self.settings.requestThreads(), 4)
+        os.environ.pop(env)
+
+        # at least one thread accepts requests
+        os.environ[env] = "0"
+        self.settings.load()
+        self.assertEqual(self.settings.requestThreads(), 1)
+        os.environ.pop(env)
+
+    def test_env_wms_cache(self):
+        self.assertEqual(self.settings.wmsCacheMemorySize(), 0)
+        self.assertEqual(self.settings.wmsCacheDirectory(), "")
+        self.assertEqual(self.settings.wmsCacheDiskSize(), 256 * 1024 * 1024)
+        self.assertEqual(self.settings.wmsMetatileSize(), 1)
+
+        os.environ["QGIS_SERVER_WMS_CACHE_MEMORY_SIZE"] = "1048576"
+        os.environ["QGIS_SERVER_WMS_CACHE_DIRECTORY"] = "/tmp/wms_cache"
+        os.environ["QGIS_SERVER_WMS_CACHE_DISK_SIZE"] = "2097152"
+        os.environ["QGIS_SERVER_WMS_METATILE_SIZE"] = "4"
+        self.settings.load()
+        self.assertEqual(self.settings.wmsCacheMemorySize(), 1048576)
+        self.assertEqual(self.settings.wmsCacheDirectory(), "/tmp/wms_cache")
+        self.assertEqual(self.settings.wmsCacheDiskSize(), 2097152)
+        self.assertEqual(self.settings.wmsMetatileSize(), 4)
+        os.environ.pop("QGIS_SERVER_WMS_CACHE_MEMORY_SIZE")
+        os.environ.pop("QGIS_SERVER_WMS_CACHE_DIRECTORY")
+        os.environ.pop("QGIS_SERVER_WMS_CACHE_DISK_SIZE")
+        os.environ.pop("QGIS_SERVER_WMS_METATILE_SIZE")
+
+    def test_env_wms_png8(self):
+        self.assertFalse(self.settings.wmsPng8Dither())
+        self.assertEqual(self.settings.wmsPng8Threads(), 1)
+
+        os.environ["QGIS_SERVER_WMS_PNG8_DITHER"] = "true"
+        os.environ["QGIS_SERVER_WMS_PNG8_THREADS"] = "0"
+        self.settings.load()
+        self.assertTrue(self.settings.wmsPng8Dither())
+        self.assertEqual(self.settings.wmsPng8Threads(), 0)
+        os.environ.pop("QGIS_SERVER_WMS_PNG8_DITHER")
+        os.environ.pop("QGIS_SERVER_WMS_PNG8_THREADS")
+
+    def test_env_preload_projects(self):
+        self.assertEqual(self.settings.preloadProjects(), [])
+        self.assertEqual(self.settings.preloadThreads(), 0)
+
+        os.environ["QGIS_SERVER_PRELOAD_PROJECTS"] = os.pathsep.join(["/tmp/a.qgs", "/tmp/b.qgs"])
+        os.environ["QGIS_SERVER_PRELOAD_THREADS"] = "2"
+        self.settings.load()
+        self.assertEqual(self.settings.preloadProjects(), ["/tmp/a.qgs", "/tmp/b.qgs"])
+        self.assertEqual(self.settings.preloadThreads(), 2)
+        os.environ.pop("QGIS_SERVER_PRELOAD_PROJECTS")
+        os.environ.pop("QGIS_SERVER_PRELOAD_THREADS")
+
+    def test_env_identify_index_size(self):
+        env = "QGIS_SERVER_IDENTIFY_INDEX_SIZE"
+
+        self.assertEqual(self.settings.identifyIndexSize(), 0)
+
+        os.environ[env] = "100000"
+        self.settings.load()
+        self.assertEqual(self.settings.identifyIndexSize(), 100000)
+        os.environ.pop(env)
+
+    def test_env_timing(self):
+        self.assertFalse(self.settings.timingHeader())
+        self.assertFalse(self.settings.timingLog())
+        self.assertFalse(self.settings.metrics())
+
+        os.environ["QGIS_SERVER_TIMING_HEADER"] = "true"
+        os.environ["QGIS_SERVER_TIMING_LOG"] = "true"
+        os.environ["QGIS_SERVER_METRICS"] = "true"
+        self.settings.load()
+        self.assertTrue(self.settings.timingHeader())
+        self.assertTrue(self.settings.timingLog())
+        self.assertTrue(self.settings.metrics())
+        os.environ.pop("QGIS_SERVER_TIMING_HEADER")
+        os.environ.pop("QGIS_SERVER_TIMING_LOG")
+        os.environ.pop("QGIS_SERVER_METRICS")
+
+    def test_env_max_threads_per_request(self):
+        env = "QGIS_SERVER_MAX_THREADS_PER_REQUEST"
+        self.assertEqual(self.settings.maxThreadsPerRequest(), 0)
+
+        os.environ[env] = "4"
+        self.settings.load()
+        self.assertEqual(self.settings.maxThreadsPerRequest(), 4)
+
+        os.environ[env] = "-2"
+        self.settings.load()
+        self.assertEqual(self.settings.maxThreadsPerRequest(), 0)
+        os.environ.pop(env)
+
     def test_env_cache_size(self):
         env = "QGIS_SERVER_CACHE_SIZE"
 
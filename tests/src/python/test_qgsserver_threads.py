@@ -0,0 +1,141 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsServer with several request threads.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS project'
+__date__ = '17/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import os
+
+# settings are read once, when the first server is created
+os.environ['QGIS_SERVER_REQUEST_THREADS'] = '4'
+
+import json
+import shutil
+import tempfile
+import threading
+import time
+import urllib.parse
+
+from qgis.core import (QgsProject,
+                       QgsVectorLayer,
+                       QgsFillSymbol,
+                       QgsSingleSymbolRenderer,
+                       QgsCoordinateReferenceSystem)
+from qgis.testing import unittest
+from qgis.PyQt.QtGui import QImage, QColor
+
+from test_qgsserver import QgsServerTestBase
+
+
+class TestQgsServerThreads(QgsServerTestBase):
+
+    def setUp(self):
+        super().setUp()
+        self.temp_dir = tempfile.mkdtemp()
+        self.project_path = os.path.join(self.temp_dir, 'project.qgs')
+
+        # a polygon covering the whole requested extent
+        polygon = {'type': 'FeatureCollection',
+                   'features': [{'type': 'Feature',
+                                 'properties': {'id': 1},
+                                 'geometry': {'type': 'Polygon',
+                                              'coordinates': [[[-40, -40], [40, -40], [40, 40], [-40, 40], [-40, -40]]]}}]}
+        self.layer_path = os.path.join(self.temp_dir, 'polygon.geojson')
+        with open(self.layer_path, 'w') as f:
+            json.dump(polygon, f)
+
+        self.write_project('#ff0000')
+
+    def tearDown(self):
+        shutil.rmtree(self.temp_dir, True)
+
+    def write_project(self, color):
+        """Writes the project with a polygon filled with color, replacing the file at once
+        so that requests never read a partially written project"""
+        project = QgsProject()
+        project.setCrs(QgsCoordinateReferenceSystem('EPSG:3857'))
+        layer = QgsVectorLayer(self.layer_path, 'polygon', 'ogr')
+        self.assertTrue(layer.isValid())
+        layer.setRenderer(QgsSingleSymbolRenderer(QgsFillSymbol.createSimple({'color': color, 'outline_style': 'no'})))
+        project.addMapLayer(layer)
+
+        temp_path = os.path.join(self.temp_dir, 'writing.qgs')
+        self.assertTrue(project.write(temp_path))
+        os.replace(temp_path, self.project_path)
+
+    def get_map_color(self):
+        """Returns the color of the center of a GetMap image, or the response body if it is no image"""
+        qs = '?' + '&'.join(['%s=%s' % i for i in list({
+            'MAP': urllib.parse.quote(self.project_path),
+            'SERVICE': 'WMS',
+            'VERSION': '1.3.0',
+            'REQUEST': 'GetMap',
+            'LAYERS': 'polygon',
+            'STYLES': '',
+            'FORMAT': 'image/png',
+            'CRS': 'EPSG:3857',
+            'BBOX': '-1000000,-1000000,1000000,1000000',
+            'WIDTH': '20',
+            'HEIGHT': '20',
+        }.items())])
+        header, body = self._execute_request(qs)
+        image = QImage.fromData(body, 'PNG')
+        if image.isNull():
+            return body
+        return QColor(image.pixel(10, 10)).name()
+
+    def test_get_map_while_project_changes(self):
+        """Concurrent GetMap requests keep working while the project file changes,
+        and the last version of the project is eventually served"""
+        self.assertEqual(self.get_map_color(), '#ff0000')
+
+        results = []
+        lock = threading.Lock()
+
+        def run():
+            colors = [self.get_map_color() for i in range(20)]
+            with lock:
+                results.extend(colors)
+
+        threads = [threading.Thread(target=run) for i in range(4)]
+        for thread in threads:
+            thread.start()
+
+        # the main thread processes the file system changes, like the event loop of the fcgi server
+        colors = ['#0000ff', '#00ff00', '#ff0000']
+        i = 0
+        while any(thread.is_alive() for thread in threads):
+            self.write_project(colors[i % len(colors)])
+            i += 1
+            self.app.processEvents()
+            time.sleep(0.01)
+        for thread in threads:
+            thread.join()
+
+        self.assertEqual(len(results), 80)
+        for color in results:
+            self.assertIn(color, ['#ff0000', '#0000ff', '#00ff00'])
+
+        # the last change is taken into account once notified
+        self.write_project('#0000ff')
+        color = None
+        for attempt in range(100):
+            self.app.processEvents()
+            color = self.get_map_color()
+            if color == '#0000ff':
+                break
+            time.sleep(0.05)
+        self.assertEqual(color, '#0000ff')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,237 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for the WFS GetFeature responses streamed by QgsServer.
+
+The streamed geometries and attributes are compared with the output of
+QgsAbstractGeometry.asGML2(), asGML3(), QgsGeometry.exportToGeoJSON(),
+QDomDocument and QgsJsonUtils.
+
+From build dir, run: ctest -R PyQgsServerWFSStream -V
+
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS project'
+__date__ = '17/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import csv
+import json
+import os
+import re
+import shutil
+import tempfile
+import urllib.parse
+import xml.etree.ElementTree as ET
+
+from qgis.core import (QgsProject,
+                       QgsVectorLayer,
+                       QgsJsonUtils,
+                       QgsCoordinateReferenceSystem)
+from qgis.testing import unittest
+from qgis.PyQt.QtCore import QUrl
+from qgis.PyQt.QtXml import QDomDocument
+
+from test_qgsserver import QgsServerTestBase
+
+GML_NS = 'http://www.opengis.net/gml'
+QGS_NS = '{http://www.qgis.org/gml}'
+
+# size in bytes of the chunks written by QgsWfsStreamWriter
+CHUNK_SIZE = 64 * 1024
+
+LAYERS = {
+    'lines': [
+        'LineString (1.1234567 2.7654321, 3.0000001 4.5, 5 6)',
+        'MultiLineString ((0 0, 1 1, 2 0), (10 10, 11.25 11.125))',
+    ],
+    'polygons': [
+        'Polygon ((0 0, 10 0, 10 10, 0 10, 0 0))',
+        'Polygon ((0 0, 10 0, 10 10, 0 10, 0 0), (2 2, 4 2, 4 4, 2 2), (6 6, 8 6, 8 8, 6 6))',
+        'MultiPolygon (((0 0, 1 0, 1 1, 0 0)), ((5 5, 9 5, 9 9, 5 9, 5 5), (6 6, 7 6, 7 7, 6 6)))',
+    ],
+    'points': [
+        'Point (1.0000004 -2.5)',
+        'MultiPoint ((1 2), (3.3333333 4.4444444))',
+    ],
+    # curved geometries are saved through the DOM
+    'curves': [
+        'CircularString (0 0, 1 1, 2 0)',
+        'CompoundCurve (CircularString (0 0, 1 1, 2 0), (2 0, 3 0))',
+        'MultiCurve (CircularString (0 0, 1 1, 2 0), (5 5, 6 6))',
+    ],
+    'curvepolygons': [
+        'CurvePolygon (CircularString (0 0, 2 0, 2 2, 0 2, 0 0))',
+        'MultiSurface (CurvePolygon (CircularString (0 0, 2 0, 2 2, 0 2, 0 0)), ((5 5, 6 5, 6 6, 5 5)))',
+    ],
+}
+
+# text escaped by QDomDocument and QgsJsonUtils, with non ASCII characters
+LABELS = [
+    'plain',
+    'less < greater > amp & quote " apos \'',
+    'cdata end ]]> and ]> and ]]]>',
+    'backslash \\ slash / tab \t',
+    'accents àéè, euro €, clef 𝄞',
+]
+
+
+class TestQgsServerWFSStream(QgsServerTestBase):
+
+    def setUp(self):
+        super().setUp()
+        self.temp_dir = tempfile.mkdtemp()
+        self.project_path = os.path.join(self.temp_dir, 'project.qgs')
+
+        project = QgsProject()
+        project.setCrs(QgsCoordinateReferenceSystem('EPSG:4326'))
+        layer_ids = []
+        for name, wkts in LAYERS.items():
+            layer_ids.append(self.add_layer(project, name, [(i, LABELS[i % len(LABELS)], wkt) for i, wkt in enumerate(wkts)]))
+        layer_ids.append(self.add_layer(project, 'attributes', [(i, label, 'Point (%d %d)' % (i, i)) for i, label in enumerate(LABELS)]))
+        # enough features for several chunks
+        layer_ids.append(self.add_layer(project, 'many', [(i, 'feature %d' % i, 'LineString (%d.123456789 0.5, %d.25 1, %d 2.000001)' % (i, i, i)) for i in range(2000)]))
+        project.writeEntry('WFSLayers', '/', layer_ids)
+        self.assertTrue(project.write(self.project_path))
+
+    def tearDown(self):
+        shutil.rmtree(self.temp_dir, True)
+
+    def add_layer(self, project, name, rows):
+        """Adds a delimited text layer of (id, label, wkt) rows to project, returns its id"""
+        path = os.path.join(self.temp_dir, name + '.csv')
+        with open(path, 'w', encoding='utf-8', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(['id', 'label', 'wkt'])
+            writer.writerows(rows)
+
+        url = QUrl.fromLocalFile(path)
+        url.setQuery('type=csv&encoding=UTF-8&wktField=wkt&crs=EPSG:4326&spatialIndex=no&subsetIndex=no&watchFile=no')
+        layer = QgsVectorLayer(url.toString(), name, 'delimitedtext')
+        self.assertTrue(layer.isValid(), name)
+        self.assertEqual(layer.featureCount(), len(rows), name)
+        project.addMapLayer(layer)
+        return layer.id()
+
+    def layer_features(self, name):
+        """Returns the features of a layer, read as the server reads them"""
+        project = QgsProject()
+        self.assertTrue(project.read(self.project_path))
+        return list(project.mapLayersByName(name)[0].getFeatures())
+
+    def get_feature(self, name, output_format):
+        qs = '?' + '&'.join(['%s=%s' % i for i in list({
+            'MAP': urllib.parse.quote(self.project_path),
+            'SERVICE': 'WFS',
+            'VERSION': '1.0.0',
+            'REQUEST': 'GetFeature',
+            'TYPENAME': name,
+            'OUTPUTFORMAT': output_format,
+        }.items())])
+        header, body = self._execute_request(qs)
+        self.assert_headers(header, body)
+        return body
+
+    def gml_geometries(self, body):
+        """Returns the geometry elements of a GML response, as saved by QDomDocument"""
+        geometries = []
+        for fragment in re.findall(b'  <qgs:geometry>\n(.*?)  </qgs:geometry>\n', body, re.DOTALL):
+            lines = fragment.split(b'\n')
+            self.assertEqual(lines.pop(), b'')
+            for line in lines:
+                self.assertTrue(line.startswith(b'   '), line)
+            geometries.append(b''.join(line[3:] + b'\n' for line in lines))
+        return geometries
+
+    def expected_gml(self, feature, gml3):
+        doc = QDomDocument()
+        geometry = feature.geometry().geometry()
+        element = geometry.asGML3(doc, 6, GML_NS) if gml3 else geometry.asGML2(doc, 6, GML_NS)
+        element.setAttribute('srsName', 'EPSG:4326')
+        doc.appendChild(element)
+        return bytes(doc.toByteArray())
+
+    def check_gml(self, name, gml3):
+        features = self.layer_features(name)
+        body = self.get_feature(name, 'GML3' if gml3 else 'GML2')
+        # the response is a well formed document
+        ET.fromstring(body)
+        geometries = self.gml_geometries(body)
+        self.assertEqual(len(geometries), len(features))
+        for feature, geometry in zip(features, geometries):
+            self.assertEqual(geometry.decode('utf-8'), self.expected_gml(feature, gml3).decode('utf-8'), feature.geometry().exportToWkt())
+        return body
+
+    def check_geojson(self, name):
+        features = self.layer_features(name)
+        body = self.get_feature(name, 'GeoJSON')
+        collection = json.loads(body.decode('utf-8'))
+        self.assertEqual(len(collection['features']), len(features))
+        for feature, streamed in zip(features, collection['features']):
+            expected = feature.geometry().exportToGeoJSON(6)
+            self.assertEqual(streamed['geometry'], json.loads(expected))
+            # the layout of the geometry is kept as well
+            self.assertIn(b'   "geometry":\n   ' + expected.encode('utf-8') + b',\n', body)
+        return body
+
+    def test_gml2_geometries(self):
+        """Streamed GML2 geometries are the ones of asGML2()"""
+        for name in LAYERS:
+            self.check_gml(name, False)
+
+    def test_gml3_geometries(self):
+        """Streamed GML3 geometries are the ones of asGML3()"""
+        for name in LAYERS:
+            self.check_gml(name, True)
+
+    def test_geojson_geometries(self):
+        """Streamed GeoJSON geometries are the ones of exportToGeoJSON()"""
+        for name in LAYERS:
+            self.check_geojson(name)
+
+    def test_gml_attributes(self):
+        """Attributes are escaped as QDomDocument escapes them"""
+        for output_format in ['GML2', 'GML3']:
+            body = self.get_feature('attributes', output_format)
+            labels = [element.text for element in ET.fromstring(body).iter(QGS_NS + 'label')]
+            self.assertEqual(labels, LABELS)
+
+            for label in LABELS:
+                doc = QDomDocument()
+                element = doc.createElement('label')
+                element.appendChild(doc.createTextNode(label))
+                doc.appendChild(element)
+                saved = bytes(doc.toByteArray()).strip()
+                self.assertTrue(saved.startswith(b'<label>') and saved.endswith(b'</label>'), saved)
+                self.assertIn(b'  <qgs:label>' + saved[len(b'<label>'):-len(b'</label>')] + b'</qgs:label>\n', body)
+
+    def test_geojson_attributes(self):
+        """Attributes are escaped as QgsJsonUtils escapes them"""
+        body = self.get_feature('attributes', 'GeoJSON')
+        collection = json.loads(body.decode('utf-8'))
+        self.assertEqual([f['properties']['label'] for f in collection['features']], LABELS)
+        self.assertEqual([f['properties']['id'] for f in collection['features']], list(range(len(LABELS))))
+        for label in LABELS:
+            self.assertIn(b'      "label":' + QgsJsonUtils.encodeValue(label).encode('utf-8'), body)
+
+    def test_chunks(self):
+        """Responses written in several chunks hold every feature once"""
+        for output_format in ['GML2', 'GML3']:
+            body = self.check_gml('many', output_format == 'GML3')
+            self.assertGreater(len(body), 2 * CHUNK_SIZE)
+            ids = [element.text for element in ET.fromstring(body).iter(QGS_NS + 'id')]
+            self.assertEqual(ids, [str(i) for i in range(2000)])
+
+        body = self.check_geojson('many')
+        self.assertGreater(len(body), 2 * CHUNK_SIZE)
+        collection = json.loads(body.decode('utf-8'))
+        self.assertEqual([f['properties']['id'] for f in collection['features']], list(range(2000)))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -21,11 +21,16 @@ import os
 # Needed on Qt 5 so that the serialization of XML is consistent among all executions
 os.environ['QT_HASH_SEED'] = '1'
 
+import json
 import re
+import shutil
+import struct
+import tempfile
 import urllib.request
 import urllib.parse
 import urllib.error
 
+from qgis.core import QgsProject, QgsVectorLayer, QgsCoordinateReferenceSystem
 from qgis.testing import unittest
 from qgis.PyQt.QtCore import QSize
 
@@ -38,6 +43,131 @@ RE_STRIP_UNCHECKABLE = b'MAP=[^"]+|Content-Length: \d+'
 RE_ATTRIBUTES = b'[^>\s]+=[^>\s]+'
 
 
+def read_varint(data, pos):
+    """Returns the protobuf varint at pos and the position following it"""
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def read_fields(data):
+    """Returns the (field, value) pairs of a protobuf message, length delimited
+    values as bytes"""
+    fields = []
+    pos = 0
+    while pos < len(data):
+        key, pos = read_varint(data, pos)
+        field, wire_type = key >> 3, key & 0x7
+        if wire_type == 0:
+            value, pos = read_varint(data, pos)
+        elif wire_type == 1:
+            value = data[pos:pos + 8]
+            pos += 8
+        elif wire_type == 2:
+            size, pos = read_varint(data, pos)
+            value = data[pos:pos + size]
+            pos += size
+        elif wire_type == 5:
+            value = data[pos:pos + 4]
+            pos += 4
+        else:
+            raise ValueError('unexpected wire type %d' % wire_type)
+        fields.append((field, value))
+    return fields
+
+
+def read_packed(data):
+    values = []
+    pos = 0
+    while pos < len(data):
+        value, pos = read_varint(data, pos)
+        values.append(value)
+    return values
+
+
+def zigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_mvt(tile):
+    """Decodes the layers of a Mapbox Vector Tile, following vector_tile.proto"""
+    layers = []
+    for field, layer_data in read_fields(tile):
+        assert field == 3
+        layer = {'keys': [], 'values': [], 'features': []}
+        for layer_field, value in read_fields(layer_data):
+            if layer_field == 1:
+                layer['name'] = value.decode('utf-8')
+            elif layer_field == 2:
+                feature = {'tags': [], 'geometry': []}
+                for feature_field, feature_value in read_fields(value):
+                    if feature_field == 1:
+                        feature['id'] = feature_value
+                    elif feature_field == 2:
+                        feature['tags'] = read_packed(feature_value)
+                    elif feature_field == 3:
+                        feature['type'] = feature_value
+                    elif feature_field == 4:
+                        feature['geometry'] = read_packed(feature_value)
+                layer['features'].append(feature)
+            elif layer_field == 3:
+                layer['keys'].append(value.decode('utf-8'))
+            elif layer_field == 4:
+                value_field, raw = read_fields(value)[0]
+                if value_field == 1:
+                    layer['values'].append(raw.decode('utf-8'))
+                elif value_field == 3:
+                    layer['values'].append(struct.unpack('<d', raw)[0])
+                elif value_field == 5:
+                    layer['values'].append(raw)
+                elif value_field == 6:
+                    layer['values'].append(zigzag(raw))
+                elif value_field == 7:
+                    layer['values'].append(bool(raw))
+            elif layer_field == 5:
+                layer['extent'] = value
+            elif layer_field == 15:
+                layer['version'] = value
+        layers.append(layer)
+    return layers
+
+
+def feature_attributes(layer, feature):
+    tags = feature['tags']
+    return {layer['keys'][tags[i]]: layer['values'][tags[i + 1]] for i in range(0, len(tags), 2)}
+
+
+def mvt_rings(geometry):
+    """Returns the rings of an encoded polygon in tile coordinates"""
+    rings = []
+    x = y = 0
+    i = 0
+    while i < len(geometry):
+        command, count = geometry[i] & 0x7, geometry[i] >> 3
+        i += 1
+        if command == 7:
+            continue
+        if command == 1:
+            rings.append([])
+        for j in range(count):
+            x += zigzag(geometry[i])
+            y += zigzag(geometry[i + 1])
+            i += 2
+            rings[-1].append((x, y))
+    return rings
+
+
+def ring_area(ring):
+    """Returns twice the signed area of a ring, positive for clockwise rings in tile coordinates"""
+    return sum(ring[j][0] * ring[i][1] - ring[i][0] * ring[j][1] for i, j in zip(range(len(ring)), range(-1, len(ring) - 1)))
+
+
 class TestQgsServerWMS(QgsServerTestBase):
 
     """QGIS Server WMS Tests"""
@@ -236,6 +366,139 @@ class TestQgsServerWMS(QgsServerTestBase):
         r, h = self._result(self._execute_request(qs))
         self._img_diff_error(r, h, "WMS_GetMap_Basic4")
 
+    def test_wms_getmap_mvt(self):
+        qs = "?" + "&".join(["%s=%s" % i for i in list({
+            "MAP": urllib.parse.quote(self.projectPath),
+            "SERVICE": "WMS",
+            "VERSION": "1.1.1",
+            "REQUEST": "GetMap",
+            "LAYERS": "Country",
+            "STYLES": "",
+            "FORMAT": urllib.parse.quote("application/vnd.mapbox-vector-tile"),
+            "BBOX": "-16817707,-4710778,5696513,14587125",
+            "HEIGHT": "512",
+            "WIDTH": "512",
+            "CRS": "EPSG:3857"
+        }.items())])
+
+        r, h = self._result(self._execute_request(qs))
+        self.assertEqual(h.get("Content-Type"), "application/vnd.mapbox-vector-tile")
+        # a tile starts with its first layer (field 3, length delimited)
+        self.assertEqual(r[0], 0x1a)
+        layers = decode_mvt(r)
+        self.assertEqual(len(layers), 1)
+        self.assertEqual(layers[0]['name'], 'Country')
+        self.assertEqual(layers[0]['version'], 2)
+        self.assertEqual(layers[0]['extent'], 4096)
+        self.assertTrue(layers[0]['features'])
+        for feature in layers[0]['features']:
+            self.assertEqual(feature['type'], 3)
+            for ring in mvt_rings(feature['geometry']):
+                self.assertGreaterEqual(len(ring), 3)
+
+    def mvt_project(self):
+        """Writes a project with a polygon layer in a temporary directory, returns its path.
+        The secret attribute is excluded from WMS"""
+        temp_dir = tempfile.mkdtemp()
+        self.addCleanup(shutil.rmtree, temp_dir, True)
+
+        def square(x, y, size):
+            return [[x, y], [x + size, y], [x + size, y + size], [x, y + size], [x, y]]
+
+        features = [
+            # a square with a hole, inside the tile
+            ('square', 1, [square(10, 10, 10), square(12, 12, 2)]),
+            # outside the tile, but in its 64 units buffer
+            ('near', 2, [square(41, 10, 0.3)]),
+            # outside the buffer
+            ('far', 3, [square(45, 10, 1)]),
+        ]
+        collection = {'type': 'FeatureCollection',
+                      'features': [{'type': 'Feature',
+                                    'properties': {'name': name, 'code': code, 'secret': 'hidden'},
+                                    'geometry': {'type': 'Polygon', 'coordinates': rings}}
+                                   for name, code, rings in features]}
+        layer_path = os.path.join(temp_dir, 'polygons.geojson')
+        with open(layer_path, 'w') as f:
+            json.dump(collection, f)
+
+        project = QgsProject()
+        project.setCrs(QgsCoordinateReferenceSystem('EPSG:4326'))
+        layer = QgsVectorLayer(layer_path, 'polygons', 'ogr')
+        self.assertTrue(layer.isValid())
+        layer.setExcludeAttributesWms({'secret'})
+        project.addMapLayer(layer)
+        project_path = os.path.join(temp_dir, 'project.qgs')
+        self.assertTrue(project.write(project_path))
+        return project_path
+
+    def mvt_request(self, project_path, extra={}):
+        """Returns the layers of the tile of the 0,0,40.96,40.96 extent, of 0.01 degrees tile units"""
+        params = {
+            "MAP": urllib.parse.quote(project_path),
+            "SERVICE": "WMS",
+            "VERSION": "1.1.1",
+            "REQUEST": "GetMap",
+            "LAYERS": "polygons",
+            "STYLES": "",
+            "FORMAT": urllib.parse.quote("application/vnd.mapbox-vector-tile"),
+            "BBOX": "0,0,40.96,40.96",
+            "HEIGHT": "512",
+            "WIDTH": "512",
+            "CRS": "EPSG:4326"
+        }
+        params.update(extra)
+        qs = "?" + "&".join(["%s=%s" % i for i in list(params.items())])
+        r, h = self._result(self._execute_request(qs))
+        self.assertEqual(h.get("Content-Type"), "application/vnd.mapbox-vector-tile")
+        return decode_mvt(r)
+
+    def test_wms_getmap_mvt_content(self):
+        layers = self.mvt_request(self.mvt_project())
+        self.assertEqual(len(layers), 1)
+        layer = layers[0]
+        self.assertEqual(layer['name'], 'polygons')
+        self.assertEqual(layer['extent'], 4096)
+
+        # the feature outside the tile and its buffer is dropped, the secret attribute is excluded
+        self.assertEqual(layer['keys'], ['name', 'code'])
+        features = {feature_attributes(layer, f)['name']: f for f in layer['features']}
+        self.assertEqual(sorted(features.keys()), ['near', 'square'])
+        self.assertEqual(feature_attributes(layer, features['square']), {'name': 'square', 'code': 1})
+        self.assertEqual(feature_attributes(layer, features['near']), {'name': 'near', 'code': 2})
+
+        # tile coordinates are x = lon * 100 and y = (40.96 - lat) * 100. The exterior ring
+        # is clockwise in tile coordinates, so it is reversed, and the hole is counterclockwise
+        square = features['square']
+        self.assertEqual(square['type'], 3)
+        self.assertEqual(square['geometry'], [
+            9, 2000, 4192,  # MoveTo(1) 1000,2096
+            26, 2000, 0, 0, 2000, 1999, 0,  # LineTo(3) 2000,2096 2000,3096 1000,3096
+            15,  # ClosePath
+            9, 400, 399,  # MoveTo(1) 1200,2896
+            26, 400, 0, 0, 399, 399, 0,  # LineTo(3) 1400,2896 1400,2696 1200,2696
+            15,
+        ])
+        exterior, hole = mvt_rings(square['geometry'])
+        self.assertGreater(ring_area(exterior), 0)
+        self.assertLess(ring_area(hole), 0)
+
+        # the feature in the buffer is encoded out of the 0-4096 range
+        for ring in mvt_rings(features['near']['geometry']):
+            for x, y in ring:
+                self.assertTrue(4096 < x <= 4160)
+
+    def test_wms_getmap_mvt_filter(self):
+        project_path = self.mvt_project()
+        layers = self.mvt_request(project_path, {"FILTER": urllib.parse.quote("polygons:\"name\" = 'near'")})
+        self.assertEqual(len(layers), 1)
+        self.assertEqual([feature_attributes(layers[0], f) for f in layers[0]['features']], [{'name': 'near', 'code': 2}])
+        self.assertEqual(layers[0]['keys'], ['name', 'code'])
+
+        # layers without features are not written
+        layers = self.mvt_request(project_path, {"FILTER": urllib.parse.quote("polygons:\"name\" = 'none'")})
+        self.assertEqual(layers, [])
+
     def test_wms_getmap_invalid_parameters(self):
         # height should be an int
         qs = "?" + "&".join(["%s=%s" % i for i in list({
@@ -0,0 +1,209 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for the QgsServer cache of GetMap images.
+
+From build dir, run: ctest -R PyQgsServerWMSCache -V
+
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS project'
+__date__ = '17/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import os
+import tempfile
+
+# settings are read once, when the first server is created. Only the disk tier
+# is enabled, so that the test sees every cached image as a file
+CACHE_DIR = tempfile.mkdtemp()
+os.environ['QGIS_SERVER_WMS_CACHE_MEMORY_SIZE'] = '0'
+os.environ['QGIS_SERVER_WMS_CACHE_DIRECTORY'] = CACHE_DIR
+os.environ['QGIS_SERVER_WMS_METATILE_SIZE'] = '2'
+
+import hashlib
+import json
+import shutil
+import time
+import urllib.parse
+
+from qgis.core import (QgsProject,
+                       QgsVectorLayer,
+                       QgsFillSymbol,
+                       QgsSingleSymbolRenderer,
+                       QgsCoordinateReferenceSystem)
+from qgis.server import QgsConfigCache
+from qgis.testing import unittest
+from qgis.PyQt.QtCore import QBuffer, QByteArray, QIODevice
+from qgis.PyQt.QtGui import QImage, QColor
+
+from test_qgsserver import QgsServerTestBase
+
+
+class TestQgsServerWMSCache(QgsServerTestBase):
+
+    @classmethod
+    def tearDownClass(cls):
+        shutil.rmtree(CACHE_DIR, True)
+
+    def setUp(self):
+        super().setUp()
+        self.temp_dir = tempfile.mkdtemp()
+
+        # a rectangle crossing the border of the tiles of the 0,0,20,20 metatile,
+        # with corners on pixel boundaries of 64 pixels tiles
+        polygon = {'type': 'FeatureCollection',
+                   'features': [{'type': 'Feature',
+                                 'properties': {'id': 1},
+                                 'geometry': {'type': 'Polygon',
+                                              'coordinates': [[[5, 2.5], [15, 2.5], [15, 17.5], [5, 17.5], [5, 2.5]]]}}]}
+        self.layer_path = os.path.join(self.temp_dir, 'polygon.geojson')
+        with open(self.layer_path, 'w') as f:
+            json.dump(polygon, f)
+
+        self.project_path = os.path.join(self.temp_dir, 'project.qgs')
+        self.write_project(self.project_path, '#ff0000')
+
+    def tearDown(self):
+        shutil.rmtree(self.temp_dir, True)
+
+    def write_project(self, path, color, max_width=None):
+        """Writes a project with the polygon filled with color, replacing the file at once"""
+        project = QgsProject()
+        project.setCrs(QgsCoordinateReferenceSystem('EPSG:4326'))
+        layer = QgsVectorLayer(self.layer_path, 'polygon', 'ogr')
+        self.assertTrue(layer.isValid())
+        layer.setRenderer(QgsSingleSymbolRenderer(QgsFillSymbol.createSimple({'color': color, 'outline_style': 'no'})))
+        project.addMapLayer(layer)
+        if max_width is not None:
+            project.writeEntry('WMSMaxWidth', '/', max_width)
+
+        temp_path = os.path.join(self.temp_dir, 'writing.qgs')
+        self.assertTrue(project.write(temp_path))
+        os.replace(temp_path, path)
+
+    def get_map(self, bbox, project_path=None, size=64):
+        """Returns the body of a GetMap request in EPSG:4326, in the axis order of WMS 1.1.1"""
+        qs = '?' + '&'.join(['%s=%s' % i for i in list({
+            'MAP': urllib.parse.quote(project_path or self.project_path),
+            'SERVICE': 'WMS',
+            'VERSION': '1.1.1',
+            'REQUEST': 'GetMap',
+            'LAYERS': 'polygon',
+            'STYLES': '',
+            'FORMAT': 'image/png',
+            'TRANSPARENT': 'true',
+            'SRS': 'EPSG:4326',
+            'BBOX': bbox,
+            'WIDTH': str(size),
+            'HEIGHT': str(size),
+        }.items())])
+        header, body = self._execute_request(qs)
+        self.assertIn(b'Content-Type: image/png', header)
+        return body
+
+    def project_cache_dir(self, project_path):
+        """Returns the directory of the cached images of a project"""
+        return os.path.join(CACHE_DIR, hashlib.sha1(project_path.encode('utf-8')).hexdigest())
+
+    def cached_files(self, project_path=None):
+        """Returns the set of cached image files of a project"""
+        files = set()
+        for root, dirs, names in os.walk(self.project_cache_dir(project_path or self.project_path)):
+            files.update(os.path.join(root, name) for name in names)
+        return files
+
+    def assertImagesEqual(self, body, expected):
+        image = QImage.fromData(body, 'PNG')
+        expected_image = QImage.fromData(expected, 'PNG')
+        self.assertFalse(image.isNull())
+        self.assertEqual(image.size(), expected_image.size())
+        for y in range(image.height()):
+            for x in range(image.width()):
+                self.assertEqual(image.pixel(x, y), expected_image.pixel(x, y), 'pixel {},{}'.format(x, y))
+
+    def test_second_request_is_cache_hit(self):
+        """The second identical GetMap request is read from the disk tier"""
+        # not aligned on a grid of 10 x 10 cells, so no metatile is rendered
+        bbox = '1,1,11,11'
+        body = self.get_map(bbox)
+        files = self.cached_files()
+        self.assertEqual(len(files), 1)
+
+        # a cache file holds the content type on its first line, then the encoded image
+        path = files.pop()
+        with open(path, 'rb') as f:
+            self.assertEqual(f.read(), b'image/png\n' + body)
+
+        # replace the cached image by another one, which is returned if the request is a cache hit
+        image = QImage(64, 64, QImage.Format_ARGB32)
+        image.fill(QColor('#0000ff'))
+        data = QByteArray()
+        buffer = QBuffer(data)
+        buffer.open(QIODevice.WriteOnly)
+        image.save(buffer, 'PNG')
+        marker = bytes(data)
+        with open(path, 'wb') as f:
+            f.write(b'image/png\n' + marker)
+
+        self.assertEqual(self.get_map(bbox), marker)
+        self.assertEqual(self.cached_files(), {path})
+
+        # another extent is a miss
+        self.assertNotEqual(self.get_map('2,2,12,12'), marker)
+        self.assertEqual(len(self.cached_files()), 2)
+
+    def test_project_change_removes_images(self):
+        """The images of a project are removed when the project changes"""
+        changed = []
+        QgsConfigCache.instance().projectChanged.connect(changed.append)
+        try:
+            self.assertEqual(QColor(QImage.fromData(self.get_map('1,1,11,11'), 'PNG').pixel(32, 32)).name(), '#ff0000')
+            self.assertTrue(self.cached_files())
+
+            self.write_project(self.project_path, '#00ff00')
+            for attempt in range(100):
+                self.app.processEvents()
+                if self.project_path in changed:
+                    break
+                time.sleep(0.05)
+            self.assertIn(self.project_path, changed)
+            self.assertFalse(os.path.exists(self.project_cache_dir(self.project_path)))
+
+            # the new project is rendered and cached again
+            self.assertEqual(QColor(QImage.fromData(self.get_map('1,1,11,11'), 'PNG').pixel(32, 32)).name(), '#00ff00')
+            self.assertEqual(len(self.cached_files()), 1)
+        finally:
+            QgsConfigCache.instance().projectChanged.disconnect(changed.append)
+
+    def test_metatile(self):
+        """A tile sliced from a metatile is the tile rendered alone"""
+        body = self.get_map('0,0,10,10')
+        # the 2 x 2 tiles of the metatile are cached at once
+        self.assertEqual(len(self.cached_files()), 4)
+
+        # the neighbour tiles are cache hits
+        neighbours = {bbox: self.get_map(bbox) for bbox in ['10,0,20,10', '0,10,10,20', '10,10,20,20']}
+        self.assertEqual(len(self.cached_files()), 4)
+
+        # a project whose maximum width is the tile width cannot render metatiles
+        direct_path = os.path.join(self.temp_dir, 'direct.qgs')
+        self.write_project(direct_path, '#ff0000', 64)
+        self.assertImagesEqual(body, self.get_map('0,0,10,10', direct_path))
+        for bbox, tile in neighbours.items():
+            self.assertImagesEqual(tile, self.get_map(bbox, direct_path))
+        self.assertEqual(len(self.cached_files(direct_path)), 4)
+
+        # the tiles are not uniform: the polygon crosses their borders
+        image = QImage.fromData(body, 'PNG')
+        self.assertEqual(QColor(image.pixel(0, 0)).alpha(), 0)
+        self.assertEqual(QColor(image.pixel(63, 0)).name(), '#ff0000')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,156 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for the QgsServer cache of WMS capabilities.
+
+From build dir, run: ctest -R PyQgsServerWMSCapabilitiesCache -V
+
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS project'
+__date__ = '17/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import json
+import os
+import shutil
+import tempfile
+import time
+import urllib.parse
+import xml.etree.ElementTree as ET
+
+from qgis.core import (QgsProject,
+                       QgsVectorLayer,
+                       QgsCoordinateReferenceSystem)
+from qgis.testing import unittest
+from qgis.PyQt.QtXml import QDomDocument
+
+from test_qgsserver import QgsServerTestBase
+
+WMS_NS = '{http://www.opengis.net/wms}'
+
+
+class TestQgsServerWMSCapabilitiesCache(QgsServerTestBase):
+
+    def setUp(self):
+        super().setUp()
+        self.temp_dir = tempfile.mkdtemp()
+        self.project_path = os.path.join(self.temp_dir, 'project.qgs')
+
+        self.layer_paths = {}
+        for i, name in enumerate(['first', 'second', 'third']):
+            points = {'type': 'FeatureCollection',
+                      'features': [{'type': 'Feature',
+                                    'properties': {'id': i, 'label': name},
+                                    'geometry': {'type': 'Point', 'coordinates': [i, i]}}]}
+            self.layer_paths[name] = os.path.join(self.temp_dir, name + '.geojson')
+            with open(self.layer_paths[name], 'w') as f:
+                json.dump(points, f)
+
+    def tearDown(self):
+        shutil.rmtree(self.temp_dir, True)
+
+    def write_project(self, titles):
+        """Writes the project with a layer by name of titles"""
+        project = QgsProject()
+        project.setCrs(QgsCoordinateReferenceSystem('EPSG:4326'))
+        for name in sorted(titles):
+            layer = QgsVectorLayer(self.layer_paths[name], name, 'ogr')
+            self.assertTrue(layer.isValid())
+            layer.setTitle(titles[name])
+            project.addMapLayer(layer)
+
+        self.replace_project(project)
+
+    def edit_title(self, name, title):
+        """Changes the title of a layer in a copy of the project, which then replaces the project"""
+        project = QgsProject()
+        self.assertTrue(project.read(self.project_path))
+        layer = project.mapLayersByName(name)[0]
+        layer.setTitle(title)
+        self.replace_project(project)
+
+    def replace_project(self, project):
+        """Writes the project to a copy, replacing the project file at once"""
+        temp_path = os.path.join(self.temp_dir, 'writing.qgs')
+        self.assertTrue(project.write(temp_path))
+        os.replace(temp_path, self.project_path)
+
+    def get_capabilities(self):
+        qs = '?' + '&'.join(['%s=%s' % i for i in list({
+            'MAP': urllib.parse.quote(self.project_path),
+            'SERVICE': 'WMS',
+            'VERSION': '1.3.0',
+            'REQUEST': 'GetCapabilities',
+        }.items())])
+        header, body = self._execute_request(qs)
+        self.assertIn(b'Content-Type: text/xml', header)
+        return body
+
+    def layer_elements(self, body):
+        """Returns the serialized named layer elements of a capabilities document by name"""
+        root = ET.fromstring(body)
+        elements = {}
+        for layer in root.iter(WMS_NS + 'Layer'):
+            name = layer.find(WMS_NS + 'Name')
+            if name is not None and name.text in self.layer_paths:
+                elements[name.text] = ET.tostring(layer)
+        return elements
+
+    def layer_title(self, body, name):
+        root = ET.fromstring(body)
+        for layer in root.iter(WMS_NS + 'Layer'):
+            if layer.findtext(WMS_NS + 'Name') == name:
+                return layer.findtext(WMS_NS + 'Title')
+        return None
+
+    def test_title_change(self):
+        """Changing the title of a layer updates its element only"""
+        self.write_project({'first': 'First title', 'second': 'Second title', 'third': 'Third title'})
+        body = self.get_capabilities()
+        self.assertEqual(self.layer_title(body, 'second'), 'Second title')
+        elements = self.layer_elements(body)
+        self.assertEqual(sorted(elements.keys()), ['first', 'second', 'third'])
+
+        # a repeated request is served from the serialized document of the cache
+        cache = self.server.serverInterface().capabilitiesCache()
+        cached_bytes = bytes(cache.searchCapabilitiesBytes(self.project_path, '1.3.0-'))
+        self.assertEqual(cached_bytes, body)
+        self.assertEqual(self.get_capabilities(), body)
+
+        # the changes of the project file are processed by the event loop
+        self.edit_title('second', 'Edited title')
+        new_body = body
+        for attempt in range(100):
+            self.app.processEvents()
+            new_body = self.get_capabilities()
+            if new_body != body:
+                break
+            time.sleep(0.05)
+
+        self.assertEqual(self.layer_title(new_body, 'second'), 'Edited title')
+        new_elements = self.layer_elements(new_body)
+        self.assertNotEqual(new_elements['second'], elements['second'])
+        self.assertEqual(new_elements['first'], elements['first'])
+        self.assertEqual(new_elements['third'], elements['third'])
+
+        # the new document is cached in turn
+        self.assertEqual(bytes(cache.searchCapabilitiesBytes(self.project_path, '1.3.0-')), new_body)
+        self.assertEqual(self.get_capabilities(), new_body)
+
+        # and the response is the cached document, whatever the project
+        doc = QDomDocument()
+        self.assertTrue(doc.setContent('<WMS_Capabilities version="1.3.0" cached="true"/>'))
+        cache.insertCapabilitiesDocument(self.project_path, '1.3.0-', doc)
+        body = self.get_capabilities()
+        self.assertIn(b'cached="true"', body)
+        self.assertEqual(body, bytes(cache.searchCapabilitiesBytes(self.project_path, '1.3.0-')))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,120 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsServer WMS GetFeatureInfo answered from identify indexes.
+
+From build dir, run: ctest -R PyQgsServerWMSIdentifyIndex -V
+
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS project'
+__date__ = '17/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import os
+
+# Needed on Qt 5 so that the serialization of XML is consistent among all executions
+os.environ['QT_HASH_SEED'] = '1'
+# settings are read once, when the first server is created
+os.environ['QGIS_SERVER_IDENTIFY_INDEX_SIZE'] = '1000'
+
+import re
+import urllib.parse
+
+from qgis.core import QgsVectorLayer, QgsFeatureRequest, QgsRectangle
+from qgis.testing import unittest
+
+import osgeo.gdal  # NOQA
+
+import test_qgsserver_wms
+from test_qgsserver import QgsServerTestBase
+
+
+class TestQgsServerWMSIdentifyIndex(QgsServerTestBase):
+
+    """GetFeatureInfo responses must not depend on whether the identify index
+    or the provider answers, so the reference files of the provider path are used"""
+
+    # reference files are the ones of the provider path, they are never regenerated here
+    regenerate_reference = False
+
+    wms_request_compare = test_qgsserver_wms.TestQgsServerWMS.wms_request_compare
+
+    filter_geom = 'POLYGON((8 44,9 44,9 45,8 45,8 44))'
+
+    def feature_info_ids(self, feature_count):
+        """Returns the feature ids of a GetFeatureInfo with a filter geometry covering all the features"""
+        project = self.testdata_path + "test_project.qgs"
+        query_string = '?MAP=%s&SERVICE=WMS&VERSION=1.3&REQUEST=GetFeatureInfo' % urllib.parse.quote(project)
+        query_string += ('&layers=testlayer%20%C3%A8%C3%A9&' +
+                         'INFO_FORMAT=text%2Fxml&' +
+                         'width=600&height=400&srs=EPSG%3A3857&' +
+                         'query_layers=testlayer%20%C3%A8%C3%A9&' +
+                         'FEATURE_COUNT=%d&FILTER_GEOM=%s' % (feature_count, urllib.parse.quote(self.filter_geom)))
+        header, body = self._execute_request(query_string)
+        self.assertIn(b'<GetFeatureInfoResponse', body, body)
+        return [int(i) for i in re.findall(rb'<Feature id="(\d+)"', body)]
+
+    def provider_ids(self):
+        """Returns the ids of the features in the filter geometry, in provider order"""
+        layer = QgsVectorLayer(self.testdata_path + 'testlayer.shp', 'testlayer', 'ogr')
+        self.assertTrue(layer.isValid())
+        request = QgsFeatureRequest().setFilterRect(QgsRectangle(8, 44, 9, 45))
+        return [f.id() for f in layer.getFeatures(request)]
+
+    def test_reference_responses(self):
+        """The indexed responses equal the ones of the provider path, also when the
+        visibility of the features comes from the cache of the previous requests"""
+        for attempt in range(2):
+            self.wms_request_compare('GetFeatureInfo',
+                                     '&layers=testlayer%20%C3%A8%C3%A9&styles=&' +
+                                     'info_format=text%2Fhtml&transparent=true&' +
+                                     'width=600&height=400&srs=EPSG%3A3857&bbox=913190.6389747962%2C' +
+                                     '5606005.488876367%2C913235.426296057%2C5606035.347090538&' +
+                                     'query_layers=testlayer%20%C3%A8%C3%A9&X=190&Y=320',
+                                     'wms_getfeatureinfo-text-html')
+
+            self.wms_request_compare('GetFeatureInfo',
+                                     '&layers=testlayer%20%C3%A8%C3%A9&styles=&' +
+                                     'transparent=true&' +
+                                     'width=600&height=400&srs=EPSG%3A3857&bbox=913190.6389747962%2C' +
+                                     '5606005.488876367%2C913235.426296057%2C5606035.347090538&' +
+                                     'query_layers=testlayer%20%C3%A8%C3%A9&X=190&Y=320',
+                                     'wms_getfeatureinfo-text-plain')
+
+    def test_filter_geometry(self):
+        """The filter geometry expression is applied to the indexed features"""
+        for attempt in range(2):
+            self.wms_request_compare('GetFeatureInfo',
+                                     '&layers=testlayer%20%C3%A8%C3%A9&' +
+                                     'INFO_FORMAT=text%2Fxml&' +
+                                     'width=600&height=400&srs=EPSG%3A3857&' +
+                                     'query_layers=testlayer%20%C3%A8%C3%A9&' +
+                                     'FEATURE_COUNT=10&FILTER_GEOM=POLYGON((8.2035381 44.901459,8.2035562 44.901459,8.2035562 44.901418,8.2035381 44.901418,8.2035381 44.901459))',
+                                     'wms_getfeatureinfo_geometry_filter')
+
+    def test_filter_still_uses_provider(self):
+        """Requests with FILTER bypass the index and keep their reference responses"""
+        self.wms_request_compare('GetFeatureInfo',
+                                 '&layers=testlayer%20%C3%A8%C3%A9&' +
+                                 'INFO_FORMAT=text%2Fxml&' +
+                                 'width=600&height=400&srs=EPSG%3A3857&' +
+                                 'query_layers=testlayer%20%C3%A8%C3%A9&' +
+                                 'FEATURE_COUNT=10&FILTER=testlayer%20%C3%A8%C3%A9' + urllib.parse.quote(':"NAME" = \'two\' OR "NAME" = \'three\''),
+                                 'wms_getfeatureinfo_filter_or')
+
+    def test_feature_count(self):
+        """FEATURE_COUNT limits the indexed features like the provider ones, in provider order"""
+        expected = self.provider_ids()
+        self.assertEqual(len(expected), 3)
+        for feature_count in (1, 2, 3, 10):
+            self.assertEqual(self.feature_info_ids(feature_count), expected[:feature_count])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,184 @@
+/***************************************************************************
+  testqgscolorcubequantizer.cpp
+  --------------------------------------
+  Date                 : October 2026
+  Copyright            : (C) 2026 by QGIS project
+  Email                : qgis-developer at lists dot osgeo dot org
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgstest.h"
+
+#include <QImage>
+#include <QObject>
+
+#include "qgscolorcubequantizer.h"
+
+class TestQgsColorCubeQuantizer : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void exactColors_data();
+    void exactColors();
+    void transparentEntry_data();
+    void transparentEntry();
+    void parallelOutput_data();
+    void parallelOutput();
+
+  private:
+    //! 255 visible colors, each in its own histogram cell, and transparent pixels of various colors
+    static QImage fewColorsImage();
+    //! A gradient with far more colors than a palette holds, with transparent and nearly black pixels
+    static QImage manyColorsImage( int width, int height );
+};
+
+QImage TestQgsColorCubeQuantizer::fewColorsImage()
+{
+  QImage image( 64, 64, QImage::Format_ARGB32 );
+  for ( int y = 0; y < image.height(); ++y )
+  {
+    for ( int x = 0; x < image.width(); ++x )
+    {
+      const int i = ( y * image.width() + x ) % 256;
+      if ( i == 255 )
+      {
+        image.setPixel( x, y, qRgba( x * 4, y * 4, 77, 0 ) );
+        continue;
+      }
+      // the high 5 bits of red, green and blue differ between colors, the low bits vary
+      const int red = ( i % 8 ) * 32 + ( i * 3 ) % 8;
+      const int green = ( ( i / 8 ) % 8 ) * 32 + ( i * 5 ) % 8;
+      const int blue = ( i / 64 ) * 64 + ( i * 7 ) % 8;
+      const int alpha = i % 5 == 0 ? 128 + i % 32 : 255;
+      image.setPixel( x, y, qRgba( red, green, blue, alpha ) );
+    }
+  }
+  return image;
+}
+
+QImage TestQgsColorCubeQuantizer::manyColorsImage( int width, int height )
+{
+  QImage image( width, height, QImage::Format_ARGB32 );
+  for ( int y = 0; y < height; ++y )
+  {
+    for ( int x = 0; x < width; ++x )
+    {
+      QRgb pixel = qRgba( ( x * 255 ) / width, ( y * 255 ) / height, ( x + y ) % 256, 255 );
+      if ( ( x / 8 + y / 8 ) % 5 == 0 )
+        pixel = qRgba( x % 256, y % 256, 200, 0 );
+      else if ( ( x / 8 + y / 8 ) % 7 == 0 )
+        pixel = qRgba( x % 4, y % 4, 1, 10 + ( x + y ) % 20 );
+      image.setPixel( x, y, pixel );
+    }
+  }
+  return image;
+}
+
+void TestQgsColorCubeQuantizer::exactColors_data()
+{
+  QTest::addColumn<bool>( "dither" );
+
+  QTest::newRow( "no dithering" ) << false;
+  QTest::newRow( "dithering" ) << true;
+}
+
+void TestQgsColorCubeQuantizer::exactColors()
+{
+  QFETCH( bool, dither );
+
+  const QImage image = fewColorsImage();
+  const QImage result = QgsWms::colorCubeQuantize( image, 256, dither, 1 );
+  QCOMPARE( result.format(), QImage::Format_Indexed8 );
+  QCOMPARE( result.size(), image.size() );
+  QVERIFY( result.colorCount() <= 256 );
+
+  for ( int y = 0; y < image.height(); ++y )
+  {
+    for ( int x = 0; x < image.width(); ++x )
+    {
+      const QRgb expected = image.pixel( x, y );
+      const QRgb actual = result.color( result.pixelIndex( x, y ) );
+      if ( qAlpha( expected ) == 0 )
+        QCOMPARE( qAlpha( actual ), 0 );
+      else
+        QCOMPARE( actual, expected );
+    }
+  }
+}
+
+void TestQgsColorCubeQuantizer::transparentEntry_data()
+{
+  QTest::addColumn<bool>( "dither" );
+  QTest::addColumn<int>( "colors" );
+
+  QTest::newRow( "256 colors" ) << false << 256;
+  QTest::newRow( "256 colors dithering" ) << true << 256;
+  QTest::newRow( "16 colors" ) << false << 16;
+  QTest::newRow( "2 colors dithering" ) << true << 2;
+}
+
+void TestQgsColorCubeQuantizer::transparentEntry()
+{
+  QFETCH( bool, dither );
+  QFETCH( int, colors );
+
+  const QImage image = manyColorsImage( 200, 150 );
+  const QImage result = QgsWms::colorCubeQuantize( image, colors, dither, 1 );
+  QVERIFY( result.colorCount() <= colors );
+  QCOMPARE( qAlpha( result.color( 0 ) ), 0 );
+
+  for ( int y = 0; y < image.height(); ++y )
+  {
+    for ( int x = 0; x < image.width(); ++x )
+    {
+      const int index = result.pixelIndex( x, y );
+      // only transparent pixels use the transparent entry
+      QCOMPARE( qAlpha( image.pixel( x, y ) ) == 0, index == 0 );
+      QCOMPARE( qAlpha( image.pixel( x, y ) ) == 0, qAlpha( result.color( index ) ) == 0 );
+    }
+  }
+}
+
+void TestQgsColorCubeQuantizer::parallelOutput_data()
+{
+  QTest::addColumn<bool>( "dither" );
+  QTest::addColumn<int>( "colors" );
+
+  QTest::newRow( "256 colors" ) << false << 256;
+  QTest::newRow( "256 colors dithering" ) << true << 256;
+  QTest::newRow( "64 colors" ) << false << 64;
+}
+
+void TestQgsColorCubeQuantizer::parallelOutput()
+{
+  QFETCH( bool, dither );
+  QFETCH( int, colors );
+
+  // large enough for the histogram and the mapping to be split between threads
+  const QImage image = manyColorsImage( 700, 600 );
+
+  QVector<QRgb> singlePalette;
+  QVector<QRgb> parallelPalette;
+  QgsWms::colorCubePalette( singlePalette, colors, image, 1 );
+  QgsWms::colorCubePalette( parallelPalette, colors, image, 4 );
+  QCOMPARE( parallelPalette, singlePalette );
+
+  const QImage single = QgsWms::colorCubeQuantize( image, colors, dither, 1 );
+  const QImage parallel = QgsWms::colorCubeQuantize( image, colors, dither, 4 );
+  QCOMPARE( parallel.colorTable(), single.colorTable() );
+  QVERIFY( parallel == single );
+
+  // the premultiplied image of the renderer gives the same result
+  const QImage premultiplied = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+  QCOMPARE( QgsWms::colorCubeQuantize( premultiplied, colors, dither, 4 ), QgsWms::colorCubeQuantize( premultiplied, colors, dither, 1 ) );
+}
+
+QGSTEST_MAIN( TestQgsColorCubeQuantizer )
+#include "testqgscolorcubequantizer.moc"